@@ -1,5 +1,8 @@
 using System;
+using System.IO.MemoryMappedFiles;
 using System.Runtime.InteropServices;
+using System.Threading;
+using System.Threading.Tasks;
 
 namespace ScreenCaptureExample
 {
@@ -15,11 +18,161 @@ namespace ScreenCaptureExample
             TextureProcessingFailed = 4,
             FileSaveFailed = 5,
             TimeoutError = 6,
+            BufferTooSmall = 7,
+            FrameDropped = 8,
+            EncoderFailed = 9,
+            Cancelled = 10,
             InvalidParameter = 97,
             NotImplemented = 98,
             UnknownError = 99
         }
 
+        // Output image formats matching the DLL
+        public enum ImageFormat : int
+        {
+            Auto = 0,
+            Png = 1,
+            Bmp = 2,
+            Raw = 3,
+            Qoi = 4,
+            Jpeg = 5,
+            Jxr = 6
+        }
+
+        // Capture APIs of one-shot captures matching the DLL
+        public enum CaptureBackend : int
+        {
+            Auto = 0,               // Graphics Capture; Desktop Duplication where it cannot hide the cursor or border
+            GraphicsCapture = 1,
+            DesktopDuplication = 2  // Monitors only, never draws the cursor or a border
+        }
+
+        // GPU choices of every capture matching the DLL
+        public enum GpuPreference : int
+        {
+            Auto = 0,               // The adapter that drives the target monitor
+            SystemDefault = 1,
+            MinimumPower = 2,
+            HighPerformance = 3
+        }
+
+        // Timed capture stages matching the DLL (indexes into GetCaptureStats)
+        public enum CaptureStage : int
+        {
+            DeviceCreation = 0,
+            FirstFrameWait = 1,
+            Readback = 2,
+            PixelCopy = 3,
+            Encode = 4,
+            FileWrite = 5
+        }
+
+        // Latency of one stage in milliseconds
+        [StructLayout(LayoutKind.Sequential)]
+        public struct StageStats
+        {
+            public ulong Count;
+            public double LastMs;
+            public double MeanMs;
+            public double P50Ms;
+            public double P99Ms;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct NativeCaptureStats
+        {
+            [MarshalAs(UnmanagedType.ByValArray, SizeConst = 6)]
+            public StageStats[] stages;
+            public ulong framesDropped;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct EncodeOptions
+        {
+            public int format;
+            public int jpegQuality;
+            public int pngFilter;
+            public int pngInterlace;
+            public int pngParallel;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct CaptureTarget
+        {
+            public int type;
+            public int monitorIndex;
+            public IntPtr monitor;
+            public IntPtr window;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct Region
+        {
+            public int x;
+            public int y;
+            public int width;
+            public int height;
+            public int scalePercent;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct AsyncOptions
+        {
+            [MarshalAs(UnmanagedType.LPWStr)]
+            public string outputPath;
+            public IntPtr target;
+            public IntPtr region;
+            public IntPtr encodeOptions;
+            public int captureFormat;
+            public int hideBorder;
+            public int hideCursor;
+            public int timeoutMs;
+        }
+
+        // Size and layout of a frame written by CaptureInto or CaptureRegionsInto
+        public struct CapturedFrame
+        {
+            public int Width;
+            public int Height;
+            public int Stride;      // 0 for encoded images
+            public long Size;       // Bytes written, or needed when Result is BufferTooSmall
+            public ErrorCode Result;
+        }
+
+        // Blittable mirrors of ScreenCaptureFrameRequest and ScreenCaptureFrameBuffer
+        [StructLayout(LayoutKind.Sequential)]
+        private struct FrameRequest
+        {
+            public CaptureTarget target;
+            public Region region;
+            public EncodeOptions encodeOptions;
+            public int encode;
+            public int pixelFormat;
+            public int captureFormat;
+            public int hideBorder;
+            public int hideCursor;
+            public int timeoutMs;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private unsafe struct FrameBuffer
+        {
+            public byte* buffer;
+            public ulong bufferSize;
+            public ulong size;
+            public int width;
+            public int height;
+            public int stride;
+            public int pixelFormat;
+            public int result;
+        }
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        private delegate void CompletionCallback(ulong request, int result, IntPtr data, uint size, IntPtr userData);
+
+        // One delegate for every request keeps the callback alive; userData carries the task
+        private static readonly CompletionCallback s_completion = OnCaptureCompleted;
+
         // P/Invoke declarations
         [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern int CaptureScreen([MarshalAs(UnmanagedType.LPWStr)] string outputPath);
@@ -27,6 +180,45 @@ namespace ScreenCaptureExample
         [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern int CaptureScreenWithOptions([MarshalAs(UnmanagedType.LPWStr)] string outputPath, int hideBorder, int hideCursor);
 
+        [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int CaptureScreenWithFormat([MarshalAs(UnmanagedType.LPWStr)] string outputPath, ref EncodeOptions encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int CaptureScreenForTarget([MarshalAs(UnmanagedType.LPWStr)] string outputPath, ref CaptureTarget target, IntPtr encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int CaptureScreenRegion([MarshalAs(UnmanagedType.LPWStr)] string outputPath, IntPtr target, ref Region region, IntPtr encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int CaptureScreenWithCaptureFormat([MarshalAs(UnmanagedType.LPWStr)] string outputPath, IntPtr target, IntPtr region, int captureFormat, IntPtr encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int BeginCapture(ref AsyncOptions options, CompletionCallback callback, IntPtr userData, out ulong request);
+
+        [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int CaptureBurst([MarshalAs(UnmanagedType.LPWStr)] string outputPattern, int count, int intervalMs, IntPtr target, IntPtr region, int captureFormat, IntPtr encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern unsafe int CaptureFramesInto(FrameRequest* requests, FrameBuffer* frames, int count);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int GetMonitorCount();
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int GetCaptureStats(out NativeCaptureStats stats);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint = "SetCaptureBackend")]
+        private static extern int NativeSetCaptureBackend(int backend);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint = "SetCaptureAdapter")]
+        private static extern int NativeSetCaptureAdapter(int preference, uint luidLowPart, int luidHighPart);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl, EntryPoint = "ResetCaptureStats")]
+        private static extern void NativeResetCaptureStats();
+
+        [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int CaptureAllMonitorsToFiles([MarshalAs(UnmanagedType.LPWStr)] string outputPath, IntPtr encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
         [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern IntPtr GetErrorDescription(int errorCode);
 
@@ -73,38 +265,1005 @@ namespace ScreenCaptureExample
         }
 
         /// <summary>
-        /// Gets a human-readable description for an error code
+        /// Captures the primary monitor and saves it in the given format
         /// </summary>
-        /// <param name="errorCode">The error code to describe</param>
-        /// <returns>Error description string</returns>
-        public static string GetErrorDescription(ErrorCode errorCode)
+        /// <param name="outputPath">Full path to the output file</param>
+        /// <param name="format">Output format (Auto picks it from the file extension)</param>
+        /// <param name="jpegQuality">JPEG quality 1-100</param>
+        /// <param name="hideBorder">Hide the capture border (recommended: true)</param>
+        /// <param name="hideCursor">Hide the mouse cursor (recommended: true)</param>
+        /// <param name="parallelPng">Encode PNG on all cores instead of with WIC</param>
+        /// <returns>ErrorCode indicating success or failure</returns>
+        public static ErrorCode Capture(string outputPath, ImageFormat format, int jpegQuality = 90, bool hideBorder = true, bool hideCursor = true, bool parallelPng = false)
         {
+            if (string.IsNullOrEmpty(outputPath))
+            {
+                return ErrorCode.InvalidParameter;
+            }
+
+            var options = new EncodeOptions { format = (int)format, jpegQuality = jpegQuality, pngParallel = parallelPng ? 1 : 0 };
+
             try
             {
-                IntPtr ptr = GetErrorDescription((int)errorCode);
-                return Marshal.PtrToStringUni(ptr) ?? "Unknown error";
+                int result = CaptureScreenWithFormat(outputPath, ref options, hideBorder ? 1 : 0, hideCursor ? 1 : 0, 10000);
+                return (ErrorCode)result;
             }
-            catch
+            catch (DllNotFoundException)
             {
-                return "Failed to get error description";
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+            catch (Exception ex)
+            {
+                throw new InvalidOperationException($"Error calling screen capture: {ex.Message}", ex);
             }
         }
 
         /// <summary>
-        /// Gets the version information of the screen capture library
+        /// Number of attached monitors (index 0 is the primary monitor)
         /// </summary>
-        /// <returns>Version string</returns>
-        public static string GetVersion()
+        public static int MonitorCount => GetMonitorCount();
+
+        /// <summary>
+        /// Captures one monitor (format from the file extension)
+        /// </summary>
+        /// <param name="outputPath">Full path to the output file</param>
+        /// <param name="monitorIndex">Monitor index, 0 is the primary monitor</param>
+        public static ErrorCode CaptureMonitor(string outputPath, int monitorIndex, bool hideBorder = true, bool hideCursor = true)
+        {
+            return CaptureTargetToFile(outputPath, new CaptureTarget { type = 1, monitorIndex = monitorIndex }, hideBorder, hideCursor);
+        }
+
+        /// <summary>
+        /// Captures one window (format from the file extension)
+        /// </summary>
+        /// <param name="outputPath">Full path to the output file</param>
+        /// <param name="window">Window handle (e.g. Process.MainWindowHandle)</param>
+        public static ErrorCode CaptureWindow(string outputPath, IntPtr window, bool hideBorder = true, bool hideCursor = true)
         {
+            return CaptureTargetToFile(outputPath, new CaptureTarget { type = 3, window = window }, hideBorder, hideCursor);
+        }
+
+        /// <summary>
+        /// Captures part of the primary monitor, cropped and downscaled on the GPU (format from the file extension)
+        /// </summary>
+        /// <param name="outputPath">Full path to the output file</param>
+        /// <param name="x">Left edge of the region</param>
+        /// <param name="y">Top edge of the region</param>
+        /// <param name="width">Region width, 0 to extend to the right edge</param>
+        /// <param name="height">Region height, 0 to extend to the bottom edge</param>
+        /// <param name="scalePercent">Output size relative to the region (1-100)</param>
+        public static ErrorCode CaptureRegion(string outputPath, int x, int y, int width, int height, int scalePercent = 100, bool hideBorder = true, bool hideCursor = true)
+        {
+            if (string.IsNullOrEmpty(outputPath))
+            {
+                return ErrorCode.InvalidParameter;
+            }
+
             try
             {
-                IntPtr ptr = GetLibraryVersion();
-                return Marshal.PtrToStringUni(ptr) ?? "Unknown version";
+                var region = new Region { x = x, y = y, width = width, height = height, scalePercent = scalePercent };
+                return (ErrorCode)CaptureScreenRegion(outputPath, IntPtr.Zero, ref region, IntPtr.Zero, hideBorder ? 1 : 0, hideCursor ? 1 : 0, 10000);
             }
-            catch
+            catch (DllNotFoundException)
             {
-                return "Failed to get version";
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Captures the primary monitor as half floats, keeping the HDR range in .jxr files;
+        /// other formats are tone-mapped to 8 bits on the GPU
+        /// </summary>
+        /// <param name="outputPath">Full path to the output file</param>
+        public static ErrorCode CaptureHdr(string outputPath, bool hideBorder = true, bool hideCursor = true)
+        {
+            if (string.IsNullOrEmpty(outputPath))
+            {
+                return ErrorCode.InvalidParameter;
+            }
+
+            try
+            {
+                return (ErrorCode)CaptureScreenWithCaptureFormat(outputPath, IntPtr.Zero, IntPtr.Zero, 1, IntPtr.Zero, hideBorder ? 1 : 0, hideCursor ? 1 : 0, 10000);
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Captures every monitor into one image of the whole desktop (format from the file extension)
+        /// </summary>
+        /// <param name="outputPath">Full path to the output file</param>
+        public static ErrorCode CaptureDesktop(string outputPath, bool hideBorder = true, bool hideCursor = true)
+        {
+            return CaptureTargetToFile(outputPath, new CaptureTarget { type = 4 }, hideBorder, hideCursor);
+        }
+
+        /// <summary>
+        /// Captures every monitor at the same moment into one file per monitor,
+        /// named &lt;name&gt;_&lt;index&gt;&lt;extension&gt; after outputPath
+        /// </summary>
+        /// <param name="outputPath">Base path of the output files</param>
+        public static ErrorCode CaptureEachMonitor(string outputPath, bool hideBorder = true, bool hideCursor = true)
+        {
+            if (string.IsNullOrEmpty(outputPath))
+            {
+                return ErrorCode.InvalidParameter;
+            }
+
+            try
+            {
+                return (ErrorCode)CaptureAllMonitorsToFiles(outputPath, IntPtr.Zero, hideBorder ? 1 : 0, hideCursor ? 1 : 0, 10000);
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Captures count frames of the primary monitor intervalMs apart in one session,
+        /// one file per frame, encoded after the last frame is taken
+        /// </summary>
+        /// <param name="outputPattern">Path with an integer field for the frame index, e.g. out_%03d.png</param>
+        public static ErrorCode CaptureBurst(string outputPattern, int count, int intervalMs, bool hideBorder = true, bool hideCursor = true)
+        {
+            if (string.IsNullOrEmpty(outputPattern) || count <= 0 || intervalMs < 0)
+            {
+                return ErrorCode.InvalidParameter;
+            }
+
+            try
+            {
+                return (ErrorCode)CaptureBurst(outputPattern, count, intervalMs, IntPtr.Zero, IntPtr.Zero, 0, IntPtr.Zero, hideBorder ? 1 : 0, hideCursor ? 1 : 0, 10000);
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Captures the primary monitor to a file on the library's capture thread
+        /// without blocking the caller or a thread-pool thread
+        /// </summary>
+        /// <param name="outputPath">Full path to the output file</param>
+        public static Task CaptureAsync(string outputPath, bool hideBorder = true, bool hideCursor = true)
+        {
+            if (string.IsNullOrEmpty(outputPath))
+            {
+                throw new ArgumentException("Output path is required", nameof(outputPath));
+            }
+
+            return BeginCaptureTask(outputPath, hideBorder, hideCursor);
+        }
+
+        /// <summary>
+        /// Captures the primary monitor as PNG bytes on the library's capture thread
+        /// without blocking the caller or a thread-pool thread
+        /// </summary>
+        public static Task<byte[]> CaptureToMemoryAsync(bool hideBorder = true, bool hideCursor = true)
+        {
+            return BeginCaptureTask(null, hideBorder, hideCursor);
+        }
+
+        private static Task<byte[]> BeginCaptureTask(string outputPath, bool hideBorder, bool hideCursor)
+        {
+            var completion = new TaskCompletionSource<byte[]>(TaskCreationOptions.RunContinuationsAsynchronously);
+            var handle = GCHandle.Alloc(completion);
+
+            var options = new AsyncOptions { outputPath = outputPath, hideBorder = hideBorder ? 1 : 0, hideCursor = hideCursor ? 1 : 0 };
+            int result;
+            try
+            {
+                result = BeginCapture(ref options, s_completion, GCHandle.ToIntPtr(handle), out _);
+            }
+            catch (DllNotFoundException)
+            {
+                handle.Free();
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
             }
+
+            if (result != (int)ErrorCode.Success)
+            {
+                handle.Free();
+                completion.SetException(new InvalidOperationException($"Failed to start capture: {GetErrorDescription((ErrorCode)result)}"));
+            }
+            return completion.Task;
+        }
+
+        private static void OnCaptureCompleted(ulong request, int result, IntPtr data, uint size, IntPtr userData)
+        {
+            var handle = GCHandle.FromIntPtr(userData);
+            var completion = (TaskCompletionSource<byte[]>)handle.Target;
+            handle.Free();
+
+            if (result != (int)ErrorCode.Success)
+            {
+                completion.SetException(new InvalidOperationException($"Capture failed: {GetErrorDescription((ErrorCode)result)}"));
+                return;
+            }
+
+            // File captures complete with an empty array
+            byte[] bytes = new byte[size];
+            if (size > 0)
+            {
+                Marshal.Copy(data, bytes, 0, (int)size);
+            }
+            completion.SetResult(bytes);
+        }
+
+        private static ErrorCode CaptureTargetToFile(string outputPath, CaptureTarget target, bool hideBorder, bool hideCursor)
+        {
+            if (string.IsNullOrEmpty(outputPath))
+            {
+                return ErrorCode.InvalidParameter;
+            }
+
+            try
+            {
+                int result = CaptureScreenForTarget(outputPath, ref target, IntPtr.Zero, hideBorder ? 1 : 0, hideCursor ? 1 : 0, 10000);
+                return (ErrorCode)result;
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Captures raw pixels of the primary monitor straight into destination
+        /// (a stackalloc, pinned or pooled buffer), with no native allocation or extra copy
+        /// </summary>
+        /// <param name="destination">Receives tightly packed rows of format</param>
+        /// <param name="frame">Layout of the pixels; on BufferTooSmall, Size is the length needed</param>
+        public static unsafe ErrorCode CaptureInto(Span<byte> destination, CaptureSession.PixelFormat format, out CapturedFrame frame, bool hideBorder = true, bool hideCursor = true)
+        {
+            FrameRequest request = NewFrameRequest(0, 0, 0, 0, format, hideBorder, hideCursor);
+            ErrorCode result;
+            fixed (byte* pixels = destination)
+            {
+                FrameBuffer buffer = new FrameBuffer { buffer = pixels, bufferSize = (ulong)destination.Length };
+                result = InvokeCaptureFramesInto(&request, &buffer, 1);
+                frame = ToCapturedFrame(buffer);
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// Captures several regions of the primary monitor from one frame in a single call,
+        /// region i going into buffers[i]
+        /// </summary>
+        /// <param name="regions">Regions relative to the monitor (width/height 0 extend to the edge)</param>
+        /// <param name="buffers">One destination per region</param>
+        /// <param name="frames">Receives the layout and result of each region</param>
+        /// <returns>ErrorCode of the first region that failed</returns>
+        public static unsafe ErrorCode CaptureRegionsInto((int X, int Y, int Width, int Height)[] regions, byte[][] buffers, CaptureSession.PixelFormat format, CapturedFrame[] frames, bool hideBorder = true, bool hideCursor = true)
+        {
+            if (regions == null || buffers == null || frames == null || regions.Length == 0 ||
+                buffers.Length != regions.Length || frames.Length != regions.Length)
+            {
+                return ErrorCode.InvalidParameter;
+            }
+
+            var requests = new FrameRequest[regions.Length];
+            var outputs = new FrameBuffer[regions.Length];
+            var pins = new GCHandle[regions.Length];
+            try
+            {
+                for (int i = 0; i < regions.Length; i++)
+                {
+                    requests[i] = NewFrameRequest(regions[i].X, regions[i].Y, regions[i].Width, regions[i].Height, format, hideBorder, hideCursor);
+                    if (buffers[i] != null)
+                    {
+                        pins[i] = GCHandle.Alloc(buffers[i], GCHandleType.Pinned);
+                        outputs[i].buffer = (byte*)pins[i].AddrOfPinnedObject();
+                        outputs[i].bufferSize = (ulong)buffers[i].Length;
+                    }
+                }
+
+                ErrorCode result;
+                fixed (FrameRequest* requestPointer = requests)
+                fixed (FrameBuffer* outputPointer = outputs)
+                {
+                    result = InvokeCaptureFramesInto(requestPointer, outputPointer, regions.Length);
+                }
+
+                for (int i = 0; i < regions.Length; i++)
+                {
+                    frames[i] = ToCapturedFrame(outputs[i]);
+                }
+                return result;
+            }
+            finally
+            {
+                foreach (var pin in pins)
+                {
+                    if (pin.IsAllocated)
+                    {
+                        pin.Free();
+                    }
+                }
+            }
+        }
+
+        private static FrameRequest NewFrameRequest(int x, int y, int width, int height, CaptureSession.PixelFormat format, bool hideBorder, bool hideCursor)
+        {
+            return new FrameRequest
+            {
+                region = new Region { x = x, y = y, width = width, height = height, scalePercent = 100 },
+                pixelFormat = (int)format,
+                hideBorder = hideBorder ? 1 : 0,
+                hideCursor = hideCursor ? 1 : 0,
+                timeoutMs = 10000
+            };
+        }
+
+        private static unsafe ErrorCode InvokeCaptureFramesInto(FrameRequest* requests, FrameBuffer* frames, int count)
+        {
+            try
+            {
+                return (ErrorCode)CaptureFramesInto(requests, frames, count);
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        private static CapturedFrame ToCapturedFrame(FrameBuffer buffer)
+        {
+            return new CapturedFrame { Width = buffer.width, Height = buffer.height, Stride = buffer.stride, Size = (long)buffer.size, Result = (ErrorCode)buffer.result };
+        }
+
+        /// <summary>
+        /// Gets per-stage latencies of every capture in the process, indexed by CaptureStage
+        /// </summary>
+        /// <param name="framesDropped">Frames captured but never delivered by streams, encode queues or recordings</param>
+        public static StageStats[] GetCaptureStats(out ulong framesDropped)
+        {
+            try
+            {
+                int result = GetCaptureStats(out NativeCaptureStats stats);
+                if (result != (int)ErrorCode.Success)
+                {
+                    throw new InvalidOperationException($"Failed to get capture stats: {GetErrorDescription((ErrorCode)result)}");
+                }
+
+                framesDropped = stats.framesDropped;
+                return stats.stages;
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Clears the statistics returned by GetCaptureStats
+        /// </summary>
+        public static void ResetCaptureStats()
+        {
+            try
+            {
+                NativeResetCaptureStats();
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Chooses the capture API of every later one-shot and asynchronous capture in the process
+        /// </summary>
+        public static void SetCaptureBackend(CaptureBackend backend)
+        {
+            try
+            {
+                int result = NativeSetCaptureBackend((int)backend);
+                if (result != (int)ErrorCode.Success)
+                {
+                    throw new ArgumentOutOfRangeException(nameof(backend));
+                }
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Chooses the GPU of every later capture, session, stream and recording in the process
+        /// </summary>
+        public static void SetCaptureAdapter(GpuPreference preference)
+        {
+            try
+            {
+                int result = NativeSetCaptureAdapter((int)preference, 0, 0);
+                if (result != (int)ErrorCode.Success)
+                {
+                    throw new ArgumentOutOfRangeException(nameof(preference));
+                }
+            }
+            catch (DllNotFoundException)
+            {
+                throw new InvalidOperationException("ScreenCaptureDLL.dll not found. Make sure it's in the same directory as your application.");
+            }
+        }
+
+        /// <summary>
+        /// Gets a human-readable description for an error code
+        /// </summary>
+        /// <param name="errorCode">The error code to describe</param>
+        /// <returns>Error description string</returns>
+        public static string GetErrorDescription(ErrorCode errorCode)
+        {
+            try
+            {
+                IntPtr ptr = GetErrorDescription((int)errorCode);
+                return Marshal.PtrToStringUni(ptr) ?? "Unknown error";
+            }
+            catch
+            {
+                return "Failed to get error description";
+            }
+        }
+
+        /// <summary>
+        /// Gets the version information of the screen capture library
+        /// </summary>
+        /// <returns>Version string</returns>
+        public static string GetVersion()
+        {
+            try
+            {
+                IntPtr ptr = GetLibraryVersion();
+                return Marshal.PtrToStringUni(ptr) ?? "Unknown version";
+            }
+            catch
+            {
+                return "Failed to get version";
+            }
+        }
+    }
+
+    /// <summary>
+    /// Persistent capture session: keeps the capture pipeline warm between grabs
+    /// </summary>
+    public sealed class CaptureSession : IDisposable
+    {
+        // Raw pixel layouts matching the DLL
+        public enum PixelFormat : int
+        {
+            Bgra = 0,
+            Rgba = 1,
+            Rgb24 = 2,
+            Gray8 = 3
+        }
+
+        /// <summary>
+        /// Shared GPU texture of a session (handles are owned by the session)
+        /// </summary>
+        [StructLayout(LayoutKind.Sequential)]
+        public struct SharedTexture
+        {
+            public IntPtr TextureHandle;
+            public IntPtr FenceHandle;
+            public int Width;
+            public int Height;
+            public ulong FrameNumber;
+            public ulong Generation;
+            public int KeyedMutex;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct SharedTextureOptions
+        {
+            public int keyedMutex;
+            public int skipReadback;
+        }
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int EnableSharedTexture(IntPtr session, ref SharedTextureOptions options);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int GetSharedTexture(IntPtr session, out SharedTexture info, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int OpenCaptureSession(int hideBorder, int hideCursor, out IntPtr session);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int GrabFrame(IntPtr session, out IntPtr buffer, out uint size, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int GrabRawFrame(IntPtr session, out IntPtr pixels, out int width, out int height, out int stride, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern unsafe int GrabRawFrameToBufferWithPixelFormat(IntPtr session, int pixelFormat, byte* buffer, uint bufferSize, out int width, out int height, out int stride, int timeoutMs);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void CloseCaptureSession(IntPtr session);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void FreeBuffer(IntPtr buffer);
+
+        private IntPtr _handle;
+
+        /// <summary>
+        /// Opens a capture session on the primary monitor
+        /// </summary>
+        /// <param name="hideBorder">Hide the capture border (recommended: true)</param>
+        /// <param name="hideCursor">Hide the mouse cursor (recommended: true)</param>
+        public CaptureSession(bool hideBorder = true, bool hideCursor = true)
+        {
+            var result = (ScreenCapture.ErrorCode)OpenCaptureSession(hideBorder ? 1 : 0, hideCursor ? 1 : 0, out _handle);
+            if (result != ScreenCapture.ErrorCode.Success)
+            {
+                throw new InvalidOperationException($"Failed to open capture session: {ScreenCapture.GetErrorDescription(result)}");
+            }
+        }
+
+        /// <summary>
+        /// Grabs the newest frame as PNG data
+        /// </summary>
+        /// <param name="timeoutMs">Maximum time to wait for the first frame</param>
+        /// <returns>PNG encoded frame</returns>
+        public byte[] Grab(int timeoutMs = 10000)
+        {
+            if (_handle == IntPtr.Zero)
+            {
+                throw new ObjectDisposedException(nameof(CaptureSession));
+            }
+
+            var result = (ScreenCapture.ErrorCode)GrabFrame(_handle, out IntPtr buffer, out uint size, timeoutMs);
+            try
+            {
+                if (result != ScreenCapture.ErrorCode.Success)
+                {
+                    throw new InvalidOperationException($"Failed to grab frame: {ScreenCapture.GetErrorDescription(result)}");
+                }
+
+                byte[] data = new byte[size];
+                Marshal.Copy(buffer, data, 0, (int)size);
+                return data;
+            }
+            finally
+            {
+                FreeBuffer(buffer);
+            }
+        }
+
+        /// <summary>
+        /// Grabs the newest frame as raw BGRA pixels, skipping the PNG round trip
+        /// </summary>
+        /// <param name="width">Frame width in pixels</param>
+        /// <param name="height">Frame height in pixels</param>
+        /// <param name="stride">Bytes between rows (may exceed width * 4)</param>
+        /// <param name="timeoutMs">Maximum time to wait for the first frame</param>
+        /// <returns>BGRA pixel data</returns>
+        public byte[] GrabRaw(out int width, out int height, out int stride, int timeoutMs = 10000)
+        {
+            if (_handle == IntPtr.Zero)
+            {
+                throw new ObjectDisposedException(nameof(CaptureSession));
+            }
+
+            var result = (ScreenCapture.ErrorCode)GrabRawFrame(_handle, out IntPtr pixels, out width, out height, out stride, timeoutMs);
+            try
+            {
+                if (result != ScreenCapture.ErrorCode.Success)
+                {
+                    throw new InvalidOperationException($"Failed to grab frame: {ScreenCapture.GetErrorDescription(result)}");
+                }
+
+                byte[] data = new byte[stride * height];
+                Marshal.Copy(pixels, data, 0, data.Length);
+                return data;
+            }
+            finally
+            {
+                FreeBuffer(pixels);
+            }
+        }
+
+        /// <summary>
+        /// Grabs the newest frame into a reusable buffer as tightly packed BGRA rows,
+        /// growing the buffer only when the frame size changes
+        /// </summary>
+        /// <param name="buffer">Reusable pixel buffer (reallocated only if too small)</param>
+        /// <param name="width">Frame width in pixels</param>
+        /// <param name="height">Frame height in pixels</param>
+        /// <param name="timeoutMs">Maximum time to wait for the first frame</param>
+        public void GrabRawInto(ref byte[] buffer, out int width, out int height, int timeoutMs = 10000)
+        {
+            GrabRawInto(ref buffer, PixelFormat.Bgra, out width, out height, timeoutMs);
+        }
+
+        /// <summary>
+        /// Grabs the newest frame into a reusable buffer converted to a pixel format
+        /// (e.g. Rgb24 or Gray8 for ML input); the conversion runs natively with SIMD
+        /// </summary>
+        /// <param name="buffer">Reusable pixel buffer (reallocated only if too small)</param>
+        /// <param name="format">Output pixel layout, rows tightly packed</param>
+        /// <param name="width">Frame width in pixels</param>
+        /// <param name="height">Frame height in pixels</param>
+        /// <param name="timeoutMs">Maximum time to wait for the first frame</param>
+        public unsafe void GrabRawInto(ref byte[] buffer, PixelFormat format, out int width, out int height, int timeoutMs = 10000)
+        {
+            if (_handle == IntPtr.Zero)
+            {
+                throw new ObjectDisposedException(nameof(CaptureSession));
+            }
+
+            while (true)
+            {
+                ScreenCapture.ErrorCode result;
+                int stride;
+                fixed (byte* pixels = buffer)
+                {
+                    result = (ScreenCapture.ErrorCode)GrabRawFrameToBufferWithPixelFormat(_handle, (int)format, pixels, (uint)(buffer?.Length ?? 0), out width, out height, out stride, timeoutMs);
+                }
+
+                if (result == ScreenCapture.ErrorCode.BufferTooSmall)
+                {
+                    buffer = new byte[stride * height];
+                    continue;
+                }
+
+                if (result != ScreenCapture.ErrorCode.Success)
+                {
+                    throw new InvalidOperationException($"Failed to grab frame: {ScreenCapture.GetErrorDescription(result)}");
+                }
+
+                return;
+            }
+        }
+
+        /// <summary>
+        /// Copies every frame into a BGRA texture that other D3D11/D3D12 devices open
+        /// by NT handle (see GetSharedTexture), without any CPU readback
+        /// </summary>
+        /// <param name="keyedMutex">Guard the texture with a keyed mutex (key 0)</param>
+        /// <param name="skipReadback">Stop staging copies for Grab calls</param>
+        public void EnableSharedTexture(bool keyedMutex = true, bool skipReadback = true)
+        {
+            if (_handle == IntPtr.Zero)
+            {
+                throw new ObjectDisposedException(nameof(CaptureSession));
+            }
+
+            var options = new SharedTextureOptions { keyedMutex = keyedMutex ? 1 : 0, skipReadback = skipReadback ? 1 : 0 };
+            var result = (ScreenCapture.ErrorCode)EnableSharedTexture(_handle, ref options);
+            if (result != ScreenCapture.ErrorCode.Success)
+            {
+                throw new InvalidOperationException($"Failed to enable texture sharing: {ScreenCapture.GetErrorDescription(result)}");
+            }
+        }
+
+        /// <summary>
+        /// Describes the shared texture, waiting for the first shared frame
+        /// </summary>
+        /// <param name="timeoutMs">Maximum time to wait for the first frame</param>
+        public SharedTexture GetSharedTexture(int timeoutMs = 10000)
+        {
+            if (_handle == IntPtr.Zero)
+            {
+                throw new ObjectDisposedException(nameof(CaptureSession));
+            }
+
+            var result = (ScreenCapture.ErrorCode)GetSharedTexture(_handle, out SharedTexture info, timeoutMs);
+            if (result != ScreenCapture.ErrorCode.Success)
+            {
+                throw new InvalidOperationException($"Failed to get shared texture: {ScreenCapture.GetErrorDescription(result)}");
+            }
+            return info;
+        }
+
+        public void Dispose()
+        {
+            if (_handle != IntPtr.Zero)
+            {
+                CloseCaptureSession(_handle);
+                _handle = IntPtr.Zero;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Records the primary monitor to an MP4 file with a hardware video encoder
+    /// </summary>
+    public sealed class ScreenRecorder : IDisposable
+    {
+        public enum VideoCodec : int
+        {
+            H264 = 0,
+            Hevc = 1
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct RecordOptions
+        {
+            public int hideBorder;
+            public int hideCursor;
+            public int codec;
+            public int frameRate;
+            public int bitrate;
+        }
+
+        [DllImport("ScreenCaptureDLL.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int StartRecording([MarshalAs(UnmanagedType.LPWStr)] string outputPath, ref RecordOptions options, out IntPtr recording);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int StopRecording(IntPtr recording);
+
+        private IntPtr _handle;
+
+        /// <summary>
+        /// Starts recording; throws if the encoder cannot be set up
+        /// </summary>
+        public ScreenRecorder(string outputPath, VideoCodec codec = VideoCodec.H264, int frameRate = 30, int bitrate = 8000000, bool hideBorder = true, bool hideCursor = true)
+        {
+            var options = new RecordOptions
+            {
+                hideBorder = hideBorder ? 1 : 0,
+                hideCursor = hideCursor ? 1 : 0,
+                codec = (int)codec,
+                frameRate = frameRate,
+                bitrate = bitrate
+            };
+
+            var result = (ScreenCapture.ErrorCode)StartRecording(outputPath, ref options, out _handle);
+            if (result != ScreenCapture.ErrorCode.Success)
+            {
+                throw new InvalidOperationException($"Failed to start recording: {ScreenCapture.GetErrorDescription(result)}");
+            }
+        }
+
+        /// <summary>
+        /// Stops recording and finalizes the file
+        /// </summary>
+        public ScreenCapture.ErrorCode Stop()
+        {
+            if (_handle == IntPtr.Zero)
+            {
+                return ScreenCapture.ErrorCode.Success;
+            }
+
+            var result = (ScreenCapture.ErrorCode)StopRecording(_handle);
+            _handle = IntPtr.Zero;
+            return result;
+        }
+
+        public void Dispose()
+        {
+            Stop();
+        }
+    }
+
+    /// <summary>
+    /// Streams the primary monitor into a named shared-memory ring that
+    /// FrameRingReader instances in other processes read without locking
+    /// </summary>
+    public sealed class FrameRingPublisher : IDisposable
+    {
+        [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Unicode)]
+        private struct RingOptions
+        {
+            [MarshalAs(UnmanagedType.LPWStr)]
+            public string name;
+            public int slotCount;
+            public int maxWidth;
+            public int maxHeight;
+        }
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int StartRingStream(IntPtr target, ref RingOptions ringOptions, IntPtr options, out IntPtr stream);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void StopStream(IntPtr stream);
+
+        private IntPtr _handle;
+
+        /// <summary>
+        /// Starts publishing; throws if the ring cannot be created (e.g. the name is in use)
+        /// </summary>
+        /// <param name="name">Mapping name, e.g. Local\ScreenCaptureRing</param>
+        public FrameRingPublisher(string name, int slotCount = 3)
+        {
+            var options = new RingOptions { name = name, slotCount = slotCount };
+            var result = (ScreenCapture.ErrorCode)StartRingStream(IntPtr.Zero, ref options, IntPtr.Zero, out _handle);
+            if (result != ScreenCapture.ErrorCode.Success)
+            {
+                throw new InvalidOperationException($"Failed to start frame ring: {ScreenCapture.GetErrorDescription(result)}");
+            }
+        }
+
+        public void Dispose()
+        {
+            if (_handle != IntPtr.Zero)
+            {
+                StopStream(_handle);
+                _handle = IntPtr.Zero;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Streams the primary monitor into numbered image files encoded on worker threads
+    /// Capture only copies pixels into a bounded queue; Dispose waits for the queued files
+    /// </summary>
+    public sealed class FileStreamWriter : IDisposable
+    {
+        [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Unicode)]
+        private struct FileStreamOptions
+        {
+            [MarshalAs(UnmanagedType.LPWStr)]
+            public string outputPattern;
+            public int format;
+            public int jpegQuality;
+            public int pngFilter;
+            public int pngInterlace;
+            public int pngParallel;
+            public int workerCount;
+            public int queueDepth;
+            public int blockWhenFull;
+        }
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
+        private delegate void FileCallback(int result, [MarshalAs(UnmanagedType.LPWStr)] string path, IntPtr userData);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern int StartFileStream(IntPtr target, ref FileStreamOptions fileOptions, IntPtr options, FileCallback callback, IntPtr userData, out IntPtr stream);
+
+        [DllImport("ScreenCaptureDLL.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void StopStream(IntPtr stream);
+
+        private IntPtr _handle;
+        private readonly FileCallback _callback;    // Kept alive while the stream runs
+        private long _written;
+        private long _dropped;
+
+        /// <summary>
+        /// Starts writing; throws if the stream cannot start
+        /// </summary>
+        /// <param name="outputPattern">One integer field for the frame index, e.g. frames\out_%05d.qoi</param>
+        /// <param name="queueDepth">Frames waiting for an encoder</param>
+        /// <param name="blockWhenFull">Wait for the encoders instead of dropping the oldest queued frame</param>
+        public FileStreamWriter(string outputPattern, int queueDepth = 4, bool blockWhenFull = false)
+        {
+            _callback = (result, path, userData) =>
+            {
+                if ((ScreenCapture.ErrorCode)result == ScreenCapture.ErrorCode.Success)
+                {
+                    Interlocked.Increment(ref _written);
+                }
+                else if ((ScreenCapture.ErrorCode)result == ScreenCapture.ErrorCode.FrameDropped)
+                {
+                    Interlocked.Increment(ref _dropped);
+                }
+            };
+
+            var options = new FileStreamOptions { outputPattern = outputPattern, queueDepth = queueDepth, blockWhenFull = blockWhenFull ? 1 : 0 };
+            var result = (ScreenCapture.ErrorCode)StartFileStream(IntPtr.Zero, ref options, IntPtr.Zero, _callback, IntPtr.Zero, out _handle);
+            if (result != ScreenCapture.ErrorCode.Success)
+            {
+                throw new InvalidOperationException($"Failed to start file stream: {ScreenCapture.GetErrorDescription(result)}");
+            }
+        }
+
+        /// <summary>Files written so far</summary>
+        public long FramesWritten => Interlocked.Read(ref _written);
+
+        /// <summary>Frames the full queue discarded</summary>
+        public long FramesDropped => Interlocked.Read(ref _dropped);
+
+        public void Dispose()
+        {
+            if (_handle != IntPtr.Zero)
+            {
+                StopStream(_handle);
+                _handle = IntPtr.Zero;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Reads the newest frame of a frame ring published by another process
+    /// </summary>
+    public sealed class FrameRingReader : IDisposable
+    {
+        private const uint Magic = 0x42524353;
+
+        // Offsets in ScreenCaptureRingHeader and ScreenCaptureRingSlot
+        private const long HeaderSizeOffset = 8;
+        private const long SlotCountOffset = 12;
+        private const long SlotSizeOffset = 16;
+        private const long LatestSlotOffset = 40;
+        private const long SlotHeaderSize = 64;
+
+        public struct FrameInfo
+        {
+            public ulong FrameNumber;
+            public long QpcTimestamp;
+            public long Timestamp;
+            public int Width;
+            public int Height;
+            public int Stride;
+        }
+
+        private readonly MemoryMappedFile _mapping;
+        private readonly MemoryMappedViewAccessor _view;
+
+        public FrameRingReader(string name)
+        {
+            _mapping = MemoryMappedFile.OpenExisting(name, MemoryMappedFileRights.Read);
+            _view = _mapping.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+        }
+
+        /// <summary>
+        /// Copies the newest frame's BGRA rows into buffer (resized as needed)
+        /// Returns false if no frame has been published yet
+        /// </summary>
+        public bool TryReadLatest(ref byte[] buffer, out FrameInfo info)
+        {
+            info = default;
+            if (_view.ReadUInt32(0) != Magic)
+            {
+                return false;
+            }
+
+            long headerSize = _view.ReadUInt32(HeaderSizeOffset);
+            long slotSize = _view.ReadInt64(SlotSizeOffset);
+            uint slotCount = _view.ReadUInt32(SlotCountOffset);
+
+            while (true)
+            {
+                long latest = _view.ReadInt64(LatestSlotOffset);
+                Thread.MemoryBarrier();
+                if (latest < 0 || latest >= slotCount)
+                {
+                    return false;
+                }
+
+                long slot = headerSize + slotSize * latest;
+                ulong before = _view.ReadUInt64(slot);
+                Thread.MemoryBarrier();
+                if ((before & 1) != 0)
+                {
+                    continue;
+                }
+
+                info.FrameNumber = _view.ReadUInt64(slot + 8);
+                info.QpcTimestamp = _view.ReadInt64(slot + 16);
+                info.Timestamp = _view.ReadInt64(slot + 24);
+                info.Width = (int)_view.ReadUInt32(slot + 32);
+                info.Height = (int)_view.ReadUInt32(slot + 36);
+                info.Stride = (int)_view.ReadUInt32(slot + 40);
+                int dataSize = (int)_view.ReadUInt32(slot + 48);
+
+                if (buffer == null || buffer.Length != dataSize)
+                {
+                    buffer = new byte[dataSize];
+                }
+                _view.ReadArray(slot + SlotHeaderSize, buffer, 0, dataSize);
+
+                // The copy is only valid if the writer did not touch the slot meanwhile
+                Thread.MemoryBarrier();
+                if (_view.ReadUInt64(slot) == before)
+                {
+                    return true;
+                }
+            }
+        }
+
+        public void Dispose()
+        {
+            _view.Dispose();
+            _mapping.Dispose();
         }
     }
 }
@@ -0,0 +1,568 @@
+#include "../../pch.h"
+#include "../core/ScreenCaptureCore.h"
+#include "../core/FrameEncoder.h"
+#include "../core/CaptureDeviceCache.h"
+#include "../core/CaptureStats.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <filesystem>
+#include <new>
+
+using namespace ScreenCaptureCore;
+
+// Every C++ heap allocation in the process, including the core library's
+// (WIC, WinRT and driver allocations go through other heaps and are not counted)
+std::atomic<uint64_t> g_allocationCount{ 0 };
+
+void* operator new(size_t size)
+{
+    ++g_allocationCount;
+    if (void* memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+struct BenchOptions
+{
+    uint32_t iterations = 20;
+    uint32_t streamSeconds = 5;
+    bool encodeOnly = false;
+    std::wstring outputPath = L"screencapture-bench.json";
+};
+
+// Summary of repeated timings in milliseconds
+struct TimingSummary
+{
+    size_t count = 0;
+    double minMs = 0.0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+};
+
+void ShowUsage()
+{
+    std::wcout << L"Usage:" << std::endl;
+    std::wcout << L"  ScreenCaptureBench.exe [options]" << std::endl;
+    std::wcout << L"" << std::endl;
+    std::wcout << L"Options:" << std::endl;
+    std::wcout << L"  --iterations <n>      - Captures and encodes per measurement (default 20)" << std::endl;
+    std::wcout << L"  --stream-seconds <s>  - Length of the streaming run (default 5)" << std::endl;
+    std::wcout << L"  --encode-only         - Skip capture measurements (no display needed)" << std::endl;
+    std::wcout << L"  --output <path>       - JSON results file (default screencapture-bench.json)" << std::endl;
+    std::wcout << L"  --help                - Show this help" << std::endl;
+    std::wcout << L"" << std::endl;
+    std::wcout << L"Streaming fps follows desktop updates; keep something animating on the primary monitor." << std::endl;
+}
+
+bool ParseCommandLine(int argc, wchar_t* argv[], BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::wstring arg = argv[i];
+        if (arg == L"--help" || arg == L"-h" || arg == L"/?")
+        {
+            ShowUsage();
+            return false;
+        }
+        else if (arg == L"--encode-only")
+        {
+            options.encodeOnly = true;
+        }
+        else if ((arg == L"--iterations" || arg == L"--stream-seconds" || arg == L"--output") && i + 1 < argc)
+        {
+            std::wstring value = argv[++i];
+            if (arg == L"--output")
+            {
+                options.outputPath = value;
+                continue;
+            }
+
+            wchar_t* end = nullptr;
+            unsigned long number = wcstoul(value.c_str(), &end, 10);
+            if (end == value.c_str() || *end != L'\0' || number == 0)
+            {
+                std::wcerr << L"Error: " << arg << L" needs a positive number" << std::endl;
+                return false;
+            }
+            (arg == L"--iterations" ? options.iterations : options.streamSeconds) = static_cast<uint32_t>(number);
+        }
+        else
+        {
+            std::wcerr << L"Error: Unknown option " << arg << std::endl;
+            ShowUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+double TicksToMs(int64_t ticks)
+{
+    static const double msPerTick = []
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return 1000.0 / static_cast<double>(frequency.QuadPart);
+    }();
+    return static_cast<double>(ticks) * msPerTick;
+}
+
+TimingSummary Summarize(std::vector<double> samples)
+{
+    TimingSummary summary;
+    if (samples.empty())
+    {
+        return summary;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double percentile)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(percentile * samples.size()));
+        return samples[rank > 0 ? rank - 1 : 0];
+    };
+
+    summary.count = samples.size();
+    summary.minMs = samples.front();
+    for (double sample : samples)
+    {
+        summary.meanMs += sample;
+    }
+    summary.meanMs /= static_cast<double>(samples.size());
+    summary.p50Ms = at(0.50);
+    summary.p99Ms = at(0.99);
+    return summary;
+}
+
+std::string ToUtf8(const std::wstring& text)
+{
+    if (text.empty())
+    {
+        return {};
+    }
+    int size = WideCharToMultiByte(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()), nullptr, 0, nullptr, nullptr);
+    std::string result(size, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()), result.data(), size, nullptr, nullptr);
+    return result;
+}
+
+std::string JsonString(const std::string& text)
+{
+    std::string result = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            sprintf_s(escaped, "\\u%04x", static_cast<unsigned char>(c));
+            result += escaped;
+        }
+        else
+        {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+std::string JsonTiming(const TimingSummary& summary)
+{
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3)
+        << "{ \"count\": " << summary.count
+        << ", \"minMs\": " << summary.minMs
+        << ", \"meanMs\": " << summary.meanMs
+        << ", \"p50Ms\": " << summary.p50Ms
+        << ", \"p99Ms\": " << summary.p99Ms << " }";
+    return json.str();
+}
+
+// Description of the adapter captures run on (the default adapter)
+std::string GetAdapterName()
+{
+    winrt::com_ptr<IDXGIFactory1> factory;
+    winrt::com_ptr<IDXGIAdapter1> adapter;
+    DXGI_ADAPTER_DESC1 desc = {};
+    if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(factory.put()))) ||
+        FAILED(factory->EnumAdapters1(0, adapter.put())) ||
+        FAILED(adapter->GetDesc1(&desc)))
+    {
+        return "unknown";
+    }
+    return ToUtf8(desc.Description);
+}
+
+// Screen-like test image: flat panels, gradients and fine detail
+RawFrame MakeTestFrame(uint32_t width, uint32_t height)
+{
+    RawFrame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.stride = width * 4;
+    frame.pixels.resize(static_cast<size_t>(frame.stride) * height);
+
+    uint32_t seed = 12345;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        uint8_t* row = frame.pixels.data() + static_cast<size_t>(y) * frame.stride;
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            uint8_t* pixel = row + static_cast<size_t>(x) * 4;
+            if (y < height / 3)
+            {
+                // Flat title bars and panels
+                uint8_t shade = ((x / 160) + (y / 40)) % 2 ? 0xF0 : 0x30;
+                pixel[0] = shade; pixel[1] = shade; pixel[2] = shade;
+            }
+            else if (y < 2 * height / 3)
+            {
+                // Smooth gradient
+                pixel[0] = static_cast<uint8_t>(x * 255 / width);
+                pixel[1] = static_cast<uint8_t>(y * 255 / height);
+                pixel[2] = static_cast<uint8_t>(255 - x * 255 / width);
+            }
+            else
+            {
+                // Text-like noise
+                seed = seed * 1664525 + 1013904223;
+                uint8_t value = (seed >> 24) > 200 ? 0x10 : 0xFF;
+                pixel[0] = value; pixel[1] = value; pixel[2] = value;
+            }
+            pixel[3] = 0xFF;
+        }
+    }
+    return frame;
+}
+
+// One-shot captures with a fresh device every time and with a shared device cache
+std::string BenchOneShot(const BenchOptions& options, RawFrame& lastFrame)
+{
+    std::vector<double> cold;
+    std::vector<double> warm;
+    uint64_t warmAllocations = 0;
+    ErrorCode failure = ErrorCode::Success;
+
+    {
+        ScreenCapture capture;
+        for (uint32_t i = 0; i < options.iterations && failure == ErrorCode::Success; ++i)
+        {
+            int64_t start = QueryCaptureTicks();
+            failure = capture.CaptureRaw(lastFrame);
+            cold.push_back(TicksToMs(QueryCaptureTicks() - start));
+        }
+    }
+
+    {
+        ScreenCapture capture;
+        capture.SetDeviceCache(std::make_shared<CaptureDeviceCache>());
+        if (failure == ErrorCode::Success)
+        {
+            // Fill the cache and size the frame before measuring
+            failure = capture.CaptureRaw(lastFrame);
+        }
+
+        uint64_t allocationsBefore = g_allocationCount.load();
+        for (uint32_t i = 0; i < options.iterations && failure == ErrorCode::Success; ++i)
+        {
+            int64_t start = QueryCaptureTicks();
+            failure = capture.CaptureRaw(lastFrame);
+            warm.push_back(TicksToMs(QueryCaptureTicks() - start));
+        }
+        warmAllocations = g_allocationCount.load() - allocationsBefore;
+    }
+
+    std::wcout << L"One-shot: cold " << Summarize(cold).p50Ms << L" ms, warm " << Summarize(warm).p50Ms << L" ms (p50)" << std::endl;
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3)
+        << "{ \"result\": " << static_cast<int>(failure)
+        << ", \"coldMs\": " << JsonTiming(Summarize(cold))
+        << ", \"warmMs\": " << JsonTiming(Summarize(warm))
+        << ", \"allocationsPerCapture\": " << (warm.empty() ? 0.0 : static_cast<double>(warmAllocations) / warm.size()) << " }";
+    return json.str();
+}
+
+// Mean of the samples a stage recorded between two snapshots
+double MeanSince(const CaptureStats& before, const CaptureStats& after, CaptureStage stage)
+{
+    const auto& first = before[stage];
+    const auto& last = after[stage];
+    if (last.count <= first.count)
+    {
+        return 0.0;
+    }
+    double total = last.meanMs * last.count - first.meanMs * first.count;
+    return total / static_cast<double>(last.count - first.count);
+}
+
+// Repeated grabs from one session, with readback bandwidth from the stage timers
+std::string BenchSession(const BenchOptions& options)
+{
+    CaptureSession session;
+    ErrorCode result = session.Open();
+
+    RawFrame frame;
+    std::vector<double> grabs;
+    uint64_t allocations = 0;
+    if (result == ErrorCode::Success)
+    {
+        // The first grab waits for the first frame and sizes the buffers
+        result = session.GrabRawFrame(frame);
+    }
+
+    const auto statsBefore = GetCaptureStats();
+    uint64_t allocationsBefore = g_allocationCount.load();
+    for (uint32_t i = 0; i < options.iterations && result == ErrorCode::Success; ++i)
+    {
+        int64_t start = QueryCaptureTicks();
+        result = session.GrabRawFrame(frame);
+        grabs.push_back(TicksToMs(QueryCaptureTicks() - start));
+    }
+    allocations = g_allocationCount.load() - allocationsBefore;
+    session.Close();
+
+    const auto statsAfter = GetCaptureStats();
+    const double mapMs = MeanSince(statsBefore, statsAfter, CaptureStage::Readback);
+    const double copyMs = MeanSince(statsBefore, statsAfter, CaptureStage::PixelCopy);
+    const double bytes = static_cast<double>(frame.pixels.size());
+    const double readbackMs = mapMs + copyMs;
+    const double bandwidth = readbackMs > 0.0 ? bytes / (readbackMs * 1000.0) : 0.0;
+
+    std::wcout << L"Session: grab " << Summarize(grabs).p50Ms << L" ms (p50), readback " << bandwidth << L" MB/s" << std::endl;
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3)
+        << "{ \"result\": " << static_cast<int>(result)
+        << ", \"grabMs\": " << JsonTiming(Summarize(grabs))
+        << ", \"allocationsPerFrame\": " << (grabs.empty() ? 0.0 : static_cast<double>(allocations) / grabs.size())
+        << ", \"readback\": { \"bytesPerFrame\": " << frame.pixels.size()
+        << ", \"mapMs\": " << mapMs
+        << ", \"copyMs\": " << copyMs
+        << ", \"megabytesPerSecond\": " << bandwidth << " } }";
+    return json.str();
+}
+
+// Sustained delivery rate of a latest-only stream
+std::string BenchStream(const BenchOptions& options)
+{
+    std::atomic<uint64_t> frames{ 0 };
+
+    CaptureSession session;
+    const uint64_t droppedBefore = GetCaptureStats().framesDropped;
+    ErrorCode result = session.StartStream([&](const StreamFrame&)
+    {
+        ++frames;
+    });
+
+    uint64_t delivered = 0;
+    uint64_t allocations = 0;
+    double seconds = 0.0;
+    StreamStats streamStats;
+    if (result == ErrorCode::Success)
+    {
+        // Let the stream settle before counting
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        uint64_t framesBefore = frames.load();
+        uint64_t allocationsBefore = g_allocationCount.load();
+        int64_t start = QueryCaptureTicks();
+
+        std::this_thread::sleep_for(std::chrono::seconds(options.streamSeconds));
+
+        seconds = TicksToMs(QueryCaptureTicks() - start) / 1000.0;
+        allocations = g_allocationCount.load() - allocationsBefore;
+        delivered = frames.load() - framesBefore;
+        session.GetStreamStats(streamStats);
+        session.StopStream();
+    }
+    session.Close();
+
+    const double fps = seconds > 0.0 ? delivered / seconds : 0.0;
+    std::wcout << L"Stream: " << fps << L" fps" << std::endl;
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3)
+        << "{ \"result\": " << static_cast<int>(result)
+        << ", \"seconds\": " << seconds
+        << ", \"frames\": " << delivered
+        << ", \"fps\": " << fps
+        << ", \"framesDropped\": " << GetCaptureStats().framesDropped - droppedBefore
+        << ", \"framesLate\": " << streamStats.framesLate
+        << ", \"callbackMs\": " << streamStats.callbackMs
+        << ", \"allocationsPerFrame\": " << (delivered ? static_cast<double>(allocations) / delivered : 0.0) << " }";
+    return json.str();
+}
+
+// Encode time of every output format at common resolutions (and the captured frame)
+std::string BenchEncode(const BenchOptions& options, const RawFrame& capturedFrame)
+{
+    struct NamedFormat
+    {
+        const char* name;
+        ImageFormat format;
+        bool parallelPng = false;
+    };
+    const NamedFormat formats[] =
+    {
+        { "png", ImageFormat::Png },
+        { "png-parallel", ImageFormat::Png, true },
+        { "bmp", ImageFormat::Bmp },
+        { "raw", ImageFormat::Raw },
+        { "qoi", ImageFormat::Qoi },
+        { "jpeg", ImageFormat::Jpeg },
+        { "jxr", ImageFormat::Jxr },
+    };
+
+    std::vector<std::pair<std::string, RawFrame>> frames;
+    frames.emplace_back("synthetic", MakeTestFrame(1280, 720));
+    frames.emplace_back("synthetic", MakeTestFrame(1920, 1080));
+    frames.emplace_back("synthetic", MakeTestFrame(3840, 2160));
+    if (!capturedFrame.pixels.empty())
+    {
+        frames.emplace_back("captured", capturedFrame);
+    }
+
+    std::ostringstream json;
+    json << "[";
+    bool first = true;
+    std::vector<uint8_t> encoded;
+    for (const auto& [source, frame] : frames)
+    {
+        for (const auto& format : formats)
+        {
+            EncodeOptions encodeOptions;
+            encodeOptions.format = format.format;
+            encodeOptions.parallelPng = format.parallelPng;
+
+            std::vector<double> samples;
+            bool failed = false;
+            uint64_t allocationsBefore = g_allocationCount.load();
+            for (uint32_t i = 0; i < options.iterations; ++i)
+            {
+                try
+                {
+                    int64_t start = QueryCaptureTicks();
+                    EncodeFrame(frame, encodeOptions, encoded);
+                    samples.push_back(TicksToMs(QueryCaptureTicks() - start));
+                }
+                catch (...)
+                {
+                    failed = true;
+                    break;
+                }
+            }
+            uint64_t allocations = g_allocationCount.load() - allocationsBefore;
+
+            auto summary = Summarize(samples);
+            std::wcout << L"Encode " << format.name << L" " << frame.width << L"x" << frame.height << L": "
+                << summary.p50Ms << L" ms (p50)" << (failed ? L" [failed]" : L"") << std::endl;
+
+            json << (first ? "\n    " : ",\n    ") << std::fixed << std::setprecision(3)
+                << "{ \"format\": " << JsonString(format.name)
+                << ", \"source\": " << JsonString(source)
+                << ", \"width\": " << frame.width
+                << ", \"height\": " << frame.height
+                << ", \"failed\": " << (failed ? "true" : "false")
+                << ", \"bytes\": " << (failed ? 0 : encoded.size())
+                << ", \"time\": " << JsonTiming(summary)
+                << ", \"allocationsPerEncode\": " << (samples.empty() ? 0.0 : static_cast<double>(allocations) / samples.size()) << " }";
+            first = false;
+        }
+    }
+    json << "\n  ]";
+    return json.str();
+}
+
+// Stage timings collected by the core over the whole run
+std::string JsonStages(const CaptureStats& stats)
+{
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3) << "{";
+    for (uint32_t i = 0; i < CaptureStageCount; ++i)
+    {
+        const auto& stage = stats.stages[i];
+        json << (i ? ",\n    " : "\n    ")
+            << JsonString(ToUtf8(GetCaptureStageName(static_cast<CaptureStage>(i))))
+            << ": { \"count\": " << stage.count
+            << ", \"lastMs\": " << stage.lastMs
+            << ", \"meanMs\": " << stage.meanMs
+            << ", \"p50Ms\": " << stage.p50Ms
+            << ", \"p99Ms\": " << stage.p99Ms << " }";
+    }
+    json << "\n  }";
+    return json.str();
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+    BenchOptions options;
+    if (!ParseCommandLine(argc, argv, options))
+    {
+        return argc >= 2 && (std::wstring(argv[1]) == L"--help" || std::wstring(argv[1]) == L"-h" || std::wstring(argv[1]) == L"/?") ? 0 : 1;
+    }
+
+    try
+    {
+        winrt::init_apartment(winrt::apartment_type::multi_threaded);
+    }
+    catch (...)
+    {
+        // Apartment may already be initialized
+    }
+
+    std::ostringstream json;
+    json << "{\n  \"version\": 1"
+        << ",\n  \"iterations\": " << options.iterations
+        << ",\n  \"adapter\": " << JsonString(GetAdapterName());
+
+    auto monitors = EnumerateMonitors();
+    if (!monitors.empty())
+    {
+        const auto& bounds = monitors[0].bounds;
+        json << ",\n  \"primaryMonitor\": { \"width\": " << (bounds.right - bounds.left) << ", \"height\": " << (bounds.bottom - bounds.top) << " }";
+    }
+
+    RawFrame capturedFrame;
+    if (!options.encodeOnly)
+    {
+        json << ",\n  \"oneShot\": " << BenchOneShot(options, capturedFrame);
+        json << ",\n  \"session\": " << BenchSession(options);
+        json << ",\n  \"stream\": " << BenchStream(options);
+    }
+
+    json << ",\n  \"encode\": " << BenchEncode(options, capturedFrame);
+
+    // Core stage timers over the whole run
+    json << ",\n  \"stages\": " << JsonStages(GetCaptureStats());
+    json << "\n}\n";
+
+    std::ofstream file(std::filesystem::path(options.outputPath), std::ios::binary);
+    if (!file)
+    {
+        std::wcerr << L"Error: Cannot write " << options.outputPath << std::endl;
+        return 1;
+    }
+    file << json.str();
+    std::wcout << L"Results written to " << options.outputPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,326 @@
+#include "CaptureServer.h"
+#include "../core/CaptureDeviceCache.h"
+#include "../core/CaptureWorker.h"
+#include "../../pch.h"
+#include <algorithm>
+
+using namespace ScreenCaptureCore;
+
+// Wire format (byte-mode pipe, little endian):
+//   request: uint32 argument count, then per argument a uint32 length in wchar_t and the characters
+//   reply:   ReplyHeader, then header.size bytes of encoded image
+struct ReplyHeader
+{
+    int32_t result;         // ErrorCode of the capture
+    uint32_t reserved;
+    uint64_t size;          // Bytes of image that follow
+};
+
+constexpr DWORD PipeBufferSize = 64 * 1024;
+constexpr size_t MaxPipeChunk = 1024 * 1024;
+constexpr uint32_t MaxRequestArguments = 64;
+constexpr uint32_t MaxArgumentLength = 32768;
+constexpr uint64_t MaxReplySize = 1ull << 30;
+
+// How long a client waits for a busy server to free an instance
+constexpr DWORD ClientConnectTimeoutMs = 30000;
+
+// Overlapped I/O on one pipe handle that gives up once stopEvent (if any) is set
+struct PipeIo
+{
+    HANDLE pipe;
+    HANDLE event;           // Manual-reset completion event of the pending operation
+    HANDLE stopEvent;       // May be nullptr
+
+    // Helper function to finish an operation that did not fail to start
+    bool Wait(OVERLAPPED& overlapped, DWORD& transferred)
+    {
+        HANDLE events[] = { event, stopEvent };
+        DWORD wait = WaitForMultipleObjects(stopEvent ? 2 : 1, events, FALSE, INFINITE);
+        if (wait != WAIT_OBJECT_0)
+        {
+            CancelIoEx(pipe, &overlapped);
+            GetOverlappedResult(pipe, &overlapped, &transferred, TRUE);
+            return false;
+        }
+        return GetOverlappedResult(pipe, &overlapped, &transferred, FALSE) != FALSE;
+    }
+
+    // Wait for the next client (server side)
+    bool Connect()
+    {
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = event;
+        if (ConnectNamedPipe(pipe, &overlapped))
+        {
+            return true;
+        }
+
+        DWORD error = GetLastError();
+        if (error == ERROR_PIPE_CONNECTED)
+        {
+            return true;
+        }
+
+        DWORD transferred = 0;
+        return error == ERROR_IO_PENDING && Wait(overlapped, transferred);
+    }
+
+    bool Read(void* data, size_t size)
+    {
+        auto* bytes = static_cast<uint8_t*>(data);
+        while (size > 0)
+        {
+            OVERLAPPED overlapped = {};
+            overlapped.hEvent = event;
+            DWORD transferred = 0;
+            if (!ReadFile(pipe, bytes, static_cast<DWORD>((std::min)(size, MaxPipeChunk)), nullptr, &overlapped) && GetLastError() != ERROR_IO_PENDING)
+            {
+                return false;
+            }
+            if (!Wait(overlapped, transferred) || transferred == 0)
+            {
+                return false;
+            }
+            bytes += transferred;
+            size -= transferred;
+        }
+        return true;
+    }
+
+    bool Write(const void* data, size_t size)
+    {
+        auto* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0)
+        {
+            OVERLAPPED overlapped = {};
+            overlapped.hEvent = event;
+            DWORD transferred = 0;
+            if (!WriteFile(pipe, bytes, static_cast<DWORD>((std::min)(size, MaxPipeChunk)), nullptr, &overlapped) && GetLastError() != ERROR_IO_PENDING)
+            {
+                return false;
+            }
+            if (!Wait(overlapped, transferred) || transferred == 0)
+            {
+                return false;
+            }
+            bytes += transferred;
+            size -= transferred;
+        }
+        return true;
+    }
+
+    // Wait until the client closes its end, so disconnecting never drops an unread reply
+    void WaitForClose()
+    {
+        uint8_t unused;
+        while (Read(&unused, 1))
+        {
+        }
+    }
+};
+
+// Helper function to read a request's arguments
+bool ReadRequest(PipeIo& io, std::vector<std::wstring>& args)
+{
+    uint32_t count = 0;
+    if (!io.Read(&count, sizeof(count)) || count > MaxRequestArguments)
+    {
+        return false;
+    }
+
+    args.resize(count);
+    for (auto& arg : args)
+    {
+        uint32_t length = 0;
+        if (!io.Read(&length, sizeof(length)) || length > MaxArgumentLength)
+        {
+            return false;
+        }
+
+        arg.resize(length);
+        if (!io.Read(arg.data(), length * sizeof(wchar_t)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper function to send a request's arguments in one write
+bool WriteRequest(PipeIo& io, const std::vector<std::wstring>& args)
+{
+    std::vector<uint8_t> message;
+    auto append = [&message](const void* data, size_t size)
+    {
+        auto* bytes = static_cast<const uint8_t*>(data);
+        message.insert(message.end(), bytes, bytes + size);
+    };
+
+    const uint32_t count = static_cast<uint32_t>(args.size());
+    append(&count, sizeof(count));
+    for (const auto& arg : args)
+    {
+        const uint32_t length = static_cast<uint32_t>(arg.size());
+        append(&length, sizeof(length));
+        append(arg.data(), arg.size() * sizeof(wchar_t));
+    }
+    return io.Write(message.data(), message.size());
+}
+
+// Helper function to answer requests on one pipe instance until the server stops
+void ServeInstance(HANDLE pipe, HANDLE stopEvent, const std::shared_ptr<CaptureDeviceCache>& deviceCache, const ServerRequestHandler& handler, ILogger* logger)
+{
+    winrt::handle ioEvent{ CreateEventW(nullptr, TRUE, FALSE, nullptr) };
+    if (!ioEvent)
+    {
+        return;
+    }
+    PipeIo io{ pipe, ioEvent.get(), stopEvent };
+
+    // Kept for the whole server so its apartment stays warm; the instance's own worker
+    // lets its requests run while other instances are busy
+    ScreenCapture capture(logger, std::make_shared<CaptureWorker>());
+    capture.SetDeviceCache(deviceCache);
+
+    while (io.Connect())
+    {
+        std::vector<std::wstring> args;
+        bool stop = false;
+        if (ReadRequest(io, args))
+        {
+            ErrorCode result = ErrorCode::Success;
+            std::vector<uint8_t> encoded;
+            stop = args.size() == 1 && args[0] == L"--stop";
+            if (!stop)
+            {
+                try
+                {
+                    result = handler(capture, args, encoded);
+                }
+                catch (...)
+                {
+                    result = ErrorCode::UnknownError;
+                }
+            }
+
+            ReplyHeader reply{ static_cast<int32_t>(result), 0, encoded.size() };
+            if (io.Write(&reply, sizeof(reply)) && io.Write(encoded.data(), encoded.size()))
+            {
+                io.WaitForClose();
+            }
+        }
+
+        DisconnectNamedPipe(pipe);
+        if (stop)
+        {
+            if (logger)
+            {
+                logger->LogInfo(L"Stop requested, shutting down");
+            }
+            SetEvent(stopEvent);
+        }
+    }
+}
+
+std::wstring GetServerPipeName()
+{
+    // Captures only see the desktop of their own session, so every session gets a server
+    DWORD sessionId = 0;
+    ProcessIdToSessionId(GetCurrentProcessId(), &sessionId);
+    return L"\\\\.\\pipe\\ScreenCaptureApp-" + std::to_wstring(sessionId);
+}
+
+ErrorCode RunCaptureServer(const std::wstring& pipeName, uint32_t instanceCount, const ServerRequestHandler& handler, ILogger* logger)
+{
+    instanceCount = std::clamp(instanceCount, 1u, static_cast<uint32_t>(PIPE_UNLIMITED_INSTANCES - 1));
+
+    winrt::handle stopEvent{ CreateEventW(nullptr, TRUE, FALSE, nullptr) };
+    if (!stopEvent)
+    {
+        return ErrorCode::InitializationFailed;
+    }
+
+    // Create every instance up front, so a second server fails here instead of sharing the name
+    std::vector<winrt::file_handle> pipes;
+    for (uint32_t i = 0; i < instanceCount; ++i)
+    {
+        const DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (i == 0 ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+        winrt::file_handle pipe{ CreateNamedPipeW(pipeName.c_str(), openMode,
+            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+            instanceCount, PipeBufferSize, PipeBufferSize, 0, nullptr) };
+        if (!pipe)
+        {
+            if (logger)
+            {
+                logger->LogError(L"Failed to create pipe " + pipeName + L" (error " + std::to_wstring(GetLastError()) + L")");
+            }
+            return ErrorCode::InitializationFailed;
+        }
+        pipes.push_back(std::move(pipe));
+    }
+
+    if (logger)
+    {
+        logger->LogInfo(L"Serving captures on " + pipeName + L" with " + std::to_wstring(instanceCount) + L" instances");
+    }
+
+    auto deviceCache = std::make_shared<CaptureDeviceCache>();
+    std::vector<std::thread> threads;
+    for (auto& pipe : pipes)
+    {
+        threads.emplace_back(ServeInstance, pipe.get(), stopEvent.get(), std::cref(deviceCache), std::cref(handler), logger);
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return ErrorCode::Success;
+}
+
+bool SendCaptureRequest(const std::wstring& pipeName, const std::vector<std::wstring>& args, ErrorCode& result, std::vector<uint8_t>& encoded)
+{
+    encoded.clear();
+
+    // The server only needs to identify the client, never to impersonate it
+    winrt::file_handle pipe;
+    while (true)
+    {
+        pipe.attach(CreateFileW(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+            FILE_FLAG_OVERLAPPED | SECURITY_SQOS_PRESENT | SECURITY_IDENTIFICATION, nullptr));
+        if (pipe)
+        {
+            break;
+        }
+
+        // Every instance is busy with a capture: wait for one to free up
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(pipeName.c_str(), ClientConnectTimeoutMs))
+        {
+            return false;
+        }
+    }
+
+    winrt::handle ioEvent{ CreateEventW(nullptr, TRUE, FALSE, nullptr) };
+    if (!ioEvent)
+    {
+        return false;
+    }
+    PipeIo io{ pipe.get(), ioEvent.get(), nullptr };
+
+    ReplyHeader reply{};
+    if (!WriteRequest(io, args) || !io.Read(&reply, sizeof(reply)) || reply.size > MaxReplySize)
+    {
+        return false;
+    }
+
+    encoded.resize(static_cast<size_t>(reply.size));
+    if (!io.Read(encoded.data(), encoded.size()))
+    {
+        encoded.clear();
+        return false;
+    }
+
+    result = static_cast<ErrorCode>(reply.result);
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../core/ScreenCaptureCore.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+// Requests a --serve process runs at once (one pipe instance and warm ScreenCapture each)
+constexpr uint32_t DefaultServerInstanceCount = 4;
+
+// Named pipe of the server in the caller's logon session
+std::wstring GetServerPipeName();
+
+// Runs one client request on the ScreenCapture of the instance that received it
+// args are the client's capture arguments; encoded receives the image of a "-" output
+using ServerRequestHandler = std::function<ScreenCaptureCore::ErrorCode(ScreenCaptureCore::ScreenCapture& capture, const std::vector<std::wstring>& args, std::vector<uint8_t>& encoded)>;
+
+// Serve capture requests on pipeName until a client sends --stop
+// Every instance keeps its ScreenCapture on its own CaptureWorker thread alive between
+// requests and all of them share one device cache, so requests skip device and capture
+// item creation and up to instanceCount of them run concurrently on the same device
+// Returns InitializationFailed if the pipe cannot be created (e.g. a server already runs)
+ScreenCaptureCore::ErrorCode RunCaptureServer(const std::wstring& pipeName, uint32_t instanceCount, const ServerRequestHandler& handler, ScreenCaptureCore::ILogger* logger);
+
+// Send capture arguments to a running server and wait for the capture
+// Returns false when no server answers or the connection drops; otherwise result is the
+// capture's result and encoded receives the image of a "-" output
+bool SendCaptureRequest(const std::wstring& pipeName, const std::vector<std::wstring>& args, ScreenCaptureCore::ErrorCode& result, std::vector<uint8_t>& encoded);
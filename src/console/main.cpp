@@ -1,12 +1,22 @@
 #include "../../pch.h"
 #include "../core/ScreenCaptureCore.h"
+#include "CaptureServer.h"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <cstdio>
+#include <fcntl.h>
+#include <io.h>
+#include <atomic>
+#include <memory>
 
 using namespace ScreenCaptureCore;
 
+// Limits of the --stream options
+constexpr uint32_t MaxStreamSeconds = 3600;
+constexpr uint32_t MaxEncodeQueueDepth = 256;
+
 void ShowUsage()
 {
     std::wcout << L"Usage:" << std::endl;
@@ -14,15 +24,125 @@ void ShowUsage()
     std::wcout << L"  ScreenCaptureApp.exe --verbose <output_path>    - Verbose mode with console output" << std::endl;
     std::wcout << L"  ScreenCaptureApp.exe --show-border <output_path> - Keep capture border visible" << std::endl;
     std::wcout << L"  ScreenCaptureApp.exe --show-cursor <output_path> - Keep mouse cursor visible" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --format <fmt> <output_path> - png, bmp, raw, qoi, jpg or jxr (default: from extension)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --quality <1-100> <output_path> - JPEG quality (default 90)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --png-filter <filter> <output_path> - none, sub, up, average, paeth or adaptive" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --parallel-png <output_path> - Encode PNG on all cores instead of with WIC" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --monitor <n> <output_path> - Capture monitor n (0 is primary)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --all-monitors <output_path> - Capture the whole desktop" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --each-monitor <output_path> - One file per monitor (<name>_<n>.<ext>), captured together" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --window <hwnd> <output_path> - Capture a window by handle (hex or decimal)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --window-title <title> <output_path> - Capture the top-level window with this title" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --region <x,y,w,h> <output_path> - Capture part of the target (w or h 0 = to the edge)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --scale <0-1> <output_path> - Downscale on the GPU (e.g. 0.5 for half size)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --backend <api> <output_path> - auto, wgc (Graphics Capture) or dxgi (Desktop Duplication)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --gpu <preference> <output_path> - auto (GPU driving the target), default, power or performance" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --hdr <output_path>        - Capture half floats (kept for .jxr, tone-mapped on the GPU otherwise)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --burst <n> <output_pattern> - Capture n frames in one session (e.g. out_%03d.png)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --interval <ms> <output_pattern> - Spacing of burst frames (default 16)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --stream <seconds> <output_pattern> - Encode every frame for that long on worker threads" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --queue-depth <n> <output_pattern> - Stream frames waiting for an encoder (default 4)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --backpressure <policy> <output_pattern> - drop-oldest (default) or block when the queue is full" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --serve [--verbose]        - Keep capture devices warm and serve --client requests" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --client [options] <output_path> - Capture through the server (\"-\" writes the image to stdout)" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --client --stop            - Stop the server" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --list-monitors            - List monitors and exit" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --list-adapters            - List graphics adapters and the monitors they drive" << std::endl;
     std::wcout << L"  ScreenCaptureApp.exe --help                     - Show this help" << std::endl;
     std::wcout << L"" << std::endl;
     std::wcout << L"Examples:" << std::endl;
     std::wcout << L"  ScreenCaptureApp.exe \"C:\\screenshot.png\"        - Clean capture (recommended)" << std::endl;
     std::wcout << L"  ScreenCaptureApp.exe --verbose \"D:\\capture.png\" - With detailed logs" << std::endl;
     std::wcout << L"  ScreenCaptureApp.exe --show-border \"test.png\"   - Keep border visible" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe \"capture.qoi\"              - Fast lossless capture" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --burst 30 --interval 16 out_%03d.png - 30 frames 16 ms apart" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --stream 10 --queue-depth 8 out_%05d.qoi - 10 seconds of frames" << std::endl;
+    std::wcout << L"  ScreenCaptureApp.exe --client --format qoi - > shot.qoi - Capture through a running --serve" << std::endl;
+}
+
+// Print attached monitors with their capture index
+void ListMonitors()
+{
+    auto monitors = EnumerateMonitors();
+    for (size_t i = 0; i < monitors.size(); ++i)
+    {
+        const auto& bounds = monitors[i].bounds;
+        std::wcout << i << L": " << monitors[i].deviceName << L" "
+            << (bounds.right - bounds.left) << L"x" << (bounds.bottom - bounds.top)
+            << L" at (" << bounds.left << L", " << bounds.top << L")"
+            << (monitors[i].primary ? L" [primary]" : L"") << std::endl;
+    }
+}
+
+// Print graphics adapters with the monitors they drive
+void ListAdapters()
+{
+    auto monitors = EnumerateMonitors();
+    auto adapters = EnumerateAdapters();
+    for (size_t i = 0; i < adapters.size(); ++i)
+    {
+        const auto& adapter = adapters[i];
+        std::wcout << i << L": " << adapter.description << L" "
+            << (adapter.dedicatedVideoMemory >> 20) << L" MB"
+            << (adapter.software ? L" [software]" : L"") << std::endl;
+
+        for (HMONITOR handle : adapter.monitors)
+        {
+            for (size_t m = 0; m < monitors.size(); ++m)
+            {
+                if (monitors[m].handle == handle)
+                {
+                    std::wcout << L"   monitor " << m << L": " << monitors[m].deviceName << std::endl;
+                }
+            }
+        }
+    }
 }
 
-bool ParseCommandLine(int argc, wchar_t* argv[], bool& verboseMode, std::wstring& outputPath, bool& hideBorder, bool& hideCursor)
+// Parse an image format name
+bool ParseImageFormat(const std::wstring& name, ImageFormat& format)
+{
+    if (name == L"png") { format = ImageFormat::Png; return true; }
+    if (name == L"bmp") { format = ImageFormat::Bmp; return true; }
+    if (name == L"raw" || name == L"bgra") { format = ImageFormat::Raw; return true; }
+    if (name == L"qoi") { format = ImageFormat::Qoi; return true; }
+    if (name == L"jpg" || name == L"jpeg") { format = ImageFormat::Jpeg; return true; }
+    if (name == L"jxr" || name == L"wdp") { format = ImageFormat::Jxr; return true; }
+    return false;
+}
+
+// Parse a capture backend name
+bool ParseCaptureBackend(const std::wstring& name, CaptureBackend& backend)
+{
+    if (name == L"auto") { backend = CaptureBackend::Auto; return true; }
+    if (name == L"wgc") { backend = CaptureBackend::GraphicsCapture; return true; }
+    if (name == L"dxgi") { backend = CaptureBackend::DesktopDuplication; return true; }
+    return false;
+}
+
+// Parse a GPU preference name
+bool ParseGpuPreference(const std::wstring& name, GpuPreference& preference)
+{
+    if (name == L"auto") { preference = GpuPreference::Auto; return true; }
+    if (name == L"default") { preference = GpuPreference::SystemDefault; return true; }
+    if (name == L"power") { preference = GpuPreference::MinimumPower; return true; }
+    if (name == L"performance") { preference = GpuPreference::HighPerformance; return true; }
+    return false;
+}
+
+// Parse a PNG filter name
+bool ParsePngFilter(const std::wstring& name, PngFilter& filter)
+{
+    if (name == L"none") { filter = PngFilter::None; return true; }
+    if (name == L"sub") { filter = PngFilter::Sub; return true; }
+    if (name == L"up") { filter = PngFilter::Up; return true; }
+    if (name == L"average") { filter = PngFilter::Average; return true; }
+    if (name == L"paeth") { filter = PngFilter::Paeth; return true; }
+    if (name == L"adaptive") { filter = PngFilter::Adaptive; return true; }
+    return false;
+}
+
+bool ParseCommandLine(int argc, wchar_t* argv[], bool& verboseMode, std::wstring& outputPath, bool& hideBorder, bool& hideCursor, EncodeOptions& encodeOptions, CaptureTarget& target, CaptureRegion& region, CaptureFormat& captureFormat, CaptureBackend& backend, AdapterOptions& adapter, bool& eachMonitor, uint32_t& burstCount, uint32_t& burstIntervalMs, uint32_t& streamSeconds, FileStreamOptions& fileStream, size_t* outputArgument = nullptr)
 {
     if (argc < 2)
     {
@@ -47,6 +167,19 @@ bool ParseCommandLine(int argc, wchar_t* argv[], bool& verboseMode, std::wstring
         return false;
     }
 
+    // List monitors
+    if (args[0] == L"--list-monitors")
+    {
+        ListMonitors();
+        return false;
+    }
+
+    if (args[0] == L"--list-adapters")
+    {
+        ListAdapters();
+        return false;
+    }
+
     // Parse arguments
     size_t outputIndex = 0;
     for (size_t i = 0; i < args.size(); ++i)
@@ -63,11 +196,204 @@ bool ParseCommandLine(int argc, wchar_t* argv[], bool& verboseMode, std::wstring
         {
             hideCursor = false;
         }
+        else if (args[i] == L"--monitor" && i + 1 < args.size())
+        {
+            target = CaptureTarget::FromMonitorIndex(static_cast<uint32_t>(_wtoi(args[++i].c_str())));
+        }
+        else if (args[i] == L"--all-monitors")
+        {
+            target = CaptureTarget::AllMonitors();
+        }
+        else if (args[i] == L"--each-monitor")
+        {
+            eachMonitor = true;
+        }
+        else if (args[i] == L"--window" && i + 1 < args.size())
+        {
+            target = CaptureTarget::FromWindow(reinterpret_cast<HWND>(static_cast<uintptr_t>(wcstoull(args[++i].c_str(), nullptr, 0))));
+        }
+        else if (args[i] == L"--window-title" && i + 1 < args.size())
+        {
+            HWND window = FindWindowW(nullptr, args[++i].c_str());
+            if (!window)
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: No window titled " << args[i] << std::endl;
+                }
+                return false;
+            }
+            target = CaptureTarget::FromWindow(window);
+        }
+        else if (args[i] == L"--region" && i + 1 < args.size())
+        {
+            if (swscanf_s(args[++i].c_str(), L"%d,%d,%u,%u", &region.x, &region.y, &region.width, &region.height) != 4)
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Region must be x,y,width,height" << std::endl;
+                }
+                return false;
+            }
+        }
+        else if (args[i] == L"--scale" && i + 1 < args.size())
+        {
+            region.scale = static_cast<float>(_wtof(args[++i].c_str()));
+            if (region.scale <= 0.0f || region.scale > 1.0f)
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Scale must be greater than 0 and at most 1" << std::endl;
+                }
+                return false;
+            }
+        }
+        else if (args[i] == L"--backend" && i + 1 < args.size())
+        {
+            if (!ParseCaptureBackend(args[++i], backend))
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Unknown backend " << args[i] << std::endl;
+                }
+                return false;
+            }
+        }
+        else if (args[i] == L"--gpu" && i + 1 < args.size())
+        {
+            if (!ParseGpuPreference(args[++i], adapter.preference))
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Unknown GPU preference " << args[i] << std::endl;
+                }
+                return false;
+            }
+        }
+        else if (args[i] == L"--hdr")
+        {
+            captureFormat = CaptureFormat::Rgba16Float;
+        }
+        else if (args[i] == L"--burst" && i + 1 < args.size())
+        {
+            int count = _wtoi(args[++i].c_str());
+            if (count < 1 || count > static_cast<int>(MaxBurstFrameCount))
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Burst count must be between 1 and " << MaxBurstFrameCount << std::endl;
+                }
+                return false;
+            }
+            burstCount = static_cast<uint32_t>(count);
+        }
+        else if (args[i] == L"--interval" && i + 1 < args.size())
+        {
+            int interval = _wtoi(args[++i].c_str());
+            if (interval < 0)
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Interval must not be negative" << std::endl;
+                }
+                return false;
+            }
+            burstIntervalMs = static_cast<uint32_t>(interval);
+        }
+        else if (args[i] == L"--stream" && i + 1 < args.size())
+        {
+            int seconds = _wtoi(args[++i].c_str());
+            if (seconds < 1 || seconds > static_cast<int>(MaxStreamSeconds))
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Stream length must be between 1 and " << MaxStreamSeconds << L" seconds" << std::endl;
+                }
+                return false;
+            }
+            streamSeconds = static_cast<uint32_t>(seconds);
+        }
+        else if (args[i] == L"--queue-depth" && i + 1 < args.size())
+        {
+            int depth = _wtoi(args[++i].c_str());
+            if (depth < 1 || depth > static_cast<int>(MaxEncodeQueueDepth))
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Queue depth must be between 1 and " << MaxEncodeQueueDepth << std::endl;
+                }
+                return false;
+            }
+            fileStream.queueDepth = static_cast<size_t>(depth);
+        }
+        else if (args[i] == L"--backpressure" && i + 1 < args.size())
+        {
+            const auto& policy = args[++i];
+            if (policy == L"block")
+            {
+                fileStream.backpressure = BackpressurePolicy::Block;
+            }
+            else if (policy == L"drop-oldest")
+            {
+                fileStream.backpressure = BackpressurePolicy::DropOldest;
+            }
+            else
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Unknown backpressure policy " << policy << std::endl;
+                }
+                return false;
+            }
+        }
+        else if (args[i] == L"--format" && i + 1 < args.size())
+        {
+            if (!ParseImageFormat(args[++i], encodeOptions.format))
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Unknown format " << args[i] << std::endl;
+                }
+                return false;
+            }
+        }
+        else if (args[i] == L"--quality" && i + 1 < args.size())
+        {
+            int quality = _wtoi(args[++i].c_str());
+            if (quality < 1 || quality > 100)
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Quality must be between 1 and 100" << std::endl;
+                }
+                return false;
+            }
+            encodeOptions.jpegQuality = quality / 100.0f;
+        }
+        else if (args[i] == L"--png-filter" && i + 1 < args.size())
+        {
+            if (!ParsePngFilter(args[++i], encodeOptions.pngFilter))
+            {
+                if (verboseMode)
+                {
+                    std::wcerr << L"Error: Unknown PNG filter " << args[i] << std::endl;
+                }
+                return false;
+            }
+        }
+        else if (args[i] == L"--parallel-png")
+        {
+            encodeOptions.parallelPng = true;
+        }
         else
         {
             // This should be the output path
             outputPath = args[i];
             outputIndex = i;
+            if (outputArgument)
+            {
+                *outputArgument = outputIndex + 1;   // Index into argv
+            }
             break;
         }
     }
@@ -86,11 +412,13 @@ bool ParseCommandLine(int argc, wchar_t* argv[], bool& verboseMode, std::wstring
     try
     {
         std::filesystem::path path(outputPath);
-        if (path.extension() != L".png")
+        auto extension = path.extension().wstring();
+        ImageFormat extensionFormat;
+        if (encodeOptions.format == ImageFormat::Auto && (extension.empty() || !ParseImageFormat(extension.substr(1), extensionFormat)))
         {
             if (verboseMode)
             {
-                std::wcerr << L"Warning: Output file should have .png extension" << std::endl;
+                std::wcerr << L"Warning: Unrecognized extension, saving as PNG" << std::endl;
             }
         }
 
@@ -155,19 +483,232 @@ void SetupConsole(bool verboseMode)
     }
 }
 
+// Encode every frame of the capture's target into files for streamSeconds
+// Dropped frames are expected with drop-oldest backpressure; only failed writes fail the stream
+ErrorCode RunFileStream(ScreenCapture& capture, const FileStreamOptions& fileStream, uint32_t streamSeconds, bool hideBorder, bool hideCursor)
+{
+    StreamOptions options;
+    options.hideBorder = hideBorder;
+    options.hideCursor = hideCursor;
+    options.delivery = StreamDelivery::EveryFrame;     // The encode queue decides which frames to drop
+    options.target = capture.GetTarget();
+    options.region = capture.GetRegion();
+    options.captureFormat = capture.GetCaptureFormat();
+
+    auto saveResult = std::make_shared<std::atomic<int>>(static_cast<int>(ErrorCode::Success));
+    auto result = capture.StartFileStream(fileStream, options, [saveResult](ErrorCode fileResult, const std::wstring&)
+    {
+        if (fileResult != ErrorCode::Success && fileResult != ErrorCode::FrameDropped)
+        {
+            saveResult->store(static_cast<int>(fileResult));
+        }
+    });
+    if (result != ErrorCode::Success)
+    {
+        return result;
+    }
+
+    Sleep(streamSeconds * 1000);
+    capture.StopStream();
+    return static_cast<ErrorCode>(saveResult->load());
+}
+
+// Run one --client request on a server instance's ScreenCapture
+// args hold the client's options and an absolute output path, or "-" to return the image
+ErrorCode RunServerRequest(ScreenCapture& capture, const std::vector<std::wstring>& args, std::vector<uint8_t>& encoded)
+{
+    std::vector<wchar_t*> argv{ const_cast<wchar_t*>(L"ScreenCaptureApp.exe") };
+    for (const auto& arg : args)
+    {
+        argv.push_back(const_cast<wchar_t*>(arg.c_str()));
+    }
+
+    bool verboseMode = false;
+    bool hideBorder = true;
+    bool hideCursor = true;
+    std::wstring outputPath;
+    EncodeOptions encodeOptions;
+    CaptureTarget target;
+    CaptureRegion region;
+    CaptureFormat captureFormat = CaptureFormat::Bgra8;
+    CaptureBackend backend = CaptureBackend::Auto;
+    AdapterOptions adapter;
+    bool eachMonitor = false;
+    uint32_t burstCount = 0;
+    uint32_t burstIntervalMs = 16;
+    uint32_t streamSeconds = 0;
+    FileStreamOptions fileStream;
+    if (!ParseCommandLine(static_cast<int>(argv.size()), argv.data(), verboseMode, outputPath, hideBorder, hideCursor, encodeOptions, target, region, captureFormat, backend, adapter, eachMonitor, burstCount, burstIntervalMs, streamSeconds, fileStream))
+    {
+        return ErrorCode::InvalidParameter;
+    }
+
+    // Every request sets the whole state, since the instance's capture outlives it
+    capture.SetTarget(target);
+    capture.SetRegion(region);
+    capture.SetCaptureFormat(captureFormat);
+    capture.SetBackend(backend);
+    capture.SetAdapterOptions(adapter);
+
+    if (outputPath == L"-")
+    {
+        if (burstCount > 0 || streamSeconds > 0 || eachMonitor)
+        {
+            return ErrorCode::InvalidParameter;
+        }
+        return capture.CaptureToMemory(encoded, encodeOptions, hideBorder, hideCursor);
+    }
+    if (burstCount > 0)
+    {
+        return capture.CaptureBurst(burstCount, burstIntervalMs, outputPath, encodeOptions, hideBorder, hideCursor);
+    }
+    if (streamSeconds > 0)
+    {
+        fileStream.outputPattern = outputPath;
+        fileStream.encode = encodeOptions;
+        return RunFileStream(capture, fileStream, streamSeconds, hideBorder, hideCursor);
+    }
+    return eachMonitor
+        ? capture.CaptureAllMonitorsToFiles(outputPath, encodeOptions, hideBorder, hideCursor)
+        : capture.CaptureToFile(outputPath, encodeOptions, hideBorder, hideCursor);
+}
+
+// Run --serve until a client sends --stop
+int RunServer(int argc, wchar_t* argv[])
+{
+    bool verboseMode = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::wstring(argv[i]) == L"--verbose" || std::wstring(argv[i]) == L"-v")
+        {
+            verboseMode = true;
+        }
+    }
+
+    SetupConsole(verboseMode);
+
+    std::unique_ptr<ILogger> logger;
+    if (verboseMode)
+    {
+        logger = std::make_unique<ConsoleLogger>();
+    }
+    else
+    {
+        logger = std::make_unique<SilentLogger>();
+    }
+
+    try
+    {
+        return static_cast<int>(RunCaptureServer(GetServerPipeName(), DefaultServerInstanceCount, RunServerRequest, logger.get()));
+    }
+    catch (...)
+    {
+        return 99; // Unknown error
+    }
+}
+
+// Send the arguments after --client to a running server
+// Parsed here first, so usage errors never reach the server and relative paths
+// resolve against the client's directory
+int RunClient(int argc, wchar_t* argv[])
+{
+    try
+    {
+        std::vector<std::wstring> args;
+        if (argc == 3 && std::wstring(argv[2]) == L"--stop")
+        {
+            args.push_back(argv[2]);
+        }
+        else
+        {
+            // The client's own command line without --client
+            std::vector<wchar_t*> captureArgv{ argv[0] };
+            captureArgv.insert(captureArgv.end(), argv + 2, argv + argc);
+
+            bool verboseMode = false;
+            bool hideBorder = true;
+            bool hideCursor = true;
+            std::wstring outputPath;
+            EncodeOptions encodeOptions;
+            CaptureTarget target;
+            CaptureRegion region;
+            CaptureFormat captureFormat = CaptureFormat::Bgra8;
+            CaptureBackend backend = CaptureBackend::Auto;
+            AdapterOptions adapter;
+            bool eachMonitor = false;
+            uint32_t burstCount = 0;
+            uint32_t burstIntervalMs = 16;
+            uint32_t streamSeconds = 0;
+            FileStreamOptions fileStream;
+            size_t outputArgument = 0;
+            if (!ParseCommandLine(static_cast<int>(captureArgv.size()), captureArgv.data(), verboseMode, outputPath, hideBorder, hideCursor, encodeOptions, target, region, captureFormat, backend, adapter, eachMonitor, burstCount, burstIntervalMs, streamSeconds, fileStream, &outputArgument))
+            {
+                return 1; // Invalid arguments (help and lists are shown by this process)
+            }
+
+            args.assign(captureArgv.begin() + 1, captureArgv.begin() + outputArgument + 1);
+            if (outputPath != L"-")
+            {
+                args.back() = std::filesystem::absolute(outputPath).wstring();
+            }
+        }
+
+        ErrorCode result = ErrorCode::Success;
+        std::vector<uint8_t> encoded;
+        if (!SendCaptureRequest(GetServerPipeName(), args, result, encoded))
+        {
+            std::wcerr << L"Error: No capture server answered (start one with --serve)" << std::endl;
+            return static_cast<int>(ErrorCode::InitializationFailed);
+        }
+
+        if (!encoded.empty())
+        {
+            _setmode(_fileno(stdout), _O_BINARY);
+            fwrite(encoded.data(), 1, encoded.size(), stdout);
+            fflush(stdout);
+        }
+        return static_cast<int>(result);
+    }
+    catch (...)
+    {
+        return 99; // Unknown error
+    }
+}
+
 int wmain(int argc, wchar_t* argv[])
 {
+    // Server and client modes replace the one-shot capture
+    if (argc >= 2 && std::wstring(argv[1]) == L"--serve")
+    {
+        return RunServer(argc, argv);
+    }
+    if (argc >= 2 && std::wstring(argv[1]) == L"--client")
+    {
+        return RunClient(argc, argv);
+    }
+
     bool verboseMode = false;
     bool hideBorder = true;
     bool hideCursor = true;
     std::wstring outputPath;
+    EncodeOptions encodeOptions;
+    CaptureTarget target;
+    CaptureRegion region;
+    CaptureFormat captureFormat = CaptureFormat::Bgra8;
+    CaptureBackend backend = CaptureBackend::Auto;
+    AdapterOptions adapter;
+    bool eachMonitor = false;
+    uint32_t burstCount = 0;
+    uint32_t burstIntervalMs = 16;
+    uint32_t streamSeconds = 0;
+    FileStreamOptions fileStream;
 
     // Parse command line
-    if (!ParseCommandLine(argc, argv, verboseMode, outputPath, hideBorder, hideCursor))
+    if (!ParseCommandLine(argc, argv, verboseMode, outputPath, hideBorder, hideCursor, encodeOptions, target, region, captureFormat, backend, adapter, eachMonitor, burstCount, burstIntervalMs, streamSeconds, fileStream))
     {
-        if (argc >= 2 && (std::wstring(argv[1]) == L"--help" || std::wstring(argv[1]) == L"-h" || std::wstring(argv[1]) == L"/?"))
+        if (argc >= 2 && (std::wstring(argv[1]) == L"--help" || std::wstring(argv[1]) == L"-h" || std::wstring(argv[1]) == L"/?" || std::wstring(argv[1]) == L"--list-monitors" || std::wstring(argv[1]) == L"--list-adapters"))
         {
-            return 0; // Help was shown, exit normally
+            return 0; // Help, monitor or adapter list was shown, exit normally
         }
         return 1; // Invalid arguments
     }
@@ -195,9 +736,30 @@ int wmain(int argc, wchar_t* argv[])
 
         // Create screen capture instance
         ScreenCapture capture(logger.get());
+        capture.SetTarget(target);
+        capture.SetRegion(region);
+        capture.SetCaptureFormat(captureFormat);
+        capture.SetBackend(backend);
+        capture.SetAdapterOptions(adapter);
 
         // Perform capture with options
-        auto result = capture.CaptureToFile(outputPath, hideBorder, hideCursor);
+        ErrorCode result;
+        if (burstCount > 0)
+        {
+            result = capture.CaptureBurst(burstCount, burstIntervalMs, outputPath, encodeOptions, hideBorder, hideCursor);
+        }
+        else if (streamSeconds > 0)
+        {
+            fileStream.outputPattern = outputPath;
+            fileStream.encode = encodeOptions;
+            result = RunFileStream(capture, fileStream, streamSeconds, hideBorder, hideCursor);
+        }
+        else
+        {
+            result = eachMonitor
+                ? capture.CaptureAllMonitorsToFiles(outputPath, encodeOptions, hideBorder, hideCursor)
+                : capture.CaptureToFile(outputPath, encodeOptions, hideBorder, hideCursor);
+        }
 
         // Handle result
         if (result == ErrorCode::Success)
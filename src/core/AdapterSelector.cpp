@@ -0,0 +1,157 @@
+#include "AdapterSelector.h"
+#include "../../pch.h"
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    // DXGI factory reused until an adapter is added or removed
+    // Leaked, like the device cache, so nothing is released during unload
+    struct AdapterFactory
+    {
+        std::mutex mutex;
+        com_ptr<IDXGIFactory1> factory;
+
+        static AdapterFactory& Instance()
+        {
+            static AdapterFactory* instance = new AdapterFactory();
+            return *instance;
+        }
+    };
+
+    // Helper function to get a DXGI factory that still reflects the adapters present
+    com_ptr<IDXGIFactory1> GetAdapterFactory()
+    {
+        auto& cache = AdapterFactory::Instance();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.factory || !cache.factory->IsCurrent())
+        {
+            cache.factory = nullptr;
+            check_hresult(CreateDXGIFactory1(IID_PPV_ARGS(cache.factory.put())));
+        }
+        return cache.factory;
+    }
+
+    // Helper function to check whether an adapter drives a monitor
+    bool AdapterDrivesMonitor(IDXGIAdapter1* adapter, HMONITOR monitor)
+    {
+        com_ptr<IDXGIOutput> output;
+        for (UINT i = 0; SUCCEEDED(adapter->EnumOutputs(i, output.put())); ++i)
+        {
+            DXGI_OUTPUT_DESC desc;
+            if (SUCCEEDED(output->GetDesc(&desc)) && desc.Monitor == monitor)
+            {
+                return true;
+            }
+            output = nullptr;
+        }
+        return false;
+    }
+
+    uint64_t GetAdapterKey(IDXGIAdapter* adapter)
+    {
+        if (!adapter)
+        {
+            return 0;
+        }
+
+        DXGI_ADAPTER_DESC desc;
+        check_hresult(adapter->GetDesc(&desc));
+        return (static_cast<uint64_t>(static_cast<uint32_t>(desc.AdapterLuid.HighPart)) << 32) | desc.AdapterLuid.LowPart;
+    }
+
+    uint64_t GetDeviceAdapterKey(ID3D11Device* device)
+    {
+        com_ptr<IDXGIDevice> dxgiDevice;
+        check_hresult(device->QueryInterface(IID_PPV_ARGS(dxgiDevice.put())));
+        com_ptr<IDXGIAdapter> adapter;
+        check_hresult(dxgiDevice->GetAdapter(adapter.put()));
+        return GetAdapterKey(adapter.get());
+    }
+
+    com_ptr<IDXGIAdapter1> SelectAdapter(const AdapterOptions& options, HMONITOR monitor)
+    {
+        auto factory = GetAdapterFactory();
+        com_ptr<IDXGIAdapter1> adapter;
+
+        if (options.adapterLuid.LowPart != 0 || options.adapterLuid.HighPart != 0)
+        {
+            if (auto factory4 = factory.try_as<IDXGIFactory4>())
+            {
+                if (SUCCEEDED(factory4->EnumAdapterByLuid(options.adapterLuid, IID_PPV_ARGS(adapter.put()))))
+                {
+                    return adapter;
+                }
+            }
+            throw hresult_error(DXGI_ERROR_NOT_FOUND, L"Selected adapter is not present");
+        }
+
+        if (options.preference == GpuPreference::MinimumPower || options.preference == GpuPreference::HighPerformance)
+        {
+            const auto preference = options.preference == GpuPreference::MinimumPower ? DXGI_GPU_PREFERENCE_MINIMUM_POWER : DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE;
+            if (auto factory6 = factory.try_as<IDXGIFactory6>())
+            {
+                if (SUCCEEDED(factory6->EnumAdapterByGpuPreference(0, preference, IID_PPV_ARGS(adapter.put()))))
+                {
+                    return adapter;
+                }
+            }
+        }
+        else if (options.preference == GpuPreference::Auto && monitor)
+        {
+            for (UINT i = 0; SUCCEEDED(factory->EnumAdapters1(i, adapter.put())); ++i)
+            {
+                if (AdapterDrivesMonitor(adapter.get(), monitor))
+                {
+                    return adapter;
+                }
+                adapter = nullptr;
+            }
+        }
+
+        // The system default adapter
+        check_hresult(factory->EnumAdapters1(0, adapter.put()));
+        return adapter;
+    }
+
+    std::vector<AdapterInfo> EnumerateAdapters()
+    {
+        std::vector<AdapterInfo> adapters;
+        try
+        {
+            auto factory = GetAdapterFactory();
+            com_ptr<IDXGIAdapter1> adapter;
+            for (UINT i = 0; SUCCEEDED(factory->EnumAdapters1(i, adapter.put())); ++i)
+            {
+                DXGI_ADAPTER_DESC1 desc;
+                if (SUCCEEDED(adapter->GetDesc1(&desc)))
+                {
+                    AdapterInfo info;
+                    info.luid = desc.AdapterLuid;
+                    info.description = desc.Description;
+                    info.dedicatedVideoMemory = desc.DedicatedVideoMemory;
+                    info.software = (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) != 0;
+
+                    com_ptr<IDXGIOutput> output;
+                    for (UINT j = 0; SUCCEEDED(adapter->EnumOutputs(j, output.put())); ++j)
+                    {
+                        DXGI_OUTPUT_DESC outputDesc;
+                        if (SUCCEEDED(output->GetDesc(&outputDesc)))
+                        {
+                            info.monitors.push_back(outputDesc.Monitor);
+                        }
+                        output = nullptr;
+                    }
+
+                    adapters.push_back(std::move(info));
+                }
+                adapter = nullptr;
+            }
+        }
+        catch (...)
+        {
+            // No factory: report no adapters
+        }
+        return adapters;
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <d3d11.h>
+#include <dxgi1_6.h>
+#include <winrt/base.h>
+
+namespace ScreenCaptureCore
+{
+    // Adapter to create capture devices on for monitor (or a window on it)
+    // Auto picks the adapter whose outputs include monitor, falling back to the system
+    // default when no adapter drives it (e.g. an indirect display); the preferences go
+    // through IDXGIFactory6::EnumAdapterByGpuPreference where it exists
+    // Never returns nullptr; throws winrt::hresult_error (DXGI_ERROR_NOT_FOUND) when
+    // options name an adapter that is not present
+    winrt::com_ptr<IDXGIAdapter1> SelectAdapter(const AdapterOptions& options, HMONITOR monitor);
+
+    // Adapter LUID packed into one value, for keying per-adapter caches
+    uint64_t GetAdapterKey(IDXGIAdapter* adapter);
+
+    // Key of the adapter a device was created on
+    uint64_t GetDeviceAdapterKey(ID3D11Device* device);
+}
@@ -0,0 +1,116 @@
+#include "CaptureDeviceCache.h"
+#include "AdapterSelector.h"
+#include "../../pch.h"
+
+using namespace winrt;
+using namespace winrt::Windows::Graphics::Capture;
+using namespace winrt::Windows::Graphics::DirectX::Direct3D11;
+
+namespace ScreenCaptureCore
+{
+    // Implemented in ScreenCaptureCore.cpp
+    com_ptr<ID3D11Device> CreateD3DDevice(IDXGIAdapter* adapter);
+    IDirect3DDevice CreateDirect3DDeviceFromD3D11Device(const com_ptr<ID3D11Device>& d3d11Device);
+    GraphicsCaptureItem CreateCaptureItemForMonitor(HMONITOR monitor);
+
+    bool IsDeviceLost(HRESULT hr)
+    {
+        return hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET || hr == DXGI_ERROR_DEVICE_HUNG;
+    }
+
+    CaptureDeviceCache::~CaptureDeviceCache()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ClearItems();
+    }
+
+    void CaptureDeviceCache::GetDevice(IDXGIAdapter* adapter, com_ptr<ID3D11Device>& d3d11Device, IDirect3DDevice& direct3DDevice)
+    {
+        const uint64_t key = GetAdapterKey(adapter);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& cached = m_devices[key];
+
+        // A removed device never recovers; replace it on the next capture
+        if (cached.d3d11Device && FAILED(cached.d3d11Device->GetDeviceRemovedReason()))
+        {
+            cached.direct3DDevice = nullptr;
+            cached.d3d11Device = nullptr;
+        }
+
+        if (!cached.d3d11Device)
+        {
+            auto device = CreateD3DDevice(adapter);
+
+            // Multi-monitor captures read back from several pool threads at once
+            if (auto multithread = device.try_as<ID3D11Multithread>())
+            {
+                multithread->SetMultithreadProtected(TRUE);
+            }
+
+            cached.direct3DDevice = CreateDirect3DDeviceFromD3D11Device(device);
+            cached.d3d11Device = std::move(device);
+        }
+
+        d3d11Device = cached.d3d11Device;
+        direct3DDevice = cached.direct3DDevice;
+    }
+
+    GraphicsCaptureItem CaptureDeviceCache::GetMonitorItem(HMONITOR monitor)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_items.find(monitor);
+        if (it != m_items.end())
+        {
+            return it->second.item;
+        }
+
+        CachedItem cached;
+        cached.item = CreateCaptureItemForMonitor(monitor);
+
+        // The item closes when its monitor is disconnected or the display mode changes
+        cached.closedToken = cached.item.Closed([this, monitor](GraphicsCaptureItem const& sender, auto const&)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto closed = m_items.find(monitor);
+            if (closed != m_items.end() && closed->second.item == sender)
+            {
+                m_items.erase(closed);
+            }
+        });
+
+        auto item = cached.item;
+        m_items.emplace(monitor, std::move(cached));
+        return item;
+    }
+
+    void CaptureDeviceCache::InvalidateDevice()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_devices.clear();
+    }
+
+    void CaptureDeviceCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_devices.clear();
+        ClearItems();
+    }
+
+    void CaptureDeviceCache::ClearItems()
+    {
+        for (auto& [monitor, cached] : m_items)
+        {
+            try
+            {
+                cached.item.Closed(cached.closedToken);
+            }
+            catch (...)
+            {
+                // The item may already be gone with its monitor
+            }
+        }
+        m_items.clear();
+    }
+}
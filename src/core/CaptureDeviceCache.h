@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <d3d11_4.h>
+#include <winrt/base.h>
+#include <winrt/Windows.Graphics.Capture.h>
+#include <winrt/Windows.Graphics.DirectX.Direct3D11.h>
+#include <mutex>
+#include <unordered_map>
+
+namespace ScreenCaptureCore
+{
+    // D3D devices (one per adapter) and per-monitor capture items shared by one-shot captures
+    // Creating them dominates a cold capture, so with a cache attached a ScreenCapture
+    // only builds the frame pool and session per call. A device is recreated once it
+    // reports removal, and a monitor's item is dropped when it raises Closed
+    class CaptureDeviceCache
+    {
+    public:
+        CaptureDeviceCache() = default;
+        ~CaptureDeviceCache();
+
+        CaptureDeviceCache(const CaptureDeviceCache&) = delete;
+        CaptureDeviceCache& operator=(const CaptureDeviceCache&) = delete;
+
+        // Cached device of adapter (nullptr: the system default) and its WinRT wrapper
+        // Devices are multithread protected
+        // Throws winrt::hresult_error if a new device cannot be created
+        void GetDevice(IDXGIAdapter* adapter, winrt::com_ptr<ID3D11Device>& d3d11Device, winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice& direct3DDevice);
+
+        // Cached capture item for a monitor
+        // Throws winrt::hresult_error if a new item cannot be created
+        winrt::Windows::Graphics::Capture::GraphicsCaptureItem GetMonitorItem(HMONITOR monitor);
+
+        // Drop the devices after a capture failed with DXGI_ERROR_DEVICE_REMOVED or _RESET
+        void InvalidateDevice();
+
+        // Drop the devices and every item
+        void Clear();
+
+    private:
+        struct CachedItem
+        {
+            winrt::Windows::Graphics::Capture::GraphicsCaptureItem item{ nullptr };
+            winrt::event_token closedToken;
+        };
+
+        struct CachedDevice
+        {
+            winrt::com_ptr<ID3D11Device> d3d11Device;
+            winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice direct3DDevice{ nullptr };
+        };
+
+        std::mutex m_mutex;
+        std::unordered_map<uint64_t, CachedDevice> m_devices;   // By GetAdapterKey
+        std::unordered_map<HMONITOR, CachedItem> m_items;
+
+        void ClearItems();
+    };
+
+    // Whether an HRESULT means the D3D device is gone and has to be recreated
+    bool IsDeviceLost(HRESULT hr);
+}
@@ -0,0 +1,226 @@
+#include "CaptureQueue.h"
+#include "../../pch.h"
+#include <deque>
+#include <algorithm>
+#include <unordered_map>
+
+namespace ScreenCaptureCore
+{
+    // State of one submitted capture (guarded by Impl::mutex once queued)
+    struct QueuedCapture
+    {
+        uint64_t id = 0;
+        CaptureRequest request;
+        CaptureCompletion completion;
+        bool cancelled = false;
+        bool done = false;
+        ErrorCode result = ErrorCode::Success;
+        std::vector<uint8_t> encoded;
+    };
+
+    struct CaptureQueue::Impl
+    {
+        ILogger* logger = nullptr;
+        std::shared_ptr<CaptureDeviceCache> deviceCache;
+
+        std::mutex mutex;
+        std::condition_variable workCondition;
+        std::condition_variable doneCondition;
+        std::deque<std::shared_ptr<QueuedCapture>> pending;
+        std::unordered_map<uint64_t, std::shared_ptr<QueuedCapture>> requests;
+        uint64_t nextId = 0;
+        bool stop = false;
+
+        std::thread worker;
+
+        void WorkerLoop()
+        {
+            // The capture lives as long as the queue
+            ScreenCapture capture(logger);
+            capture.SetDeviceCache(deviceCache);
+
+            while (true)
+            {
+                std::shared_ptr<QueuedCapture> entry;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    workCondition.wait(lock, [this] { return stop || !pending.empty(); });
+                    if (stop)
+                    {
+                        return;
+                    }
+
+                    entry = std::move(pending.front());
+                    pending.pop_front();
+                }
+
+                std::vector<uint8_t> encoded;
+                ErrorCode result = Run(capture, entry->request, encoded);
+                Finish(entry, result, std::move(encoded));
+            }
+        }
+
+        ErrorCode Run(ScreenCapture& capture, const CaptureRequest& request, std::vector<uint8_t>& encoded)
+        {
+            try
+            {
+                capture.SetTarget(request.target);
+                capture.SetRegion(request.region);
+                capture.SetCaptureFormat(request.captureFormat);
+                capture.SetBackend(request.backend);
+                capture.SetAdapterOptions(request.adapter);
+
+                if (!request.outputPath.empty())
+                {
+                    return capture.CaptureToFile(request.outputPath, request.encodeOptions, request.hideBorder, request.hideCursor, request.timeoutMs);
+                }
+                return capture.CaptureToMemory(encoded, request.encodeOptions, request.hideBorder, request.hideCursor, request.timeoutMs);
+            }
+            catch (...)
+            {
+                return ErrorCode::UnknownError;
+            }
+        }
+
+        // Record the result, run the completion outside the lock and wake waiters
+        void Finish(const std::shared_ptr<QueuedCapture>& entry, ErrorCode result, std::vector<uint8_t> encoded)
+        {
+            CaptureCompletion completion;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (entry->cancelled)
+                {
+                    result = ErrorCode::Cancelled;
+                    encoded.clear();
+                }
+
+                entry->result = result;
+                entry->encoded = std::move(encoded);
+                entry->done = true;
+                completion = std::move(entry->completion);
+                if (completion)
+                {
+                    requests.erase(entry->id);
+                }
+            }
+            doneCondition.notify_all();
+
+            if (completion)
+            {
+                try
+                {
+                    completion(entry->id, entry->result, entry->encoded);
+                }
+                catch (...)
+                {
+                    // Never let a callback exception end the queue thread
+                }
+            }
+        }
+    };
+
+    CaptureQueue::CaptureQueue(ILogger* logger, std::shared_ptr<CaptureDeviceCache> deviceCache)
+        : m_logger(logger ? logger : &m_defaultLogger)
+        , m_impl(std::make_unique<Impl>())
+    {
+        m_impl->logger = m_logger;
+        m_impl->deviceCache = std::move(deviceCache);
+        m_impl->worker = std::thread(&Impl::WorkerLoop, m_impl.get());
+    }
+
+    CaptureQueue::~CaptureQueue()
+    {
+        std::deque<std::shared_ptr<QueuedCapture>> cancelled;
+        {
+            std::lock_guard<std::mutex> lock(m_impl->mutex);
+            m_impl->stop = true;
+            cancelled.swap(m_impl->pending);
+            for (auto& entry : cancelled)
+            {
+                entry->cancelled = true;
+            }
+        }
+        m_impl->workCondition.notify_all();
+
+        if (m_impl->worker.joinable())
+        {
+            m_impl->worker.join();
+        }
+
+        for (auto& entry : cancelled)
+        {
+            m_impl->Finish(entry, ErrorCode::Cancelled, {});
+        }
+    }
+
+    uint64_t CaptureQueue::Submit(const CaptureRequest& request, CaptureCompletion completion)
+    {
+        auto entry = std::make_shared<QueuedCapture>();
+        entry->request = request;
+        entry->completion = std::move(completion);
+
+        {
+            std::lock_guard<std::mutex> lock(m_impl->mutex);
+            entry->id = ++m_impl->nextId;
+            m_impl->requests.emplace(entry->id, entry);
+            m_impl->pending.push_back(entry);
+        }
+        m_impl->workCondition.notify_one();
+
+        return entry->id;
+    }
+
+    ErrorCode CaptureQueue::Wait(uint64_t requestId, uint32_t timeoutMs, ErrorCode& result, std::vector<uint8_t>* encoded)
+    {
+        std::unique_lock<std::mutex> lock(m_impl->mutex);
+        auto it = m_impl->requests.find(requestId);
+        if (it == m_impl->requests.end())
+        {
+            return ErrorCode::InvalidParameter;
+        }
+
+        auto entry = it->second;
+        if (!m_impl->doneCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&entry] { return entry->done; }))
+        {
+            return ErrorCode::TimeoutError;
+        }
+
+        result = entry->result;
+        if (encoded)
+        {
+            *encoded = std::move(entry->encoded);
+        }
+        m_impl->requests.erase(requestId);
+        return ErrorCode::Success;
+    }
+
+    ErrorCode CaptureQueue::Cancel(uint64_t requestId)
+    {
+        std::shared_ptr<QueuedCapture> removed;
+        {
+            std::lock_guard<std::mutex> lock(m_impl->mutex);
+            auto it = m_impl->requests.find(requestId);
+            if (it == m_impl->requests.end() || it->second->done)
+            {
+                return ErrorCode::InvalidParameter;
+            }
+
+            auto entry = it->second;
+            entry->cancelled = true;
+
+            auto queued = std::find(m_impl->pending.begin(), m_impl->pending.end(), entry);
+            if (queued != m_impl->pending.end())
+            {
+                m_impl->pending.erase(queued);
+                removed = std::move(entry);
+            }
+        }
+
+        // A running capture is left to finish; Finish reports it as cancelled
+        if (removed)
+        {
+            m_impl->Finish(removed, ErrorCode::Cancelled, {});
+        }
+        return ErrorCode::Success;
+    }
+}
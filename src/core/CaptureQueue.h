@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+
+namespace ScreenCaptureCore
+{
+    // One capture handed to a CaptureQueue
+    struct CaptureRequest
+    {
+        std::wstring outputPath;                            // File to write; empty encodes to memory
+        EncodeOptions encodeOptions;
+        CaptureTarget target;
+        CaptureRegion region;
+        CaptureFormat captureFormat = CaptureFormat::Bgra8;
+        CaptureBackend backend = CaptureBackend::Auto;     // A kept-open Desktop Duplication serves repeated requests at once
+        AdapterOptions adapter;                            // GPU to capture on; Auto follows the target
+        bool hideBorder = true;
+        bool hideCursor = true;
+        uint32_t timeoutMs = DefaultFrameTimeoutMs;
+    };
+
+    // Called once a capture finished, failed or was cancelled
+    // encoded holds the image of memory captures and is only valid during the call
+    using CaptureCompletion = std::function<void(uint64_t requestId, ErrorCode result, const std::vector<uint8_t>& encoded)>;
+
+    // Runs one-shot captures on a queue-owned thread
+    // The thread owns the ScreenCapture used for every request and waits for the
+    // CaptureWorker, so callers on any thread only enqueue work and never block for the capture
+    class CaptureQueue
+    {
+    public:
+        // deviceCache, if given, is shared by every capture the queue runs
+        CaptureQueue(ILogger* logger = nullptr, std::shared_ptr<CaptureDeviceCache> deviceCache = nullptr);
+
+        // Cancels queued captures and waits for the running one
+        ~CaptureQueue();
+
+        CaptureQueue(const CaptureQueue&) = delete;
+        CaptureQueue& operator=(const CaptureQueue&) = delete;
+
+        // Queue a capture and return its request id (never 0)
+        // With a completion, it runs on the queue thread and the request is released
+        // afterwards; without one, the result is kept until Wait collects it
+        uint64_t Submit(const CaptureRequest& request, CaptureCompletion completion = nullptr);
+
+        // Wait up to timeoutMs for a request to finish
+        // Returns Success with the capture's own result in result (and the image of a
+        // memory capture in encoded), TimeoutError while it is still queued or running, or
+        // InvalidParameter for unknown ids; finished requests are released once collected
+        ErrorCode Wait(uint64_t requestId, uint32_t timeoutMs, ErrorCode& result, std::vector<uint8_t>* encoded = nullptr);
+
+        // Cancel a request
+        // Queued requests finish with Cancelled immediately (their completion runs on the
+        // calling thread); a running capture completes but reports Cancelled and drops its image
+        // Returns InvalidParameter if the request is unknown or already finished
+        ErrorCode Cancel(uint64_t requestId);
+
+    private:
+        struct Impl;
+
+        ILogger* m_logger;
+        SilentLogger m_defaultLogger;
+        std::unique_ptr<Impl> m_impl;
+    };
+}
@@ -0,0 +1,193 @@
+#include "CaptureStats.h"
+#include "../../pch.h"
+#include <TraceLoggingProvider.h>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+// ETW provider "ScreenCapture" {1f3ddd28-d8ab-4052-aa36-f143e23e43b4}
+// Events are only written while a trace session (WPR, xperf, tracelog) enables it
+TRACELOGGING_DEFINE_PROVIDER(
+    g_captureTraceProvider,
+    "ScreenCapture",
+    (0x1f3ddd28, 0xd8ab, 0x4052, 0xaa, 0x36, 0xf1, 0x43, 0xe2, 0x3e, 0x43, 0xb4));
+
+namespace ScreenCaptureCore
+{
+    // Samples of one stage; guarded by its own mutex so stages never contend
+    struct StageSamples
+    {
+        std::mutex mutex;
+        uint64_t count = 0;
+        double totalMs = 0.0;
+        double lastMs = 0.0;
+        std::array<float, CaptureStatsWindow> window{};
+    };
+
+    // Leaked, like the CaptureWorker, so threads still recording at process exit are safe
+    struct StatsRecorder
+    {
+        std::array<StageSamples, CaptureStageCount> stages;
+        std::atomic<uint64_t> framesDropped{ 0 };
+        double msPerTick = 0.0;
+
+        StatsRecorder()
+        {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            msPerTick = 1000.0 / static_cast<double>(frequency.QuadPart);
+        }
+
+        static StatsRecorder& Instance()
+        {
+            static StatsRecorder* recorder = new StatsRecorder();
+            return *recorder;
+        }
+    };
+
+    // Registered on first use and unregistered when the module unloads
+    struct TraceProviderRegistration
+    {
+        TraceProviderRegistration()
+        {
+            TraceLoggingRegister(g_captureTraceProvider);
+        }
+
+        ~TraceProviderRegistration()
+        {
+            TraceLoggingUnregister(g_captureTraceProvider);
+        }
+    };
+
+    // Helper function to register the trace provider once
+    void EnsureTraceProvider()
+    {
+        static TraceProviderRegistration registration;
+    }
+
+    // Helper function to get the value at a percentile of unsorted samples
+    double Percentile(std::vector<float>& samples, double percentile)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(percentile * samples.size()));
+        size_t index = rank > 0 ? rank - 1 : 0;
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+
+    const wchar_t* GetCaptureStageName(CaptureStage stage)
+    {
+        switch (stage)
+        {
+        case CaptureStage::DeviceCreation:
+            return L"DeviceCreation";
+        case CaptureStage::FirstFrameWait:
+            return L"FirstFrameWait";
+        case CaptureStage::Readback:
+            return L"Readback";
+        case CaptureStage::PixelCopy:
+            return L"PixelCopy";
+        case CaptureStage::Encode:
+            return L"Encode";
+        case CaptureStage::FileWrite:
+            return L"FileWrite";
+        default:
+            return L"Unknown";
+        }
+    }
+
+    int64_t QueryCaptureTicks()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    void RecordCaptureStage(CaptureStage stage, int64_t ticks)
+    {
+        if (stage >= CaptureStage::Count)
+        {
+            return;
+        }
+
+        auto& recorder = StatsRecorder::Instance();
+        const double ms = static_cast<double>(ticks) * recorder.msPerTick;
+
+        auto& samples = recorder.stages[static_cast<uint32_t>(stage)];
+        {
+            std::lock_guard<std::mutex> lock(samples.mutex);
+            samples.window[samples.count % CaptureStatsWindow] = static_cast<float>(ms);
+            ++samples.count;
+            samples.totalMs += ms;
+            samples.lastMs = ms;
+        }
+
+        EnsureTraceProvider();
+        TraceLoggingWrite(
+            g_captureTraceProvider,
+            "CaptureStage",
+            TraceLoggingWideString(GetCaptureStageName(stage), "Stage"),
+            TraceLoggingFloat64(ms, "DurationMs"));
+    }
+
+    void RecordDroppedFrames(uint64_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        StatsRecorder::Instance().framesDropped += count;
+
+        EnsureTraceProvider();
+        TraceLoggingWrite(
+            g_captureTraceProvider,
+            "FramesDropped",
+            TraceLoggingUInt64(count, "Count"));
+    }
+
+    CaptureStats GetCaptureStats()
+    {
+        auto& recorder = StatsRecorder::Instance();
+
+        CaptureStats stats;
+        std::vector<float> window;
+        for (uint32_t i = 0; i < CaptureStageCount; ++i)
+        {
+            auto& samples = recorder.stages[i];
+            auto& result = stats.stages[i];
+            {
+                std::lock_guard<std::mutex> lock(samples.mutex);
+                result.count = samples.count;
+                result.lastMs = samples.lastMs;
+                result.meanMs = samples.count ? samples.totalMs / static_cast<double>(samples.count) : 0.0;
+
+                const size_t filled = static_cast<size_t>((std::min<uint64_t>)(samples.count, CaptureStatsWindow));
+                window.assign(samples.window.begin(), samples.window.begin() + filled);
+            }
+
+            // Sort outside the lock so recording threads are not held up
+            if (!window.empty())
+            {
+                result.p50Ms = Percentile(window, 0.50);
+                result.p99Ms = Percentile(window, 0.99);
+            }
+        }
+
+        stats.framesDropped = recorder.framesDropped.load();
+        return stats;
+    }
+
+    void ResetCaptureStats()
+    {
+        auto& recorder = StatsRecorder::Instance();
+        for (auto& samples : recorder.stages)
+        {
+            std::lock_guard<std::mutex> lock(samples.mutex);
+            samples.count = 0;
+            samples.totalMs = 0.0;
+            samples.lastMs = 0.0;
+        }
+        recorder.framesDropped = 0;
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <exception>
+
+namespace ScreenCaptureCore
+{
+    // Stages of the capture paths timed with StageTimer
+    enum class CaptureStage : uint32_t
+    {
+        DeviceCreation = 0,     // D3D11 device creation (cache misses only when a cache is attached)
+        FirstFrameWait,         // StartCapture until the first frame arrived
+        Readback,               // Staging copy and Map, including any wait for the GPU
+        PixelCopy,              // memcpy or pixel conversion out of the mapped texture
+        Encode,                 // Image encoding (built-in or WIC)
+        FileWrite,              // Writing an encoded image to disk
+        Count
+    };
+
+    constexpr uint32_t CaptureStageCount = static_cast<uint32_t>(CaptureStage::Count);
+
+    // Recent samples per stage used for the percentiles
+    constexpr uint32_t CaptureStatsWindow = 1024;
+
+    // Latency of one stage in milliseconds
+    struct StageStats
+    {
+        uint64_t count = 0;     // Samples since the last reset
+        double lastMs = 0.0;
+        double meanMs = 0.0;    // Over all samples since the last reset
+        double p50Ms = 0.0;     // Over the last CaptureStatsWindow samples
+        double p99Ms = 0.0;
+    };
+
+    // Process-wide capture statistics
+    struct CaptureStats
+    {
+        StageStats stages[CaptureStageCount];
+        uint64_t framesDropped = 0;    // Stream, encode pipeline and recorder frames that were never delivered
+
+        const StageStats& operator[](CaptureStage stage) const
+        {
+            return stages[static_cast<uint32_t>(stage)];
+        }
+    };
+
+    // Name of a stage as used in logs and trace events
+    const wchar_t* GetCaptureStageName(CaptureStage stage);
+
+    // Current QueryPerformanceCounter value
+    int64_t QueryCaptureTicks();
+
+    // Add one sample of a stage, in QueryPerformanceCounter ticks
+    // Also raises a TraceLogging event when an ETW session enabled the provider
+    void RecordCaptureStage(CaptureStage stage, int64_t ticks);
+
+    // Count frames that were captured but never reached the consumer
+    void RecordDroppedFrames(uint64_t count);
+
+    // Snapshot of every stage and the dropped frame count
+    CaptureStats GetCaptureStats();
+
+    // Forget all samples and the dropped frame count
+    void ResetCaptureStats();
+
+    // Times a scope and records it as one sample of a stage
+    // A scope left by an exception is not recorded; Cancel leaves out other failed attempts
+    class StageTimer
+    {
+    public:
+        explicit StageTimer(CaptureStage stage)
+            : m_stage(stage)
+            , m_start(QueryCaptureTicks())
+            , m_exceptions(std::uncaught_exceptions())
+        {
+        }
+
+        ~StageTimer()
+        {
+            if (std::uncaught_exceptions() <= m_exceptions)
+            {
+                Stop();
+            }
+        }
+
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+
+        // Record now instead of at the end of the scope
+        void Stop()
+        {
+            if (m_active)
+            {
+                m_active = false;
+                RecordCaptureStage(m_stage, QueryCaptureTicks() - m_start);
+            }
+        }
+
+        void Cancel()
+        {
+            m_active = false;
+        }
+
+    private:
+        CaptureStage m_stage;
+        int64_t m_start;
+        int m_exceptions;
+        bool m_active = true;
+    };
+}
@@ -0,0 +1,122 @@
+#include "CaptureWorker.h"
+#include "../../pch.h"
+#include <deque>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    struct CaptureWorker::Impl
+    {
+        std::mutex mutex;
+        std::deque<std::packaged_task<void()>> pending;
+        handle workEvent{ CreateEventW(nullptr, FALSE, FALSE, nullptr) };
+        std::thread::id workerId;
+        std::thread worker;
+        bool stopping = false;      // Guarded by mutex
+
+        void WorkerLoop()
+        {
+            try
+            {
+                init_apartment(apartment_type::single_threaded);
+            }
+            catch (...)
+            {
+                // Apartment may already be initialized
+            }
+
+            HANDLE events[] = { workEvent.get() };
+            while (true)
+            {
+                DWORD waitResult = MsgWaitForMultipleObjectsEx(1, events, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+                if (waitResult == WAIT_OBJECT_0 + 1)
+                {
+                    MSG msg;
+                    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+                    {
+                        TranslateMessage(&msg);
+                        DispatchMessage(&msg);
+                    }
+                    continue;
+                }
+
+                if (waitResult != WAIT_OBJECT_0)
+                {
+                    // Keep serving requests even if a wait fails spuriously
+                    Sleep(1);
+                }
+
+                std::deque<std::packaged_task<void()>> work;
+                bool stop = false;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    work.swap(pending);
+                    stop = stopping;
+                }
+
+                for (auto& task : work)
+                {
+                    // Exceptions are stored in the task's future for the caller
+                    task();
+                }
+
+                if (stop)
+                {
+                    break;
+                }
+            }
+
+            uninit_apartment();
+        }
+    };
+
+    CaptureWorker& CaptureWorker::Instance()
+    {
+        static CaptureWorker* worker = new CaptureWorker();
+        return *worker;
+    }
+
+    CaptureWorker::CaptureWorker()
+        : m_impl(new Impl())
+    {
+        m_impl->worker = std::thread(&Impl::WorkerLoop, m_impl);
+        m_impl->workerId = m_impl->worker.get_id();
+    }
+
+    CaptureWorker::~CaptureWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_impl->mutex);
+            m_impl->stopping = true;
+        }
+        SetEvent(m_impl->workEvent.get());
+
+        m_impl->worker.join();
+        delete m_impl;
+    }
+
+    bool CaptureWorker::IsWorkerThread() const
+    {
+        return std::this_thread::get_id() == m_impl->workerId;
+    }
+
+    void CaptureWorker::Invoke(const std::function<void()>& work)
+    {
+        if (IsWorkerThread())
+        {
+            work();
+            return;
+        }
+
+        std::packaged_task<void()> task(work);
+        auto done = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_impl->mutex);
+            m_impl->pending.push_back(std::move(task));
+        }
+        SetEvent(m_impl->workEvent.get());
+
+        done.get();
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <functional>
+
+namespace ScreenCaptureCore
+{
+    // Library-owned thread that runs all ScreenCapture work
+    // The thread enters a single-threaded apartment once and pumps its message queue
+    // while idle, so callers never need an apartment of their own and MTA or
+    // thread-pool threads cannot deadlock the frame pool's FrameArrived dispatch
+    class CaptureWorker
+    {
+    public:
+        // Process-wide worker, started on first use and never torn down
+        // (joining a thread from static destruction would run under the loader lock)
+        static CaptureWorker& Instance();
+
+        // Dedicated worker, for captures that must not wait behind the process-wide one
+        CaptureWorker();
+
+        // Finishes queued work and joins the thread; must not run on the worker itself
+        ~CaptureWorker();
+
+        CaptureWorker(const CaptureWorker&) = delete;
+        CaptureWorker& operator=(const CaptureWorker&) = delete;
+
+        // Run work on the worker thread and wait for it, rethrowing its exception
+        // Calls made from the worker thread itself run inline
+        void Invoke(const std::function<void()>& work);
+
+        bool IsWorkerThread() const;
+
+    private:
+        struct Impl;
+
+        Impl* m_impl;
+    };
+}
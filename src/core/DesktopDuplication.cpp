@@ -0,0 +1,281 @@
+#include "DesktopDuplication.h"
+#include "../../pch.h"
+#include <algorithm>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    // Changed rectangles copied one by one before a frame is copied as a whole
+    constexpr size_t MaxCopyRects = 64;
+
+    DesktopDuplication::~DesktopDuplication()
+    {
+        Reset();
+    }
+
+    void DesktopDuplication::Open(ID3D11Device* device, HMONITOR monitor)
+    {
+        if (m_duplication && m_device.get() == device && m_monitor == monitor)
+        {
+            return;
+        }
+
+        Reset();
+        m_device.copy_from(device);
+        m_device->GetImmediateContext(m_context.put());
+        m_monitor = monitor;
+
+        try
+        {
+            Duplicate();
+        }
+        catch (...)
+        {
+            Reset();
+            throw;
+        }
+    }
+
+    bool DesktopDuplication::IsOpen(HMONITOR monitor) const
+    {
+        return m_duplication && m_monitor == monitor;
+    }
+
+    ID3D11Device* DesktopDuplication::GetDevice() const
+    {
+        return m_device.get();
+    }
+
+    const std::vector<DirtyRect>& DesktopDuplication::GetDirtyRects() const
+    {
+        return m_dirtyRects;
+    }
+
+    void DesktopDuplication::Reset()
+    {
+        ReleaseFrame();
+        m_duplication = nullptr;
+        m_desktop = nullptr;
+        m_desktopDesc = {};
+        m_hasImage = false;
+        m_dirtyRects.clear();
+        m_monitor = nullptr;
+        m_context = nullptr;
+        m_device = nullptr;
+    }
+
+    void DesktopDuplication::Duplicate()
+    {
+        m_duplication = nullptr;
+        m_hasImage = false;
+
+        // Duplication only works on the adapter the monitor is attached to
+        com_ptr<IDXGIAdapter> adapter;
+        check_hresult(m_device.as<IDXGIDevice>()->GetAdapter(adapter.put()));
+
+        com_ptr<IDXGIOutput> output;
+        for (UINT i = 0; !output; ++i)
+        {
+            com_ptr<IDXGIOutput> candidate;
+            HRESULT hr = adapter->EnumOutputs(i, candidate.put());
+            if (hr == DXGI_ERROR_NOT_FOUND)
+            {
+                throw hresult_error(DXGI_ERROR_NOT_FOUND, L"Monitor is not attached to the capture adapter");
+            }
+            check_hresult(hr);
+
+            DXGI_OUTPUT_DESC outputDesc;
+            check_hresult(candidate->GetDesc(&outputDesc));
+            if (outputDesc.Monitor == m_monitor)
+            {
+                output = candidate;
+            }
+        }
+
+        com_ptr<IDXGIOutputDuplication> duplication;
+        check_hresult(output.as<IDXGIOutput1>()->DuplicateOutput(m_device.get(), duplication.put()));
+
+        // Rotated desktops arrive in the panel's native orientation and system-memory
+        // ones need MapDesktopSurface; both are left to Graphics Capture
+        DXGI_OUTDUPL_DESC desc;
+        duplication->GetDesc(&desc);
+        if (desc.DesktopImageInSystemMemory ||
+            (desc.Rotation != DXGI_MODE_ROTATION_IDENTITY && desc.Rotation != DXGI_MODE_ROTATION_UNSPECIFIED))
+        {
+            throw hresult_error(DXGI_ERROR_UNSUPPORTED, L"Rotated and system-memory desktops are not duplicated");
+        }
+
+        m_duplication = std::move(duplication);
+    }
+
+    void DesktopDuplication::ReleaseFrame()
+    {
+        if (m_frameHeld)
+        {
+            m_frameHeld = false;
+            m_duplication->ReleaseFrame();
+        }
+    }
+
+    ID3D11Texture2D* DesktopDuplication::AcquireFrame(uint32_t timeoutMs)
+    {
+        if (!m_duplication)
+        {
+            throw hresult_error(E_NOT_VALID_STATE, L"Desktop duplication is not open");
+        }
+
+        m_dirtyRects.clear();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        bool reopened = false;
+
+        while (true)
+        {
+            // Only the first image is waited for; after it, no pending frame means no change
+            UINT waitMs = 0;
+            if (!m_hasImage)
+            {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                waitMs = remaining > 0 ? static_cast<UINT>(remaining) : 0;
+            }
+
+            DXGI_OUTDUPL_FRAME_INFO info;
+            com_ptr<IDXGIResource> resource;
+            HRESULT hr = m_duplication->AcquireNextFrame(waitMs, &info, resource.put());
+            if (hr == DXGI_ERROR_WAIT_TIMEOUT)
+            {
+                if (m_hasImage)
+                {
+                    return m_desktop.get();
+                }
+                if (waitMs == 0)
+                {
+                    return nullptr;
+                }
+                continue;
+            }
+
+            if (hr == DXGI_ERROR_ACCESS_LOST && !reopened)
+            {
+                // Mode change, desktop switch or exclusive full-screen app: start over,
+                // the desktop may have a new size
+                reopened = true;
+                Duplicate();
+                continue;
+            }
+            check_hresult(hr);
+            m_frameHeld = true;
+
+            try
+            {
+                // Pointer-only updates can come before the first presented image
+                if (!m_hasImage && info.LastPresentTime.QuadPart == 0)
+                {
+                    ReleaseFrame();
+                    if (std::chrono::steady_clock::now() >= deadline)
+                    {
+                        return nullptr;
+                    }
+                    continue;
+                }
+
+                UpdateDesktop(info, resource.get());
+            }
+            catch (...)
+            {
+                ReleaseFrame();
+                throw;
+            }
+
+            // The image is copied out, so the frame goes back to DXGI right away
+            ReleaseFrame();
+            return m_desktop.get();
+        }
+    }
+
+    void DesktopDuplication::UpdateDesktop(const DXGI_OUTDUPL_FRAME_INFO& info, IDXGIResource* resource)
+    {
+        com_ptr<ID3D11Texture2D> texture;
+        check_hresult(resource->QueryInterface(IID_PPV_ARGS(texture.put())));
+
+        D3D11_TEXTURE2D_DESC desc;
+        texture->GetDesc(&desc);
+
+        const bool sameSize = m_desktop && desc.Width == m_desktopDesc.Width && desc.Height == m_desktopDesc.Height && desc.Format == m_desktopDesc.Format;
+        if (!sameSize)
+        {
+            desc.MipLevels = 1;
+            desc.ArraySize = 1;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = 0;
+            desc.CPUAccessFlags = 0;
+            desc.MiscFlags = 0;
+
+            m_desktop = nullptr;
+            check_hresult(m_device->CreateTexture2D(&desc, nullptr, m_desktop.put()));
+            m_desktopDesc = desc;
+            m_hasImage = false;
+        }
+
+        const DirtyRect fullFrame{ 0, 0, m_desktopDesc.Width, m_desktopDesc.Height };
+        if (!m_hasImage)
+        {
+            m_context->CopyResource(m_desktop.get(), texture.get());
+            m_dirtyRects.assign(1, fullFrame);
+            m_hasImage = true;
+            return;
+        }
+
+        // Nothing but the pointer changed
+        if (info.LastPresentTime.QuadPart == 0 || info.TotalMetadataBufferSize == 0)
+        {
+            return;
+        }
+
+        // Move rectangles come first in the metadata, dirty rectangles after them
+        m_metadata.resize(info.TotalMetadataBufferSize);
+        UINT moveBytes = 0;
+        check_hresult(m_duplication->GetFrameMoveRects(info.TotalMetadataBufferSize, reinterpret_cast<DXGI_OUTDUPL_MOVE_RECT*>(m_metadata.data()), &moveBytes));
+        UINT dirtyBytes = 0;
+        check_hresult(m_duplication->GetFrameDirtyRects(info.TotalMetadataBufferSize - moveBytes, reinterpret_cast<RECT*>(m_metadata.data() + moveBytes), &dirtyBytes));
+
+        const auto* moves = reinterpret_cast<const DXGI_OUTDUPL_MOVE_RECT*>(m_metadata.data());
+        const auto* dirty = reinterpret_cast<const RECT*>(m_metadata.data() + moveBytes);
+        const size_t moveCount = moveBytes / sizeof(DXGI_OUTDUPL_MOVE_RECT);
+        const size_t dirtyCount = dirtyBytes / sizeof(RECT);
+
+        if (moveCount + dirtyCount > MaxCopyRects)
+        {
+            m_context->CopyResource(m_desktop.get(), texture.get());
+            m_dirtyRects.assign(1, fullFrame);
+            return;
+        }
+
+        // The acquired image is complete, so moved areas are copied from their
+        // destination like dirty ones instead of being replayed
+        auto copyRect = [&](const RECT& rect)
+        {
+            const LONG left = (std::max)(rect.left, 0L);
+            const LONG top = (std::max)(rect.top, 0L);
+            const LONG right = (std::min)(rect.right, static_cast<LONG>(m_desktopDesc.Width));
+            const LONG bottom = (std::min)(rect.bottom, static_cast<LONG>(m_desktopDesc.Height));
+            if (left >= right || top >= bottom)
+            {
+                return;
+            }
+
+            D3D11_BOX box{ static_cast<UINT>(left), static_cast<UINT>(top), 0, static_cast<UINT>(right), static_cast<UINT>(bottom), 1 };
+            m_context->CopySubresourceRegion(m_desktop.get(), 0, box.left, box.top, 0, texture.get(), 0, &box);
+            m_dirtyRects.push_back(DirtyRect{ box.left, box.top, box.right - box.left, box.bottom - box.top });
+        };
+
+        for (size_t i = 0; i < moveCount; ++i)
+        {
+            copyRect(moves[i].DestinationRect);
+        }
+        for (size_t i = 0; i < dirtyCount; ++i)
+        {
+            copyRect(dirty[i]);
+        }
+    }
+}
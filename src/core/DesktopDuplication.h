@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <d3d11.h>
+#include <dxgi1_2.h>
+#include <winrt/base.h>
+
+namespace ScreenCaptureCore
+{
+    // Desktop image of one monitor through DXGI Desktop Duplication
+    // The image is kept in a texture that only dirty and moved rectangles are copied
+    // into, so a poll of an unchanged desktop costs no GPU work and a changed one copies
+    // only what changed. Frames never show the mouse cursor or a capture border
+    class DesktopDuplication
+    {
+    public:
+        DesktopDuplication() = default;
+        ~DesktopDuplication();
+
+        DesktopDuplication(const DesktopDuplication&) = delete;
+        DesktopDuplication& operator=(const DesktopDuplication&) = delete;
+
+        // Duplicate the output showing monitor; does nothing if already open for both
+        // The monitor has to be attached to the adapter of device
+        // Throws winrt::hresult_error: DXGI_ERROR_NOT_FOUND for a monitor on another
+        // adapter, DXGI_ERROR_UNSUPPORTED for rotated or system-memory desktops, and
+        // E_ACCESSDENIED or DXGI_ERROR_NOT_CURRENTLY_AVAILABLE while duplication is unavailable
+        void Open(ID3D11Device* device, HMONITOR monitor);
+
+        // Whether Open succeeded for monitor
+        bool IsOpen(HMONITOR monitor) const;
+
+        // Device the duplication was opened on (nullptr when closed)
+        ID3D11Device* GetDevice() const;
+
+        // Bring the desktop texture up to date and return it (BGRA, valid until the next call)
+        // Waits up to timeoutMs for the first image; once one is held, returns at once
+        // since updates accumulate between calls and none pending means no change
+        // Returns nullptr on timeout; reopens the duplication after DXGI_ERROR_ACCESS_LOST
+        // Throws winrt::hresult_error on other failures
+        ID3D11Texture2D* AcquireFrame(uint32_t timeoutMs);
+
+        // Areas the last AcquireFrame changed (the whole image for the first)
+        const std::vector<DirtyRect>& GetDirtyRects() const;
+
+        // Release the duplication and the desktop texture
+        void Reset();
+
+    private:
+        winrt::com_ptr<ID3D11Device> m_device;
+        winrt::com_ptr<ID3D11DeviceContext> m_context;
+        HMONITOR m_monitor = nullptr;
+        winrt::com_ptr<IDXGIOutputDuplication> m_duplication;
+        bool m_frameHeld = false;   // AcquireNextFrame succeeded without ReleaseFrame
+
+        // Desktop image as of the last acquired frame
+        winrt::com_ptr<ID3D11Texture2D> m_desktop;
+        D3D11_TEXTURE2D_DESC m_desktopDesc{};
+        bool m_hasImage = false;
+
+        std::vector<uint8_t> m_metadata;
+        std::vector<DirtyRect> m_dirtyRects;
+
+        void Duplicate();
+        void ReleaseFrame();
+
+        // Copy the changed parts of an acquired frame into the desktop texture
+        void UpdateDesktop(const DXGI_OUTDUPL_FRAME_INFO& info, IDXGIResource* resource);
+    };
+}
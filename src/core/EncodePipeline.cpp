@@ -0,0 +1,234 @@
+#include "EncodePipeline.h"
+#include "FrameEncoder.h"
+#include "CaptureStats.h"
+#include "../../pch.h"
+#include <algorithm>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    EncodePipeline::EncodePipeline(const EncodePipelineOptions& options, ILogger* logger)
+        : m_options(options)
+        , m_logger(logger ? logger : &m_defaultLogger)
+    {
+        m_options.workerCount = std::max<size_t>(m_options.workerCount, 1);
+        m_options.queueDepth = std::max<size_t>(m_options.queueDepth, 1);
+
+        for (size_t i = 0; i < m_options.workerCount; ++i)
+        {
+            m_workers.emplace_back(&EncodePipeline::WorkerLoop, this);
+        }
+    }
+
+    EncodePipeline::~EncodePipeline()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_jobAvailable.notify_all();
+        m_slotAvailable.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    bool EncodePipeline::SubmitToFile(RawFrame&& frame, const std::wstring& outputPath, FileEncodeCompletion completion)
+    {
+        Job job;
+        job.frame = std::move(frame);
+        job.outputPath = outputPath;
+        job.completion = std::move(completion);
+        return Enqueue(std::move(job));
+    }
+
+    bool EncodePipeline::SubmitStreamFrame(const StreamFrame& frame, const std::wstring& outputPath, FileEncodeCompletion completion)
+    {
+        // Texture frames have no CPU pixels to encode
+        if (!frame.pixels)
+        {
+            return false;
+        }
+
+        RawFrame rawFrame = AcquireFrame();
+        rawFrame.width = frame.width;
+        rawFrame.height = frame.height;
+        rawFrame.stride = frame.stride;
+        rawFrame.format = PixelFormat::Bgra;    // Recycled frames may hold another layout
+        rawFrame.timestamp = frame.timestamp;
+        rawFrame.pixels.resize(static_cast<size_t>(frame.stride) * frame.height);
+        memcpy(rawFrame.pixels.data(), frame.pixels, rawFrame.pixels.size());
+
+        return SubmitToFile(std::move(rawFrame), outputPath, std::move(completion));
+    }
+
+    RawFrame EncodePipeline::AcquireFrame()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_freeFrames.empty())
+        {
+            return RawFrame();
+        }
+
+        RawFrame frame = std::move(m_freeFrames.back());
+        m_freeFrames.pop_back();
+        return frame;
+    }
+
+    void EncodePipeline::Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_queue.empty() && m_activeJobs == 0; });
+    }
+
+    uint64_t EncodePipeline::DroppedCount() const
+    {
+        return m_dropped.load();
+    }
+
+    bool EncodePipeline::Enqueue(Job&& job)
+    {
+        Job droppedJob;
+        bool dropped = false;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stopping)
+            {
+                return false;
+            }
+
+            if (m_queue.size() >= m_options.queueDepth)
+            {
+                if (m_options.backpressure == BackpressurePolicy::Block)
+                {
+                    m_slotAvailable.wait(lock, [this] { return m_queue.size() < m_options.queueDepth || m_stopping; });
+                    if (m_stopping)
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    droppedJob = std::move(m_queue.front());
+                    m_queue.pop_front();
+                    dropped = true;
+                    ++m_dropped;
+                }
+            }
+
+            m_queue.push_back(std::move(job));
+        }
+        m_jobAvailable.notify_one();
+
+        if (dropped)
+        {
+            RecordDroppedFrames(1);
+            CompleteDropped(droppedJob);
+        }
+
+        return true;
+    }
+
+    void EncodePipeline::WorkerLoop()
+    {
+        // Encoding uses WinRT; workers have their own multithreaded apartment
+        try
+        {
+            init_apartment(apartment_type::multi_threaded);
+        }
+        catch (...)
+        {
+            // Apartment may already be initialized
+        }
+
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobAvailable.wait(lock, [this] { return !m_queue.empty() || m_stopping; });
+                if (m_queue.empty())
+                {
+                    // Stopping and fully drained
+                    break;
+                }
+
+                job = std::move(m_queue.front());
+                m_queue.pop_front();
+                ++m_activeJobs;
+            }
+            m_slotAvailable.notify_one();
+
+            RunJob(job);
+            RecycleFrame(std::move(job.frame));
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_activeJobs;
+                if (m_queue.empty() && m_activeJobs == 0)
+                {
+                    m_idle.notify_all();
+                }
+            }
+        }
+
+        uninit_apartment();
+    }
+
+    void EncodePipeline::RunJob(Job& job)
+    {
+        ErrorCode result = ErrorCode::Success;
+        try
+        {
+            SaveFrameToFile(job.frame, job.outputPath, m_options.encode);
+        }
+        catch (...)
+        {
+            m_logger->LogError(L"Error saving frame to " + job.outputPath);
+            result = ErrorCode::FileSaveFailed;
+        }
+
+        if (job.completion)
+        {
+            try
+            {
+                job.completion(result, job.outputPath);
+            }
+            catch (...)
+            {
+                // Completion callbacks must not take down the worker
+            }
+        }
+    }
+
+    void EncodePipeline::CompleteDropped(Job& job)
+    {
+        try
+        {
+            if (job.completion)
+            {
+                job.completion(ErrorCode::FrameDropped, job.outputPath);
+            }
+        }
+        catch (...)
+        {
+            // Completion callbacks must not take down the producer
+        }
+
+        RecycleFrame(std::move(job.frame));
+    }
+
+    void EncodePipeline::RecycleFrame(RawFrame&& frame)
+    {
+        // Keep enough buffers for a full queue plus one per worker
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_freeFrames.size() < m_options.queueDepth + m_options.workerCount)
+        {
+            m_freeFrames.push_back(std::move(frame));
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+namespace ScreenCaptureCore
+{
+    // Encode pipeline options
+    struct EncodePipelineOptions
+    {
+        size_t workerCount = 2;     // Encoder worker threads
+        size_t queueDepth = 4;      // Frames waiting for a worker
+        BackpressurePolicy backpressure = BackpressurePolicy::DropOldest;
+        EncodeOptions encode;       // Format for every job (Auto picks file formats by extension)
+    };
+
+    // Bounded producer/consumer encode stage
+    // The capture side only copies pixels into a queued frame; a pool of worker
+    // threads does the encoding and file I/O, so capture is not limited by encode speed
+    class EncodePipeline
+    {
+    public:
+        EncodePipeline(const EncodePipelineOptions& options = EncodePipelineOptions(), ILogger* logger = nullptr);
+
+        // Encodes everything still queued, then stops the workers
+        ~EncodePipeline();
+
+        EncodePipeline(const EncodePipeline&) = delete;
+        EncodePipeline& operator=(const EncodePipeline&) = delete;
+
+        // Queue a frame to be encoded to a file
+        // Returns false if the pipeline is shutting down
+        bool SubmitToFile(RawFrame&& frame, const std::wstring& outputPath, FileEncodeCompletion completion = nullptr);
+
+        // Copy a stream frame's mapped pixels into a recycled buffer and queue it for a file
+        // Safe to call from a stream callback; the copy is the only work done on the capture thread
+        bool SubmitStreamFrame(const StreamFrame& frame, const std::wstring& outputPath, FileEncodeCompletion completion = nullptr);
+
+        // Take a frame whose pixel buffer can be reused (avoids per-frame allocation)
+        RawFrame AcquireFrame();
+
+        // Wait until all queued frames have been encoded
+        void Flush();
+
+        // Number of frames discarded by DropOldest backpressure
+        uint64_t DroppedCount() const;
+
+    private:
+        struct Job
+        {
+            RawFrame frame;
+            std::wstring outputPath;
+            FileEncodeCompletion completion;
+        };
+
+        EncodePipelineOptions m_options;
+        ILogger* m_logger;
+        SilentLogger m_defaultLogger;
+
+        std::mutex m_mutex;
+        std::condition_variable m_jobAvailable;
+        std::condition_variable m_slotAvailable;
+        std::condition_variable m_idle;
+        std::deque<Job> m_queue;
+        std::vector<RawFrame> m_freeFrames;
+        size_t m_activeJobs = 0;
+        bool m_stopping = false;
+        std::atomic<uint64_t> m_dropped{ 0 };
+
+        std::vector<std::thread> m_workers;
+
+        bool Enqueue(Job&& job);
+        void WorkerLoop();
+        void RunJob(Job& job);
+        void CompleteDropped(Job& job);
+        void RecycleFrame(RawFrame&& frame);
+    };
+}
@@ -0,0 +1,344 @@
+#include "FrameChangeDetector.h"
+#include "../../pch.h"
+#include <d3dcompiler.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    // One thread group per 64x64 tile, each thread hashing a 4x4 block
+    // Thread hashes are mixed with the thread index and XORed together, so any
+    // changed pixel changes the tile hash
+    constexpr char TileHashShaderSource[] = R"(
+Texture2D<float4> Source : register(t0);
+RWStructuredBuffer<uint> Hashes : register(u0);
+
+cbuffer Constants : register(b0)
+{
+    uint2 Offset;
+    uint2 Size;
+    uint TilesX;
+    uint3 Padding;
+};
+
+groupshared uint TileHash;
+
+[numthreads(16, 16, 1)]
+void main(uint3 group : SV_GroupID, uint3 thread : SV_GroupThreadID, uint index : SV_GroupIndex)
+{
+    if (index == 0)
+    {
+        TileHash = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    uint hash = 2166136261;
+    uint2 origin = group.xy * 64 + thread.xy * 4;
+    for (uint y = 0; y < 4; ++y)
+    {
+        for (uint x = 0; x < 4; ++x)
+        {
+            uint2 position = origin + uint2(x, y);
+            if (all(position < Size))
+            {
+                uint4 c = uint4(round(Source[Offset + position] * 255));
+                hash = (hash ^ (c.r | (c.g << 8) | (c.b << 16) | (c.a << 24))) * 16777619;
+            }
+        }
+    }
+
+    InterlockedXor(TileHash, (hash ^ index) * 2654435761);
+    GroupMemoryBarrierWithGroupSync();
+
+    if (index == 0)
+    {
+        Hashes[group.y * TilesX + group.x] = TileHash;
+    }
+}
+)";
+
+    struct TileHashConstants
+    {
+        uint32_t offsetX;
+        uint32_t offsetY;
+        uint32_t width;
+        uint32_t height;
+        uint32_t tilesX;
+        uint32_t padding[3];
+    };
+
+    bool MapDirtyRect(int32_t left, int32_t top, int32_t right, int32_t bottom, const D3D11_BOX& box, uint32_t outputWidth, uint32_t outputHeight, DirtyRect& rect)
+    {
+        const int64_t clippedLeft = std::max<int64_t>(left, box.left);
+        const int64_t clippedTop = std::max<int64_t>(top, box.top);
+        const int64_t clippedRight = std::min<int64_t>(right, box.right);
+        const int64_t clippedBottom = std::min<int64_t>(bottom, box.bottom);
+        if (clippedRight <= clippedLeft || clippedBottom <= clippedTop)
+        {
+            return false;
+        }
+
+        const double scaleX = static_cast<double>(outputWidth) / (box.right - box.left);
+        const double scaleY = static_cast<double>(outputHeight) / (box.bottom - box.top);
+        const auto outLeft = static_cast<uint32_t>(std::floor((clippedLeft - box.left) * scaleX));
+        const auto outTop = static_cast<uint32_t>(std::floor((clippedTop - box.top) * scaleY));
+        const auto outRight = std::min(outputWidth, static_cast<uint32_t>(std::ceil((clippedRight - box.left) * scaleX)));
+        const auto outBottom = std::min(outputHeight, static_cast<uint32_t>(std::ceil((clippedBottom - box.top) * scaleY)));
+
+        rect = { outLeft, outTop, outRight - outLeft, outBottom - outTop };
+        return rect.width > 0 && rect.height > 0;
+    }
+
+    bool FrameChangeDetector::Detect(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* texture, const D3D11_BOX& box, std::vector<DirtyRect>& dirtyRects)
+    {
+        const uint32_t width = box.right - box.left;
+        const uint32_t height = box.bottom - box.top;
+
+        EnsureDevice(device);
+        EnsureHashBuffers(width, height);
+        ID3D11ShaderResourceView* view = EnsureView(texture);
+
+        TileHashConstants constants = { box.left, box.top, width, height, m_tilesX, {} };
+        context->UpdateSubresource(m_constants.get(), 0, nullptr, &constants, 0, 0);
+
+        ID3D11ShaderResourceView* views[] = { view };
+        ID3D11UnorderedAccessView* outputs[] = { m_hashView.get() };
+        ID3D11Buffer* buffers[] = { m_constants.get() };
+        context->CSSetShader(m_shader.get(), nullptr, 0);
+        context->CSSetShaderResources(0, 1, views);
+        context->CSSetUnorderedAccessViews(0, 1, outputs, nullptr);
+        context->CSSetConstantBuffers(0, 1, buffers);
+        context->Dispatch(m_tilesX, m_tilesY, 1);
+
+        ID3D11ShaderResourceView* nullViews[] = { nullptr };
+        ID3D11UnorderedAccessView* nullOutputs[] = { nullptr };
+        context->CSSetShaderResources(0, 1, nullViews);
+        context->CSSetUnorderedAccessViews(0, 1, nullOutputs, nullptr);
+        context->CSSetShader(nullptr, nullptr, 0);
+
+        // Only the hashes come back to the CPU (4 bytes per tile)
+        context->CopyResource(m_readbackBuffers[m_queued % m_readbackBuffers.size()].get(), m_hashBuffer.get());
+        const bool first = m_queued == 0;
+        ++m_queued;
+
+        // Wait only for copies that fell ReadbackLatency frames behind, then take
+        // whatever else the GPU already finished
+        while (m_queued - m_resolved > ReadbackLatency)
+        {
+            Resolve(context, true);
+        }
+        while (m_resolved < m_queued && Resolve(context, false))
+        {
+        }
+
+        if (first)
+        {
+            std::fill(m_changedTiles.begin(), m_changedTiles.end(), static_cast<uint8_t>(0));
+            dirtyRects.push_back({ 0, 0, width, height });
+            return true;
+        }
+
+        // Merge changed tiles of a row into runs to keep the rectangle count low
+        bool changed = false;
+        for (uint32_t tileY = 0; tileY < m_tilesY; ++tileY)
+        {
+            const uint8_t* row = m_changedTiles.data() + static_cast<size_t>(tileY) * m_tilesX;
+            uint32_t tileX = 0;
+            while (tileX < m_tilesX)
+            {
+                if (!row[tileX])
+                {
+                    ++tileX;
+                    continue;
+                }
+
+                uint32_t runEnd = tileX + 1;
+                while (runEnd < m_tilesX && row[runEnd])
+                {
+                    ++runEnd;
+                }
+
+                const uint32_t left = tileX * TileSize;
+                const uint32_t top = tileY * TileSize;
+                const uint32_t right = std::min(runEnd * TileSize, width);
+                const uint32_t bottom = std::min(top + TileSize, height);
+                dirtyRects.push_back({ left, top, right - left, bottom - top });
+                changed = true;
+                tileX = runEnd;
+            }
+        }
+
+        std::fill(m_changedTiles.begin(), m_changedTiles.end(), static_cast<uint8_t>(0));
+        return changed;
+    }
+
+    bool FrameChangeDetector::Resolve(ID3D11DeviceContext* context, bool wait)
+    {
+        ID3D11Buffer* readbackBuffer = m_readbackBuffers[m_resolved % m_readbackBuffers.size()].get();
+
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        HRESULT hr = context->Map(readbackBuffer, 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedResource);
+        if (hr == DXGI_ERROR_WAS_STILL_DRAWING && !wait)
+        {
+            return false;
+        }
+        check_hresult(hr);
+        const auto* hashes = static_cast<const uint32_t*>(mappedResource.pData);
+
+        // The first copy has nothing to compare with; Detect reports it as a whole
+        if (m_hasPrevious)
+        {
+            for (size_t index = 0; index < m_previousHashes.size(); ++index)
+            {
+                if (hashes[index] != m_previousHashes[index])
+                {
+                    m_changedTiles[index] = 1;
+                }
+            }
+        }
+
+        std::copy(hashes, hashes + m_previousHashes.size(), m_previousHashes.begin());
+        m_hasPrevious = true;
+        context->Unmap(readbackBuffer, 0);
+
+        ++m_resolved;
+        return true;
+    }
+
+    void FrameChangeDetector::Reset()
+    {
+        m_views.clear();
+        m_readbackBuffers = {};
+        m_queued = 0;
+        m_resolved = 0;
+        m_hashView = nullptr;
+        m_hashBuffer = nullptr;
+        m_constants = nullptr;
+        m_shader = nullptr;
+        m_device = nullptr;
+        m_width = 0;
+        m_height = 0;
+        m_tilesX = 0;
+        m_tilesY = 0;
+        m_previousHashes.clear();
+        m_changedTiles.clear();
+        m_hasPrevious = false;
+    }
+
+    void FrameChangeDetector::EnsureDevice(ID3D11Device* device)
+    {
+        if (m_device.get() == device && m_shader)
+        {
+            return;
+        }
+
+        Reset();
+
+        if (device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0)
+        {
+            throw hresult_error(DXGI_ERROR_UNSUPPORTED, L"Change detection requires Direct3D feature level 11.0");
+        }
+
+        com_ptr<ID3DBlob> shaderBlob;
+        com_ptr<ID3DBlob> errorBlob;
+        HRESULT hr = D3DCompile(
+            TileHashShaderSource,
+            sizeof(TileHashShaderSource) - 1,
+            "FrameChangeDetector",
+            nullptr,
+            nullptr,
+            "main",
+            "cs_5_0",
+            D3DCOMPILE_OPTIMIZATION_LEVEL3,
+            0,
+            shaderBlob.put(),
+            errorBlob.put()
+        );
+        if (FAILED(hr))
+        {
+            throw hresult_error(hr, L"Failed to compile tile hash shader");
+        }
+
+        check_hresult(device->CreateComputeShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, m_shader.put()));
+
+        D3D11_BUFFER_DESC bufferDesc = {};
+        bufferDesc.ByteWidth = sizeof(TileHashConstants);
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        check_hresult(device->CreateBuffer(&bufferDesc, nullptr, m_constants.put()));
+
+        m_device.copy_from(device);
+    }
+
+    void FrameChangeDetector::EnsureHashBuffers(uint32_t width, uint32_t height)
+    {
+        if (m_hashBuffer && m_width == width && m_height == height)
+        {
+            return;
+        }
+
+        m_tilesX = (width + TileSize - 1) / TileSize;
+        m_tilesY = (height + TileSize - 1) / TileSize;
+        const uint32_t tileCount = m_tilesX * m_tilesY;
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = tileCount * sizeof(uint32_t);
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = sizeof(uint32_t);
+
+        m_hashView = nullptr;
+        m_hashBuffer = nullptr;
+        m_readbackBuffers = {};
+        m_queued = 0;
+        m_resolved = 0;
+        check_hresult(m_device->CreateBuffer(&desc, nullptr, m_hashBuffer.put()));
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC viewDesc = {};
+        viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+        viewDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        viewDesc.Buffer.NumElements = tileCount;
+        check_hresult(m_device->CreateUnorderedAccessView(m_hashBuffer.get(), &viewDesc, m_hashView.put()));
+
+        D3D11_BUFFER_DESC readbackDesc = {};
+        readbackDesc.ByteWidth = desc.ByteWidth;
+        readbackDesc.Usage = D3D11_USAGE_STAGING;
+        readbackDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        for (auto& readbackBuffer : m_readbackBuffers)
+        {
+            check_hresult(m_device->CreateBuffer(&readbackDesc, nullptr, readbackBuffer.put()));
+        }
+
+        m_width = width;
+        m_height = height;
+        m_previousHashes.assign(tileCount, 0);
+        m_changedTiles.assign(tileCount, 0);
+        m_hasPrevious = false;
+    }
+
+    ID3D11ShaderResourceView* FrameChangeDetector::EnsureView(ID3D11Texture2D* texture)
+    {
+        for (auto const& cached : m_views)
+        {
+            if (cached.first.get() == texture)
+            {
+                return cached.second.get();
+            }
+        }
+
+        if (m_views.size() >= MaxCachedViews)
+        {
+            m_views.erase(m_views.begin());
+        }
+
+        com_ptr<ID3D11Texture2D> viewTexture;
+        viewTexture.copy_from(texture);
+        com_ptr<ID3D11ShaderResourceView> view;
+        check_hresult(m_device->CreateShaderResourceView(texture, nullptr, view.put()));
+        m_views.emplace_back(std::move(viewTexture), std::move(view));
+        return m_views.back().second.get();
+    }
+}
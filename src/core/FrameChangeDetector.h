@@ -0,0 +1,78 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <d3d11.h>
+#include <winrt/base.h>
+#include <array>
+#include <utility>
+#include <vector>
+
+// Direct3D11CaptureFrame::DirtyRegions needs the Windows 11 24H2 SDK (10.0.26100)
+#if defined(NTDDI_WIN11_GE) && defined(WDK_NTDDI_VERSION) && WDK_NTDDI_VERSION >= NTDDI_WIN11_GE
+#define SCREENCAPTURE_HAS_DIRTY_REGIONS 1
+#endif
+
+namespace ScreenCaptureCore
+{
+    // Map a rectangle of the source frame into the output of a crop box scaled to
+    // outputWidth x outputHeight, growing it to whole output pixels
+    // Returns false if the rectangle is outside the box
+    bool MapDirtyRect(int32_t left, int32_t top, int32_t right, int32_t bottom, const D3D11_BOX& box, uint32_t outputWidth, uint32_t outputHeight, DirtyRect& rect);
+
+    // Finds the tiles of a frame that differ from the previous frame
+    // A compute pass hashes each TileSize x TileSize tile on the GPU and only the
+    // hashes are read back, so unchanged frames never leave video memory
+    // The hashes go through a ring of staging buffers and are read ReadbackLatency
+    // frames behind, so the CPU never waits for the pass it just queued
+    class FrameChangeDetector
+    {
+    public:
+        static constexpr uint32_t TileSize = 64;
+        static constexpr uint32_t ReadbackLatency = 1;
+
+        // Hash the box of texture and append the tiles (relative to the box) that changed
+        // in the frames whose hashes came back since the previous call; those of this frame
+        // surface with a later call, up to ReadbackLatency frames on
+        // The first frame, and any frame after a size change, is changed as a whole
+        // Returns false if nothing changed since the previous call
+        // Throws winrt::hresult_error on failure
+        bool Detect(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* texture, const D3D11_BOX& box, std::vector<DirtyRect>& dirtyRects);
+
+        // Forget the previous frame and release all GPU resources
+        void Reset();
+
+    private:
+        winrt::com_ptr<ID3D11Device> m_device;
+        winrt::com_ptr<ID3D11ComputeShader> m_shader;
+        winrt::com_ptr<ID3D11Buffer> m_constants;
+
+        // Views of the recently hashed textures, newest last
+        // Uncropped frames are the frame pool surfaces themselves, so one per pool buffer
+        // and one for the scaler output
+        static constexpr size_t MaxCachedViews = MaxFrameBufferCount + 1;
+        std::vector<std::pair<winrt::com_ptr<ID3D11Texture2D>, winrt::com_ptr<ID3D11ShaderResourceView>>> m_views;
+
+        // Per-tile hashes written by the shader and the ring of their CPU-readable copies
+        winrt::com_ptr<ID3D11Buffer> m_hashBuffer;
+        winrt::com_ptr<ID3D11UnorderedAccessView> m_hashView;
+        std::array<winrt::com_ptr<ID3D11Buffer>, ReadbackLatency + 1> m_readbackBuffers;
+        uint64_t m_queued = 0;              // Hash copies queued into the ring
+        uint64_t m_resolved = 0;            // Hash copies read back and compared
+
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_tilesX = 0;
+        uint32_t m_tilesY = 0;
+        std::vector<uint32_t> m_previousHashes;
+        std::vector<uint8_t> m_changedTiles;    // Tiles changed in the copies read back since the last report
+        bool m_hasPrevious = false;
+
+        void EnsureDevice(ID3D11Device* device);
+        void EnsureHashBuffers(uint32_t width, uint32_t height);
+        ID3D11ShaderResourceView* EnsureView(ID3D11Texture2D* texture);
+
+        // Compare the oldest queued copy with the hashes before it
+        // Returns false if wait is false and the GPU has not written the copy yet
+        bool Resolve(ID3D11DeviceContext* context, bool wait);
+    };
+}
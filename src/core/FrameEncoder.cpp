@@ -0,0 +1,581 @@
+#include "FrameEncoder.h"
+#include "PixelConverter.h"
+#include "CaptureStats.h"
+#include "ParallelPngEncoder.h"
+#include "../../pch.h"
+#include <wincodec.h>
+#include <shlwapi.h>
+#include <shcore.h>
+#include <filesystem>
+#include <cwctype>
+#include <unordered_set>
+
+using namespace winrt;
+using namespace winrt::Windows::Foundation;
+using namespace winrt::Windows::Graphics::Imaging;
+using namespace winrt::Windows::Storage::Streams;
+
+namespace ScreenCaptureCore
+{
+    void CopyRows(uint8_t* destination, size_t destinationStride, const uint8_t* source, size_t sourceStride, size_t rowBytes, uint32_t rowCount)
+    {
+        if (destinationStride == sourceStride && destinationStride == rowBytes)
+        {
+            memcpy(destination, source, rowBytes * rowCount);
+            return;
+        }
+
+        for (uint32_t y = 0; y < rowCount; ++y)
+        {
+            memcpy(destination + y * destinationStride, source + y * sourceStride, rowBytes);
+        }
+    }
+
+    bool IsValidEncodeOptions(const EncodeOptions& options)
+    {
+        return options.jpegQuality >= 0.0f && options.jpegQuality <= 1.0f;
+    }
+
+    ImageFormat ResolveImageFormat(ImageFormat format, const std::wstring& outputPath)
+    {
+        if (format != ImageFormat::Auto)
+        {
+            return format;
+        }
+
+        std::wstring extension = std::filesystem::path(outputPath).extension().wstring();
+        for (auto& c : extension)
+        {
+            c = static_cast<wchar_t>(std::towlower(c));
+        }
+
+        if (extension == L".bmp")
+        {
+            return ImageFormat::Bmp;
+        }
+        if (extension == L".raw" || extension == L".bgra")
+        {
+            return ImageFormat::Raw;
+        }
+        if (extension == L".qoi")
+        {
+            return ImageFormat::Qoi;
+        }
+        if (extension == L".jpg" || extension == L".jpeg")
+        {
+            return ImageFormat::Jpeg;
+        }
+        if (extension == L".jxr" || extension == L".wdp" || extension == L".hdp")
+        {
+            return ImageFormat::Jxr;
+        }
+        return ImageFormat::Png;
+    }
+
+    // Helper function to get tightly packed rows, repacking only when the frame is padded
+    const uint8_t* GetPackedPixels(const RawFrame& frame, std::vector<uint8_t>& packedPixels)
+    {
+        const uint32_t rowBytes = frame.width * BytesPerPixel(frame.format);
+        if (frame.stride == rowBytes)
+        {
+            return frame.pixels.data();
+        }
+
+        packedPixels.resize(static_cast<size_t>(rowBytes) * frame.height);
+        CopyRows(packedPixels.data(), rowBytes, frame.pixels.data(), frame.stride, rowBytes, frame.height);
+        return packedPixels.data();
+    }
+
+    // Helper function to write packed BGRA (or half-float) rows with no header
+    void EncodeRaw(const RawFrame& frame, std::vector<uint8_t>& outputBuffer)
+    {
+        const uint32_t rowBytes = frame.width * BytesPerPixel(frame.format);
+        outputBuffer.resize(static_cast<size_t>(rowBytes) * frame.height);
+        CopyRows(outputBuffer.data(), rowBytes, frame.pixels.data(), frame.stride, rowBytes, frame.height);
+    }
+
+    // Helper function to write an uncompressed top-down 32-bit BMP
+    void EncodeBmp(const RawFrame& frame, std::vector<uint8_t>& outputBuffer)
+    {
+        const uint32_t rowBytes = frame.width * 4;
+        const uint32_t headerSize = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
+        const size_t imageSize = static_cast<size_t>(rowBytes) * frame.height;
+
+        BITMAPFILEHEADER fileHeader = {};
+        fileHeader.bfType = 0x4D42; // "BM"
+        fileHeader.bfSize = static_cast<DWORD>(headerSize + imageSize);
+        fileHeader.bfOffBits = headerSize;
+
+        BITMAPINFOHEADER infoHeader = {};
+        infoHeader.biSize = sizeof(BITMAPINFOHEADER);
+        infoHeader.biWidth = static_cast<LONG>(frame.width);
+        infoHeader.biHeight = -static_cast<LONG>(frame.height); // Negative height: rows are top-down like the capture
+        infoHeader.biPlanes = 1;
+        infoHeader.biBitCount = 32;
+        infoHeader.biCompression = BI_RGB;
+        infoHeader.biSizeImage = static_cast<DWORD>(imageSize);
+
+        outputBuffer.resize(headerSize + imageSize);
+        memcpy(outputBuffer.data(), &fileHeader, sizeof(fileHeader));
+        memcpy(outputBuffer.data() + sizeof(fileHeader), &infoHeader, sizeof(infoHeader));
+        CopyRows(outputBuffer.data() + headerSize, rowBytes, frame.pixels.data(), frame.stride, rowBytes, frame.height);
+    }
+
+    // Helper function to write a 32-bit big-endian value
+    uint8_t* WriteBigEndian32(uint8_t* output, uint32_t value)
+    {
+        *output++ = static_cast<uint8_t>(value >> 24);
+        *output++ = static_cast<uint8_t>(value >> 16);
+        *output++ = static_cast<uint8_t>(value >> 8);
+        *output++ = static_cast<uint8_t>(value);
+        return output;
+    }
+
+    // Helper function to encode a BGRA frame as a 3-channel QOI image (alpha is ignored like the PNG path)
+    void EncodeQoi(const RawFrame& frame, std::vector<uint8_t>& outputBuffer)
+    {
+        constexpr uint8_t OpIndex = 0x00;
+        constexpr uint8_t OpDiff = 0x40;
+        constexpr uint8_t OpLuma = 0x80;
+        constexpr uint8_t OpRun = 0xC0;
+        constexpr uint8_t OpRgb = 0xFE;
+        constexpr size_t HeaderSize = 14;
+        constexpr size_t EndMarkerSize = 8;
+
+        // Worst case is one OpRgb (4 bytes) per pixel
+        const size_t pixelCount = static_cast<size_t>(frame.width) * frame.height;
+        outputBuffer.resize(HeaderSize + pixelCount * 4 + EndMarkerSize);
+
+        uint8_t* output = outputBuffer.data();
+        *output++ = 'q';
+        *output++ = 'o';
+        *output++ = 'i';
+        *output++ = 'f';
+        output = WriteBigEndian32(output, frame.width);
+        output = WriteBigEndian32(output, frame.height);
+        *output++ = 3; // RGB
+        *output++ = 0; // sRGB with linear alpha
+
+        // Pixels are packed as 0xAARRGGBB with alpha forced opaque, so the zeroed
+        // index (transparent black) never matches and alpha never needs an op
+        uint32_t index[64] = {};
+        uint32_t previous = 0xFF000000;
+        uint32_t run = 0;
+        size_t remaining = pixelCount;
+
+        for (uint32_t y = 0; y < frame.height; ++y)
+        {
+            const uint8_t* row = frame.pixels.data() + static_cast<size_t>(y) * frame.stride;
+            for (uint32_t x = 0; x < frame.width; ++x, --remaining)
+            {
+                const uint8_t b = row[x * 4 + 0];
+                const uint8_t g = row[x * 4 + 1];
+                const uint8_t r = row[x * 4 + 2];
+                const uint32_t pixel = 0xFF000000 | (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+
+                if (pixel == previous)
+                {
+                    ++run;
+                    if (run == 62 || remaining == 1)
+                    {
+                        *output++ = static_cast<uint8_t>(OpRun | (run - 1));
+                        run = 0;
+                    }
+                    continue;
+                }
+
+                if (run > 0)
+                {
+                    *output++ = static_cast<uint8_t>(OpRun | (run - 1));
+                    run = 0;
+                }
+
+                const uint32_t hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+                if (index[hash] == pixel)
+                {
+                    *output++ = static_cast<uint8_t>(OpIndex | hash);
+                }
+                else
+                {
+                    index[hash] = pixel;
+
+                    const int8_t dr = static_cast<int8_t>(r - static_cast<uint8_t>(previous >> 16));
+                    const int8_t dg = static_cast<int8_t>(g - static_cast<uint8_t>(previous >> 8));
+                    const int8_t db = static_cast<int8_t>(b - static_cast<uint8_t>(previous));
+                    const int8_t drDg = static_cast<int8_t>(dr - dg);
+                    const int8_t dbDg = static_cast<int8_t>(db - dg);
+
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                    {
+                        *output++ = static_cast<uint8_t>(OpDiff | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                    }
+                    else if (dg >= -32 && dg <= 31 && drDg >= -8 && drDg <= 7 && dbDg >= -8 && dbDg <= 7)
+                    {
+                        *output++ = static_cast<uint8_t>(OpLuma | (dg + 32));
+                        *output++ = static_cast<uint8_t>(((drDg + 8) << 4) | (dbDg + 8));
+                    }
+                    else
+                    {
+                        *output++ = OpRgb;
+                        *output++ = r;
+                        *output++ = g;
+                        *output++ = b;
+                    }
+                }
+
+                previous = pixel;
+            }
+        }
+
+        // End marker: seven 0x00 bytes followed by 0x01
+        for (size_t i = 0; i < EndMarkerSize - 1; ++i)
+        {
+            *output++ = 0;
+        }
+        *output++ = 1;
+
+        outputBuffer.resize(static_cast<size_t>(output - outputBuffer.data()));
+    }
+
+    // Helper function to encode a BGRA or half-float frame as lossless JPEG XR into a stream
+    // WinRT's BitmapEncoder has no half-float pixel format, so this uses the WIC COM encoder
+    void EncodeJxrToStream(const RawFrame& frame, IStream* stream)
+    {
+        auto factory = create_instance<IWICImagingFactory>(CLSID_WICImagingFactory);
+
+        com_ptr<IWICBitmapEncoder> encoder;
+        check_hresult(factory->CreateEncoder(GUID_ContainerFormatWmp, nullptr, encoder.put()));
+        check_hresult(encoder->Initialize(stream, WICBitmapEncoderNoCache));
+
+        com_ptr<IWICBitmapFrameEncode> frameEncode;
+        com_ptr<IPropertyBag2> properties;
+        check_hresult(encoder->CreateNewFrame(frameEncode.put(), properties.put()));
+
+        PROPBAG2 option = {};
+        option.pstrName = const_cast<LPOLESTR>(L"Lossless");
+        VARIANT value;
+        VariantInit(&value);
+        value.vt = VT_BOOL;
+        value.boolVal = VARIANT_TRUE;
+        check_hresult(properties->Write(1, &option, &value));
+
+        check_hresult(frameEncode->Initialize(properties.get()));
+        check_hresult(frameEncode->SetSize(frame.width, frame.height));
+
+        // The encoder may pick a different format; refuse rather than write converted pixels
+        const WICPixelFormatGUID requestedFormat = frame.format == PixelFormat::Rgba16Float ? GUID_WICPixelFormat64bppRGBAHalf : GUID_WICPixelFormat32bppBGRA;
+        WICPixelFormatGUID pixelFormat = requestedFormat;
+        check_hresult(frameEncode->SetPixelFormat(&pixelFormat));
+        if (pixelFormat != requestedFormat)
+        {
+            throw hresult_error(WINCODEC_ERR_UNSUPPORTEDPIXELFORMAT, L"JPEG XR encoder rejected the pixel format");
+        }
+
+        check_hresult(frameEncode->WritePixels(frame.height, frame.stride, static_cast<UINT>(frame.pixels.size()), const_cast<BYTE*>(frame.pixels.data())));
+        check_hresult(frameEncode->Commit());
+        check_hresult(encoder->Commit());
+    }
+
+    // Helper function to encode a BGRA or half-float frame as lossless JPEG XR in memory
+    void EncodeJxr(const RawFrame& frame, std::vector<uint8_t>& outputBuffer)
+    {
+        com_ptr<IStream> stream;
+        check_hresult(CreateStreamOnHGlobal(nullptr, TRUE, stream.put()));
+        EncodeJxrToStream(frame, stream.get());
+
+        // Copy the encoded bytes out of the stream's memory
+        HGLOBAL memory = nullptr;
+        check_hresult(GetHGlobalFromStream(stream.get(), &memory));
+
+        STATSTG stat = {};
+        check_hresult(stream->Stat(&stat, STATFLAG_NONAME));
+
+        const void* data = GlobalLock(memory);
+        check_bool(data != nullptr);
+        outputBuffer.resize(static_cast<size_t>(stat.cbSize.QuadPart));
+        memcpy(outputBuffer.data(), data, outputBuffer.size());
+        GlobalUnlock(memory);
+    }
+
+    // Helper function to build WIC encoder properties for the chosen format
+    BitmapPropertySet CreateEncoderProperties(ImageFormat format, const EncodeOptions& options)
+    {
+        BitmapPropertySet properties;
+        if (format == ImageFormat::Jpeg)
+        {
+            properties.Insert(L"ImageQuality", BitmapTypedValue(box_value(options.jpegQuality), PropertyType::Single));
+        }
+        else
+        {
+            if (options.pngFilter != PngFilter::Default)
+            {
+                // PngFilter values match WICPngFilterOption
+                properties.Insert(L"FilterOption", BitmapTypedValue(box_value(static_cast<uint8_t>(options.pngFilter)), PropertyType::UInt8));
+            }
+            if (options.pngInterlace)
+            {
+                properties.Insert(L"InterlaceOption", BitmapTypedValue(box_value(true), PropertyType::Boolean));
+            }
+        }
+        return properties;
+    }
+
+    // Helper function to encode a raw BGRA frame to PNG or JPEG into a stream
+    void EncodeWicToStream(const RawFrame& frame, ImageFormat format, const EncodeOptions& options, IRandomAccessStream const& stream)
+    {
+        auto encoderId = format == ImageFormat::Jpeg ? BitmapEncoder::JpegEncoderId() : BitmapEncoder::PngEncoderId();
+        BitmapEncoder encoder = BitmapEncoder::CreateAsync(encoderId, stream, CreateEncoderProperties(format, options)).get();
+
+        // The encoder expects tightly packed rows
+        std::vector<uint8_t> packedPixels;
+        const uint8_t* pixels = GetPackedPixels(frame, packedPixels);
+        const size_t imageSize = static_cast<size_t>(frame.width) * 4 * frame.height;
+
+        encoder.SetPixelData(
+            BitmapPixelFormat::Bgra8,
+            BitmapAlphaMode::Ignore,
+            frame.width,
+            frame.height,
+            96.0,
+            96.0,
+            winrt::array_view<uint8_t const>(pixels, pixels + imageSize)
+        );
+
+        encoder.FlushAsync().get();
+    }
+
+    // Helper function to check whether a format is encoded through WIC
+    bool IsWicFormat(ImageFormat format)
+    {
+        return format == ImageFormat::Png || format == ImageFormat::Jpeg;
+    }
+
+    // Helper function to check whether a format is encoded into a byte buffer without WIC
+    bool IsBuiltInFormat(ImageFormat format, const EncodeOptions& options)
+    {
+        if (format == ImageFormat::Png)
+        {
+            return options.parallelPng && !options.pngInterlace;
+        }
+        return !IsWicFormat(format);
+    }
+
+    // Helper function to encode a frame with one of the encoders that write into a byte buffer
+    void EncodeBuiltIn(const RawFrame& frame, ImageFormat format, const EncodeOptions& options, std::vector<uint8_t>& outputBuffer)
+    {
+        switch (format)
+        {
+        case ImageFormat::Png:
+            EncodePngParallel(frame, options.pngFilter, outputBuffer);
+            break;
+        case ImageFormat::Jxr:
+            EncodeJxr(frame, outputBuffer);
+            break;
+        case ImageFormat::Bmp:
+            EncodeBmp(frame, outputBuffer);
+            break;
+        case ImageFormat::Qoi:
+            EncodeQoi(frame, outputBuffer);
+            break;
+        case ImageFormat::Raw:
+        default:
+            EncodeRaw(frame, outputBuffer);
+            break;
+        }
+    }
+
+    // Helper function to reject frames the encoder cannot read
+    // Every encoder reads BGRA; half floats can only be written as JPEG XR or raw rows
+    void CheckFrameFormat(const RawFrame& frame, ImageFormat format)
+    {
+        if (frame.format == PixelFormat::Bgra)
+        {
+            return;
+        }
+        if (frame.format == PixelFormat::Rgba16Float && (format == ImageFormat::Jxr || format == ImageFormat::Raw))
+        {
+            return;
+        }
+        throw winrt::hresult_error(E_INVALIDARG, L"Frames in this pixel format cannot be encoded to this image format");
+    }
+
+    void EncodeFrame(const RawFrame& frame, const EncodeOptions& options, std::vector<uint8_t>& outputBuffer)
+    {
+        const ImageFormat format = options.format == ImageFormat::Auto ? ImageFormat::Png : options.format;
+        CheckFrameFormat(frame, format);
+
+        StageTimer timer(CaptureStage::Encode);
+        if (IsBuiltInFormat(format, options))
+        {
+            EncodeBuiltIn(frame, format, options, outputBuffer);
+            return;
+        }
+
+        InMemoryRandomAccessStream stream;
+        EncodeWicToStream(frame, format, options, stream);
+
+        // Read stream into output buffer
+        auto reader = DataReader(stream.GetInputStreamAt(0));
+        auto bytesToRead = static_cast<uint32_t>(stream.Size());
+        reader.LoadAsync(bytesToRead).get();
+
+        outputBuffer.resize(bytesToRead);
+        reader.ReadBytes(winrt::array_view<uint8_t>(outputBuffer));
+    }
+
+    // Helper function to make sure an output directory exists
+    // Known directories are cached, so batch jobs writing thousands of files into the
+    // same directories only touch the file system once per directory
+    void EnsureDirectory(const std::filesystem::path& directory, bool recheck)
+    {
+        static std::mutex mutex;
+        static std::unordered_set<std::wstring> knownDirectories;
+
+        const auto key = directory.wstring();
+        if (!recheck)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (knownDirectories.count(key))
+            {
+                return;
+            }
+        }
+
+        // Does nothing if the directory is already there
+        std::filesystem::create_directories(directory);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        knownDirectories.insert(key);
+    }
+
+    // Helper function to check whether opening a file failed because its directory is missing
+    bool IsMissingDirectory(HRESULT hr)
+    {
+        return hr == HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND);
+    }
+
+    // Helper function to write an encoded buffer to a file in one sequential pass
+    void WriteEncodedFile(const std::filesystem::path& filePath, const std::vector<uint8_t>& encoded)
+    {
+        auto open = [&]
+        {
+            return file_handle(CreateFileW(filePath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+        };
+
+        auto file = open();
+        if (!file && IsMissingDirectory(HRESULT_FROM_WIN32(GetLastError())))
+        {
+            // The cached directory was removed since; create it again
+            EnsureDirectory(filePath.parent_path(), true);
+            file = open();
+        }
+        if (!file)
+        {
+            throw_last_error();
+        }
+
+        // WriteFile takes at most 4 GB per call
+        try
+        {
+            size_t written = 0;
+            while (written < encoded.size())
+            {
+                DWORD chunk = static_cast<DWORD>((std::min)(encoded.size() - written, static_cast<size_t>(1) << 30));
+                DWORD chunkWritten = 0;
+                check_bool(WriteFile(file.get(), encoded.data() + written, chunk, &chunkWritten, nullptr));
+                if (chunkWritten == 0)
+                {
+                    throw hresult_error(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), L"File write made no progress");
+                }
+                written += chunkWritten;
+            }
+        }
+        catch (...)
+        {
+            // Do not leave a truncated image behind, like the WIC path
+            file.close();
+            DeleteFileW(filePath.c_str());
+            throw;
+        }
+    }
+
+    // Helper function to open a Win32 file stream that encoders write into directly
+    com_ptr<IStream> CreateFileStream(const std::filesystem::path& filePath)
+    {
+        auto open = [&](com_ptr<IStream>& stream)
+        {
+            return SHCreateStreamOnFileEx(filePath.c_str(), STGM_CREATE | STGM_READWRITE | STGM_SHARE_EXCLUSIVE, FILE_ATTRIBUTE_NORMAL, TRUE, nullptr, stream.put());
+        };
+
+        com_ptr<IStream> stream;
+        HRESULT hr = open(stream);
+        if (IsMissingDirectory(hr))
+        {
+            EnsureDirectory(filePath.parent_path(), true);
+            hr = open(stream);
+        }
+        check_hresult(hr);
+        return stream;
+    }
+
+    void SaveFrameToFile(const RawFrame& frame, const std::wstring& outputPath, const EncodeOptions& options)
+    {
+        const ImageFormat format = ResolveImageFormat(options.format, outputPath);
+        CheckFrameFormat(frame, format);
+
+        // If no parent path specified, use current directory
+        std::filesystem::path filePath(outputPath);
+        if (!filePath.has_parent_path())
+        {
+            filePath = std::filesystem::current_path() / filePath;
+        }
+        EnsureDirectory(filePath.parent_path(), false);
+
+        if (IsBuiltInFormat(format, options) && format != ImageFormat::Jxr)
+        {
+            std::vector<uint8_t> encoded;
+            {
+                StageTimer timer(CaptureStage::Encode);
+                EncodeBuiltIn(frame, format, options, encoded);
+            }
+
+            StageTimer timer(CaptureStage::FileWrite);
+            WriteEncodedFile(filePath, encoded);
+            return;
+        }
+
+        // WIC encoders write straight into the file, without an in-memory copy, so
+        // their writes count as encoding; the open and final commit are one FileWrite sample
+        try
+        {
+            int64_t writeStart = QueryCaptureTicks();
+            auto stream = CreateFileStream(filePath);
+            int64_t writeTicks = QueryCaptureTicks() - writeStart;
+
+            {
+                StageTimer timer(CaptureStage::Encode);
+                if (format == ImageFormat::Jxr)
+                {
+                    EncodeJxrToStream(frame, stream.get());
+                }
+                else
+                {
+                    IRandomAccessStream randomAccessStream{ nullptr };
+                    check_hresult(CreateRandomAccessStreamOverStream(stream.get(), BSOS_DEFAULT, guid_of<IRandomAccessStream>(), put_abi(randomAccessStream)));
+                    EncodeWicToStream(frame, format, options, randomAccessStream);
+                    randomAccessStream.Close();
+                }
+            }
+
+            writeStart = QueryCaptureTicks();
+            check_hresult(stream->Commit(STGC_DEFAULT));
+            RecordCaptureStage(CaptureStage::FileWrite, writeTicks + QueryCaptureTicks() - writeStart);
+        }
+        catch (...)
+        {
+            // Do not leave a truncated image behind
+            DeleteFileW(filePath.c_str());
+            throw;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+
+namespace ScreenCaptureCore
+{
+    // Copy image rows between buffers with different strides
+    void CopyRows(uint8_t* destination, size_t destinationStride, const uint8_t* source, size_t sourceStride, size_t rowBytes, uint32_t rowCount);
+
+    // Check encoder tuning values (e.g. JPEG quality range)
+    bool IsValidEncodeOptions(const EncodeOptions& options);
+
+    // Resolve ImageFormat::Auto from the output file extension (PNG when unknown or empty)
+    ImageFormat ResolveImageFormat(ImageFormat format, const std::wstring& outputPath);
+
+    // Encode a raw BGRA frame in memory (Auto means PNG; converted frames are rejected,
+    // except half floats for JPEG XR and raw output)
+    // Throws winrt::hresult_error on failure
+    void EncodeFrame(const RawFrame& frame, const EncodeOptions& options, std::vector<uint8_t>& outputBuffer);
+
+    // Encode a raw BGRA (or half-float, see EncodeFrame) frame to a file, creating the parent directory if needed
+    // Encoders write through a Win32 file stream; directories found once are not checked again
+    // Throws winrt::hresult_error or std::filesystem::filesystem_error on failure
+    void SaveFrameToFile(const RawFrame& frame, const std::wstring& outputPath, const EncodeOptions& options);
+}
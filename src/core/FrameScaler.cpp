@@ -0,0 +1,250 @@
+#include "FrameScaler.h"
+#include "../../pch.h"
+#include <d3dcompiler.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    // Box-filter downscale: each output pixel averages the source pixels it covers
+    // Typed UAV stores to BGRA are optional, so the output is an RGBA texture whose
+    // channels are written swizzled; its bytes are BGRA like every other frame
+    // Sources that already hold BGRA bytes in an RGBA texture (tone-mapped frames)
+    // are written unswizzled
+    constexpr char ScaleShaderSource[] = R"(
+Texture2D<float4> Source : register(t0);
+RWTexture2D<float4> Destination : register(u0);
+
+cbuffer Constants : register(b0)
+{
+    uint2 SourceSize;
+    uint2 DestinationSize;
+    uint Swizzle;
+    uint3 Padding;
+};
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    if (id.x >= DestinationSize.x || id.y >= DestinationSize.y)
+    {
+        return;
+    }
+
+    uint2 start = id.xy * SourceSize / DestinationSize;
+    uint2 end = max((id.xy + 1) * SourceSize / DestinationSize, start + 1);
+
+    float4 sum = 0;
+    for (uint y = start.y; y < end.y; ++y)
+    {
+        for (uint x = start.x; x < end.x; ++x)
+        {
+            sum += Source[uint2(x, y)];
+        }
+    }
+
+    float4 color = sum / ((end.x - start.x) * (end.y - start.y));
+    Destination[id.xy] = Swizzle ? color.bgra : color;
+}
+)";
+
+    struct ScaleConstants
+    {
+        uint32_t sourceWidth;
+        uint32_t sourceHeight;
+        uint32_t destinationWidth;
+        uint32_t destinationHeight;
+        uint32_t swizzle;
+        uint32_t padding[3];
+    };
+
+    bool IsValidCaptureRegion(const CaptureRegion& region)
+    {
+        return region.scale > 0.0f && region.scale <= 1.0f;
+    }
+
+    bool IsFullFrameRegion(const CaptureRegion& region)
+    {
+        return region.x == 0 && region.y == 0 && region.width == 0 && region.height == 0 && region.scale == 1.0f;
+    }
+
+    bool ResolveCaptureRegion(const CaptureRegion& region, uint32_t frameWidth, uint32_t frameHeight, D3D11_BOX& box, uint32_t& outputWidth, uint32_t& outputHeight)
+    {
+        const int64_t right = region.width ? static_cast<int64_t>(region.x) + region.width : frameWidth;
+        const int64_t bottom = region.height ? static_cast<int64_t>(region.y) + region.height : frameHeight;
+
+        box.left = static_cast<UINT>(std::clamp<int64_t>(region.x, 0, frameWidth));
+        box.top = static_cast<UINT>(std::clamp<int64_t>(region.y, 0, frameHeight));
+        box.right = static_cast<UINT>(std::clamp<int64_t>(right, 0, frameWidth));
+        box.bottom = static_cast<UINT>(std::clamp<int64_t>(bottom, 0, frameHeight));
+        box.front = 0;
+        box.back = 1;
+
+        if (box.right <= box.left || box.bottom <= box.top)
+        {
+            return false;
+        }
+
+        outputWidth = std::max(1u, static_cast<uint32_t>(std::lround((box.right - box.left) * region.scale)));
+        outputHeight = std::max(1u, static_cast<uint32_t>(std::lround((box.bottom - box.top) * region.scale)));
+        return true;
+    }
+
+    ID3D11Texture2D* FrameScaler::Process(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* source, const CaptureRegion& region, D3D11_BOX& box)
+    {
+        D3D11_TEXTURE2D_DESC sourceDesc;
+        source->GetDesc(&sourceDesc);
+
+        uint32_t outputWidth = 0;
+        uint32_t outputHeight = 0;
+        if (!ResolveCaptureRegion(region, sourceDesc.Width, sourceDesc.Height, box, outputWidth, outputHeight))
+        {
+            throw hresult_error(E_INVALIDARG, L"Capture region is outside the frame");
+        }
+
+        const uint32_t cropWidth = box.right - box.left;
+        const uint32_t cropHeight = box.bottom - box.top;
+        if (outputWidth == cropWidth && outputHeight == cropHeight)
+        {
+            // Crop only: the caller copies the box straight into staging
+            return source;
+        }
+
+        EnsureDevice(device);
+        EnsureCropTexture(cropWidth, cropHeight, sourceDesc.Format);
+        EnsureOutputTexture(outputWidth, outputHeight);
+
+        context->CopySubresourceRegion(m_cropTexture.get(), 0, 0, 0, 0, source, 0, &box);
+
+        const uint32_t swizzle = sourceDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM ? 0 : 1;
+        ScaleConstants constants = { cropWidth, cropHeight, outputWidth, outputHeight, swizzle, {} };
+        context->UpdateSubresource(m_constants.get(), 0, nullptr, &constants, 0, 0);
+
+        ID3D11ShaderResourceView* views[] = { m_cropView.get() };
+        ID3D11UnorderedAccessView* outputs[] = { m_outputView.get() };
+        ID3D11Buffer* buffers[] = { m_constants.get() };
+        context->CSSetShader(m_shader.get(), nullptr, 0);
+        context->CSSetShaderResources(0, 1, views);
+        context->CSSetUnorderedAccessViews(0, 1, outputs, nullptr);
+        context->CSSetConstantBuffers(0, 1, buffers);
+        context->Dispatch((outputWidth + 7) / 8, (outputHeight + 7) / 8, 1);
+
+        // Unbind so the textures can be copied and recreated freely
+        ID3D11ShaderResourceView* nullViews[] = { nullptr };
+        ID3D11UnorderedAccessView* nullOutputs[] = { nullptr };
+        context->CSSetShaderResources(0, 1, nullViews);
+        context->CSSetUnorderedAccessViews(0, 1, nullOutputs, nullptr);
+        context->CSSetShader(nullptr, nullptr, 0);
+
+        box = { 0, 0, 0, outputWidth, outputHeight, 1 };
+        return m_outputTexture.get();
+    }
+
+    void FrameScaler::Reset()
+    {
+        m_outputView = nullptr;
+        m_outputTexture = nullptr;
+        m_outputDesc = {};
+        m_cropView = nullptr;
+        m_cropTexture = nullptr;
+        m_cropDesc = {};
+        m_constants = nullptr;
+        m_shader = nullptr;
+        m_device = nullptr;
+    }
+
+    void FrameScaler::EnsureDevice(ID3D11Device* device)
+    {
+        if (m_device.get() == device && m_shader)
+        {
+            return;
+        }
+
+        Reset();
+
+        if (device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0)
+        {
+            throw hresult_error(DXGI_ERROR_UNSUPPORTED, L"GPU scaling requires Direct3D feature level 11.0");
+        }
+
+        com_ptr<ID3DBlob> shaderBlob;
+        com_ptr<ID3DBlob> errorBlob;
+        HRESULT hr = D3DCompile(
+            ScaleShaderSource,
+            sizeof(ScaleShaderSource) - 1,
+            "FrameScaler",
+            nullptr,
+            nullptr,
+            "main",
+            "cs_5_0",
+            D3DCOMPILE_OPTIMIZATION_LEVEL3,
+            0,
+            shaderBlob.put(),
+            errorBlob.put()
+        );
+        if (FAILED(hr))
+        {
+            throw hresult_error(hr, L"Failed to compile scaling shader");
+        }
+
+        check_hresult(device->CreateComputeShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, m_shader.put()));
+
+        D3D11_BUFFER_DESC bufferDesc = {};
+        bufferDesc.ByteWidth = sizeof(ScaleConstants);
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        check_hresult(device->CreateBuffer(&bufferDesc, nullptr, m_constants.put()));
+
+        m_device.copy_from(device);
+    }
+
+    void FrameScaler::EnsureCropTexture(uint32_t width, uint32_t height, DXGI_FORMAT format)
+    {
+        if (m_cropTexture && m_cropDesc.Width == width && m_cropDesc.Height == height && m_cropDesc.Format == format)
+        {
+            return;
+        }
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = format;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        m_cropView = nullptr;
+        m_cropTexture = nullptr;
+        check_hresult(m_device->CreateTexture2D(&desc, nullptr, m_cropTexture.put()));
+        check_hresult(m_device->CreateShaderResourceView(m_cropTexture.get(), nullptr, m_cropView.put()));
+        m_cropDesc = desc;
+    }
+
+    void FrameScaler::EnsureOutputTexture(uint32_t width, uint32_t height)
+    {
+        if (m_outputTexture && m_outputDesc.Width == width && m_outputDesc.Height == height)
+        {
+            return;
+        }
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
+
+        m_outputView = nullptr;
+        m_outputTexture = nullptr;
+        check_hresult(m_device->CreateTexture2D(&desc, nullptr, m_outputTexture.put()));
+        check_hresult(m_device->CreateUnorderedAccessView(m_outputTexture.get(), nullptr, m_outputView.put()));
+        m_outputDesc = desc;
+    }
+}
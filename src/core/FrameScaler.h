@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <d3d11.h>
+#include <winrt/base.h>
+
+namespace ScreenCaptureCore
+{
+    // Check region values (scale range)
+    bool IsValidCaptureRegion(const CaptureRegion& region);
+
+    // Whether a region reads back the whole frame unscaled
+    bool IsFullFrameRegion(const CaptureRegion& region);
+
+    // Clip a region to the frame and compute the output size
+    // Returns false if nothing of the region is inside the frame
+    bool ResolveCaptureRegion(const CaptureRegion& region, uint32_t frameWidth, uint32_t frameHeight, D3D11_BOX& box, uint32_t& outputWidth, uint32_t& outputHeight);
+
+    // Crops and downscales capture textures on the GPU so that only the
+    // requested pixels are copied to staging and read back
+    // Cropping is a CopySubresourceRegion box; scaling is a box-filter compute pass
+    class FrameScaler
+    {
+    public:
+        // Prepare region of source for readback
+        // Returns the texture to copy from and sets box to the part to copy
+        // (source itself when no scaling is needed)
+        // Throws winrt::hresult_error on failure or when the region is outside the frame
+        ID3D11Texture2D* Process(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* source, const CaptureRegion& region, D3D11_BOX& box);
+
+        // Release all GPU resources
+        void Reset();
+
+    private:
+        winrt::com_ptr<ID3D11Device> m_device;
+        winrt::com_ptr<ID3D11ComputeShader> m_shader;
+        winrt::com_ptr<ID3D11Buffer> m_constants;
+
+        // Cropped source pixels, readable by the shader
+        winrt::com_ptr<ID3D11Texture2D> m_cropTexture;
+        winrt::com_ptr<ID3D11ShaderResourceView> m_cropView;
+        D3D11_TEXTURE2D_DESC m_cropDesc{};
+
+        // Scaled output (BGRA bytes in an RGBA texture, see the shader)
+        winrt::com_ptr<ID3D11Texture2D> m_outputTexture;
+        winrt::com_ptr<ID3D11UnorderedAccessView> m_outputView;
+        D3D11_TEXTURE2D_DESC m_outputDesc{};
+
+        void EnsureDevice(ID3D11Device* device);
+        void EnsureCropTexture(uint32_t width, uint32_t height, DXGI_FORMAT format);
+        void EnsureOutputTexture(uint32_t width, uint32_t height);
+    };
+}
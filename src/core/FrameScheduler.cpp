@@ -0,0 +1,155 @@
+#include "FrameScheduler.h"
+#include "../../pch.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ScreenCaptureCore
+{
+    // 100 ns units per millisecond and per second
+    constexpr int64_t IntervalUnitsPerMs = 10000;
+    constexpr int64_t IntervalUnitsPerSecond = 10000000;
+
+    // Frames arriving up to a quarter interval early still count as due, so a
+    // 30 fps cap on a 60 Hz display delivers every other frame despite jitter
+    constexpr int64_t DueToleranceDivisor = 4;
+
+    // Callback averages weigh the newest duration by 1/8
+    constexpr double CallbackAverageWeight = 0.125;
+
+    void FrameScheduler::Reset(const StreamOptions& options)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        int64_t interval = static_cast<int64_t>(options.minUpdateIntervalMs) * IntervalUnitsPerMs;
+        if (options.targetFps > 0.0f)
+        {
+            interval = (std::max)(interval, static_cast<int64_t>(std::llround(IntervalUnitsPerSecond / static_cast<double>(options.targetFps))));
+        }
+
+        m_baseInterval = (std::min)(interval, MaxInterval);
+        m_backoffInterval = 0;
+        m_nextDue = 0;
+        m_reportedInterval = -1;
+        m_adaptive = options.adaptiveRate;
+        m_callbackAverage = 0.0;
+        m_stats = StreamStats();
+    }
+
+    int64_t FrameScheduler::EffectiveInterval() const
+    {
+        return (std::max)(m_baseInterval, m_backoffInterval);
+    }
+
+    bool FrameScheduler::ShouldDeliver(int64_t timestamp)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const int64_t interval = EffectiveInterval();
+        if (interval == 0)
+        {
+            return true;
+        }
+
+        if (m_nextDue != 0 && timestamp < m_nextDue - interval / DueToleranceDivisor)
+        {
+            ++m_stats.framesSkipped;
+            return false;
+        }
+
+        // Stay on the interval grid, but start over after a pause instead of catching up
+        if (m_nextDue == 0 || timestamp - m_nextDue > interval)
+        {
+            m_nextDue = timestamp + interval;
+        }
+        else
+        {
+            m_nextDue += interval;
+        }
+        return true;
+    }
+
+    void FrameScheduler::RecordDelivered(int64_t timestamp, int64_t start, int64_t end)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        ++m_stats.framesDelivered;
+
+        const int64_t interval = EffectiveInterval();
+        if (start - timestamp > (interval ? interval : DefaultLateThreshold))
+        {
+            ++m_stats.framesLate;
+        }
+
+        const double duration = static_cast<double>((std::max)(end - start, static_cast<int64_t>(0)));
+        m_callbackAverage = m_stats.framesDelivered == 1 ? duration : m_callbackAverage + (duration - m_callbackAverage) * CallbackAverageWeight;
+
+        if (!m_adaptive)
+        {
+            return;
+        }
+
+        // Back off while callbacks need most of the interval; uncapped streams get one 60 Hz refresh
+        const double budget = static_cast<double>(interval ? interval : DefaultLateThreshold / 2);
+        if (m_callbackAverage > budget * 0.9)
+        {
+            m_backoffInterval = (std::min)(static_cast<int64_t>(m_callbackAverage * 1.25), MaxInterval);
+        }
+        else if (m_backoffInterval != 0 && m_callbackAverage < budget * 0.5)
+        {
+            // Recover gradually, back to the requested rate
+            m_backoffInterval = m_backoffInterval * 4 / 5;
+            if (m_backoffInterval <= m_baseInterval)
+            {
+                m_backoffInterval = 0;
+            }
+        }
+    }
+
+    void FrameScheduler::RecordDropped(uint64_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.framesDropped += count;
+    }
+
+    bool FrameScheduler::TakeIntervalChange(int64_t& interval)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        interval = EffectiveInterval();
+        if (interval == m_reportedInterval)
+        {
+            return false;
+        }
+        m_reportedInterval = interval;
+        return true;
+    }
+
+    StreamStats FrameScheduler::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        StreamStats stats = m_stats;
+        const int64_t interval = EffectiveInterval();
+        stats.currentFps = interval ? static_cast<double>(IntervalUnitsPerSecond) / static_cast<double>(interval) : 0.0;
+        stats.callbackMs = m_callbackAverage / IntervalUnitsPerMs;
+        return stats;
+    }
+
+    int64_t FrameScheduler::Now()
+    {
+        static const int64_t frequency = []
+        {
+            LARGE_INTEGER value;
+            QueryPerformanceFrequency(&value);
+            return value.QuadPart;
+        }();
+
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+
+        // Split the conversion so large counter values do not overflow
+        const int64_t seconds = counter.QuadPart / frequency;
+        const int64_t remainder = counter.QuadPart % frequency;
+        return seconds * IntervalUnitsPerSecond + remainder * IntervalUnitsPerSecond / frequency;
+    }
+}
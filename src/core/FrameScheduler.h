@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <mutex>
+
+// GraphicsCaptureSession::MinUpdateInterval needs the Windows 11 24H2 SDK (10.0.26100)
+#if defined(NTDDI_WIN11_GE) && defined(WDK_NTDDI_VERSION) && WDK_NTDDI_VERSION >= NTDDI_WIN11_GE
+#define SCREENCAPTURE_HAS_MIN_UPDATE_INTERVAL 1
+#endif
+
+namespace ScreenCaptureCore
+{
+    // Paces stream delivery: caps the rate at StreamOptions::targetFps (or
+    // minUpdateIntervalMs) and, with adaptiveRate, stretches the interval while
+    // callbacks take longer than it, recovering once they speed up again
+    // Times are SystemRelativeTime values (QueryPerformanceCounter in 100 ns units),
+    // the clock of Direct3D11CaptureFrame timestamps
+    // All members are thread-safe
+    class FrameScheduler
+    {
+    public:
+        // Longest interval backoff goes to (1 fps)
+        static constexpr int64_t MaxInterval = 10000000;
+
+        // Late threshold of uncapped streams: two 60 Hz refreshes
+        static constexpr int64_t DefaultLateThreshold = 333333;
+
+        // Start a new stream with fresh counters
+        void Reset(const StreamOptions& options);
+
+        // Whether a frame captured at timestamp is due; frames that are not are counted as
+        // skipped and should not be copied for readback
+        bool ShouldDeliver(int64_t timestamp);
+
+        // Record a callback that started at start and ended at end for a frame captured at timestamp
+        void RecordDelivered(int64_t timestamp, int64_t start, int64_t end);
+
+        // Count frames that were copied but replaced before the callback took them
+        void RecordDropped(uint64_t count);
+
+        // Interval to pass to GraphicsCaptureSession::MinUpdateInterval, once per change
+        // Returns false if it did not change since the last call
+        bool TakeIntervalChange(int64_t& interval);
+
+        StreamStats GetStats() const;
+
+        // Current time on the frame timestamp clock
+        static int64_t Now();
+
+    private:
+        mutable std::mutex m_mutex;
+        int64_t m_baseInterval = 0;     // From targetFps and minUpdateIntervalMs (0 = uncapped)
+        int64_t m_backoffInterval = 0;  // Raised interval while the consumer is behind (0 = none)
+        int64_t m_nextDue = 0;
+        int64_t m_reportedInterval = -1;
+        bool m_adaptive = true;
+        double m_callbackAverage = 0.0; // Moving average of callback durations
+        StreamStats m_stats;
+
+        int64_t EffectiveInterval() const;
+    };
+}
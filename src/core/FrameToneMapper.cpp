@@ -0,0 +1,225 @@
+#include "FrameToneMapper.h"
+#include "../../pch.h"
+#include <d3dcompiler.h>
+#include <vector>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    // scRGB is linear Rec.709 with 1.0 at 80 nits; dividing by the SDR white scale
+    // puts SDR white at 1.0. Luminance above the knee is compressed exponentially so
+    // brighter HDR highlights approach white, then the result is sRGB-encoded.
+    // The output is written swizzled into an RGBA texture, as in FrameScaler
+    constexpr char ToneMapShaderSource[] = R"(
+Texture2D<float4> Source : register(t0);
+RWTexture2D<float4> Destination : register(u0);
+
+cbuffer Constants : register(b0)
+{
+    uint2 Size;
+    float WhiteScale;
+    float Padding;
+};
+
+static const float Knee = 0.8;
+
+float3 LinearToSrgb(float3 c)
+{
+    return c <= 0.0031308 ? c * 12.92 : 1.055 * pow(c, 1.0 / 2.4) - 0.055;
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    if (id.x >= Size.x || id.y >= Size.y)
+    {
+        return;
+    }
+
+    float3 color = max(Source[id.xy].rgb / WhiteScale, 0.0);
+    float luminance = dot(color, float3(0.2126, 0.7152, 0.0722));
+    if (luminance > Knee)
+    {
+        float mapped = Knee + (1.0 - Knee) * (1.0 - exp(-(luminance - Knee) / (1.0 - Knee)));
+        color *= mapped / luminance;
+    }
+
+    Destination[id.xy] = float4(LinearToSrgb(saturate(color)), 1.0).bgra;
+}
+)";
+
+    struct ToneMapConstants
+    {
+        uint32_t width;
+        uint32_t height;
+        float whiteScale;
+        float padding;
+    };
+
+    float GetSdrWhiteScale(HMONITOR monitor)
+    {
+        MONITORINFOEXW monitorInfo = {};
+        monitorInfo.cbSize = sizeof(monitorInfo);
+        if (!monitor || !GetMonitorInfoW(monitor, &monitorInfo))
+        {
+            return 1.0f;
+        }
+
+        UINT32 pathCount = 0;
+        UINT32 modeCount = 0;
+        if (GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &pathCount, &modeCount) != ERROR_SUCCESS)
+        {
+            return 1.0f;
+        }
+
+        std::vector<DISPLAYCONFIG_PATH_INFO> paths(pathCount);
+        std::vector<DISPLAYCONFIG_MODE_INFO> modes(modeCount);
+        if (QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &pathCount, paths.data(), &modeCount, modes.data(), nullptr) != ERROR_SUCCESS)
+        {
+            return 1.0f;
+        }
+
+        // Find the path whose source is the monitor's GDI device, then ask its target
+        for (UINT32 i = 0; i < pathCount; ++i)
+        {
+            DISPLAYCONFIG_SOURCE_DEVICE_NAME sourceName = {};
+            sourceName.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME;
+            sourceName.header.size = sizeof(sourceName);
+            sourceName.header.adapterId = paths[i].sourceInfo.adapterId;
+            sourceName.header.id = paths[i].sourceInfo.id;
+            if (DisplayConfigGetDeviceInfo(&sourceName.header) != ERROR_SUCCESS ||
+                wcscmp(sourceName.viewGdiDeviceName, monitorInfo.szDevice) != 0)
+            {
+                continue;
+            }
+
+            DISPLAYCONFIG_SDR_WHITE_LEVEL whiteLevel = {};
+            whiteLevel.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SDR_WHITE_LEVEL;
+            whiteLevel.header.size = sizeof(whiteLevel);
+            whiteLevel.header.adapterId = paths[i].targetInfo.adapterId;
+            whiteLevel.header.id = paths[i].targetInfo.id;
+            if (DisplayConfigGetDeviceInfo(&whiteLevel.header) != ERROR_SUCCESS || whiteLevel.SDRWhiteLevel == 0)
+            {
+                return 1.0f;
+            }
+
+            // SDRWhiteLevel is in units of 80 nits / 1000
+            return static_cast<float>(whiteLevel.SDRWhiteLevel) / 1000.0f;
+        }
+
+        return 1.0f;
+    }
+
+    ID3D11Texture2D* FrameToneMapper::Process(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* source, float whiteScale)
+    {
+        D3D11_TEXTURE2D_DESC sourceDesc;
+        source->GetDesc(&sourceDesc);
+
+        EnsureDevice(device);
+        EnsureOutputTexture(sourceDesc.Width, sourceDesc.Height);
+
+        com_ptr<ID3D11ShaderResourceView> view;
+        check_hresult(device->CreateShaderResourceView(source, nullptr, view.put()));
+
+        ToneMapConstants constants = { sourceDesc.Width, sourceDesc.Height, whiteScale > 0.0f ? whiteScale : 1.0f, 0.0f };
+        context->UpdateSubresource(m_constants.get(), 0, nullptr, &constants, 0, 0);
+
+        ID3D11ShaderResourceView* views[] = { view.get() };
+        ID3D11UnorderedAccessView* outputs[] = { m_outputView.get() };
+        ID3D11Buffer* buffers[] = { m_constants.get() };
+        context->CSSetShader(m_shader.get(), nullptr, 0);
+        context->CSSetShaderResources(0, 1, views);
+        context->CSSetUnorderedAccessViews(0, 1, outputs, nullptr);
+        context->CSSetConstantBuffers(0, 1, buffers);
+        context->Dispatch((sourceDesc.Width + 7) / 8, (sourceDesc.Height + 7) / 8, 1);
+
+        // Unbind so the output can be copied, scaled and hashed
+        ID3D11ShaderResourceView* nullViews[] = { nullptr };
+        ID3D11UnorderedAccessView* nullOutputs[] = { nullptr };
+        context->CSSetShaderResources(0, 1, nullViews);
+        context->CSSetUnorderedAccessViews(0, 1, nullOutputs, nullptr);
+        context->CSSetShader(nullptr, nullptr, 0);
+
+        return m_outputTexture.get();
+    }
+
+    void FrameToneMapper::Reset()
+    {
+        m_outputView = nullptr;
+        m_outputTexture = nullptr;
+        m_outputDesc = {};
+        m_constants = nullptr;
+        m_shader = nullptr;
+        m_device = nullptr;
+    }
+
+    void FrameToneMapper::EnsureDevice(ID3D11Device* device)
+    {
+        if (m_device.get() == device && m_shader)
+        {
+            return;
+        }
+
+        Reset();
+
+        if (device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0)
+        {
+            throw hresult_error(DXGI_ERROR_UNSUPPORTED, L"GPU tone mapping requires Direct3D feature level 11.0");
+        }
+
+        com_ptr<ID3DBlob> shaderBlob;
+        com_ptr<ID3DBlob> errorBlob;
+        HRESULT hr = D3DCompile(
+            ToneMapShaderSource,
+            sizeof(ToneMapShaderSource) - 1,
+            "FrameToneMapper",
+            nullptr,
+            nullptr,
+            "main",
+            "cs_5_0",
+            D3DCOMPILE_OPTIMIZATION_LEVEL3,
+            0,
+            shaderBlob.put(),
+            errorBlob.put()
+        );
+        if (FAILED(hr))
+        {
+            throw hresult_error(hr, L"Failed to compile tone mapping shader");
+        }
+
+        check_hresult(device->CreateComputeShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, m_shader.put()));
+
+        D3D11_BUFFER_DESC bufferDesc = {};
+        bufferDesc.ByteWidth = sizeof(ToneMapConstants);
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        check_hresult(device->CreateBuffer(&bufferDesc, nullptr, m_constants.put()));
+
+        m_device.copy_from(device);
+    }
+
+    void FrameToneMapper::EnsureOutputTexture(uint32_t width, uint32_t height)
+    {
+        if (m_outputTexture && m_outputDesc.Width == width && m_outputDesc.Height == height)
+        {
+            return;
+        }
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
+
+        m_outputView = nullptr;
+        m_outputTexture = nullptr;
+        check_hresult(m_device->CreateTexture2D(&desc, nullptr, m_outputTexture.put()));
+        check_hresult(m_device->CreateUnorderedAccessView(m_outputTexture.get(), nullptr, m_outputView.put()));
+        m_outputDesc = desc;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <d3d11.h>
+#include <winrt/base.h>
+
+namespace ScreenCaptureCore
+{
+    // scRGB value of SDR white on a monitor (SDR white level / 80 nits)
+    // Returns 1.0 when the monitor is not in HDR mode or the level cannot be queried
+    float GetSdrWhiteScale(HMONITOR monitor);
+
+    // Converts scRGB half-float capture textures to 8-bit sRGB on the GPU
+    // SDR content keeps the brightness the desktop shows it at; HDR highlights
+    // above SDR white roll off towards white instead of clipping
+    class FrameToneMapper
+    {
+    public:
+        // Tone-map source (R16G16B16A16_FLOAT) with whiteScale as SDR white
+        // Returns a texture of the same size holding BGRA bytes, like FrameScaler output
+        // Throws winrt::hresult_error on failure
+        ID3D11Texture2D* Process(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* source, float whiteScale);
+
+        // Release all GPU resources
+        void Reset();
+
+    private:
+        winrt::com_ptr<ID3D11Device> m_device;
+        winrt::com_ptr<ID3D11ComputeShader> m_shader;
+        winrt::com_ptr<ID3D11Buffer> m_constants;
+
+        // 8-bit output (BGRA bytes in an RGBA texture)
+        winrt::com_ptr<ID3D11Texture2D> m_outputTexture;
+        winrt::com_ptr<ID3D11UnorderedAccessView> m_outputView;
+        D3D11_TEXTURE2D_DESC m_outputDesc{};
+
+        void EnsureDevice(ID3D11Device* device);
+        void EnsureOutputTexture(uint32_t width, uint32_t height);
+    };
+}
@@ -0,0 +1,1178 @@
+#include "ParallelPngEncoder.h"
+#include "PixelConverter.h"
+#include "../../pch.h"
+#include <emmintrin.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <queue>
+
+namespace ScreenCaptureCore
+{
+    // Implemented in FrameEncoder.cpp
+    uint8_t* WriteBigEndian32(uint8_t* output, uint32_t value);
+
+    // PNG output is 8-bit RGB
+    constexpr size_t PngBytesPerPixel = 3;
+
+    // Target size of one strip's filtered rows; smaller strips balance better but
+    // restart the deflate window more often
+    constexpr size_t PngStripBytes = 512 * 1024;
+
+    // Deflate parameters
+    constexpr size_t DeflateWindowSize = 32768;
+    constexpr size_t DeflateWindowMask = DeflateWindowSize - 1;
+    constexpr uint32_t DeflateHashBits = 15;
+    constexpr uint32_t DeflateMinMatch = 3;
+    constexpr uint32_t DeflateMaxMatch = 258;
+    constexpr uint32_t DeflateMaxChain = 16;        // Candidates tried per position
+    constexpr uint32_t DeflateNiceMatch = 128;      // Stop searching at a match this long
+    constexpr size_t DeflateBlockSymbols = 32768;   // Symbols per Huffman block
+    constexpr uint32_t DeflateMaxCodeLength = 15;
+    constexpr uint32_t DeflateMaxCodeLengthCodeLength = 7;
+    constexpr size_t DeflateLitLenCodes = 286;
+    constexpr size_t DeflateDistanceCodes = 30;
+    constexpr size_t DeflateCodeLengthCodes = 19;
+    constexpr size_t DeflateMaxStoredBlock = 65535;
+
+    // PNG filter types as written in front of each row
+    enum class RowFilter : uint8_t
+    {
+        None = 0,
+        Sub = 1,
+        Up = 2,
+        Average = 3,
+        Paeth = 4
+    };
+
+    // Parallel-for over strips on a process-wide pool
+    // The calling thread claims strips as well, so nested or concurrent encodes (e.g.
+    // from EncodePipeline workers) always make progress even when every pool thread is busy
+    class StripWorkers
+    {
+    public:
+        static StripWorkers& Instance()
+        {
+            // Leaked so no pool thread is joined under the loader lock at DLL unload
+            static StripWorkers* workers = new StripWorkers();
+            return *workers;
+        }
+
+        size_t ThreadCount() const
+        {
+            return m_threads.size() + 1;
+        }
+
+        // Run task(0) ... task(count - 1) and wait for all; rethrows the first exception
+        void Run(size_t count, const std::function<void(size_t)>& task)
+        {
+            auto job = std::make_shared<Job>();
+            job->task = &task;
+            job->count = count;
+
+            if (count > 1 && !m_threads.empty())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_jobs.push_back(job);
+                }
+                m_jobAvailable.notify_all();
+            }
+
+            Work(*job);
+
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->finished.wait(lock, [&job] { return job->done == job->count; });
+            if (job->error)
+            {
+                std::rethrow_exception(job->error);
+            }
+        }
+
+    private:
+        struct Job
+        {
+            const std::function<void(size_t)>* task = nullptr;
+            size_t count = 0;
+            std::atomic<size_t> next{ 0 };
+
+            std::mutex mutex;
+            std::condition_variable finished;
+            size_t done = 0;
+            std::exception_ptr error;
+        };
+
+        std::mutex m_mutex;
+        std::condition_variable m_jobAvailable;
+        std::deque<std::shared_ptr<Job>> m_jobs;
+        std::vector<std::thread> m_threads;
+
+        StripWorkers()
+        {
+            const unsigned cores = (std::max)(1u, std::thread::hardware_concurrency());
+            for (unsigned i = 1; i < cores; ++i)
+            {
+                m_threads.emplace_back(&StripWorkers::ThreadLoop, this);
+            }
+        }
+
+        // Claim and run strips of a job until none are left
+        static void Work(Job& job)
+        {
+            while (true)
+            {
+                size_t index = job.next.fetch_add(1);
+                if (index >= job.count)
+                {
+                    return;
+                }
+
+                std::exception_ptr error;
+                try
+                {
+                    (*job.task)(index);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(job.mutex);
+                if (error && !job.error)
+                {
+                    job.error = error;
+                }
+                if (++job.done == job.count)
+                {
+                    job.finished.notify_all();
+                }
+            }
+        }
+
+        void ThreadLoop()
+        {
+            while (true)
+            {
+                std::shared_ptr<Job> job;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_jobAvailable.wait(lock, [this] { return !m_jobs.empty(); });
+                    job = m_jobs.front();
+
+                    // Retire jobs whose strips are all claimed; running ones finish on their own
+                    if (job->next.load() >= job->count)
+                    {
+                        m_jobs.pop_front();
+                        continue;
+                    }
+                }
+                Work(*job);
+            }
+        }
+    };
+
+    // CRC-32 of PNG chunks (polynomial 0xEDB88320)
+    struct PngCrcTable
+    {
+        std::array<uint32_t, 256> entries;
+
+        PngCrcTable()
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                entries[n] = c;
+            }
+        }
+    };
+
+    uint32_t PngCrc32(const uint8_t* data, size_t size)
+    {
+        static const PngCrcTable table;
+
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    // Adler-32 of the zlib stream, computed per strip and combined afterwards
+    constexpr uint32_t AdlerBase = 65521;
+
+    uint32_t Adler32(const uint8_t* data, size_t size)
+    {
+        // 5552 bytes is the most that can be summed before the 32-bit sums overflow
+        uint32_t a = 1;
+        uint32_t b = 0;
+        while (size > 0)
+        {
+            size_t chunk = (std::min)(size, static_cast<size_t>(5552));
+            size -= chunk;
+            for (size_t i = 0; i < chunk; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            data += chunk;
+            a %= AdlerBase;
+            b %= AdlerBase;
+        }
+        return (b << 16) | a;
+    }
+
+    // Checksum of A followed by B from the checksums of A and of B (B of length lengthB)
+    uint32_t CombineAdler32(uint32_t adlerA, uint32_t adlerB, size_t lengthB)
+    {
+        const uint32_t remainder = static_cast<uint32_t>(lengthB % AdlerBase);
+        uint32_t sum1 = adlerA & 0xFFFF;
+        uint32_t sum2 = static_cast<uint32_t>((static_cast<uint64_t>(remainder) * sum1) % AdlerBase);
+        sum1 += (adlerB & 0xFFFF) + AdlerBase - 1;
+        sum2 += (adlerA >> 16) + (adlerB >> 16) + AdlerBase - remainder;
+        if (sum1 >= AdlerBase) sum1 -= AdlerBase;
+        if (sum1 >= AdlerBase) sum1 -= AdlerBase;
+        if (sum2 >= (AdlerBase << 1)) sum2 -= (AdlerBase << 1);
+        if (sum2 >= AdlerBase) sum2 -= AdlerBase;
+        return (sum2 << 16) | sum1;
+    }
+
+    // Helper function to predict a byte with the Paeth filter
+    inline uint8_t PaethPredictor(int a, int b, int c)
+    {
+        const int pa = std::abs(b - c);
+        const int pb = std::abs(a - c);
+        const int pc = std::abs(a + b - 2 * c);
+        if (pa <= pb && pa <= pc)
+        {
+            return static_cast<uint8_t>(a);
+        }
+        return static_cast<uint8_t>(pb <= pc ? b : c);
+    }
+
+    // Helper function to filter bytes [begin, end) of a row one at a time
+    void FilterBytesScalar(RowFilter filter, const uint8_t* row, const uint8_t* previous, size_t begin, size_t end, uint8_t* output)
+    {
+        for (size_t x = begin; x < end; ++x)
+        {
+            const int a = x >= PngBytesPerPixel ? row[x - PngBytesPerPixel] : 0;
+            const int b = previous[x];
+            const int c = x >= PngBytesPerPixel ? previous[x - PngBytesPerPixel] : 0;
+
+            uint8_t predicted = 0;
+            switch (filter)
+            {
+            case RowFilter::Sub: predicted = static_cast<uint8_t>(a); break;
+            case RowFilter::Up: predicted = static_cast<uint8_t>(b); break;
+            case RowFilter::Average: predicted = static_cast<uint8_t>((a + b) >> 1); break;
+            case RowFilter::Paeth: predicted = PaethPredictor(a, b, c); break;
+            default: break;
+            }
+            output[x] = static_cast<uint8_t>(row[x] - predicted);
+        }
+    }
+
+    // Helper function to compute the Paeth prediction of 8 pixels bytes widened to 16 bits
+    inline __m128i PaethPredict16(__m128i a, __m128i b, __m128i c)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bc = _mm_sub_epi16(b, c);
+        const __m128i ac = _mm_sub_epi16(a, c);
+        const __m128i abc = _mm_add_epi16(bc, ac);
+        const __m128i pa = _mm_max_epi16(bc, _mm_sub_epi16(zero, bc));
+        const __m128i pb = _mm_max_epi16(ac, _mm_sub_epi16(zero, ac));
+        const __m128i pc = _mm_max_epi16(abc, _mm_sub_epi16(zero, abc));
+
+        const __m128i notA = _mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc));
+        const __m128i notB = _mm_cmpgt_epi16(pb, pc);
+        const __m128i bOrC = _mm_or_si128(_mm_andnot_si128(notB, b), _mm_and_si128(notB, c));
+        return _mm_or_si128(_mm_andnot_si128(notA, a), _mm_and_si128(notA, bOrC));
+    }
+
+    // Helper function to filter one row; row and previous hold rowBytes bytes,
+    // previous is all zeros for the first row of the image
+    // Filtering only reads unfiltered bytes, so 16 bytes are predicted at a time with SSE2
+    void FilterRow(RowFilter filter, const uint8_t* row, const uint8_t* previous, size_t rowBytes, uint8_t* output)
+    {
+        if (filter == RowFilter::None)
+        {
+            memcpy(output, row, rowBytes);
+            return;
+        }
+
+        // The first pixel has no left neighbour
+        const size_t head = (std::min)(rowBytes, PngBytesPerPixel);
+        FilterBytesScalar(filter, row, previous, 0, head, output);
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi8(1);
+        size_t x = head;
+        for (; x + 16 <= rowBytes; x += 16)
+        {
+            const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            const __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x - PngBytesPerPixel));
+            const __m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + x));
+
+            __m128i predicted;
+            switch (filter)
+            {
+            case RowFilter::Sub:
+                predicted = left;
+                break;
+            case RowFilter::Up:
+                predicted = up;
+                break;
+            case RowFilter::Average:
+                // _mm_avg_epu8 rounds up; PNG rounds down
+                predicted = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), one));
+                break;
+            default:
+            {
+                const __m128i upLeft = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + x - PngBytesPerPixel));
+                const __m128i low = PaethPredict16(_mm_unpacklo_epi8(left, zero), _mm_unpacklo_epi8(up, zero), _mm_unpacklo_epi8(upLeft, zero));
+                const __m128i high = PaethPredict16(_mm_unpackhi_epi8(left, zero), _mm_unpackhi_epi8(up, zero), _mm_unpackhi_epi8(upLeft, zero));
+                predicted = _mm_packus_epi16(low, high);
+                break;
+            }
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + x), _mm_sub_epi8(current, predicted));
+        }
+
+        FilterBytesScalar(filter, row, previous, x, rowBytes, output);
+    }
+
+    // Helper function to score a filtered row: sum of the bytes as signed magnitudes
+    uint64_t FilteredRowCost(const uint8_t* filtered, size_t rowBytes)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sums = zero;
+        size_t x = 0;
+        for (; x + 16 <= rowBytes; x += 16)
+        {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(filtered + x));
+            const __m128i magnitude = _mm_min_epu8(value, _mm_sub_epi8(zero, value));
+            sums = _mm_add_epi64(sums, _mm_sad_epu8(magnitude, zero));
+        }
+
+        uint64_t cost = static_cast<uint64_t>(_mm_cvtsi128_si32(sums)) + static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+        for (; x < rowBytes; ++x)
+        {
+            cost += (std::min)(filtered[x], static_cast<uint8_t>(256 - filtered[x]));
+        }
+        return cost;
+    }
+
+    // Helper function to write one filtered row (filter byte and data) for the chosen filter
+    void FilterRowWith(PngFilter filter, const uint8_t* row, const uint8_t* previous, size_t rowBytes, uint8_t* output, std::vector<uint8_t>& scratch)
+    {
+        RowFilter fixed = RowFilter::None;
+        switch (filter)
+        {
+        case PngFilter::None: fixed = RowFilter::None; break;
+        case PngFilter::Sub: fixed = RowFilter::Sub; break;
+        case PngFilter::Up: fixed = RowFilter::Up; break;
+        case PngFilter::Average: fixed = RowFilter::Average; break;
+        case PngFilter::Paeth: fixed = RowFilter::Paeth; break;
+        default:
+        {
+            // Try every filter and keep the one whose output looks most compressible
+            scratch.resize(rowBytes);
+            uint64_t bestCost = UINT64_MAX;
+            for (uint8_t type = 0; type <= static_cast<uint8_t>(RowFilter::Paeth); ++type)
+            {
+                uint8_t* candidate = bestCost == UINT64_MAX ? output + 1 : scratch.data();
+                FilterRow(static_cast<RowFilter>(type), row, previous, rowBytes, candidate);
+                uint64_t cost = FilteredRowCost(candidate, rowBytes);
+                if (cost < bestCost)
+                {
+                    if (candidate != output + 1)
+                    {
+                        memcpy(output + 1, candidate, rowBytes);
+                    }
+                    bestCost = cost;
+                    output[0] = type;
+                }
+            }
+            return;
+        }
+        }
+
+        output[0] = static_cast<uint8_t>(fixed);
+        FilterRow(fixed, row, previous, rowBytes, output + 1);
+    }
+
+    // Length and distance code tables of RFC 1951 section 3.2.5
+    struct DeflateTables
+    {
+        std::array<uint16_t, DeflateMaxMatch + 1> lengthCode{};     // Length -> code 257..285
+        std::array<uint8_t, 29> lengthExtraBits{};
+        std::array<uint16_t, 29> lengthBase{};
+        std::array<uint8_t, 30> distanceExtraBits{};
+        std::array<uint16_t, 30> distanceBase{};
+        std::array<uint8_t, 512> distanceCode{};    // (distance - 1) < 256 directly, else 256 + ((distance - 1) >> 7)
+
+        DeflateTables()
+        {
+            static constexpr uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+            static constexpr uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+            uint32_t base = 3;
+            for (size_t code = 0; code < 29; ++code)
+            {
+                lengthExtraBits[code] = lengthExtra[code];
+                lengthBase[code] = static_cast<uint16_t>(base);
+                for (uint32_t i = 0; i < (1u << lengthExtra[code]) && base + i <= DeflateMaxMatch; ++i)
+                {
+                    lengthCode[base + i] = static_cast<uint16_t>(257 + code);
+                }
+                base += 1u << lengthExtra[code];
+            }
+
+            // 258 has its own code without extra bits
+            lengthBase[28] = 258;
+            lengthCode[258] = 285;
+
+            base = 1;
+            for (size_t code = 0; code < 30; ++code)
+            {
+                distanceExtraBits[code] = distanceExtra[code];
+                distanceBase[code] = static_cast<uint16_t>(base);
+                for (uint32_t i = 0; i < (1u << distanceExtra[code]); ++i)
+                {
+                    const uint32_t distance = base + i - 1;
+                    if (distance < 256)
+                    {
+                        distanceCode[distance] = static_cast<uint8_t>(code);
+                    }
+                    else
+                    {
+                        distanceCode[256 + (distance >> 7)] = static_cast<uint8_t>(code);
+                    }
+                }
+                base += 1u << distanceExtra[code];
+            }
+        }
+
+        uint32_t DistanceCode(uint32_t distance) const
+        {
+            const uint32_t d = distance - 1;
+            return d < 256 ? distanceCode[d] : distanceCode[256 + (d >> 7)];
+        }
+
+        static const DeflateTables& Instance()
+        {
+            static const DeflateTables tables;
+            return tables;
+        }
+    };
+
+    // LSB-first bit writer for deflate data
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& output)
+            : m_output(output)
+        {
+        }
+
+        // count is at most 32
+        void Put(uint32_t bits, uint32_t count)
+        {
+            m_buffer |= static_cast<uint64_t>(bits) << m_count;
+            m_count += count;
+            if (m_count >= 32)
+            {
+                const size_t size = m_output.size();
+                m_output.resize(size + 4);
+                m_output[size] = static_cast<uint8_t>(m_buffer);
+                m_output[size + 1] = static_cast<uint8_t>(m_buffer >> 8);
+                m_output[size + 2] = static_cast<uint8_t>(m_buffer >> 16);
+                m_output[size + 3] = static_cast<uint8_t>(m_buffer >> 24);
+                m_buffer >>= 32;
+                m_count -= 32;
+            }
+        }
+
+        // Pad to a byte boundary
+        void Align()
+        {
+            while (m_count > 0)
+            {
+                m_output.push_back(static_cast<uint8_t>(m_buffer));
+                m_buffer >>= 8;
+                m_count = m_count > 8 ? m_count - 8 : 0;
+            }
+            m_buffer = 0;
+        }
+
+        void PutBytes(const uint8_t* data, size_t size)
+        {
+            m_output.insert(m_output.end(), data, data + size);
+        }
+
+    private:
+        std::vector<uint8_t>& m_output;
+        uint64_t m_buffer = 0;
+        uint32_t m_count = 0;
+    };
+
+    // Helper function to build length-limited Huffman code lengths for symbol frequencies
+    // Unused symbols get length 0; a lone used symbol gets a partner so the code is complete
+    void BuildCodeLengths(const uint32_t* frequencies, size_t symbolCount, uint32_t maxLength, uint8_t* lengths)
+    {
+        std::fill(lengths, lengths + symbolCount, static_cast<uint8_t>(0));
+
+        std::vector<uint32_t> used;
+        for (uint32_t symbol = 0; symbol < symbolCount; ++symbol)
+        {
+            if (frequencies[symbol])
+            {
+                used.push_back(symbol);
+            }
+        }
+
+        if (used.empty())
+        {
+            return;
+        }
+        if (used.size() == 1)
+        {
+            lengths[used[0]] = 1;
+            lengths[used[0] == 0 ? 1 : 0] = 1;
+            return;
+        }
+
+        // Plain Huffman tree: leaves are 0..n-1, internal nodes follow
+        const size_t leafCount = used.size();
+        std::vector<uint32_t> parent(2 * leafCount - 1, 0);
+        using Node = std::pair<uint64_t, uint32_t>;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+        for (uint32_t i = 0; i < leafCount; ++i)
+        {
+            queue.push({ frequencies[used[i]], i });
+        }
+
+        uint32_t next = static_cast<uint32_t>(leafCount);
+        while (queue.size() > 1)
+        {
+            Node first = queue.top();
+            queue.pop();
+            Node second = queue.top();
+            queue.pop();
+            parent[first.second] = next;
+            parent[second.second] = next;
+            queue.push({ first.first + second.first, next });
+            ++next;
+        }
+
+        // Depth of every node; parents always have higher indexes, so walk down from the root
+        const uint32_t root = next - 1;
+        std::vector<uint32_t> depth(2 * leafCount - 1, 0);
+        for (uint32_t node = root; node-- > 0;)
+        {
+            depth[node] = depth[parent[node]] + 1;
+        }
+
+        // Count codes per length, folding everything deeper than maxLength into maxLength
+        std::array<uint32_t, 64> lengthCounts{};
+        for (uint32_t i = 0; i < leafCount; ++i)
+        {
+            lengthCounts[(std::min)(depth[i], maxLength)]++;
+        }
+
+        // Restore the Kraft equality: move codes from maxLength to split a shorter one
+        uint64_t kraft = 0;
+        for (uint32_t length = 1; length <= maxLength; ++length)
+        {
+            kraft += static_cast<uint64_t>(lengthCounts[length]) << (maxLength - length);
+        }
+        while (kraft > (1ull << maxLength))
+        {
+            lengthCounts[maxLength]--;
+            for (uint32_t length = maxLength - 1; length > 0; --length)
+            {
+                if (lengthCounts[length])
+                {
+                    lengthCounts[length]--;
+                    lengthCounts[length + 1] += 2;
+                    break;
+                }
+            }
+            kraft--;
+        }
+
+        // Most frequent symbols get the shortest codes
+        std::sort(used.begin(), used.end(), [frequencies](uint32_t a, uint32_t b)
+        {
+            return frequencies[a] != frequencies[b] ? frequencies[a] > frequencies[b] : a < b;
+        });
+
+        size_t index = 0;
+        for (uint32_t length = 1; length <= maxLength; ++length)
+        {
+            for (uint32_t i = 0; i < lengthCounts[length]; ++i)
+            {
+                lengths[used[index++]] = static_cast<uint8_t>(length);
+            }
+        }
+    }
+
+    // Helper function to turn code lengths into bit-reversed canonical codes
+    void BuildCodes(const uint8_t* lengths, size_t symbolCount, uint16_t* codes)
+    {
+        std::array<uint32_t, DeflateMaxCodeLength + 2> lengthCounts{};
+        for (size_t symbol = 0; symbol < symbolCount; ++symbol)
+        {
+            lengthCounts[lengths[symbol]]++;
+        }
+        lengthCounts[0] = 0;
+
+        std::array<uint32_t, DeflateMaxCodeLength + 2> nextCode{};
+        uint32_t code = 0;
+        for (uint32_t length = 1; length <= DeflateMaxCodeLength; ++length)
+        {
+            code = (code + lengthCounts[length - 1]) << 1;
+            nextCode[length] = code;
+        }
+
+        for (size_t symbol = 0; symbol < symbolCount; ++symbol)
+        {
+            const uint32_t length = lengths[symbol];
+            if (!length)
+            {
+                codes[symbol] = 0;
+                continue;
+            }
+
+            // Deflate sends Huffman codes most significant bit first
+            uint32_t value = nextCode[length]++;
+            uint32_t reversed = 0;
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                reversed = (reversed << 1) | (value & 1);
+                value >>= 1;
+            }
+            codes[symbol] = static_cast<uint16_t>(reversed);
+        }
+    }
+
+    // One LZ77 output symbol: a literal (distance 0) or a match
+    struct LzSymbol
+    {
+        uint16_t value;         // Literal byte or match length
+        uint16_t distance;
+    };
+
+    // Deflates one strip into a byte-aligned run of blocks
+    class StripDeflater
+    {
+    public:
+        StripDeflater()
+            : m_head(size_t(1) << DeflateHashBits, -1)
+            , m_previous(DeflateWindowSize, -1)
+        {
+            m_symbols.reserve(DeflateBlockSymbols);
+        }
+
+        // Compress data; the last strip ends the stream, the others end with a sync flush
+        void Compress(const uint8_t* data, size_t size, bool finalStrip, std::vector<uint8_t>& output)
+        {
+            BitWriter writer(output);
+            size_t blockStart = 0;
+            size_t position = 0;
+
+            while (position < size)
+            {
+                uint32_t matchLength = 0;
+                uint32_t matchDistance = 0;
+                if (position + DeflateMinMatch <= size)
+                {
+                    FindMatch(data, size, position, matchLength, matchDistance);
+                    Insert(data, position);
+                }
+
+                if (matchLength >= DeflateMinMatch)
+                {
+                    m_symbols.push_back({ static_cast<uint16_t>(matchLength), static_cast<uint16_t>(matchDistance) });
+                    for (size_t i = 1; i < matchLength; ++i)
+                    {
+                        if (position + i + DeflateMinMatch <= size)
+                        {
+                            Insert(data, position + i);
+                        }
+                    }
+                    position += matchLength;
+                }
+                else
+                {
+                    m_symbols.push_back({ data[position], 0 });
+                    ++position;
+                }
+
+                if (m_symbols.size() >= DeflateBlockSymbols && position < size)
+                {
+                    WriteBlock(writer, data + blockStart, position - blockStart, false);
+                    blockStart = position;
+                }
+            }
+
+            WriteBlock(writer, data + blockStart, size - blockStart, finalStrip);
+            if (!finalStrip)
+            {
+                // Empty stored block: ends the strip on a byte boundary (zlib's sync flush)
+                writer.Put(0, 3);
+                writer.Align();
+                static constexpr uint8_t syncMarker[4] = { 0x00, 0x00, 0xFF, 0xFF };
+                writer.PutBytes(syncMarker, sizeof(syncMarker));
+            }
+            writer.Align();
+        }
+
+    private:
+        std::vector<int32_t> m_head;
+        std::vector<int32_t> m_previous;
+        std::vector<LzSymbol> m_symbols;
+
+        static uint32_t Hash(const uint8_t* bytes)
+        {
+            const uint32_t value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+            return (value * 2654435761u) >> (32 - DeflateHashBits);
+        }
+
+        void Insert(const uint8_t* data, size_t position)
+        {
+            const uint32_t hash = Hash(data + position);
+            m_previous[position & DeflateWindowMask] = m_head[hash];
+            m_head[hash] = static_cast<int32_t>(position);
+        }
+
+        static uint32_t MatchLength(const uint8_t* a, const uint8_t* b, uint32_t limit)
+        {
+            uint32_t length = 0;
+            while (length + 8 <= limit)
+            {
+                uint64_t x;
+                uint64_t y;
+                memcpy(&x, a + length, 8);
+                memcpy(&y, b + length, 8);
+                if (x != y)
+                {
+                    return length + static_cast<uint32_t>(std::countr_zero(x ^ y) >> 3);
+                }
+                length += 8;
+            }
+            while (length < limit && a[length] == b[length])
+            {
+                ++length;
+            }
+            return length;
+        }
+
+        void FindMatch(const uint8_t* data, size_t size, size_t position, uint32_t& bestLength, uint32_t& bestDistance) const
+        {
+            const uint32_t limit = static_cast<uint32_t>((std::min)(static_cast<size_t>(DeflateMaxMatch), size - position));
+            int32_t candidate = m_head[Hash(data + position)];
+            uint32_t chain = DeflateMaxChain;
+
+            while (candidate >= 0 && chain-- > 0)
+            {
+                const size_t distance = position - static_cast<size_t>(candidate);
+                if (distance > DeflateWindowSize)
+                {
+                    break;
+                }
+
+                // A longer match has to agree at the current best length first
+                const uint8_t* match = data + candidate;
+                if (match[bestLength < limit ? bestLength : 0] == data[position + (bestLength < limit ? bestLength : 0)])
+                {
+                    const uint32_t length = MatchLength(match, data + position, limit);
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = static_cast<uint32_t>(distance);
+                        if (length >= DeflateNiceMatch || length == limit)
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                // Slots are reused after a window; an entry newer than the candidate is stale
+                const int32_t next = m_previous[static_cast<size_t>(candidate) & DeflateWindowMask];
+                if (next >= candidate)
+                {
+                    break;
+                }
+                candidate = next;
+            }
+
+            if (bestLength < DeflateMinMatch)
+            {
+                bestLength = 0;
+            }
+        }
+
+        // Write the collected symbols as one dynamic Huffman block, or as stored blocks
+        // when that is smaller (e.g. for noise); data/size are the bytes they cover
+        void WriteBlock(BitWriter& writer, const uint8_t* data, size_t size, bool finalBlock)
+        {
+            const auto& tables = DeflateTables::Instance();
+
+            std::array<uint32_t, DeflateLitLenCodes> litLenFrequencies{};
+            std::array<uint32_t, DeflateDistanceCodes> distanceFrequencies{};
+            for (const auto& symbol : m_symbols)
+            {
+                if (symbol.distance == 0)
+                {
+                    litLenFrequencies[symbol.value]++;
+                }
+                else
+                {
+                    litLenFrequencies[tables.lengthCode[symbol.value]]++;
+                    distanceFrequencies[tables.DistanceCode(symbol.distance)]++;
+                }
+            }
+            litLenFrequencies[256] = 1;
+
+            std::array<uint8_t, DeflateLitLenCodes> litLenLengths;
+            std::array<uint8_t, DeflateDistanceCodes> distanceLengths;
+            BuildCodeLengths(litLenFrequencies.data(), DeflateLitLenCodes, DeflateMaxCodeLength, litLenLengths.data());
+            BuildCodeLengths(distanceFrequencies.data(), DeflateDistanceCodes, DeflateMaxCodeLength, distanceLengths.data());
+
+            // A block without matches still needs one distance code
+            if (std::all_of(distanceLengths.begin(), distanceLengths.end(), [](uint8_t length) { return length == 0; }))
+            {
+                distanceLengths[0] = 1;
+                distanceLengths[1] = 1;
+            }
+
+            size_t litLenCount = DeflateLitLenCodes;
+            while (litLenCount > 257 && litLenLengths[litLenCount - 1] == 0)
+            {
+                --litLenCount;
+            }
+            size_t distanceCount = DeflateDistanceCodes;
+            while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0)
+            {
+                --distanceCount;
+            }
+
+            // Run-length code the two length tables as one sequence (RFC 1951 3.2.7)
+            std::vector<uint8_t> lengths(litLenLengths.begin(), litLenLengths.begin() + litLenCount);
+            lengths.insert(lengths.end(), distanceLengths.begin(), distanceLengths.begin() + distanceCount);
+
+            struct LengthSymbol
+            {
+                uint8_t code;
+                uint8_t extra;
+            };
+            std::vector<LengthSymbol> lengthSymbols;
+            std::array<uint32_t, DeflateCodeLengthCodes> codeLengthFrequencies{};
+            for (size_t i = 0; i < lengths.size();)
+            {
+                const uint8_t length = lengths[i];
+                size_t run = 1;
+                while (i + run < lengths.size() && lengths[i + run] == length)
+                {
+                    ++run;
+                }
+
+                size_t remaining = run;
+                if (length == 0)
+                {
+                    while (remaining >= 11)
+                    {
+                        size_t count = (std::min)(remaining, static_cast<size_t>(138));
+                        lengthSymbols.push_back({ 18, static_cast<uint8_t>(count - 11) });
+                        remaining -= count;
+                    }
+                    if (remaining >= 3)
+                    {
+                        lengthSymbols.push_back({ 17, static_cast<uint8_t>(remaining - 3) });
+                        remaining = 0;
+                    }
+                }
+                else
+                {
+                    lengthSymbols.push_back({ length, 0 });
+                    remaining--;
+                    while (remaining >= 3)
+                    {
+                        size_t count = (std::min)(remaining, static_cast<size_t>(6));
+                        lengthSymbols.push_back({ 16, static_cast<uint8_t>(count - 3) });
+                        remaining -= count;
+                    }
+                }
+                while (remaining-- > 0)
+                {
+                    lengthSymbols.push_back({ length, 0 });
+                }
+                i += run;
+            }
+            for (const auto& symbol : lengthSymbols)
+            {
+                codeLengthFrequencies[symbol.code]++;
+            }
+
+            std::array<uint8_t, DeflateCodeLengthCodes> codeLengthLengths;
+            BuildCodeLengths(codeLengthFrequencies.data(), DeflateCodeLengthCodes, DeflateMaxCodeLengthCodeLength, codeLengthLengths.data());
+
+            static constexpr uint8_t codeLengthOrder[DeflateCodeLengthCodes] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+            size_t codeLengthCount = DeflateCodeLengthCodes;
+            while (codeLengthCount > 4 && codeLengthLengths[codeLengthOrder[codeLengthCount - 1]] == 0)
+            {
+                --codeLengthCount;
+            }
+
+            // Size of the dynamic block in bits, to compare with storing the bytes
+            static constexpr uint8_t lengthSymbolExtraBits[3] = { 2, 3, 7 };
+            uint64_t bits = 3 + 5 + 5 + 4 + 3 * codeLengthCount;
+            for (const auto& symbol : lengthSymbols)
+            {
+                bits += codeLengthLengths[symbol.code] + (symbol.code >= 16 ? lengthSymbolExtraBits[symbol.code - 16] : 0);
+            }
+            for (size_t code = 0; code < DeflateLitLenCodes; ++code)
+            {
+                bits += static_cast<uint64_t>(litLenFrequencies[code]) * litLenLengths[code];
+                if (code >= 257)
+                {
+                    bits += static_cast<uint64_t>(litLenFrequencies[code]) * tables.lengthExtraBits[code - 257];
+                }
+            }
+            for (size_t code = 0; code < DeflateDistanceCodes; ++code)
+            {
+                bits += static_cast<uint64_t>(distanceFrequencies[code]) * (distanceLengths[code] + tables.distanceExtraBits[code]);
+            }
+
+            const size_t storedBlocks = (std::max)(static_cast<size_t>(1), (size + DeflateMaxStoredBlock - 1) / DeflateMaxStoredBlock);
+            const uint64_t storedBits = (static_cast<uint64_t>(size) + storedBlocks * 5) * 8 + 7;
+            if (storedBits < bits)
+            {
+                WriteStored(writer, data, size, finalBlock);
+                m_symbols.clear();
+                return;
+            }
+
+            // Header and code tables
+            writer.Put(finalBlock ? 1 : 0, 1);
+            writer.Put(2, 2);
+            writer.Put(static_cast<uint32_t>(litLenCount - 257), 5);
+            writer.Put(static_cast<uint32_t>(distanceCount - 1), 5);
+            writer.Put(static_cast<uint32_t>(codeLengthCount - 4), 4);
+            for (size_t i = 0; i < codeLengthCount; ++i)
+            {
+                writer.Put(codeLengthLengths[codeLengthOrder[i]], 3);
+            }
+
+            std::array<uint16_t, DeflateCodeLengthCodes> codeLengthCodes;
+            BuildCodes(codeLengthLengths.data(), DeflateCodeLengthCodes, codeLengthCodes.data());
+            for (const auto& symbol : lengthSymbols)
+            {
+                writer.Put(codeLengthCodes[symbol.code], codeLengthLengths[symbol.code]);
+                if (symbol.code >= 16)
+                {
+                    writer.Put(symbol.extra, lengthSymbolExtraBits[symbol.code - 16]);
+                }
+            }
+
+            // Data
+            std::array<uint16_t, DeflateLitLenCodes> litLenCodes;
+            std::array<uint16_t, DeflateDistanceCodes> distanceCodes;
+            BuildCodes(litLenLengths.data(), DeflateLitLenCodes, litLenCodes.data());
+            BuildCodes(distanceLengths.data(), DeflateDistanceCodes, distanceCodes.data());
+            for (const auto& symbol : m_symbols)
+            {
+                if (symbol.distance == 0)
+                {
+                    writer.Put(litLenCodes[symbol.value], litLenLengths[symbol.value]);
+                    continue;
+                }
+
+                const uint32_t lengthCode = tables.lengthCode[symbol.value];
+                const uint32_t lengthIndex = lengthCode - 257;
+                writer.Put(litLenCodes[lengthCode], litLenLengths[lengthCode]);
+                writer.Put(symbol.value - tables.lengthBase[lengthIndex], tables.lengthExtraBits[lengthIndex]);
+
+                const uint32_t distanceCode = tables.DistanceCode(symbol.distance);
+                writer.Put(distanceCodes[distanceCode], distanceLengths[distanceCode]);
+                writer.Put(symbol.distance - tables.distanceBase[distanceCode], tables.distanceExtraBits[distanceCode]);
+            }
+            writer.Put(litLenCodes[256], litLenLengths[256]);
+
+            m_symbols.clear();
+        }
+
+        static void WriteStored(BitWriter& writer, const uint8_t* data, size_t size, bool finalBlock)
+        {
+            do
+            {
+                const size_t chunk = (std::min)(size, DeflateMaxStoredBlock);
+                const bool last = chunk == size;
+                writer.Put(finalBlock && last ? 1 : 0, 1);
+                writer.Put(0, 2);
+                writer.Align();
+
+                const uint8_t header[4] = {
+                    static_cast<uint8_t>(chunk), static_cast<uint8_t>(chunk >> 8),
+                    static_cast<uint8_t>(~chunk), static_cast<uint8_t>(~chunk >> 8)
+                };
+                writer.PutBytes(header, sizeof(header));
+                writer.PutBytes(data, chunk);
+                data += chunk;
+                size -= chunk;
+            } while (size > 0);
+        }
+    };
+
+    // Helper function to append a PNG chunk
+    void AppendPngChunk(std::vector<uint8_t>& output, const char type[4], const uint8_t* data, size_t size)
+    {
+        const size_t start = output.size();
+        output.resize(start + 8 + size + 4);
+        uint8_t* chunk = output.data() + start;
+        WriteBigEndian32(chunk, static_cast<uint32_t>(size));
+        memcpy(chunk + 4, type, 4);
+        if (size)
+        {
+            memcpy(chunk + 8, data, size);
+        }
+        WriteBigEndian32(chunk + 8 + size, PngCrc32(chunk + 4, size + 4));
+    }
+
+    // Output of one strip: an IDAT chunk and the Adler-32 of its filtered rows
+    struct PngStrip
+    {
+        uint32_t firstRow = 0;
+        uint32_t rowCount = 0;
+        std::vector<uint8_t> chunk;
+        uint32_t adler = 1;
+        size_t filteredSize = 0;
+    };
+
+    void EncodePngParallel(const RawFrame& frame, PngFilter filter, std::vector<uint8_t>& outputBuffer)
+    {
+        if (frame.format != PixelFormat::Bgra || frame.width == 0 || frame.height == 0)
+        {
+            throw winrt::hresult_error(E_INVALIDARG, L"PNG encoding needs a non-empty BGRA frame");
+        }
+
+        // PNG dimensions are limited to 2^31 - 1
+        if (frame.width > 0x7FFFFFFFu || frame.height > 0x7FFFFFFFu)
+        {
+            throw winrt::hresult_error(E_INVALIDARG, L"Frame is too large for PNG encoding");
+        }
+
+        const size_t rowBytes = static_cast<size_t>(frame.width) * PngBytesPerPixel;
+        const size_t filteredRowBytes = rowBytes + 1;
+
+        // Enough strips to keep every core busy, none much smaller than PngStripBytes
+        auto& workers = StripWorkers::Instance();
+        const size_t totalBytes = filteredRowBytes * frame.height;
+        const size_t maxStrips = (std::min)(static_cast<size_t>(frame.height), workers.ThreadCount() * 2);
+        const size_t stripCount = std::clamp((totalBytes + PngStripBytes - 1) / PngStripBytes, static_cast<size_t>(1), maxStrips);
+        const uint32_t rowsPerStrip = static_cast<uint32_t>((frame.height + stripCount - 1) / stripCount);
+
+        std::vector<PngStrip> strips;
+        for (uint32_t row = 0; row < frame.height; row += rowsPerStrip)
+        {
+            PngStrip strip;
+            strip.firstRow = row;
+            strip.rowCount = (std::min)(rowsPerStrip, frame.height - row);
+            strips.push_back(std::move(strip));
+        }
+
+        workers.Run(strips.size(), [&](size_t index)
+        {
+            auto& strip = strips[index];
+            const bool first = index == 0;
+            const bool last = index + 1 == strips.size();
+
+            // RGB rows of the strip plus the row above it, which the filters predict from
+            const uint32_t convertFirst = first ? strip.firstRow : strip.firstRow - 1;
+            const uint32_t convertCount = strip.rowCount + (first ? 0 : 1);
+            std::vector<uint8_t> rgb((static_cast<size_t>(convertCount) + (first ? 1 : 0)) * rowBytes);
+            uint8_t* rows = rgb.data() + (first ? rowBytes : 0);     // First image row gets a zero row above
+            ConvertPixels(frame.pixels.data() + static_cast<size_t>(convertFirst) * frame.stride, frame.stride, rows, rowBytes, frame.width, convertCount, PixelFormat::Rgb24);
+
+            std::vector<uint8_t> filtered(static_cast<size_t>(strip.rowCount) * filteredRowBytes);
+            std::vector<uint8_t> scratch;
+            const uint8_t* previous = first ? rgb.data() : rows;
+            const uint8_t* current = first ? rows : rows + rowBytes;
+            for (uint32_t y = 0; y < strip.rowCount; ++y)
+            {
+                FilterRowWith(filter, current, previous, rowBytes, filtered.data() + y * filteredRowBytes, scratch);
+                previous = current;
+                current += rowBytes;
+            }
+            strip.adler = Adler32(filtered.data(), filtered.size());
+            strip.filteredSize = filtered.size();
+
+            // Chunk header, zlib header on the first strip, then the deflate blocks
+            strip.chunk.reserve(filtered.size() / 2 + 64);
+            strip.chunk.resize(8);
+            memcpy(strip.chunk.data() + 4, "IDAT", 4);
+            if (first)
+            {
+                strip.chunk.push_back(0x78);
+                strip.chunk.push_back(0x01);
+            }
+
+            StripDeflater deflater;
+            deflater.Compress(filtered.data(), filtered.size(), last, strip.chunk);
+
+            const size_t dataSize = strip.chunk.size() - 8;
+            WriteBigEndian32(strip.chunk.data(), static_cast<uint32_t>(dataSize));
+            strip.chunk.resize(strip.chunk.size() + 4);
+            WriteBigEndian32(strip.chunk.data() + 8 + dataSize, PngCrc32(strip.chunk.data() + 4, dataSize + 4));
+        });
+
+        // Signature and header (8-bit RGB, no interlace)
+        static constexpr uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        uint8_t header[13];
+        WriteBigEndian32(header, frame.width);
+        WriteBigEndian32(header + 4, frame.height);
+        header[8] = 8;      // Bit depth
+        header[9] = 2;      // Truecolor
+        header[10] = 0;     // Deflate
+        header[11] = 0;     // Adaptive filtering
+        header[12] = 0;     // No interlace
+
+        size_t totalSize = sizeof(signature) + 25 + 16 + 12;
+        for (const auto& strip : strips)
+        {
+            totalSize += strip.chunk.size();
+        }
+
+        outputBuffer.clear();
+        outputBuffer.reserve(totalSize);
+        outputBuffer.insert(outputBuffer.end(), signature, signature + sizeof(signature));
+        AppendPngChunk(outputBuffer, "IHDR", header, sizeof(header));
+
+        uint32_t adler = strips[0].adler;
+        for (size_t i = 0; i < strips.size(); ++i)
+        {
+            if (i > 0)
+            {
+                adler = CombineAdler32(adler, strips[i].adler, strips[i].filteredSize);
+            }
+            outputBuffer.insert(outputBuffer.end(), strips[i].chunk.begin(), strips[i].chunk.end());
+        }
+
+        // The zlib trailer goes into a last small IDAT chunk
+        uint8_t trailer[4];
+        WriteBigEndian32(trailer, adler);
+        AppendPngChunk(outputBuffer, "IDAT", trailer, sizeof(trailer));
+        AppendPngChunk(outputBuffer, "IEND", nullptr, 0);
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+
+namespace ScreenCaptureCore
+{
+    // Encode a BGRA frame as a 24-bit PNG (alpha ignored, as with the WIC encoder)
+    // The frame is cut into row strips that are filtered with SSE2 and deflated on all
+    // cores. Each strip ends in a sync flush and becomes its own IDAT chunk, so the
+    // strips join into one zlib stream that any decoder reads
+    // filter picks the row filter; Default and Adaptive choose per row by the smallest
+    // sum of absolute differences. Files are typically a little larger than WIC's
+    // Throws winrt::hresult_error for frames that are not BGRA or too large for PNG
+    void EncodePngParallel(const RawFrame& frame, PngFilter filter, std::vector<uint8_t>& outputBuffer);
+}
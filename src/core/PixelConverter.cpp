@@ -0,0 +1,327 @@
+#include "PixelConverter.h"
+#include "../../pch.h"
+#include <immintrin.h>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SC_TARGET_SSSE3
+#define SC_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define SC_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define SC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace ScreenCaptureCore
+{
+    // Converts one row of width BGRA pixels
+    using RowKernel = void (*)(const uint8_t* source, uint8_t* destination, uint32_t width);
+
+    // BT.601 luma in 8.8 fixed point; the SIMD kernels use the same weights and rounding
+    constexpr uint32_t GrayWeightB = 29;
+    constexpr uint32_t GrayWeightG = 150;
+    constexpr uint32_t GrayWeightR = 77;
+
+    // Helper function to compute the gray value of one BGRA pixel
+    inline uint8_t GrayPixel(const uint8_t* pixel)
+    {
+        return static_cast<uint8_t>((pixel[0] * GrayWeightB + pixel[1] * GrayWeightG + pixel[2] * GrayWeightR + 128) >> 8);
+    }
+
+    // Scalar kernels, also used for the row tails of the SIMD kernels
+    void RgbaRowScalar(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        for (uint32_t x = 0; x < width; ++x, source += 4, destination += 4)
+        {
+            destination[0] = source[2];
+            destination[1] = source[1];
+            destination[2] = source[0];
+            destination[3] = source[3];
+        }
+    }
+
+    void RgbRowScalar(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        for (uint32_t x = 0; x < width; ++x, source += 4, destination += 3)
+        {
+            destination[0] = source[2];
+            destination[1] = source[1];
+            destination[2] = source[0];
+        }
+    }
+
+    void GrayRowScalar(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        for (uint32_t x = 0; x < width; ++x, source += 4)
+        {
+            destination[x] = GrayPixel(source);
+        }
+    }
+
+    // SSSE3 kernels: 4 pixels per shuffle, 16 pixels per iteration for RGB and gray
+    SC_TARGET_SSSE3 void RgbaRowSsse3(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        const __m128i swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+        uint32_t x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), _mm_shuffle_epi8(pixels, swizzle));
+        }
+        RgbaRowScalar(source + x * 4, destination + x * 4, width - x);
+    }
+
+    SC_TARGET_SSSE3 void RgbRowSsse3(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        // Pack 4 pixels into the low 12 bytes as R, G, B
+        const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        uint32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            const __m128i* input = reinterpret_cast<const __m128i*>(source + x * 4);
+            __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(input + 0), pack);
+            __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(input + 1), pack);
+            __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(input + 2), pack);
+            __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(input + 3), pack);
+
+            // Stitch the four 12-byte groups into three 16-byte stores
+            __m128i* output = reinterpret_cast<__m128i*>(destination + x * 3);
+            _mm_storeu_si128(output + 0, _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+            _mm_storeu_si128(output + 1, _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+            _mm_storeu_si128(output + 2, _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+        }
+        RgbRowScalar(source + x * 4, destination + x * 3, width - x);
+    }
+
+    // Helper function to compute 4 gray values (as 32-bit lanes) from 4 BGRA pixels
+    SC_TARGET_SSSE3 inline __m128i GrayQuadSsse3(__m128i pixels, __m128i weights, __m128i rounding)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+        __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+        return _mm_srli_epi32(_mm_add_epi32(_mm_hadd_epi32(low, high), rounding), 8);
+    }
+
+    SC_TARGET_SSSE3 void GrayRowSsse3(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        const __m128i weights = _mm_setr_epi16(GrayWeightB, GrayWeightG, GrayWeightR, 0, GrayWeightB, GrayWeightG, GrayWeightR, 0);
+        const __m128i rounding = _mm_set1_epi32(128);
+
+        uint32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            const __m128i* input = reinterpret_cast<const __m128i*>(source + x * 4);
+            __m128i g0 = GrayQuadSsse3(_mm_loadu_si128(input + 0), weights, rounding);
+            __m128i g1 = GrayQuadSsse3(_mm_loadu_si128(input + 1), weights, rounding);
+            __m128i g2 = GrayQuadSsse3(_mm_loadu_si128(input + 2), weights, rounding);
+            __m128i g3 = GrayQuadSsse3(_mm_loadu_si128(input + 3), weights, rounding);
+
+            __m128i gray = _mm_packus_epi16(_mm_packs_epi32(g0, g1), _mm_packs_epi32(g2, g3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x), gray);
+        }
+        GrayRowScalar(source + x * 4, destination + x, width - x);
+    }
+
+    // AVX2 kernels: shuffles work per 128-bit lane, so lanes are reordered before storing
+    SC_TARGET_AVX2 void RgbaRowAvx2(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        const __m256i swizzle = _mm256_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + x * 4));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x * 4), _mm256_shuffle_epi8(pixels, swizzle));
+        }
+        RgbaRowScalar(source + x * 4, destination + x * 4, width - x);
+    }
+
+    SC_TARGET_AVX2 void RgbRowAvx2(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        const __m256i pack = _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        // Move the 12 packed bytes of the upper lane next to those of the lower lane
+        const __m256i gather = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + x * 4));
+            __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(pixels, pack), gather);
+
+            // 24 bytes out: 16 from the low lane, 8 from the high lane
+            uint8_t* output = destination + x * 3;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm256_castsi256_si128(packed));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 16), _mm256_extracti128_si256(packed, 1));
+        }
+        RgbRowScalar(source + x * 4, destination + x * 3, width - x);
+    }
+
+    // Helper function to compute 8 gray values (as 32-bit lanes, in order) from 8 BGRA pixels
+    SC_TARGET_AVX2 inline __m256i GrayOctAvx2(__m256i pixels, __m256i weights, __m256i rounding)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i low = _mm256_madd_epi16(_mm256_unpacklo_epi8(pixels, zero), weights);
+        __m256i high = _mm256_madd_epi16(_mm256_unpackhi_epi8(pixels, zero), weights);
+        return _mm256_srli_epi32(_mm256_add_epi32(_mm256_hadd_epi32(low, high), rounding), 8);
+    }
+
+    SC_TARGET_AVX2 void GrayRowAvx2(const uint8_t* source, uint8_t* destination, uint32_t width)
+    {
+        const __m256i weights = _mm256_setr_epi16(
+            GrayWeightB, GrayWeightG, GrayWeightR, 0, GrayWeightB, GrayWeightG, GrayWeightR, 0,
+            GrayWeightB, GrayWeightG, GrayWeightR, 0, GrayWeightB, GrayWeightG, GrayWeightR, 0);
+        const __m256i rounding = _mm256_set1_epi32(128);
+
+        // After the lane-wise packs the 4-pixel groups sit in dwords 0, 4, 1, 5
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+        uint32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            const __m256i* input = reinterpret_cast<const __m256i*>(source + x * 4);
+            __m256i g0 = GrayOctAvx2(_mm256_loadu_si256(input + 0), weights, rounding);
+            __m256i g1 = GrayOctAvx2(_mm256_loadu_si256(input + 1), weights, rounding);
+
+            __m256i words = _mm256_packs_epi32(g0, g1);
+            __m256i gray = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(words, words), order);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x), _mm256_castsi256_si128(gray));
+        }
+        GrayRowScalar(source + x * 4, destination + x, width - x);
+    }
+
+    // Kernel set picked for the running CPU
+    struct PixelKernels
+    {
+        RowKernel rgba;
+        RowKernel rgb;
+        RowKernel gray;
+        const char* name;
+    };
+
+    // Helper function to check the CPU for AVX2 (including OS support for YMM state) and SSSE3
+    void DetectCpuFeatures(bool& hasAvx2, bool& hasSsse3)
+    {
+        hasAvx2 = false;
+        hasSsse3 = false;
+
+#if defined(_MSC_VER)
+        int info[4] = {};
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        const int ecx = info[2];
+        hasSsse3 = (ecx & (1 << 9)) != 0;
+
+        const bool osUsesYmm = (ecx & (1 << 27)) != 0 && (ecx & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        if (osUsesYmm && maxLeaf >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            hasAvx2 = (info[1] & (1 << 5)) != 0;
+        }
+#else
+        hasSsse3 = __builtin_cpu_supports("ssse3");
+        hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    const PixelKernels& GetPixelKernels()
+    {
+        static const PixelKernels kernels = []
+        {
+            bool hasAvx2 = false;
+            bool hasSsse3 = false;
+            DetectCpuFeatures(hasAvx2, hasSsse3);
+
+            if (hasAvx2)
+            {
+                return PixelKernels{ RgbaRowAvx2, RgbRowAvx2, GrayRowAvx2, "AVX2" };
+            }
+            if (hasSsse3)
+            {
+                return PixelKernels{ RgbaRowSsse3, RgbRowSsse3, GrayRowSsse3, "SSSE3" };
+            }
+            return PixelKernels{ RgbaRowScalar, RgbRowScalar, GrayRowScalar, "Scalar" };
+        }();
+        return kernels;
+    }
+
+    uint32_t BytesPerPixel(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PixelFormat::Rgb24:
+            return 3;
+        case PixelFormat::Gray8:
+            return 1;
+        case PixelFormat::Rgba16Float:
+            return 8;
+        default:
+            return 4;
+        }
+    }
+
+    void ConvertPixels(const uint8_t* source, size_t sourceStride, uint8_t* destination, size_t destinationStride, uint32_t width, uint32_t height, PixelFormat format)
+    {
+        const auto& kernels = GetPixelKernels();
+
+        RowKernel kernel = nullptr;
+        switch (format)
+        {
+        case PixelFormat::Rgba:
+            kernel = kernels.rgba;
+            break;
+        case PixelFormat::Rgb24:
+            kernel = kernels.rgb;
+            break;
+        case PixelFormat::Gray8:
+            kernel = kernels.gray;
+            break;
+        default:
+            break;
+        }
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t* sourceRow = source + y * sourceStride;
+            uint8_t* destinationRow = destination + y * destinationStride;
+            if (kernel)
+            {
+                kernel(sourceRow, destinationRow, width);
+            }
+            else
+            {
+                memcpy(destinationRow, sourceRow, static_cast<size_t>(width) * 4);
+            }
+        }
+    }
+
+    void ConvertFrame(RawFrame& frame, PixelFormat format)
+    {
+        if (format == frame.format)
+        {
+            return;
+        }
+
+        const uint32_t stride = frame.width * BytesPerPixel(format);
+        std::vector<uint8_t> pixels(static_cast<size_t>(stride) * frame.height);
+        ConvertPixels(frame.pixels.data(), frame.stride, pixels.data(), stride, frame.width, frame.height, format);
+
+        frame.pixels = std::move(pixels);
+        frame.stride = stride;
+        frame.format = format;
+    }
+
+    const char* GetPixelKernelName()
+    {
+        return GetPixelKernels().name;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+
+namespace ScreenCaptureCore
+{
+    // Bytes per pixel of an output pixel format
+    uint32_t BytesPerPixel(PixelFormat format);
+
+    // Convert BGRA rows to format and drop the source row padding in one pass
+    // (Rgba16Float is a capture format, not a conversion target)
+    // destinationStride must be at least width * BytesPerPixel(format)
+    // Uses AVX2 or SSSE3 kernels when the CPU has them (checked once at first use)
+    void ConvertPixels(const uint8_t* source, size_t sourceStride, uint8_t* destination, size_t destinationStride, uint32_t width, uint32_t height, PixelFormat format);
+
+    // Convert a BGRA frame in place to tightly packed rows of format
+    void ConvertFrame(RawFrame& frame, PixelFormat format);
+
+    // Name of the kernels ConvertPixels uses on this CPU ("AVX2", "SSSE3" or "Scalar")
+    const char* GetPixelKernelName();
+}
@@ -1,6 +1,21 @@
 #include "ScreenCaptureCore.h"
+#include "FrameEncoder.h"
+#include "EncodePipeline.h"
+#include "FrameScaler.h"
+#include "FrameToneMapper.h"
+#include "FrameChangeDetector.h"
+#include "FrameScheduler.h"
+#include "PixelConverter.h"
+#include "SharedFrameTexture.h"
+#include "SharedFrameRing.h"
+#include "CaptureWorker.h"
+#include "CaptureDeviceCache.h"
+#include "CaptureStats.h"
+#include "DesktopDuplication.h"
+#include "AdapterSelector.h"
 #include "../../pch.h"
 #include <windows.graphics.directx.direct3d11.interop.h>
+#include <winrt/Windows.Foundation.Metadata.h>
 #include <iostream>
 #include <vector>
 #include <mutex>
@@ -8,6 +23,10 @@
 #include <chrono>
 #include <thread>
 #include <filesystem>
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
 
 using namespace winrt;
 using namespace winrt::Windows::Foundation;
@@ -32,8 +51,10 @@ namespace ScreenCaptureCore
     }
 
     // Helper function to create D3D11 device
-    com_ptr<ID3D11Device> CreateD3DDevice()
+    com_ptr<ID3D11Device> CreateD3DDevice(IDXGIAdapter* adapter)
     {
+        StageTimer timer(CaptureStage::DeviceCreation);
+
         UINT creationFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
 
 #if defined(_DEBUG)
@@ -53,11 +74,18 @@ namespace ScreenCaptureCore
 
         com_ptr<ID3D11Device> device;
         com_ptr<ID3D11DeviceContext> context;
+
+        // An explicit adapter needs the unknown driver type; without one the
+        // system default hardware adapter is used
+        const D3D_DRIVER_TYPE driverType = adapter ? D3D_DRIVER_TYPE_UNKNOWN : D3D_DRIVER_TYPE_HARDWARE;
+
+        // Video support lets Media Foundation encoders share the capture device;
+        // retry without it on drivers that reject the flag
         HRESULT hr = D3D11CreateDevice(
-            nullptr,
-            D3D_DRIVER_TYPE_HARDWARE,
+            adapter,
+            driverType,
             0,
-            creationFlags,
+            creationFlags | D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
             featureLevels,
             ARRAYSIZE(featureLevels),
             D3D11_SDK_VERSION,
@@ -66,6 +94,22 @@ namespace ScreenCaptureCore
             context.put()
         );
 
+        if (FAILED(hr))
+        {
+            hr = D3D11CreateDevice(
+                adapter,
+                driverType,
+                0,
+                creationFlags,
+                featureLevels,
+                ARRAYSIZE(featureLevels),
+                D3D11_SDK_VERSION,
+                device.put(),
+                nullptr,
+                context.put()
+            );
+        }
+
         if (FAILED(hr))
         {
             throw hresult_error(hr, L"Failed to create D3D11 device");
@@ -86,336 +130,305 @@ namespace ScreenCaptureCore
         return inspectable.as<IDirect3DDevice>();
     }
 
-    // Helper function to create GraphicsCaptureItem for primary monitor
-    GraphicsCaptureItem CreateCaptureItemForMonitor()
+    CaptureTarget CaptureTarget::Primary()
     {
-        auto factory = winrt::get_activation_factory<GraphicsCaptureItem>();
-        auto interop = factory.as<IGraphicsCaptureItemInterop>();
-
-        // Get primary monitor
-        HMONITOR primaryMonitor = MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+        return CaptureTarget();
+    }
 
-        GraphicsCaptureItem item{ nullptr };
-        winrt::check_hresult(interop->CreateForMonitor(
-            primaryMonitor,
-            winrt::guid_of<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>(),
-            winrt::put_abi(item)
-        ));
+    CaptureTarget CaptureTarget::FromMonitorIndex(uint32_t index)
+    {
+        CaptureTarget target;
+        target.type = CaptureTargetType::MonitorIndex;
+        target.monitorIndex = index;
+        return target;
+    }
 
-        return item;
+    CaptureTarget CaptureTarget::FromMonitor(HMONITOR monitor)
+    {
+        CaptureTarget target;
+        target.type = CaptureTargetType::Monitor;
+        target.monitor = monitor;
+        return target;
     }
 
-    // ScreenCapture implementation
-    ScreenCapture::ScreenCapture(ILogger* logger)
-        : m_logger(logger ? logger : &m_defaultLogger)
+    CaptureTarget CaptureTarget::FromWindow(HWND window)
     {
-        try
-        {
-            init_apartment(apartment_type::single_threaded);
-        }
-        catch (...)
-        {
-            // Apartment may already be initialized
-        }
+        CaptureTarget target;
+        target.type = CaptureTargetType::Window;
+        target.window = window;
+        return target;
     }
 
-    ScreenCapture::~ScreenCapture()
+    CaptureTarget CaptureTarget::AllMonitors()
     {
+        CaptureTarget target;
+        target.type = CaptureTargetType::AllMonitors;
+        return target;
     }
 
-    void ScreenCapture::Log(const std::wstring& message)
+    // Helper function to collect monitors from EnumDisplayMonitors
+    BOOL CALLBACK AddMonitorInfo(HMONITOR monitor, HDC, LPRECT, LPARAM data)
     {
-        if (m_logger)
+        auto monitors = reinterpret_cast<std::vector<MonitorInfo>*>(data);
+
+        MONITORINFOEXW info = {};
+        info.cbSize = sizeof(info);
+        if (GetMonitorInfoW(monitor, &info))
         {
-            m_logger->LogInfo(message);
+            MonitorInfo monitorInfo;
+            monitorInfo.handle = monitor;
+            monitorInfo.bounds = info.rcMonitor;
+            monitorInfo.primary = (info.dwFlags & MONITORINFOF_PRIMARY) != 0;
+            monitorInfo.deviceName = info.szDevice;
+            monitors->push_back(monitorInfo);
         }
+        return TRUE;
     }
 
-    void ScreenCapture::LogError(const std::wstring& message)
+    std::vector<MonitorInfo> EnumerateMonitors()
     {
-        if (m_logger)
+        std::vector<MonitorInfo> monitors;
+        EnumDisplayMonitors(nullptr, nullptr, AddMonitorInfo, reinterpret_cast<LPARAM>(&monitors));
+
+        // Primary first, the rest in enumeration order
+        std::stable_partition(monitors.begin(), monitors.end(), [](const MonitorInfo& monitor) { return monitor.primary; });
+        return monitors;
+    }
+
+    // Helper function to resolve a single-item target to a monitor or a window
+    // Returns false for AllMonitors, unknown monitor indexes and destroyed windows
+    bool ResolveCaptureTarget(const CaptureTarget& target, HMONITOR& monitor, HWND& window)
+    {
+        monitor = nullptr;
+        window = nullptr;
+
+        switch (target.type)
         {
-            m_logger->LogError(message);
+        case CaptureTargetType::PrimaryMonitor:
+            monitor = MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+            return true;
+        case CaptureTargetType::MonitorIndex:
+        {
+            auto monitors = EnumerateMonitors();
+            if (target.monitorIndex >= monitors.size())
+            {
+                return false;
+            }
+            monitor = monitors[target.monitorIndex].handle;
+            return true;
+        }
+        case CaptureTargetType::Monitor:
+            monitor = target.monitor;
+            return monitor != nullptr;
+        case CaptureTargetType::Window:
+            window = target.window;
+            return window != nullptr && IsWindow(window);
+        default:
+            return false;
         }
     }
 
-    ErrorCode ScreenCapture::CaptureToFile(const std::wstring& outputPath)
+    // Helper function to create GraphicsCaptureItem for a monitor
+    GraphicsCaptureItem CreateCaptureItemForMonitor(HMONITOR monitor)
     {
-        // Default: hide border and cursor for cleaner capture
-        return CaptureToFile(outputPath, true, true);
+        auto factory = winrt::get_activation_factory<GraphicsCaptureItem>();
+        auto interop = factory.as<IGraphicsCaptureItemInterop>();
+
+        GraphicsCaptureItem item{ nullptr };
+        winrt::check_hresult(interop->CreateForMonitor(
+            monitor,
+            winrt::guid_of<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>(),
+            winrt::put_abi(item)
+        ));
+
+        return item;
     }
 
-    ErrorCode ScreenCapture::CaptureToFile(const std::wstring& outputPath, bool hideBorder, bool hideCursor)
+    // Helper function to create GraphicsCaptureItem for a window
+    GraphicsCaptureItem CreateCaptureItemForWindow(HWND window)
     {
-        return InternalCapture(outputPath, hideBorder, hideCursor);
+        auto factory = winrt::get_activation_factory<GraphicsCaptureItem>();
+        auto interop = factory.as<IGraphicsCaptureItemInterop>();
+
+        GraphicsCaptureItem item{ nullptr };
+        winrt::check_hresult(interop->CreateForWindow(
+            window,
+            winrt::guid_of<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>(),
+            winrt::put_abi(item)
+        ));
+
+        return item;
     }
 
-    ErrorCode ScreenCapture::CaptureToMemory(std::vector<uint8_t>& outputBuffer, bool hideBorder, bool hideCursor)
+    // Helper function to create GraphicsCaptureItem for a resolved target
+    GraphicsCaptureItem CreateCaptureItem(HMONITOR monitor, HWND window)
     {
-        return InternalCaptureToMemory(outputBuffer, hideBorder, hideCursor);
+        return window ? CreateCaptureItemForWindow(window) : CreateCaptureItemForMonitor(monitor);
     }
 
-    ErrorCode ScreenCapture::InternalCapture(const std::wstring& outputPath, bool hideBorder, bool hideCursor)
+    // Helper function to wait for a frame event while dispatching window messages
+    // Frame pools created with Direct3D11CaptureFramePool::Create raise FrameArrived
+    // through the calling thread's message queue, so the wait must keep pumping it
+    bool WaitForFrameEvent(HANDLE frameEvent, uint32_t timeoutMs)
     {
-        try
-        {
-            Log(L"Initializing capture system...");
-
-            // 1. Create D3D11 Device
-            auto d3d11Device = CreateD3DDevice();
-            auto direct3DDevice = CreateDirect3DDeviceFromD3D11Device(d3d11Device);
-
-            // 2. Create capture item for primary monitor
-            auto captureItem = CreateCaptureItemForMonitor();
-            Log(L"Capture item created. Size: " + std::to_wstring(captureItem.Size().Width) + L"x" + std::to_wstring(captureItem.Size().Height));
-
-            // 3. Create Direct3D11CaptureFramePool
-            auto framePool = Direct3D11CaptureFramePool::Create(
-                direct3DDevice,
-                DirectXPixelFormat::B8G8R8A8UIntNormalized,
-                1,
-                captureItem.Size()
-            );
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
 
-            // 4. Create capture session
-            auto session = framePool.CreateCaptureSession(captureItem);
+        while (true)
+        {
+            auto now = std::chrono::steady_clock::now();
+            DWORD remaining = now < deadline
+                ? static_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count())
+                : 0;
 
-            // 5. Configure capture session options
-            if (hideCursor)
+            DWORD waitResult = MsgWaitForMultipleObjectsEx(1, &frameEvent, remaining, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+            if (waitResult == WAIT_OBJECT_0)
             {
-                Log(L"Disabling cursor in capture...");
-                session.IsCursorCaptureEnabled(false);
+                return true;
             }
 
-            if (hideBorder)
+            if (waitResult != WAIT_OBJECT_0 + 1)
             {
-                Log(L"Attempting to disable border...");
-                try
-                {
-                    session.IsBorderRequired(false);
-                }
-                catch (...)
-                {
-                    Log(L"Warning: Could not disable border (may require newer Windows version)");
-                }
+                // Timeout or wait failure
+                return false;
             }
 
-            // 6. Setup frame processing
-            bool frameReceived = false;
-            bool captureSuccess = false;
-            std::mutex frameMutex;
-            std::condition_variable frameCondition;
-
-            Log(L"Setting up frame handler...");
-
-            framePool.FrameArrived([&](auto const& sender, auto const& args)
+            MSG msg;
+            while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
             {
-                Log(L"FrameArrived event triggered!");
-
-                auto frame = sender.TryGetNextFrame();
-                if (frame)
-                {
-                    try
-                    {
-                        Log(L"Frame captured! Processing...");
-
-                        // Get the Direct3D11 surface
-                        auto surface = frame.Surface();
-
-                        // Get the underlying D3D11 texture using interop
-                        com_ptr<ID3D11Texture2D> texture;
-                        auto dxgiInterfaceAccess = surface.as<::Windows::Graphics::DirectX::Direct3D11::IDirect3DDxgiInterfaceAccess>();
-                        winrt::check_hresult(dxgiInterfaceAccess->GetInterface(IID_PPV_ARGS(&texture)));
-
-                        // Get texture description
-                        D3D11_TEXTURE2D_DESC desc;
-                        texture->GetDesc(&desc);
-
-                        Log(L"Texture size: " + std::to_wstring(desc.Width) + L"x" + std::to_wstring(desc.Height));
-
-                        // Create staging texture for CPU access
-                        desc.Usage = D3D11_USAGE_STAGING;
-                        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-                        desc.BindFlags = 0;
-                        desc.MiscFlags = 0;
-
-                        com_ptr<ID3D11Texture2D> stagingTexture;
-                        winrt::check_hresult(d3d11Device->CreateTexture2D(&desc, nullptr, stagingTexture.put()));
-
-                        // Copy to staging texture
-                        com_ptr<ID3D11DeviceContext> context;
-                        d3d11Device->GetImmediateContext(context.put());
-                        context->CopyResource(stagingTexture.get(), texture.get());
-
-                        // Map the texture
-                        D3D11_MAPPED_SUBRESOURCE mappedResource;
-                        winrt::check_hresult(context->Map(stagingTexture.get(), 0, D3D11_MAP_READ, 0, &mappedResource));
-
-                        // Create bitmap data
-                        uint32_t dataSize = mappedResource.RowPitch * desc.Height;
-                        std::vector<uint8_t> bitmapData(dataSize);
-                        memcpy(bitmapData.data(), mappedResource.pData, dataSize);
-
-                        context->Unmap(stagingTexture.get(), 0);
-
-                        // Save to file
-                        try
-                        {
-                            // Get folder and filename from path
-                            std::filesystem::path filePath(outputPath);
-                            auto parentPath = filePath.parent_path();
-                            auto fileName = filePath.filename().wstring();
-                            
-                            // If no parent path specified, use current directory
-                            if (parentPath.empty())
-                            {
-                                parentPath = std::filesystem::current_path();
-                            }
-                            
-                            // Ensure directory exists
-                            if (!std::filesystem::exists(parentPath))
-                            {
-                                std::filesystem::create_directories(parentPath);
-                            }
-                            
-                            // Create file using Windows Storage API
-                            auto folder = StorageFolder::GetFolderFromPathAsync(parentPath.wstring()).get();
-                            auto file = folder.CreateFileAsync(fileName, CreationCollisionOption::ReplaceExisting).get();
-
-                            InMemoryRandomAccessStream stream;
-                            BitmapEncoder encoder = BitmapEncoder::CreateAsync(BitmapEncoder::PngEncoderId(), stream).get();
-
-                            encoder.SetPixelData(
-                                BitmapPixelFormat::Bgra8,
-                                BitmapAlphaMode::Ignore,
-                                desc.Width,
-                                desc.Height,
-                                96.0,
-                                96.0,
-                                bitmapData
-                            );
-
-                            encoder.FlushAsync().get();
-
-                            auto outputStream = file.OpenAsync(FileAccessMode::ReadWrite).get();
-                            stream.Seek(0);
-                            RandomAccessStream::CopyAsync(stream, outputStream).get();
-                            outputStream.FlushAsync().get();
-                            outputStream.Close();
-
-                            Log(L"Screenshot saved successfully to " + outputPath);
-                            captureSuccess = true;
-                        }
-                        catch (...)
-                        {
-                            LogError(L"Error saving screenshot to file");
-                        }
-
-                        // Signal completion
-                        {
-                            std::lock_guard<std::mutex> lock(frameMutex);
-                            frameReceived = true;
-                        }
-                        frameCondition.notify_one();
-                    }
-                    catch (hresult_error const& ex)
-                    {
-                        LogError(L"Error processing frame: " + std::wstring(ex.message()));
-                        {
-                            std::lock_guard<std::mutex> lock(frameMutex);
-                            frameReceived = true;
-                        }
-                        frameCondition.notify_one();
-                    }
-                }
-                else
-                {
-                    LogError(L"No frame available");
-                }
-            });
-
-            // 7. Start capture
-            Log(L"Starting capture session...");
-            session.StartCapture();
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
+        }
+    }
 
-            // Wait for frame with timeout and message pumping
-            Log(L"Waiting for frame (timeout: 10 seconds)...");
+    // Helper function to apply border and cursor options to a capture session
+    void ConfigureCaptureSession(GraphicsCaptureSession const& session, bool hideBorder, bool hideCursor)
+    {
+        if (hideCursor)
+        {
+            try
+            {
+                session.IsCursorCaptureEnabled(false);
+            }
+            catch (...)
             {
-                std::unique_lock<std::mutex> lock(frameMutex);
-                auto start = std::chrono::steady_clock::now();
-                auto timeout = std::chrono::seconds(10);
+                // Ignore if not supported
+            }
+        }
 
-                while (!frameReceived && (std::chrono::steady_clock::now() - start) < timeout)
-                {
-                    lock.unlock();
+        if (hideBorder)
+        {
+            try
+            {
+                session.IsBorderRequired(false);
+            }
+            catch (...)
+            {
+                // Ignore if not supported
+            }
+        }
+    }
 
-                    // Pump messages to allow Windows events to be processed
-                    MSG msg;
-                    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-                    {
-                        TranslateMessage(&msg);
-                        DispatchMessage(&msg);
-                    }
+    // Helper function to check whether Graphics Capture runs on this system
+    bool IsGraphicsCaptureSupported()
+    {
+        static const bool supported = []
+        {
+            try
+            {
+                return GraphicsCaptureSession::IsSupported();
+            }
+            catch (...)
+            {
+                return false;
+            }
+        }();
+        return supported;
+    }
 
-                    // Small sleep to prevent busy waiting
-                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // Helper function to check whether capture sessions have a property on this system
+    bool HasSessionProperty(const wchar_t* name)
+    {
+        try
+        {
+            return winrt::Windows::Foundation::Metadata::ApiInformation::IsPropertyPresent(L"Windows.Graphics.Capture.GraphicsCaptureSession", name);
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
 
-                    lock.lock();
-                }
+    // Helper function to check whether sessions can hide the cursor (Windows 10 2004 and later)
+    bool SupportsCursorControl()
+    {
+        static const bool supported = HasSessionProperty(L"IsCursorCaptureEnabled");
+        return supported;
+    }
 
-                if (frameReceived)
-                {
-                    Log(L"Frame received and processed!");
-                }
-                else
-                {
-                    LogError(L"Timeout: No frame received within 10 seconds");
-                    return ErrorCode::TimeoutError;
-                }
-            }
+    // Helper function to check whether sessions can hide the capture border (Windows 11 and Server 2022)
+    bool SupportsBorderControl()
+    {
+        static const bool supported = HasSessionProperty(L"IsBorderRequired");
+        return supported;
+    }
 
-            // Cleanup
-            session.Close();
-            framePool.Close();
+    // Helper function to get the frame pool pixel format for a capture format
+    DirectXPixelFormat GetSurfaceFormat(CaptureFormat format)
+    {
+        return format == CaptureFormat::Rgba16Float ? DirectXPixelFormat::R16G16B16A16Float : DirectXPixelFormat::B8G8R8A8UIntNormalized;
+    }
 
-            Log(L"Capture completed!");
+    // Helper function to get the monitor a target is shown on (SDR white level, adapter)
+    HMONITOR GetTargetMonitor(HMONITOR monitor, HWND window)
+    {
+        return monitor ? monitor : MonitorFromWindow(window, MONITOR_DEFAULTTONEAREST);
+    }
 
-            return captureSuccess ? ErrorCode::Success : ErrorCode::FileSaveFailed;
-        }
-        catch (hresult_error const& ex)
-        {
-            LogError(L"Capture error: " + std::wstring(ex.message()));
-            return ErrorCode::CaptureSessionFailed;
-        }
-        catch (std::exception const& ex)
+    // Helper function to get the capture device of an adapter, from the cache when one is attached
+    void AcquireDevice(CaptureDeviceCache* cache, IDXGIAdapter* adapter, com_ptr<ID3D11Device>& d3d11Device, IDirect3DDevice& direct3DDevice)
+    {
+        if (cache)
         {
-            std::wstring errorMsg(ex.what(), ex.what() + strlen(ex.what()));
-            LogError(L"Standard error: " + errorMsg);
-            return ErrorCode::UnknownError;
+            cache->GetDevice(adapter, d3d11Device, direct3DDevice);
+            return;
         }
-        catch (...)
+
+        d3d11Device = CreateD3DDevice(adapter);
+        direct3DDevice = CreateDirect3DDeviceFromD3D11Device(d3d11Device);
+    }
+
+    // Helper function to get a monitor's capture item, from the cache when one is attached
+    GraphicsCaptureItem AcquireMonitorItem(CaptureDeviceCache* cache, HMONITOR monitor)
+    {
+        return cache ? cache->GetMonitorItem(monitor) : CreateCaptureItemForMonitor(monitor);
+    }
+
+    // Helper function to drop a cached device a failed capture found lost
+    void ReportDeviceError(CaptureDeviceCache* cache, HRESULT hr)
+    {
+        if (cache && IsDeviceLost(hr))
         {
-            LogError(L"Unknown error occurred");
-            return ErrorCode::UnknownError;
+            cache->InvalidateDevice();
         }
     }
 
     // Helper function to setup capture session
     std::tuple<winrt::Windows::Graphics::Capture::GraphicsCaptureSession, 
                winrt::Windows::Graphics::Capture::Direct3D11CaptureFramePool,
-               winrt::com_ptr<ID3D11Device>> SetupCaptureSession(bool hideBorder, bool hideCursor)
+               winrt::com_ptr<ID3D11Device>> SetupCaptureSession(GraphicsCaptureItem const& captureItem, bool hideBorder, bool hideCursor, CaptureFormat captureFormat = CaptureFormat::Bgra8, CaptureDeviceCache* cache = nullptr, IDXGIAdapter* adapter = nullptr)
     {
-        // 1. Create D3D11 Device
-        auto d3d11Device = CreateD3DDevice();
-        auto direct3DDevice = CreateDirect3DDeviceFromD3D11Device(d3d11Device);
+        // 1. Create D3D11 Device (or reuse the cached one)
+        com_ptr<ID3D11Device> d3d11Device;
+        IDirect3DDevice direct3DDevice{ nullptr };
+        AcquireDevice(cache, adapter, d3d11Device, direct3DDevice);
 
-        // 2. Create capture item for primary monitor
-        auto captureItem = CreateCaptureItemForMonitor();
+        // 2. Capture item is created by the caller for the selected target
 
         // 3. Create Direct3D11CaptureFramePool
         auto framePool = Direct3D11CaptureFramePool::Create(
             direct3DDevice,
-            DirectXPixelFormat::B8G8R8A8UIntNormalized,
+            GetSurfaceFormat(captureFormat),
             1,
             captureItem.Size()
         );
@@ -424,212 +437,2807 @@ namespace ScreenCaptureCore
         auto session = framePool.CreateCaptureSession(captureItem);
 
         // 5. Configure capture session options
-        if (hideCursor)
-        {
-            session.IsCursorCaptureEnabled(false);
-        }
+        ConfigureCaptureSession(session, hideBorder, hideCursor);
 
-        if (hideBorder)
+        return std::make_tuple(session, framePool, d3d11Device);
+    }
+
+    // Helper function to get the D3D11 texture behind a captured frame
+    com_ptr<ID3D11Texture2D> GetFrameTexture(Direct3D11CaptureFrame const& frame)
+    {
+        com_ptr<ID3D11Texture2D> texture;
+        auto dxgiInterfaceAccess = frame.Surface().as<::Windows::Graphics::DirectX::Direct3D11::IDirect3DDxgiInterfaceAccess>();
+        winrt::check_hresult(dxgiInterfaceAccess->GetInterface(IID_PPV_ARGS(&texture)));
+        return texture;
+    }
+
+    // Helper function to copy a mapped staging texture into a raw frame
+    // BGRA and half floats keep the driver's row pitch so the whole image is a single
+    // memcpy; other formats are converted and packed in the same pass
+    void CopyMappedFrame(const D3D11_MAPPED_SUBRESOURCE& mappedResource, uint32_t width, uint32_t height, RawFrame& frame, PixelFormat format = PixelFormat::Bgra)
+    {
+        StageTimer timer(CaptureStage::PixelCopy);
+
+        frame.width = width;
+        frame.height = height;
+        frame.format = format;
+
+        if (format == PixelFormat::Bgra || format == PixelFormat::Rgba16Float)
         {
-            try
-            {
-                session.IsBorderRequired(false);
-            }
-            catch (...)
-            {
-                // Ignore if not supported
-            }
+            frame.stride = mappedResource.RowPitch;
+            frame.pixels.resize(static_cast<size_t>(mappedResource.RowPitch) * height);
+            memcpy(frame.pixels.data(), mappedResource.pData, frame.pixels.size());
+            return;
         }
 
-        return std::make_tuple(session, framePool, d3d11Device);
+        frame.stride = width * BytesPerPixel(format);
+        frame.pixels.resize(static_cast<size_t>(frame.stride) * height);
+        ConvertPixels(static_cast<const uint8_t*>(mappedResource.pData), mappedResource.RowPitch, frame.pixels.data(), frame.stride, width, height, format);
     }
 
-    ErrorCode ScreenCapture::InternalCaptureToMemory(std::vector<uint8_t>& outputBuffer, bool hideBorder, bool hideCursor)
+    // Helper function to read a texture (or the box of it) back through a one-off staging texture
+    void ReadbackTexture(const com_ptr<ID3D11Device>& d3d11Device, ID3D11Texture2D* texture, RawFrame& frame, const D3D11_BOX* box = nullptr, PixelFormat format = PixelFormat::Bgra)
     {
-        try
+        D3D11_TEXTURE2D_DESC desc;
+        texture->GetDesc(&desc);
+
+        // Create staging texture for CPU access, sized to the copied part
+        if (box)
         {
-            Log(L"Initializing capture system for memory output...");
+            desc.Width = box->right - box->left;
+            desc.Height = box->bottom - box->top;
+        }
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        desc.BindFlags = 0;
+        desc.MiscFlags = 0;
 
-            auto [session, framePool, d3d11Device] = SetupCaptureSession(hideBorder, hideCursor);
+        com_ptr<ID3D11Texture2D> stagingTexture;
+        winrt::check_hresult(d3d11Device->CreateTexture2D(&desc, nullptr, stagingTexture.put()));
 
-            // 6. Setup frame processing
-            bool frameReceived = false;
-            bool captureSuccess = false;
-            std::mutex frameMutex;
-            std::condition_variable frameCondition;
+        // Copy to staging texture
+        StageTimer readbackTimer(CaptureStage::Readback);
+        com_ptr<ID3D11DeviceContext> context;
+        d3d11Device->GetImmediateContext(context.put());
+        context->CopySubresourceRegion(stagingTexture.get(), 0, 0, 0, 0, texture, 0, box);
 
-            Log(L"Setting up frame handler for memory capture...");
+        // Map the texture (waits for the copy)
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        winrt::check_hresult(context->Map(stagingTexture.get(), 0, D3D11_MAP_READ, 0, &mappedResource));
+        readbackTimer.Stop();
 
-            framePool.FrameArrived([&](auto const& sender, auto const& args)
-            {
-                Log(L"FrameArrived event triggered!");
+        CopyMappedFrame(mappedResource, desc.Width, desc.Height, frame, format);
 
-                auto frame = sender.TryGetNextFrame();
-                if (frame)
-                {
+        context->Unmap(stagingTexture.get(), 0);
+    }
+
+    // First frame of one monitor in a concurrent multi-monitor capture
+    // Shared with the FrameArrived handler, which may still run after the capture gave up
+    struct MonitorFrameState
+    {
+        std::mutex mutex;
+        bool done = false;
+        bool success = false;
+        RawFrame frame;
+        winrt::handle frameEvent;
+        int64_t startTicks = 0;     // When the session was started
+    };
+
+    // ScreenCapture implementation
+    ScreenCapture::ScreenCapture(ILogger* logger)
+        : m_logger(logger ? logger : &m_defaultLogger)
+    {
+        // No apartment is needed on the caller's thread; all work runs on the CaptureWorker
+    }
+
+    ScreenCapture::ScreenCapture(ILogger* logger, std::shared_ptr<CaptureWorker> worker)
+        : m_logger(logger ? logger : &m_defaultLogger)
+        , m_worker(std::move(worker))
+    {
+    }
+
+    ScreenCapture::~ScreenCapture()
+    {
+        // The stream's session was created on the worker, so release it there too
+        RunOnWorker([this]
+        {
+            m_stream.reset();
+            m_duplication.reset();
+            return ErrorCode::Success;
+        });
+    }
+
+    ErrorCode ScreenCapture::RunOnWorker(const std::function<ErrorCode()>& work) const
+    {
+        ErrorCode result = ErrorCode::UnknownError;
+        CaptureWorker& worker = m_worker ? *m_worker : CaptureWorker::Instance();
+        worker.Invoke([&]
+        {
+            result = work();
+        });
+        return result;
+    }
+
+    void ScreenCapture::Log(const std::wstring& message)
+    {
+        if (m_logger)
+        {
+            m_logger->LogInfo(message);
+        }
+    }
+
+    void ScreenCapture::LogError(const std::wstring& message)
+    {
+        if (m_logger)
+        {
+            m_logger->LogError(message);
+        }
+    }
+
+    void ScreenCapture::Log(const wchar_t* message)
+    {
+        // Literal messages are only turned into strings when someone reads them
+        if (LogEnabled())
+        {
+            m_logger->LogInfo(message);
+        }
+    }
+
+    bool ScreenCapture::LogEnabled() const
+    {
+        return m_logger && m_logger->IsEnabled();
+    }
+
+    ErrorCode ScreenCapture::CaptureToFile(const std::wstring& outputPath)
+    {
+        // Default: hide border and cursor for cleaner capture
+        return CaptureToFile(outputPath, true, true);
+    }
+
+    ErrorCode ScreenCapture::CaptureToFile(const std::wstring& outputPath, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return CaptureToFile(outputPath, EncodeOptions(), hideBorder, hideCursor, timeoutMs);
+    }
+
+    ErrorCode ScreenCapture::CaptureToFile(const std::wstring& outputPath, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return RunOnWorker([&]
+        {
+            return InternalCapture(outputPath, encodeOptions, hideBorder, hideCursor, timeoutMs);
+        });
+    }
+
+    ErrorCode ScreenCapture::CaptureToMemory(std::vector<uint8_t>& outputBuffer, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return CaptureToMemory(outputBuffer, EncodeOptions(), hideBorder, hideCursor, timeoutMs);
+    }
+
+    ErrorCode ScreenCapture::CaptureToMemory(std::vector<uint8_t>& outputBuffer, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return RunOnWorker([&]
+        {
+            return InternalCaptureToMemory(outputBuffer, encodeOptions, hideBorder, hideCursor, timeoutMs);
+        });
+    }
+
+    ErrorCode ScreenCapture::CaptureRaw(RawFrame& frame, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return CaptureRaw(frame, PixelFormat::Bgra, hideBorder, hideCursor, timeoutMs);
+    }
+
+    ErrorCode ScreenCapture::CaptureRaw(RawFrame& frame, PixelFormat format, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return RunOnWorker([&]
+        {
+            return InternalCaptureRaw(frame, format, hideBorder, hideCursor, timeoutMs);
+        });
+    }
+
+    ErrorCode ScreenCapture::StartStream(const StreamOptions& options, FrameCallback callback)
+    {
+        return RunOnWorker([&]
+        {
+            m_stream.reset();
+
+            auto stream = std::make_unique<CaptureSession>(m_logger, m_worker);
+            stream->SetAdapterOptions(m_adapterOptions);
+            auto result = stream->StartStream(std::move(callback), options);
+            if (result == ErrorCode::Success)
+            {
+                m_stream = std::move(stream);
+            }
+            return result;
+        });
+    }
+
+    ErrorCode ScreenCapture::StartFileStream(const FileStreamOptions& fileOptions, const StreamOptions& options, FileEncodeCompletion completion)
+    {
+        return RunOnWorker([&]
+        {
+            m_stream.reset();
+
+            auto stream = std::make_unique<CaptureSession>(m_logger, m_worker);
+            stream->SetAdapterOptions(m_adapterOptions);
+            auto result = stream->StartFileStream(fileOptions, options, std::move(completion));
+            if (result == ErrorCode::Success)
+            {
+                m_stream = std::move(stream);
+            }
+            return result;
+        });
+    }
+
+    void ScreenCapture::StopStream()
+    {
+        RunOnWorker([this]
+        {
+            m_stream.reset();
+            return ErrorCode::Success;
+        });
+    }
+
+    ErrorCode ScreenCapture::GetStreamStats(StreamStats& stats)
+    {
+        return RunOnWorker([&]
+        {
+            if (!m_stream)
+            {
+                LogError(L"No stream is running");
+                return ErrorCode::InvalidParameter;
+            }
+            return m_stream->GetStreamStats(stats);
+        });
+    }
+
+    void ScreenCapture::SetTarget(const CaptureTarget& target)
+    {
+        RunOnWorker([&]
+        {
+            m_target = target;
+            return ErrorCode::Success;
+        });
+    }
+
+    CaptureTarget ScreenCapture::GetTarget() const
+    {
+        CaptureTarget target;
+        RunOnWorker([&]
+        {
+            target = m_target;
+            return ErrorCode::Success;
+        });
+        return target;
+    }
+
+    void ScreenCapture::SetRegion(const CaptureRegion& region)
+    {
+        RunOnWorker([&]
+        {
+            m_region = region;
+            return ErrorCode::Success;
+        });
+    }
+
+    CaptureRegion ScreenCapture::GetRegion() const
+    {
+        CaptureRegion region;
+        RunOnWorker([&]
+        {
+            region = m_region;
+            return ErrorCode::Success;
+        });
+        return region;
+    }
+
+    void ScreenCapture::SetCaptureFormat(CaptureFormat format)
+    {
+        RunOnWorker([&]
+        {
+            m_captureFormat = format;
+            return ErrorCode::Success;
+        });
+    }
+
+    CaptureFormat ScreenCapture::GetCaptureFormat() const
+    {
+        CaptureFormat format = CaptureFormat::Bgra8;
+        RunOnWorker([&]
+        {
+            format = m_captureFormat;
+            return ErrorCode::Success;
+        });
+        return format;
+    }
+
+    void ScreenCapture::SetDeviceCache(std::shared_ptr<CaptureDeviceCache> cache)
+    {
+        RunOnWorker([&]
+        {
+            m_deviceCache = std::move(cache);
+            return ErrorCode::Success;
+        });
+    }
+
+    void ScreenCapture::SetBackend(CaptureBackend backend)
+    {
+        RunOnWorker([&]
+        {
+            m_backend = backend;
+            return ErrorCode::Success;
+        });
+    }
+
+    CaptureBackend ScreenCapture::GetBackend() const
+    {
+        CaptureBackend backend = CaptureBackend::Auto;
+        RunOnWorker([&]
+        {
+            backend = m_backend;
+            return ErrorCode::Success;
+        });
+        return backend;
+    }
+
+    void ScreenCapture::SetAdapterOptions(const AdapterOptions& options)
+    {
+        RunOnWorker([&]
+        {
+            m_adapterOptions = options;
+            return ErrorCode::Success;
+        });
+    }
+
+    AdapterOptions ScreenCapture::GetAdapterOptions() const
+    {
+        AdapterOptions options;
+        RunOnWorker([&]
+        {
+            options = m_adapterOptions;
+            return ErrorCode::Success;
+        });
+        return options;
+    }
+
+    bool ScreenCapture::UsesDesktopDuplication(bool hideBorder, bool hideCursor) const
+    {
+        if (m_captureFormat != CaptureFormat::Bgra8)
+        {
+            return false;
+        }
+
+        switch (m_backend)
+        {
+        case CaptureBackend::DesktopDuplication:
+            return true;
+        case CaptureBackend::GraphicsCapture:
+            return false;
+        default:
+            // Duplication never draws the cursor, so unless Graphics Capture is missing
+            // altogether it only stands in for captures that hide the cursor anyway
+            return !IsGraphicsCaptureSupported() ||
+                (hideCursor && (!SupportsCursorControl() || (hideBorder && !SupportsBorderControl())));
+        }
+    }
+
+    bool ScreenCapture::UsesFloatFrames() const
+    {
+        return m_captureFormat == CaptureFormat::Rgba16Float && m_target.type != CaptureTargetType::AllMonitors;
+    }
+
+    ErrorCode ScreenCapture::InternalCapture(const std::wstring& outputPath, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        if (!IsValidEncodeOptions(encodeOptions))
+        {
+            LogError(L"Invalid encode options");
+            return ErrorCode::InvalidParameter;
+        }
+
+        // JPEG XR keeps half-float captures as they are; other encoders get tone-mapped BGRA
+        const bool keepFloat = ResolveImageFormat(encodeOptions.format, outputPath) == ImageFormat::Jxr && UsesFloatFrames();
+
+        RawFrame frame;
+        auto result = InternalCaptureRaw(frame, keepFloat ? PixelFormat::Rgba16Float : PixelFormat::Bgra, hideBorder, hideCursor, timeoutMs);
+        if (result != ErrorCode::Success)
+        {
+            return result;
+        }
+
+        // Save to file
+        try
+        {
+            SaveFrameToFile(frame, outputPath, encodeOptions);
+            if (LogEnabled())
+            {
+                Log(L"Screenshot saved successfully to " + outputPath);
+            }
+        }
+        catch (...)
+        {
+            LogError(L"Error saving screenshot to file");
+            return ErrorCode::FileSaveFailed;
+        }
+
+        Log(L"Capture completed!");
+        return ErrorCode::Success;
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureToMemory(std::vector<uint8_t>& outputBuffer, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        if (!IsValidEncodeOptions(encodeOptions))
+        {
+            LogError(L"Invalid encode options");
+            return ErrorCode::InvalidParameter;
+        }
+
+        const bool keepFloat = encodeOptions.format == ImageFormat::Jxr && UsesFloatFrames();
+
+        RawFrame frame;
+        auto result = InternalCaptureRaw(frame, keepFloat ? PixelFormat::Rgba16Float : PixelFormat::Bgra, hideBorder, hideCursor, timeoutMs);
+        if (result != ErrorCode::Success)
+        {
+            return result;
+        }
+
+        // Encode in memory
+        try
+        {
+            EncodeFrame(frame, encodeOptions, outputBuffer);
+            if (LogEnabled())
+            {
+                Log(L"Screenshot encoded to memory successfully. Size: " + std::to_wstring(outputBuffer.size()) + L" bytes");
+            }
+        }
+        catch (...)
+        {
+            LogError(L"Error encoding screenshot to memory");
+            return ErrorCode::TextureProcessingFailed;
+        }
+
+        Log(L"Memory capture completed!");
+        return ErrorCode::Success;
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureRaw(RawFrame& frame, PixelFormat format, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        if (!IsValidCaptureRegion(m_region))
+        {
+            LogError(L"Invalid capture region");
+            return ErrorCode::InvalidParameter;
+        }
+
+        if (format == PixelFormat::Rgba16Float && (!UsesFloatFrames() || m_region.scale != 1.0f))
+        {
+            LogError(L"Half-float frames need CaptureFormat::Rgba16Float on a single target and cannot be scaled");
+            return ErrorCode::InvalidParameter;
+        }
+
+        if (m_target.type == CaptureTargetType::AllMonitors)
+        {
+            if (!IsFullFrameRegion(m_region))
+            {
+                LogError(L"Capture regions are not supported for the whole desktop");
+                return ErrorCode::InvalidParameter;
+            }
+
+            // The desktop is composed from BGRA monitor frames, so convert it afterwards
+            auto result = InternalCaptureAllMonitors(frame, hideBorder, hideCursor, timeoutMs);
+            if (result == ErrorCode::Success)
+            {
+                ConvertFrame(frame, format);
+            }
+            return result;
+        }
+
+        return InternalCaptureTarget(m_target, frame, format, hideBorder, hideCursor, timeoutMs);
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureAllMonitors(RawFrame& frame, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        auto monitors = EnumerateMonitors();
+        if (monitors.empty())
+        {
+            LogError(L"No monitors found");
+            return ErrorCode::CaptureItemCreationFailed;
+        }
+
+        RECT virtualBounds = monitors[0].bounds;
+        for (const auto& monitor : monitors)
+        {
+            UnionRect(&virtualBounds, &virtualBounds, &monitor.bounds);
+        }
+
+        frame.width = static_cast<uint32_t>(virtualBounds.right - virtualBounds.left);
+        frame.height = static_cast<uint32_t>(virtualBounds.bottom - virtualBounds.top);
+        frame.stride = frame.width * 4;
+        frame.timestamp = 0;
+        frame.pixels.assign(static_cast<size_t>(frame.stride) * frame.height, 0);
+
+        std::vector<RawFrame> monitorFrames;
+        auto result = InternalCaptureMonitors(monitors, monitorFrames, hideBorder, hideCursor, timeoutMs);
+        if (result != ErrorCode::Success)
+        {
+            return result;
+        }
+
+        for (size_t i = 0; i < monitors.size(); ++i)
+        {
+            const auto& monitor = monitors[i];
+            const auto& monitorFrame = monitorFrames[i];
+
+            // Place the monitor at its virtual-screen position, clipped in case the
+            // captured size and the monitor rectangle disagree (DPI virtualization)
+            const uint32_t x = static_cast<uint32_t>(monitor.bounds.left - virtualBounds.left);
+            const uint32_t y = static_cast<uint32_t>(monitor.bounds.top - virtualBounds.top);
+            const uint32_t copyWidth = std::min(monitorFrame.width, frame.width - x);
+            const uint32_t copyHeight = std::min(monitorFrame.height, frame.height - y);
+
+            CopyRows(
+                frame.pixels.data() + static_cast<size_t>(y) * frame.stride + static_cast<size_t>(x) * 4,
+                frame.stride,
+                monitorFrame.pixels.data(),
+                monitorFrame.stride,
+                static_cast<size_t>(copyWidth) * 4,
+                copyHeight
+            );
+        }
+
+        if (LogEnabled())
+        {
+            Log(L"Captured " + std::to_wstring(monitors.size()) + L" monitors: " + std::to_wstring(frame.width) + L"x" + std::to_wstring(frame.height));
+        }
+        return ErrorCode::Success;
+    }
+
+    ErrorCode ScreenCapture::CaptureAllMonitors(std::vector<RawFrame>& frames, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return RunOnWorker([&]
+        {
+            return InternalCaptureEachMonitor(frames, hideBorder, hideCursor, timeoutMs);
+        });
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureEachMonitor(std::vector<RawFrame>& frames, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        auto monitors = EnumerateMonitors();
+        if (monitors.empty())
+        {
+            LogError(L"No monitors found");
+            return ErrorCode::CaptureItemCreationFailed;
+        }
+
+        return InternalCaptureMonitors(monitors, frames, hideBorder, hideCursor, timeoutMs);
+    }
+
+    ErrorCode ScreenCapture::CaptureAllMonitorsToFiles(const std::wstring& outputPath, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return RunOnWorker([&]
+        {
+            return InternalCaptureAllMonitorsToFiles(outputPath, encodeOptions, hideBorder, hideCursor, timeoutMs);
+        });
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureAllMonitorsToFiles(const std::wstring& outputPath, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        if (outputPath.empty() || !IsValidEncodeOptions(encodeOptions))
+        {
+            LogError(L"Invalid output path or encode options");
+            return ErrorCode::InvalidParameter;
+        }
+
+        std::vector<RawFrame> frames;
+        auto result = InternalCaptureEachMonitor(frames, hideBorder, hideCursor, timeoutMs);
+        if (result != ErrorCode::Success)
+        {
+            return result;
+        }
+
+        // One encoder worker per monitor so the files are written in parallel
+        EncodePipelineOptions pipelineOptions;
+        pipelineOptions.workerCount = frames.size();
+        pipelineOptions.queueDepth = frames.size();
+        pipelineOptions.backpressure = BackpressurePolicy::Block;
+        pipelineOptions.encode = encodeOptions;
+
+        std::mutex resultMutex;
+        ErrorCode saveResult = ErrorCode::Success;
+        {
+            EncodePipeline pipeline(pipelineOptions, m_logger);
+
+            std::filesystem::path basePath(outputPath);
+            for (size_t i = 0; i < frames.size(); ++i)
+            {
+                auto monitorPath = basePath.parent_path() / (basePath.stem().wstring() + L"_" + std::to_wstring(i) + basePath.extension().wstring());
+                pipeline.SubmitToFile(std::move(frames[i]), monitorPath.wstring(), [&](ErrorCode fileResult, const std::wstring& path)
+                {
+                    if (fileResult == ErrorCode::Success)
+                    {
+                        if (LogEnabled())
+                        {
+                            Log(L"Screenshot saved successfully to " + path);
+                        }
+                        return;
+                    }
+
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    saveResult = fileResult;
+                });
+            }
+
+            pipeline.Flush();
+        }
+
+        return saveResult;
+    }
+
+    // Helper function to build the file name of one burst frame
+    // Replaces the first printf-style integer field (%d, %03d, ...) with the index;
+    // patterns without one get _<index> before the extension
+    std::wstring FormatBurstPath(const std::wstring& pattern, uint32_t index)
+    {
+        for (size_t start = pattern.find(L'%'); start != std::wstring::npos; start = pattern.find(L'%', start + 1))
+        {
+            size_t end = start + 1;
+            bool zeroPad = end < pattern.size() && pattern[end] == L'0';
+            size_t widthStart = end;
+            while (end < pattern.size() && iswdigit(pattern[end]))
+            {
+                ++end;
+            }
+
+            if (end >= pattern.size() || pattern[end] != L'd')
+            {
+                continue;
+            }
+
+            size_t width = end > widthStart ? static_cast<size_t>(_wtoi(pattern.substr(widthStart, end - widthStart).c_str())) : 0;
+            auto number = std::to_wstring(index);
+            if (number.size() < width)
+            {
+                number.insert(0, width - number.size(), zeroPad ? L'0' : L' ');
+            }
+            return pattern.substr(0, start) + number + pattern.substr(end + 1);
+        }
+
+        std::filesystem::path basePath(pattern);
+        return (basePath.parent_path() / (basePath.stem().wstring() + L"_" + std::to_wstring(index) + basePath.extension().wstring())).wstring();
+    }
+
+    // Helper function to wait until a deadline with sub-millisecond precision
+    // A high-resolution waitable timer avoids the 15.6 ms default sleep granularity
+    void SleepUntil(HANDLE timer, std::chrono::steady_clock::time_point deadline)
+    {
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero())
+        {
+            return;
+        }
+
+        if (timer)
+        {
+            // Negative due times are relative, in 100 ns units
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+            if (SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE))
+            {
+                WaitForSingleObject(timer, INFINITE);
+                return;
+            }
+        }
+
+        std::this_thread::sleep_until(deadline);
+    }
+
+    ErrorCode ScreenCapture::CaptureBurst(uint32_t count, uint32_t intervalMs, std::vector<RawFrame>& frames, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return RunOnWorker([&]
+        {
+            return InternalCaptureBurst(count, intervalMs, frames, hideBorder, hideCursor, timeoutMs);
+        });
+    }
+
+    ErrorCode ScreenCapture::CaptureBurst(uint32_t count, uint32_t intervalMs, const std::wstring& outputPattern, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        return RunOnWorker([&]
+        {
+            return InternalCaptureBurstToFiles(count, intervalMs, outputPattern, encodeOptions, hideBorder, hideCursor, timeoutMs);
+        });
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureBurst(uint32_t count, uint32_t intervalMs, std::vector<RawFrame>& frames, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        if (count == 0 || count > MaxBurstFrameCount || m_target.type == CaptureTargetType::AllMonitors)
+        {
+            LogError(L"Invalid burst frame count or target");
+            return ErrorCode::InvalidParameter;
+        }
+
+        // One session for the whole burst; with every pool buffer in use, frames keep
+        // arriving while the previous one is read back
+        CaptureSession session(m_logger, m_worker);
+        session.SetAdapterOptions(m_adapterOptions);
+        auto result = session.Open(m_target, m_captureFormat, hideBorder, hideCursor, MaxFrameBufferCount);
+        if (result == ErrorCode::Success)
+        {
+            result = session.SetRegion(m_region);
+        }
+        if (result != ErrorCode::Success)
+        {
+            return result;
+        }
+
+        winrt::handle timer{ CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS) };
+        if (!timer)
+        {
+            // High-resolution timers need Windows 10 1803
+            timer.attach(CreateWaitableTimerW(nullptr, TRUE, nullptr));
+        }
+
+        if (LogEnabled())
+        {
+            Log(L"Capturing burst of " + std::to_wstring(count) + L" frames every " + std::to_wstring(intervalMs) + L" ms...");
+        }
+
+        // Grabs run on a fixed schedule measured from the first frame, so a slow grab
+        // delays only its own frame instead of shifting every later one
+        frames.clear();
+        frames.resize(count);
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (i > 0)
+            {
+                SleepUntil(timer.get(), start + std::chrono::milliseconds(static_cast<uint64_t>(intervalMs) * i));
+            }
+
+            result = session.GrabRawFrame(frames[i], timeoutMs);
+            if (result != ErrorCode::Success)
+            {
+                frames.clear();
+                return result;
+            }
+
+            if (i == 0)
+            {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (LogEnabled())
+        {
+            Log(L"Burst captured: " + std::to_wstring(frames[0].width) + L"x" + std::to_wstring(frames[0].height));
+        }
+        return ErrorCode::Success;
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureBurstToFiles(uint32_t count, uint32_t intervalMs, const std::wstring& outputPattern, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        if (outputPattern.empty() || !IsValidEncodeOptions(encodeOptions))
+        {
+            LogError(L"Invalid output pattern or encode options");
+            return ErrorCode::InvalidParameter;
+        }
+
+        std::vector<RawFrame> frames;
+        auto result = InternalCaptureBurst(count, intervalMs, frames, hideBorder, hideCursor, timeoutMs);
+        if (result != ErrorCode::Success)
+        {
+            return result;
+        }
+
+        // Encoding starts only after the last grab so it cannot disturb the spacing
+        EncodePipelineOptions pipelineOptions;
+        pipelineOptions.workerCount = (std::min)(static_cast<size_t>((std::max)(1u, std::thread::hardware_concurrency())), frames.size());
+        pipelineOptions.queueDepth = frames.size();
+        pipelineOptions.backpressure = BackpressurePolicy::Block;
+        pipelineOptions.encode = encodeOptions;
+
+        std::mutex resultMutex;
+        ErrorCode saveResult = ErrorCode::Success;
+        {
+            EncodePipeline pipeline(pipelineOptions, m_logger);
+
+            for (uint32_t i = 0; i < frames.size(); ++i)
+            {
+                pipeline.SubmitToFile(std::move(frames[i]), FormatBurstPath(outputPattern, i), [&](ErrorCode fileResult, const std::wstring& path)
+                {
+                    if (fileResult == ErrorCode::Success)
+                    {
+                        if (LogEnabled())
+                        {
+                            Log(L"Screenshot saved successfully to " + path);
+                        }
+                        return;
+                    }
+
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    saveResult = fileResult;
+                });
+            }
+
+            pipeline.Flush();
+        }
+
+        return saveResult;
+    }
+
+    // Helper function to check whether two requests can be served from the same capture
+    bool IsSameCapture(const FrameRequest& a, const FrameRequest& b)
+    {
+        return a.target.type == b.target.type && a.target.monitorIndex == b.target.monitorIndex &&
+            a.target.monitor == b.target.monitor && a.target.window == b.target.window &&
+            a.captureFormat == b.captureFormat && a.hideBorder == b.hideBorder && a.hideCursor == b.hideCursor;
+    }
+
+    // Helper function to check whether a request can be cropped out of a full BGRA frame on the CPU
+    // Scaled regions and half-float output still need a capture of their own
+    bool CanCropFrame(const FrameRequest& request)
+    {
+        const bool floatFrames = request.captureFormat == CaptureFormat::Rgba16Float && request.target.type != CaptureTargetType::AllMonitors;
+        return request.region.scale == 1.0f && !floatFrames && (request.encode || request.pixelFormat != PixelFormat::Rgba16Float);
+    }
+
+    // Helper function to get the pixel format a request is captured in
+    PixelFormat GetRequestPixelFormat(const FrameRequest& request)
+    {
+        if (!request.encode)
+        {
+            return request.pixelFormat;
+        }
+
+        // JPEG XR keeps half-float captures as they are; other encoders get tone-mapped BGRA
+        const bool floatFrames = request.captureFormat == CaptureFormat::Rgba16Float && request.target.type != CaptureTargetType::AllMonitors;
+        return request.encodeOptions.format == ImageFormat::Jxr && floatFrames ? PixelFormat::Rgba16Float : PixelFormat::Bgra;
+    }
+
+    // Helper function to copy bytes into a caller buffer, or report the size it needs
+    ErrorCode WriteOutputBytes(const uint8_t* data, size_t size, FrameOutput& output)
+    {
+        output.size = size;
+        if (!output.buffer || output.bufferSize < size)
+        {
+            return ErrorCode::BufferTooSmall;
+        }
+
+        memcpy(output.buffer, data, size);
+        return ErrorCode::Success;
+    }
+
+    // Helper function to write width x height pixels at source (BGRA, or already in the
+    // request's pixel format when converted is set) to a request's output
+    ErrorCode WriteFrameOutput(const uint8_t* source, size_t sourceStride, uint32_t width, uint32_t height, bool converted, const FrameRequest& request, FrameOutput& output, RawFrame& scratch, std::vector<uint8_t>& encoded)
+    {
+        const PixelFormat format = GetRequestPixelFormat(request);
+        output.layout.width = width;
+        output.layout.height = height;
+
+        if (!request.encode)
+        {
+            // Raw rows go straight into the caller's buffer, converted on the way
+            output.layout.format = format;
+            output.layout.stride = width * BytesPerPixel(format);
+            output.size = output.layout.Size();
+            if (!output.buffer || output.bufferSize < output.size)
+            {
+                return ErrorCode::BufferTooSmall;
+            }
+
+            if (converted)
+            {
+                CopyRows(output.buffer, output.layout.stride, source, sourceStride, output.layout.stride, height);
+            }
+            else
+            {
+                ConvertPixels(source, sourceStride, output.buffer, output.layout.stride, width, height, format);
+            }
+            return ErrorCode::Success;
+        }
+
+        // Encoders read a RawFrame; crops are copied into a reused one first
+        const uint32_t rowBytes = width * BytesPerPixel(format);
+        scratch.width = width;
+        scratch.height = height;
+        scratch.stride = rowBytes;
+        scratch.format = format;
+        scratch.pixels.resize(static_cast<size_t>(rowBytes) * height);
+        CopyRows(scratch.pixels.data(), rowBytes, source, sourceStride, rowBytes, height);
+
+        output.layout.format = format;
+        output.layout.stride = 0;
+        EncodeFrame(scratch, request.encodeOptions, encoded);
+        return WriteOutputBytes(encoded.data(), encoded.size(), output);
+    }
+
+    ErrorCode ScreenCapture::CaptureFrames(const FrameRequest* requests, FrameOutput* outputs, size_t count)
+    {
+        if (count > 0 && (!requests || !outputs))
+        {
+            LogError(L"Frame requests and outputs are required");
+            return ErrorCode::InvalidParameter;
+        }
+
+        return RunOnWorker([&]
+        {
+            return InternalCaptureFrames(requests, outputs, count);
+        });
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureFrames(const FrameRequest* requests, FrameOutput* outputs, size_t count)
+    {
+        // Requests bring their own target, region and format; restore the object's
+        // selection however the batch ends
+        struct SelectionGuard
+        {
+            ScreenCapture& capture;
+            const CaptureTarget target;
+            const CaptureRegion region;
+            const CaptureFormat captureFormat;
+
+            ~SelectionGuard()
+            {
+                capture.m_target = target;
+                capture.m_region = region;
+                capture.m_captureFormat = captureFormat;
+            }
+        };
+        SelectionGuard selectionGuard{ *this, m_target, m_region, m_captureFormat };
+
+        ErrorCode firstError = ErrorCode::Success;
+        std::vector<bool> served(count, false);
+        RawFrame frame;
+        RawFrame scratch;
+        std::vector<uint8_t> encoded;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (served[i])
+            {
+                continue;
+            }
+
+            const FrameRequest& request = requests[i];
+
+            // Later requests this capture can serve too
+            std::vector<size_t> group(1, i);
+            if (CanCropFrame(request))
+            {
+                for (size_t j = i + 1; j < count; ++j)
+                {
+                    if (!served[j] && CanCropFrame(requests[j]) && IsSameCapture(request, requests[j]))
+                    {
+                        group.push_back(j);
+                    }
+                }
+            }
+
+            // A lone request is cropped, scaled and converted during readback; a group
+            // reads back the whole BGRA frame once and crops each request out of it
+            const bool shared = group.size() > 1;
+            uint32_t timeoutMs = 0;
+            for (size_t index : group)
+            {
+                timeoutMs = (std::max)(timeoutMs, requests[index].timeoutMs);
+                outputs[index].size = 0;
+                outputs[index].layout = FrameLayout();
+            }
+
+            m_target = request.target;
+            m_captureFormat = request.captureFormat;
+            m_region = shared ? CaptureRegion() : request.region;
+
+            ErrorCode captureResult = ErrorCode::InvalidParameter;
+            if (!request.encode || IsValidEncodeOptions(request.encodeOptions) || shared)
+            {
+                captureResult = InternalCaptureRaw(frame, shared ? PixelFormat::Bgra : GetRequestPixelFormat(request), request.hideBorder, request.hideCursor, timeoutMs);
+            }
+
+            for (size_t index : group)
+            {
+                served[index] = true;
+                const FrameRequest& member = requests[index];
+                FrameOutput& output = outputs[index];
+                output.result = captureResult;
+
+                if (captureResult == ErrorCode::Success)
+                {
+                    try
+                    {
+                        if (member.encode && !IsValidEncodeOptions(member.encodeOptions))
+                        {
+                            output.result = ErrorCode::InvalidParameter;
+                        }
+                        else if (!shared)
+                        {
+                            output.result = WriteFrameOutput(frame.pixels.data(), frame.stride, frame.width, frame.height, true, member, output, scratch, encoded);
+                        }
+                        else
+                        {
+                            D3D11_BOX box;
+                            uint32_t width = 0;
+                            uint32_t height = 0;
+                            if (!ResolveCaptureRegion(member.region, frame.width, frame.height, box, width, height))
+                            {
+                                output.result = ErrorCode::InvalidParameter;
+                            }
+                            else
+                            {
+                                const uint8_t* source = frame.pixels.data() + static_cast<size_t>(box.top) * frame.stride + static_cast<size_t>(box.left) * 4;
+                                output.result = WriteFrameOutput(source, frame.stride, width, height, member.pixelFormat == PixelFormat::Bgra || member.encode, member, output, scratch, encoded);
+                            }
+                        }
+                    }
+                    catch (...)
+                    {
+                        output.result = ErrorCode::TextureProcessingFailed;
+                    }
+                }
+
+                if (output.result != ErrorCode::Success && firstError == ErrorCode::Success)
+                {
+                    firstError = output.result;
+                }
+            }
+        }
+
+        if (LogEnabled())
+        {
+            Log(L"Captured " + std::to_wstring(count) + L" frames in one batch");
+        }
+        return firstError;
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureMonitors(const std::vector<MonitorInfo>& monitors, std::vector<RawFrame>& frames, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        if (monitors.size() > MAXIMUM_WAIT_OBJECTS)
+        {
+            LogError(L"Too many monitors to capture at once");
+            return ErrorCode::InvalidParameter;
+        }
+
+        try
+        {
+            if (LogEnabled())
+            {
+                Log(L"Capturing " + std::to_wstring(monitors.size()) + L" monitors concurrently...");
+            }
+
+            // 1. One device shared by every session; the free-threaded handlers read
+            // back on pool threads at the same time, so protect the immediate context
+            // Monitors on other adapters than the primary one are copied across by the OS
+            com_ptr<ID3D11Device> d3d11Device;
+            IDirect3DDevice direct3DDevice{ nullptr };
+            auto adapter = SelectAdapter(m_adapterOptions, monitors[0].handle);
+            AcquireDevice(m_deviceCache.get(), adapter.get(), d3d11Device, direct3DDevice);
+            if (auto multithread = d3d11Device.try_as<ID3D11Multithread>())
+            {
+                multithread->SetMultithreadProtected(TRUE);
+            }
+
+            // 2. Create a frame pool and session per monitor
+            std::vector<std::shared_ptr<MonitorFrameState>> states;
+            std::vector<Direct3D11CaptureFramePool> framePools;
+            std::vector<GraphicsCaptureSession> sessions;
+            std::vector<HANDLE> frameEvents;
+
+            auto closeAll = [&]()
+            {
+                for (auto& session : sessions)
+                {
+                    session.Close();
+                }
+                for (auto& framePool : framePools)
+                {
+                    framePool.Close();
+                }
+            };
+
+            for (const auto& monitor : monitors)
+            {
+                GraphicsCaptureItem captureItem{ nullptr };
+                try
+                {
+                    captureItem = AcquireMonitorItem(m_deviceCache.get(), monitor.handle);
+                }
+                catch (hresult_error const& ex)
+                {
+                    LogError(L"Failed to create capture item for " + monitor.deviceName + L": " + std::wstring(ex.message()));
+                    closeAll();
+                    return ErrorCode::CaptureItemCreationFailed;
+                }
+
+                auto state = std::make_shared<MonitorFrameState>();
+                state->frameEvent.attach(CreateEventW(nullptr, TRUE, FALSE, nullptr));
+                winrt::check_bool(static_cast<bool>(state->frameEvent));
+
+                auto framePool = Direct3D11CaptureFramePool::CreateFreeThreaded(
+                    direct3DDevice,
+                    DirectXPixelFormat::B8G8R8A8UIntNormalized,
+                    1,
+                    captureItem.Size()
+                );
+
+                framePool.FrameArrived([state, d3d11Device](auto const& sender, auto const&)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (state->done)
+                    {
+                        return;
+                    }
+
+                    auto capturedFrame = sender.TryGetNextFrame();
+                    if (!capturedFrame)
+                    {
+                        return;
+                    }
+                    RecordCaptureStage(CaptureStage::FirstFrameWait, QueryCaptureTicks() - state->startTicks);
+
+                    try
+                    {
+                        ReadbackTexture(d3d11Device, GetFrameTexture(capturedFrame).get(), state->frame);
+                        state->success = true;
+                    }
+                    catch (...)
+                    {
+                        // Reported as TextureProcessingFailed below
+                    }
+
+                    state->done = true;
+                    SetEvent(state->frameEvent.get());
+                });
+
+                auto session = framePool.CreateCaptureSession(captureItem);
+                ConfigureCaptureSession(session, hideBorder, hideCursor);
+
+                frameEvents.push_back(state->frameEvent.get());
+                states.push_back(state);
+                framePools.push_back(framePool);
+                sessions.push_back(session);
+            }
+
+            // 3. Start every session back to back so the frames line up in time
+            for (size_t i = 0; i < sessions.size(); ++i)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(states[i]->mutex);
+                    states[i]->startTicks = QueryCaptureTicks();
+                }
+                sessions[i].StartCapture();
+            }
+
+            // 4. Wait for all first frames together
+            DWORD waitResult = WaitForMultipleObjects(static_cast<DWORD>(frameEvents.size()), frameEvents.data(), TRUE, timeoutMs);
+            closeAll();
+
+            if (waitResult >= WAIT_OBJECT_0 + frameEvents.size())
+            {
+                // Handlers still in flight must not write into frames we return
+                for (auto& state : states)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->done = true;
+                }
+
+                LogError(L"Timeout: Not every monitor delivered a frame within " + std::to_wstring(timeoutMs) + L" ms");
+                return ErrorCode::TimeoutError;
+            }
+
+            frames.resize(states.size());
+            for (size_t i = 0; i < states.size(); ++i)
+            {
+                std::lock_guard<std::mutex> lock(states[i]->mutex);
+                if (!states[i]->success)
+                {
+                    LogError(L"Error processing frame for " + monitors[i].deviceName);
+                    return ErrorCode::TextureProcessingFailed;
+                }
+                frames[i] = std::move(states[i]->frame);
+            }
+
+            Log(L"All monitor frames received");
+            return ErrorCode::Success;
+        }
+        catch (hresult_error const& ex)
+        {
+            ReportDeviceError(m_deviceCache.get(), ex.code());
+            LogError(L"Capture error: " + std::wstring(ex.message()));
+            return ErrorCode::CaptureSessionFailed;
+        }
+        catch (...)
+        {
+            LogError(L"Unknown error occurred");
+            return ErrorCode::UnknownError;
+        }
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureTarget(const CaptureTarget& target, RawFrame& frame, PixelFormat format, bool hideBorder, bool hideCursor, uint32_t timeoutMs)
+    {
+        HMONITOR monitor = nullptr;
+        HWND window = nullptr;
+        if (!ResolveCaptureTarget(target, monitor, window))
+        {
+            LogError(L"Invalid capture target");
+            return ErrorCode::InvalidParameter;
+        }
+
+        if (!window && UsesDesktopDuplication(hideBorder, hideCursor))
+        {
+            auto result = InternalCaptureDuplication(monitor, frame, format, timeoutMs);
+            if (result == ErrorCode::Success || m_backend == CaptureBackend::DesktopDuplication)
+            {
+                return result;
+            }
+            Log(L"Desktop Duplication failed, falling back to Graphics Capture");
+        }
+        else if (m_backend == CaptureBackend::DesktopDuplication)
+        {
+            LogError(L"Desktop Duplication only captures monitors in BGRA8");
+            return ErrorCode::InvalidParameter;
+        }
+
+        try
+        {
+            Log(L"Initializing capture system...");
+
+            GraphicsCaptureItem captureItem{ nullptr };
+            try
+            {
+                captureItem = window ? CreateCaptureItemForWindow(window) : AcquireMonitorItem(m_deviceCache.get(), monitor);
+            }
+            catch (hresult_error const& ex)
+            {
+                LogError(L"Failed to create capture item: " + std::wstring(ex.message()));
+                return ErrorCode::CaptureItemCreationFailed;
+            }
+
+            // Create the device on the GPU that scans out the target, so frames
+            // arrive without a cross-adapter copy
+            auto adapter = SelectAdapter(m_adapterOptions, GetTargetMonitor(monitor, window));
+            auto [session, framePool, d3d11Device] = SetupCaptureSession(captureItem, hideBorder, hideCursor, m_captureFormat, m_deviceCache.get(), adapter.get());
+            auto poolSize = captureItem.Size();
+
+            // Half-float frames are tone-mapped to BGRA unless the caller keeps them
+            const bool toneMap = m_captureFormat == CaptureFormat::Rgba16Float && format != PixelFormat::Rgba16Float;
+            const float whiteScale = toneMap ? GetSdrWhiteScale(GetTargetMonitor(monitor, window)) : 1.0f;
+
+            // Setup frame processing
+            bool captureSuccess = false;
+            winrt::handle frameEvent{ CreateEventW(nullptr, TRUE, FALSE, nullptr) };
+            winrt::check_bool(static_cast<bool>(frameEvent));
+
+            Log(L"Setting up frame handler...");
+
+            FrameToneMapper toneMapper;
+            FrameScaler scaler;
+            int64_t startTicks = 0;
+            bool firstFrameRecorded = false;
+            framePool.FrameArrived([&](auto const& sender, auto const& args)
+            {
+                Log(L"FrameArrived event triggered!");
+
+                auto capturedFrame = sender.TryGetNextFrame();
+                if (capturedFrame && !firstFrameRecorded)
+                {
+                    RecordCaptureStage(CaptureStage::FirstFrameWait, QueryCaptureTicks() - startTicks);
+                    firstFrameRecorded = true;
+                }
+                if (capturedFrame && capturedFrame.ContentSize() != poolSize)
+                {
+                    // The target was resized (or a cached item outlived a mode change):
+                    // resize the pool and take the next frame, which has the new size
+                    try
+                    {
+                        poolSize = capturedFrame.ContentSize();
+                        sender.Recreate(CreateDirect3DDeviceFromD3D11Device(d3d11Device), GetSurfaceFormat(m_captureFormat), 1, poolSize);
+                        Log(L"Capture size changed, recreated frame pool");
+                        return;
+                    }
+                    catch (hresult_error const& ex)
+                    {
+                        LogError(L"Failed to recreate frame pool: " + std::wstring(ex.message()));
+                    }
+                }
+
+                if (capturedFrame)
+                {
                     try
                     {
-                        Log(L"Frame captured! Processing to memory...");
+                        Log(L"Frame captured! Reading back...");
+
+                        // Crop and scale on the GPU so only the region is read back
+                        auto texture = GetFrameTexture(capturedFrame);
+                        com_ptr<ID3D11DeviceContext> context;
+                        d3d11Device->GetImmediateContext(context.put());
+
+                        ID3D11Texture2D* frameTexture = texture.get();
+                        if (toneMap)
+                        {
+                            frameTexture = toneMapper.Process(d3d11Device.get(), context.get(), frameTexture, whiteScale);
+                        }
+
+                        D3D11_BOX box;
+                        auto source = scaler.Process(d3d11Device.get(), context.get(), frameTexture, m_region, box);
+                        ReadbackTexture(d3d11Device, source, frame, &box, format);
+
+                        if (LogEnabled())
+                        {
+                            Log(L"Texture size: " + std::to_wstring(frame.width) + L"x" + std::to_wstring(frame.height));
+                        }
+                        captureSuccess = true;
+                    }
+                    catch (hresult_error const& ex)
+                    {
+                        ReportDeviceError(m_deviceCache.get(), ex.code());
+                        LogError(L"Error processing frame: " + std::wstring(ex.message()));
+                    }
+
+                    // Signal completion
+                    SetEvent(frameEvent.get());
+                }
+                else
+                {
+                    LogError(L"No frame available");
+                }
+            });
+
+            // Start capture
+            Log(L"Starting capture session...");
+            startTicks = QueryCaptureTicks();
+            session.StartCapture();
+
+            // Wait for frame with timeout, dispatching messages so FrameArrived can fire
+            if (LogEnabled())
+            {
+                Log(L"Waiting for frame (timeout: " + std::to_wstring(timeoutMs) + L" ms)...");
+            }
+            bool frameReceived = WaitForFrameEvent(frameEvent.get(), timeoutMs);
+
+            // Cleanup
+            session.Close();
+            framePool.Close();
+
+            if (frameReceived)
+            {
+                Log(L"Frame received and processed!");
+            }
+            else
+            {
+                LogError(L"Timeout: No frame received within " + std::to_wstring(timeoutMs) + L" ms");
+                return ErrorCode::TimeoutError;
+            }
+
+            return captureSuccess ? ErrorCode::Success : ErrorCode::TextureProcessingFailed;
+        }
+        catch (hresult_error const& ex)
+        {
+            ReportDeviceError(m_deviceCache.get(), ex.code());
+            LogError(L"Capture error: " + std::wstring(ex.message()));
+            return ErrorCode::CaptureSessionFailed;
+        }
+        catch (std::exception const& ex)
+        {
+            std::wstring errorMsg(ex.what(), ex.what() + strlen(ex.what()));
+            LogError(L"Standard error: " + errorMsg);
+            return ErrorCode::UnknownError;
+        }
+        catch (...)
+        {
+            LogError(L"Unknown error occurred");
+            return ErrorCode::UnknownError;
+        }
+    }
+
+    ErrorCode ScreenCapture::InternalCaptureDuplication(HMONITOR monitor, RawFrame& frame, PixelFormat format, uint32_t timeoutMs)
+    {
+        try
+        {
+            Log(L"Capturing through Desktop Duplication...");
+
+            // Keep polling on the device the duplication was opened on unless a cache
+            // decides or another adapter was selected
+            auto adapter = SelectAdapter(m_adapterOptions, monitor);
+            com_ptr<ID3D11Device> d3d11Device;
+            if (m_deviceCache)
+            {
+                IDirect3DDevice direct3DDevice{ nullptr };
+                m_deviceCache->GetDevice(adapter.get(), d3d11Device, direct3DDevice);
+            }
+            else if (m_duplication && m_duplication->IsOpen(monitor) && GetDeviceAdapterKey(m_duplication->GetDevice()) == GetAdapterKey(adapter.get()))
+            {
+                d3d11Device.copy_from(m_duplication->GetDevice());
+            }
+            else
+            {
+                d3d11Device = CreateD3DDevice(adapter.get());
+            }
+
+            if (!m_duplication)
+            {
+                m_duplication = std::make_unique<DesktopDuplication>();
+            }
+            m_duplication->Open(d3d11Device.get(), monitor);
+
+            const int64_t startTicks = QueryCaptureTicks();
+            ID3D11Texture2D* texture = m_duplication->AcquireFrame(timeoutMs);
+            if (!texture)
+            {
+                LogError(L"Timeout: No frame received within " + std::to_wstring(timeoutMs) + L" ms");
+                return ErrorCode::TimeoutError;
+            }
+            RecordCaptureStage(CaptureStage::FirstFrameWait, QueryCaptureTicks() - startTicks);
+
+            // Crop and scale on the GPU so only the region is read back
+            com_ptr<ID3D11DeviceContext> context;
+            d3d11Device->GetImmediateContext(context.put());
+
+            FrameScaler scaler;
+            D3D11_BOX box;
+            auto source = scaler.Process(d3d11Device.get(), context.get(), texture, m_region, box);
+            ReadbackTexture(d3d11Device, source, frame, &box, format);
+
+            if (LogEnabled())
+            {
+                Log(L"Texture size: " + std::to_wstring(frame.width) + L"x" + std::to_wstring(frame.height) +
+                    L", " + std::to_wstring(m_duplication->GetDirtyRects().size()) + L" changed areas");
+            }
+            return ErrorCode::Success;
+        }
+        catch (hresult_error const& ex)
+        {
+            ReportDeviceError(m_deviceCache.get(), ex.code());
+            m_duplication.reset();
+            LogError(L"Desktop Duplication error: " + std::wstring(ex.message()));
+            return ErrorCode::CaptureSessionFailed;
+        }
+    }
+
+    // Size, capture time and sequence number of a frame copied into the staging ring
+    struct StagedFrameInfo
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        int64_t timestamp = 0;
+        uint64_t sequence = 0;
+        uint64_t submission = 0;            // Frames submitted to the ring up to this one; gaps mean overwritten frames
+        std::vector<DirtyRect> dirtyRects;  // Only filled when MapNewest takes them
+    };
+
+    // Ring of staging textures for GPU-to-CPU readback
+    // Frames are copied into a free slot as they arrive and only mapped when a
+    // caller reads them, so the copy of frame N overlaps the map of frame N-1
+    // and Map rarely has to wait for the GPU. Slots are cached until the copied
+    // size or format changes.
+    class StagingTextureRing
+    {
+    public:
+        // One slot being mapped, one holding the newest copy, one free for the next copy
+        static constexpr size_t SlotCount = 3;
+
+        // Dirty rectangles kept before they collapse into one for the whole frame
+        static constexpr size_t MaxDirtyRects = 64;
+
+        // Issue a copy of the box of the texture into a free slot and make it the newest
+        // dirtyRects are added to those collected since the last MapNewest that took them
+        void Submit(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* texture, const D3D11_BOX& box, const std::vector<DirtyRect>& dirtyRects, int64_t timestamp, uint64_t sequence)
+        {
+            D3D11_TEXTURE2D_DESC desc;
+            texture->GetDesc(&desc);
+            desc.Width = box.right - box.left;
+            desc.Height = box.bottom - box.top;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (desc.Width != m_desc.Width || desc.Height != m_desc.Height || desc.Format != m_desc.Format)
+            {
+                Recreate(device, desc);
+            }
+
+            // Pick the next slot that is neither being mapped nor the newest copy
+            size_t slot = (m_newest + 1) % SlotCount;
+            while (m_slots[slot].mapped || static_cast<int>(slot) == m_newest)
+            {
+                slot = (slot + 1) % SlotCount;
+            }
+
+            context->CopySubresourceRegion(m_slots[slot].texture.get(), 0, 0, 0, 0, texture, 0, &box);
+
+            // Submit the copy now so it is finished by the time the slot is mapped
+            context->Flush();
+
+            m_slots[slot].timestamp = timestamp;
+            m_slots[slot].sequence = sequence;
+            m_slots[slot].submission = ++m_submitted;
+            m_newest = static_cast<int>(slot);
+            AddDirtyRects(dirtyRects);
+        }
+
+        // Map the newest slot and hand the mapped data to reader(mappedResource, info)
+        // With takeDirtyRects, info carries the areas changed since the previous take
+        // Returns false if no frame has been submitted yet
+        template <typename Reader>
+        bool MapNewest(ID3D11DeviceContext* context, Reader&& reader, bool takeDirtyRects = false)
+        {
+            com_ptr<ID3D11Texture2D> texture;
+            size_t slot = 0;
+            StagedFrameInfo info;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_newest < 0)
+                {
+                    return false;
+                }
+
+                slot = static_cast<size_t>(m_newest);
+                m_slots[slot].mapped = true;
+                texture = m_slots[slot].texture;
+                info.width = m_desc.Width;
+                info.height = m_desc.Height;
+                info.timestamp = m_slots[slot].timestamp;
+                info.sequence = m_slots[slot].sequence;
+                info.submission = m_slots[slot].submission;
+                if (takeDirtyRects)
+                {
+                    info.dirtyRects.swap(m_dirtyRects);
+                    m_dirtyRects.clear();
+                    m_dirtyFullFrame = false;
+                }
+            }
+
+            StageTimer mapTimer(CaptureStage::Readback);
+            D3D11_MAPPED_SUBRESOURCE mappedResource;
+            HRESULT hr = context->Map(texture.get(), 0, D3D11_MAP_READ, 0, &mappedResource);
+            if (SUCCEEDED(hr))
+            {
+                mapTimer.Stop();
+                try
+                {
+                    reader(mappedResource, static_cast<const StagedFrameInfo&>(info));
+                }
+                catch (...)
+                {
+                    context->Unmap(texture.get(), 0);
+                    ReleaseSlot(slot, texture);
+                    throw;
+                }
+                context->Unmap(texture.get(), 0);
+            }
+
+            ReleaseSlot(slot, texture);
+
+            winrt::check_hresult(hr);
+            return true;
+        }
+
+        // Map the newest slot and copy it into a raw frame, converted to format
+        // Returns false if no frame has been submitted yet
+        bool ReadNewest(ID3D11DeviceContext* context, RawFrame& frame, PixelFormat format = PixelFormat::Bgra)
+        {
+            return MapNewest(context, [&](const D3D11_MAPPED_SUBRESOURCE& mappedResource, const StagedFrameInfo& info)
+            {
+                CopyMappedFrame(mappedResource, info.width, info.height, frame, format);
+                frame.timestamp = info.timestamp;
+            });
+        }
+
+        void Reset()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slots = {};
+            m_desc = {};
+            m_newest = -1;
+            m_dirtyRects.clear();
+            m_dirtyFullFrame = false;
+        }
+
+    private:
+        struct Slot
+        {
+            com_ptr<ID3D11Texture2D> texture;
+            bool mapped = false;
+            int64_t timestamp = 0;
+            uint64_t sequence = 0;
+            uint64_t submission = 0;
+        };
+
+        std::mutex m_mutex;
+        std::array<Slot, SlotCount> m_slots;
+        D3D11_TEXTURE2D_DESC m_desc{};
+        int m_newest = -1;
+        uint64_t m_submitted = 0;
+        std::vector<DirtyRect> m_dirtyRects;
+        bool m_dirtyFullFrame = false;
+
+        void AddDirtyRects(const std::vector<DirtyRect>& dirtyRects)
+        {
+            if (m_dirtyFullFrame || dirtyRects.empty())
+            {
+                return;
+            }
+
+            m_dirtyRects.insert(m_dirtyRects.end(), dirtyRects.begin(), dirtyRects.end());
+            bool fullFrame = m_dirtyRects.size() > MaxDirtyRects;
+            for (const auto& rect : dirtyRects)
+            {
+                fullFrame = fullFrame || (rect.width >= m_desc.Width && rect.height >= m_desc.Height);
+            }
+
+            if (fullFrame)
+            {
+                m_dirtyRects.assign(1, DirtyRect{ 0, 0, m_desc.Width, m_desc.Height });
+                m_dirtyFullFrame = true;
+            }
+        }
+
+        void ReleaseSlot(size_t slot, const com_ptr<ID3D11Texture2D>& texture)
+        {
+            // The ring may have been recreated meanwhile; only release our own slot
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_slots[slot].texture == texture)
+            {
+                m_slots[slot].mapped = false;
+            }
+        }
+
+        void Recreate(ID3D11Device* device, const D3D11_TEXTURE2D_DESC& sourceDesc)
+        {
+            D3D11_TEXTURE2D_DESC desc = sourceDesc;
+            desc.Usage = D3D11_USAGE_STAGING;
+            desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+            desc.BindFlags = 0;
+            desc.MiscFlags = 0;
+
+            std::array<Slot, SlotCount> slots;
+            for (auto& slot : slots)
+            {
+                winrt::check_hresult(device->CreateTexture2D(&desc, nullptr, slot.texture.put()));
+            }
+
+            m_slots = std::move(slots);
+            m_desc = sourceDesc;
+            m_newest = -1;
+
+            // Nothing of the old size carries over
+            m_dirtyRects.assign(1, DirtyRect{ 0, 0, m_desc.Width, m_desc.Height });
+            m_dirtyFullFrame = true;
+        }
+    };
+
+    // Helper function to ask a session to report dirty regions with each frame
+    // Returns false when the system or SDK does not support it
+    bool EnableDirtyRegions(GraphicsCaptureSession const& session)
+    {
+#ifdef SCREENCAPTURE_HAS_DIRTY_REGIONS
+        try
+        {
+            if (winrt::Windows::Foundation::Metadata::ApiInformation::IsPropertyPresent(L"Windows.Graphics.Capture.GraphicsCaptureSession", L"DirtyRegionMode"))
+            {
+                session.DirtyRegionMode(GraphicsCaptureDirtyRegionMode::ReportOnly);
+                return true;
+            }
+        }
+        catch (...)
+        {
+            // Fall back to tile hashes
+        }
+#endif
+        return false;
+    }
+
+    // Helper function to check whether sessions can be asked for a minimum update interval
+    bool SupportsMinUpdateInterval()
+    {
+#ifdef SCREENCAPTURE_HAS_MIN_UPDATE_INTERVAL
+        try
+        {
+            return winrt::Windows::Foundation::Metadata::ApiInformation::IsPropertyPresent(L"Windows.Graphics.Capture.GraphicsCaptureSession", L"MinUpdateInterval");
+        }
+        catch (...)
+        {
+            // Pace frames only after they arrive
+        }
+#endif
+        return false;
+    }
+
+    // Helper function to ask a session not to present frames more often than interval (100 ns units)
+    void SetMinUpdateInterval(GraphicsCaptureSession const& session, int64_t interval)
+    {
+#ifdef SCREENCAPTURE_HAS_MIN_UPDATE_INTERVAL
+        try
+        {
+            session.MinUpdateInterval(winrt::Windows::Foundation::TimeSpan(interval));
+        }
+        catch (...)
+        {
+            // The scheduler still skips frames that arrive early
+        }
+#else
+        (void)session;
+        (void)interval;
+#endif
+    }
+
+    // CaptureSession implementation
+    struct CaptureSession::Impl
+    {
+        com_ptr<ID3D11Device> d3d11Device;
+        com_ptr<ID3D11DeviceContext> context;
+        IDirect3DDevice direct3DDevice{ nullptr };
+        GraphicsCaptureItem captureItem{ nullptr };
+        Direct3D11CaptureFramePool framePool{ nullptr };
+        GraphicsCaptureSession session{ nullptr };
+        Direct3D11CaptureFramePool::FrameArrived_revoker frameArrivedRevoker;
+        winrt::Windows::Graphics::SizeInt32 poolSize{};
+        int32_t bufferCount = DefaultFrameBufferCount;
+        CaptureFormat captureFormat = CaptureFormat::Bgra8;
+
+        // Half-float frames are tone-mapped to BGRA before the scaler (frame pool thread only)
+        FrameToneMapper toneMapper;
+        float whiteScale = 1.0f;
+
+        // Arrived frames are copied straight into the ring and handed back to the pool
+        StagingTextureRing stagingRing;
+
+        // Part of each frame copied into the ring (region guarded by regionMutex,
+        // scaler only used on the frame pool thread)
+        std::mutex regionMutex;
+        CaptureRegion region;
+        FrameScaler scaler;
+
+        // Change detection state (frame pool thread only, except the flags)
+        FrameChangeDetector changeDetector;
+        std::vector<DirtyRect> frameDirtyRects;
+        std::atomic<bool> osDirtyRegions{ false };      // Session reports dirty regions itself
+        std::atomic<bool> changesReset{ false };        // Report the next frame as changed as a whole
+
+        // Shared texture for GPU consumers (pointer guarded by sharedMutex)
+        std::mutex sharedMutex;
+        std::shared_ptr<SharedFrameTexture> sharedTexture;
+
+        // Number of frames seen by the frame pool, including ones a stream dropped
+        std::atomic<uint64_t> arrivedCount{ 0 };
+
+        // When StartCapture was called, for the first frame wait
+        int64_t startTicks = 0;
+
+        // Number of frames copied into the ring (guarded by frameMutex)
+        std::mutex frameMutex;
+        std::condition_variable frameCondition;
+        uint64_t frameCount = 0;
+
+        // Serializes readers of the ring
+        std::mutex grabMutex;
+
+        // Scratch frame reused by GrabFrame so steady-state PNG grabs keep their buffers
+        std::mutex encodeMutex;
+        RawFrame encodeFrame;
+
+        // Stream callback and options (guarded by streamMutex)
+        // callbackMutex is held while the callback runs, so StopStream waits for an
+        // in-flight callback without the frame pool thread waiting for it as well;
+        // it is always taken before streamMutex
+        std::mutex streamMutex;
+        std::mutex callbackMutex;
+        FrameCallback streamCallback;
+        StreamOptions streamOptions;
+        uint64_t lastDeliveredSubmission = 0;   // Guarded by callbackMutex
+
+        // Stream pacing and counters
+        FrameScheduler scheduler;
+        std::atomic<bool> minUpdateIntervalSupported{ false };
+
+        // Delivery thread for StreamDelivery::LatestOnly
+        std::thread deliveryThread;
+        std::mutex deliveryMutex;
+        std::condition_variable deliveryCondition;
+        bool deliveryPending = false;
+        bool deliveryStop = false;
+
+        bool WaitForFirstFrame(uint32_t timeoutMs)
+        {
+            std::unique_lock<std::mutex> lock(frameMutex);
+            return frameCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return frameCount > 0; });
+        }
+
+        void OnFrameArrived(Direct3D11CaptureFramePool const& sender)
+        {
+            auto frame = sender.TryGetNextFrame();
+            if (!frame)
+            {
+                return;
+            }
+
+            auto contentSize = frame.ContentSize();
+            int64_t timestamp = frame.SystemRelativeTime().count();
+            uint64_t sequence = ++arrivedCount;
+            if (sequence == 1)
+            {
+                RecordCaptureStage(CaptureStage::FirstFrameWait, QueryCaptureTicks() - startTicks);
+            }
+            auto texture = GetFrameTexture(frame);
+
+            // Frames a stream is not due for are neither delivered nor copied for readback
+            bool streaming = false;
+            bool due = false;
+            bool textureStream = false;
+            bool deliverInline = false;
+            bool deliverOnThread = false;
+            ChangeDetection changeDetection = ChangeDetection::Off;
+            {
+                std::lock_guard<std::mutex> lock(streamMutex);
+                if (streamCallback)
+                {
+                    streaming = true;
+                    due = scheduler.ShouldDeliver(timestamp);
+                    textureStream = streamOptions.deliverTexture;
+                    deliverInline = due && !textureStream && streamOptions.delivery == StreamDelivery::EveryFrame;
+                    deliverOnThread = due && !textureStream && !deliverInline;
+                    changeDetection = streamOptions.changeDetection;
+                }
+            }
+
+            // Follow backoff with the system's own update interval
+            int64_t interval = 0;
+            if (streaming && minUpdateIntervalSupported && scheduler.TakeIntervalChange(interval))
+            {
+                SetMinUpdateInterval(session, interval);
+            }
+
+            // Texture streams get the frame pool surface itself, with no readback
+            if (textureStream && due)
+            {
+                DeliverTexture(texture.get(), timestamp, sequence);
+            }
+
+            // GPU consumers get the full frame pool surface through the shared texture
+            std::shared_ptr<SharedFrameTexture> shared;
+            {
+                std::lock_guard<std::mutex> lock(sharedMutex);
+                shared = sharedTexture;
+            }
+            if (shared)
+            {
+                try
+                {
+                    shared->Publish(d3d11Device.get(), context.get(), texture.get());
+                }
+                catch (...)
+                {
+                    // Keep feeding the staging ring and streams
+                }
+            }
+
+            // With sharing, staging copies are only made for pixel streams unless asked for
+            const bool pixelStream = deliverInline || deliverOnThread;
+            const bool skipped = streaming && !due;
+            const bool feedRing = !textureStream && !skipped && (!shared || !shared->Options().skipReadback || pixelStream);
+
+            // Tile hashes compare against the last hashed frame, but the session's dirty regions
+            // only cover one frame: those of a skipped frame are lost, so the next one is whole
+            if (skipped && osDirtyRegions)
+            {
+                changesReset = true;
+            }
+
+            bool submitted = false;
+            if (feedRing)
+            {
+                CaptureRegion currentRegion;
+                {
+                    std::lock_guard<std::mutex> lock(regionMutex);
+                    currentRegion = region;
+                }
+
+                ID3D11Texture2D* frameTexture = texture.get();
+                if (captureFormat == CaptureFormat::Rgba16Float)
+                {
+                    frameTexture = toneMapper.Process(d3d11Device.get(), context.get(), frameTexture, whiteScale);
+                }
+
+                D3D11_BOX box;
+                auto source = scaler.Process(d3d11Device.get(), context.get(), frameTexture, currentRegion, box);
+
+                bool changed = FindDirtyRects(frame, texture.get(), source, box, currentRegion, changeDetection);
+                if (changed || changeDetection != ChangeDetection::SkipUnchanged)
+                {
+                    stagingRing.Submit(d3d11Device.get(), context.get(), source, box, frameDirtyRects, timestamp, sequence);
+                    submitted = true;
+                }
+            }
+            frame.Close();
+
+            if (!submitted)
+            {
+                // Texture delivery, a skipped, shared-only or unchanged frame: nothing new in the ring
+                deliverInline = false;
+                deliverOnThread = false;
+            }
+            else
+            {
+                {
+                    std::lock_guard<std::mutex> lock(frameMutex);
+                    ++frameCount;
+                }
+                frameCondition.notify_all();
+            }
+
+            if (deliverInline)
+            {
+                DeliverNewest();
+            }
+            else if (deliverOnThread)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(deliveryMutex);
+                    deliveryPending = true;
+                }
+                deliveryCondition.notify_one();
+            }
+
+            // Follow resolution changes of the captured monitor
+            if (contentSize.Width != poolSize.Width || contentSize.Height != poolSize.Height)
+            {
+                poolSize = contentSize;
+                sender.Recreate(direct3DDevice, GetSurfaceFormat(captureFormat), bufferCount, poolSize);
+            }
+        }
+
+        // Fill frameDirtyRects with the areas of the copied box that changed since the
+        // previous frame, from the session's dirty regions or else GPU tile hashes
+        // Returns false if nothing changed
+        bool FindDirtyRects(Direct3D11CaptureFrame const& frame, ID3D11Texture2D* frameTexture, ID3D11Texture2D* source, const D3D11_BOX& box, const CaptureRegion& currentRegion, ChangeDetection changeDetection)
+        {
+            const DirtyRect fullFrame = { 0, 0, box.right - box.left, box.bottom - box.top };
+            frameDirtyRects.clear();
+
+            bool reset = changesReset.exchange(false);
+            if (changeDetection == ChangeDetection::Off)
+            {
+                frameDirtyRects.push_back(fullFrame);
+                return true;
+            }
+
+            try
+            {
+                if (osDirtyRegions)
+                {
+#ifdef SCREENCAPTURE_HAS_DIRTY_REGIONS
+                    // Dirty regions are in frame pool surface pixels; map them through the crop and scale
+                    D3D11_TEXTURE2D_DESC desc;
+                    frameTexture->GetDesc(&desc);
+
+                    D3D11_BOX cropBox;
+                    uint32_t outputWidth = 0;
+                    uint32_t outputHeight = 0;
+                    if (ResolveCaptureRegion(currentRegion, desc.Width, desc.Height, cropBox, outputWidth, outputHeight))
+                    {
+                        for (auto const& dirtyRegion : frame.DirtyRegions())
+                        {
+                            DirtyRect rect;
+                            if (MapDirtyRect(dirtyRegion.X, dirtyRegion.Y, dirtyRegion.X + dirtyRegion.Width, dirtyRegion.Y + dirtyRegion.Height, cropBox, outputWidth, outputHeight, rect))
+                            {
+                                frameDirtyRects.push_back(rect);
+                            }
+                        }
+                    }
+#endif
+                }
+                else
+                {
+                    changeDetector.Detect(d3d11Device.get(), context.get(), source, box, frameDirtyRects);
+                }
+            }
+            catch (...)
+            {
+                // Without detection the whole frame counts as changed
+                reset = true;
+            }
+
+            if (reset)
+            {
+                frameDirtyRects.assign(1, fullFrame);
+            }
+            return !frameDirtyRects.empty();
+        }
+
+        // Whether a stream callback is installed (the caller holds callbackMutex, so it stays installed)
+        bool HasStreamCallback()
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            return static_cast<bool>(streamCallback);
+        }
+
+        // Hand a frame pool surface to a texture stream callback
+        // Returns false if the stream stopped meanwhile
+        bool DeliverTexture(ID3D11Texture2D* texture, int64_t timestamp, uint64_t sequence)
+        {
+            std::lock_guard<std::mutex> callbackLock(callbackMutex);
+            if (!HasStreamCallback())
+            {
+                return false;
+            }
+
+            D3D11_TEXTURE2D_DESC desc;
+            texture->GetDesc(&desc);
+
+            StreamFrame streamFrame;
+            streamFrame.width = desc.Width;
+            streamFrame.height = desc.Height;
+            streamFrame.timestamp = timestamp;
+            streamFrame.frameNumber = sequence;
+            streamFrame.texture = texture;
+            streamFrame.device = d3d11Device.get();
+
+            const int64_t start = FrameScheduler::Now();
+            streamCallback(streamFrame);
+            scheduler.RecordDelivered(timestamp, start, FrameScheduler::Now());
+            return true;
+        }
+
+        // Hand the newest ring slot to the stream callback straight from mapped memory
+        void DeliverNewest()
+        {
+            std::lock_guard<std::mutex> callbackLock(callbackMutex);
+            if (!HasStreamCallback())
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> grabLock(grabMutex);
+            stagingRing.MapNewest(context.get(), [&](const D3D11_MAPPED_SUBRESOURCE& mappedResource, const StagedFrameInfo& info)
+            {
+                // Skip a frame the latest-only thread already delivered
+                if (info.submission == lastDeliveredSubmission)
+                {
+                    return;
+                }
+
+                // Frames overwritten in the ring before delivery never reach the callback
+                const bool firstFrame = lastDeliveredSubmission == 0;
+                const bool replaced = !firstFrame && info.submission > lastDeliveredSubmission + 1;
+                if (replaced)
+                {
+                    const uint64_t dropped = info.submission - lastDeliveredSubmission - 1;
+                    RecordDroppedFrames(dropped);
+                    scheduler.RecordDropped(dropped);
+                }
+                lastDeliveredSubmission = info.submission;
+
+                // The slot's rects only cover the change since the submission before it, so after
+                // dropped frames (or for the first frame of the stream) the whole frame is dirty
+                const DirtyRect fullFrame = { 0, 0, info.width, info.height };
+                const bool whole = firstFrame || replaced;
+
+                StreamFrame streamFrame;
+                streamFrame.pixels = static_cast<const uint8_t*>(mappedResource.pData);
+                streamFrame.width = info.width;
+                streamFrame.height = info.height;
+                streamFrame.stride = mappedResource.RowPitch;
+                streamFrame.timestamp = info.timestamp;
+                streamFrame.frameNumber = info.sequence;
+                streamFrame.dirtyRects = whole ? &fullFrame : info.dirtyRects.data();
+                streamFrame.dirtyRectCount = whole ? 1 : static_cast<uint32_t>(info.dirtyRects.size());
+
+                const int64_t start = FrameScheduler::Now();
+                streamCallback(streamFrame);
+                scheduler.RecordDelivered(info.timestamp, start, FrameScheduler::Now());
+            }, true);
+        }
+
+        void DeliveryLoop()
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(deliveryMutex);
+                    deliveryCondition.wait(lock, [this] { return deliveryPending || deliveryStop; });
+                    if (deliveryStop)
+                    {
+                        return;
+                    }
+                    deliveryPending = false;
+                }
+
+                try
+                {
+                    DeliverNewest();
+                }
+                catch (...)
+                {
+                    // Keep delivering; a failed map or callback only loses this frame
+                }
+            }
+        }
+
+        void StopDelivery()
+        {
+            {
+                std::lock_guard<std::mutex> callbackLock(callbackMutex);
+                std::lock_guard<std::mutex> lock(streamMutex);
+                streamCallback = nullptr;
+            }
+
+            // Let later GrabFrame calls see every frame again
+            if (minUpdateIntervalSupported)
+            {
+                SetMinUpdateInterval(session, 0);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(deliveryMutex);
+                deliveryStop = true;
+            }
+            deliveryCondition.notify_one();
+
+            if (deliveryThread.joinable())
+            {
+                deliveryThread.join();
+            }
+
+            deliveryStop = false;
+            deliveryPending = false;
+        }
+    };
+
+    CaptureSession::CaptureSession(ILogger* logger)
+        : m_logger(logger ? logger : &m_defaultLogger)
+    {
+        // No apartment is needed on the caller's thread; setup and teardown run on the CaptureWorker
+    }
+
+    CaptureSession::CaptureSession(ILogger* logger, std::shared_ptr<CaptureWorker> worker)
+        : m_logger(logger ? logger : &m_defaultLogger)
+        , m_worker(std::move(worker))
+    {
+    }
+
+    ErrorCode CaptureSession::RunOnWorker(const std::function<ErrorCode()>& work) const
+    {
+        ErrorCode result = ErrorCode::UnknownError;
+        CaptureWorker& worker = m_worker ? *m_worker : CaptureWorker::Instance();
+        worker.Invoke([&]
+        {
+            result = work();
+        });
+        return result;
+    }
+
+    CaptureSession::~CaptureSession()
+    {
+        Close();
+    }
+
+    void CaptureSession::Log(const std::wstring& message)
+    {
+        if (m_logger)
+        {
+            m_logger->LogInfo(message);
+        }
+    }
+
+    void CaptureSession::LogError(const std::wstring& message)
+    {
+        if (m_logger)
+        {
+            m_logger->LogError(message);
+        }
+    }
+
+    void CaptureSession::Log(const wchar_t* message)
+    {
+        // Literal messages are only turned into strings when someone reads them
+        if (LogEnabled())
+        {
+            m_logger->LogInfo(message);
+        }
+    }
+
+    bool CaptureSession::LogEnabled() const
+    {
+        return m_logger && m_logger->IsEnabled();
+    }
+
+    bool CaptureSession::IsOpen() const
+    {
+        return m_impl != nullptr;
+    }
+
+    ErrorCode CaptureSession::Open(bool hideBorder, bool hideCursor, int32_t bufferCount)
+    {
+        return Open(CaptureTarget(), hideBorder, hideCursor, bufferCount);
+    }
+
+    ErrorCode CaptureSession::Open(const CaptureTarget& target, bool hideBorder, bool hideCursor, int32_t bufferCount)
+    {
+        return Open(target, CaptureFormat::Bgra8, hideBorder, hideCursor, bufferCount);
+    }
+
+    ErrorCode CaptureSession::Open(const CaptureTarget& target, CaptureFormat captureFormat, bool hideBorder, bool hideCursor, int32_t bufferCount)
+    {
+        return RunOnWorker([&]
+        {
+            return InternalOpen(target, captureFormat, hideBorder, hideCursor, bufferCount);
+        });
+    }
+
+    ErrorCode CaptureSession::InternalOpen(const CaptureTarget& target, CaptureFormat captureFormat, bool hideBorder, bool hideCursor, int32_t bufferCount)
+    {
+        if (m_impl)
+        {
+            return ErrorCode::Success;
+        }
+
+        HMONITOR monitor = nullptr;
+        HWND window = nullptr;
+        if (!ResolveCaptureTarget(target, monitor, window))
+        {
+            LogError(L"Invalid capture target");
+            return ErrorCode::InvalidParameter;
+        }
+
+        try
+        {
+            Log(L"Opening persistent capture session...");
+
+            auto impl = std::make_shared<Impl>();
+            impl->bufferCount = std::clamp(bufferCount, 1, MaxFrameBufferCount);
+            impl->captureFormat = captureFormat;
+            if (captureFormat == CaptureFormat::Rgba16Float)
+            {
+                impl->whiteScale = GetSdrWhiteScale(GetTargetMonitor(monitor, window));
+            }
+
+            // 1. Create D3D11 Device
+            // The frame pool and the grabbing thread share the device, so turn on
+            // multithread protection for the immediate context
+            impl->d3d11Device = CreateD3DDevice(SelectAdapter(m_adapterOptions, GetTargetMonitor(monitor, window)).get());
+            impl->d3d11Device->GetImmediateContext(impl->context.put());
+            if (auto multithread = impl->d3d11Device.try_as<ID3D11Multithread>())
+            {
+                multithread->SetMultithreadProtected(TRUE);
+            }
+            impl->direct3DDevice = CreateDirect3DDeviceFromD3D11Device(impl->d3d11Device);
+
+            // 2. Create capture item for the selected monitor or window
+            try
+            {
+                impl->captureItem = CreateCaptureItem(monitor, window);
+            }
+            catch (hresult_error const& ex)
+            {
+                LogError(L"Failed to create capture item: " + std::wstring(ex.message()));
+                return ErrorCode::CaptureItemCreationFailed;
+            }
+            impl->poolSize = impl->captureItem.Size();
+            if (LogEnabled())
+            {
+                Log(L"Capture item created. Size: " + std::to_wstring(impl->poolSize.Width) + L"x" + std::to_wstring(impl->poolSize.Height));
+            }
+
+            // 3. Create a free-threaded frame pool so frames arrive without a message pump
+            impl->framePool = Direct3D11CaptureFramePool::CreateFreeThreaded(
+                impl->direct3DDevice,
+                GetSurfaceFormat(captureFormat),
+                impl->bufferCount,
+                impl->poolSize
+            );
+
+            // 4. Create capture session
+            impl->session = impl->framePool.CreateCaptureSession(impl->captureItem);
+
+            // 5. Configure capture session options
+            if (hideCursor)
+            {
+                try
+                {
+                    impl->session.IsCursorCaptureEnabled(false);
+                }
+                catch (...)
+                {
+                    Log(L"Warning: Could not hide cursor (may require newer Windows version)");
+                }
+            }
+
+            if (hideBorder)
+            {
+                try
+                {
+                    impl->session.IsBorderRequired(false);
+                }
+                catch (...)
+                {
+                    Log(L"Warning: Could not disable border (may require newer Windows version)");
+                }
+            }
+
+            // 6. Copy each new frame into the staging ring for GrabFrame
+            // The handler runs on a pool thread and may still be in flight after Close
+            std::weak_ptr<Impl> weakImpl = impl;
+            impl->frameArrivedRevoker = impl->framePool.FrameArrived(winrt::auto_revoke, [weakImpl](auto const& sender, auto const&)
+            {
+                try
+                {
+                    if (auto strongImpl = weakImpl.lock())
+                    {
+                        strongImpl->OnFrameArrived(sender);
+                    }
+                }
+                catch (...)
+                {
+                    // Never let an exception escape into the frame pool thread
+                }
+            });
 
-                        // Get the Direct3D11 surface
-                        auto surface = frame.Surface();
+            // 7. Start capture
+            impl->startTicks = QueryCaptureTicks();
+            impl->session.StartCapture();
+            m_impl = std::move(impl);
 
-                        // Get the underlying D3D11 texture using interop
-                        com_ptr<ID3D11Texture2D> texture;
-                        auto dxgiInterfaceAccess = surface.as<::Windows::Graphics::DirectX::Direct3D11::IDirect3DDxgiInterfaceAccess>();
-                        winrt::check_hresult(dxgiInterfaceAccess->GetInterface(IID_PPV_ARGS(&texture)));
+            Log(L"Capture session started");
+            return ErrorCode::Success;
+        }
+        catch (hresult_error const& ex)
+        {
+            LogError(L"Failed to open capture session: " + std::wstring(ex.message()));
+            return ErrorCode::CaptureSessionFailed;
+        }
+        catch (...)
+        {
+            LogError(L"Unknown error opening capture session");
+            return ErrorCode::UnknownError;
+        }
+    }
 
-                        // Get texture description
-                        D3D11_TEXTURE2D_DESC desc;
-                        texture->GetDesc(&desc);
+    ErrorCode CaptureSession::GrabFrame(std::vector<uint8_t>& outputBuffer, uint32_t timeoutMs)
+    {
+        return GrabFrame(outputBuffer, EncodeOptions(), timeoutMs);
+    }
 
-                        Log(L"Texture size: " + std::to_wstring(desc.Width) + L"x" + std::to_wstring(desc.Height));
+    ErrorCode CaptureSession::GrabFrame(std::vector<uint8_t>& outputBuffer, const EncodeOptions& encodeOptions, uint32_t timeoutMs)
+    {
+        if (!IsValidEncodeOptions(encodeOptions))
+        {
+            LogError(L"Invalid encode options");
+            return ErrorCode::InvalidParameter;
+        }
 
-                        // Create staging texture for CPU access
-                        desc.Usage = D3D11_USAGE_STAGING;
-                        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-                        desc.BindFlags = 0;
-                        desc.MiscFlags = 0;
+        if (!m_impl)
+        {
+            LogError(L"Capture session is not open");
+            return ErrorCode::CaptureSessionFailed;
+        }
 
-                        com_ptr<ID3D11Texture2D> stagingTexture;
-                        winrt::check_hresult(d3d11Device->CreateTexture2D(&desc, nullptr, stagingTexture.put()));
+        std::lock_guard<std::mutex> encodeLock(m_impl->encodeMutex);
 
-                        // Copy to staging texture
-                        com_ptr<ID3D11DeviceContext> context;
-                        d3d11Device->GetImmediateContext(context.put());
-                        context->CopyResource(stagingTexture.get(), texture.get());
+        auto result = GrabRawFrame(m_impl->encodeFrame, timeoutMs);
+        if (result != ErrorCode::Success)
+        {
+            return result;
+        }
 
-                        // Map the texture
-                        D3D11_MAPPED_SUBRESOURCE mappedResource;
-                        winrt::check_hresult(context->Map(stagingTexture.get(), 0, D3D11_MAP_READ, 0, &mappedResource));
+        // WIC encoders need the worker's apartment; the caller may have none
+        return RunOnWorker([&]
+        {
+            try
+            {
+                EncodeFrame(m_impl->encodeFrame, encodeOptions, outputBuffer);
+            }
+            catch (...)
+            {
+                LogError(L"Error encoding frame to memory");
+                return ErrorCode::TextureProcessingFailed;
+            }
 
-                        // Create bitmap data
-                        uint32_t dataSize = mappedResource.RowPitch * desc.Height;
-                        std::vector<uint8_t> bitmapData(dataSize);
-                        memcpy(bitmapData.data(), mappedResource.pData, dataSize);
+            return ErrorCode::Success;
+        });
+    }
 
-                        context->Unmap(stagingTexture.get(), 0);
+    ErrorCode CaptureSession::GrabRawFrame(RawFrame& frame, uint32_t timeoutMs)
+    {
+        return GrabRawFrame(frame, PixelFormat::Bgra, timeoutMs);
+    }
 
-                        // Encode to PNG in memory
-                        try
-                        {
-                            InMemoryRandomAccessStream stream;
-                            BitmapEncoder encoder = BitmapEncoder::CreateAsync(BitmapEncoder::PngEncoderId(), stream).get();
-
-                            encoder.SetPixelData(
-                                BitmapPixelFormat::Bgra8,
-                                BitmapAlphaMode::Ignore,
-                                desc.Width,
-                                desc.Height,
-                                96.0,
-                                96.0,
-                                bitmapData
-                            );
-
-                            encoder.FlushAsync().get();
-
-                            // Read stream into output buffer
-                            auto reader = DataReader(stream.GetInputStreamAt(0));
-                            auto bytesToRead = static_cast<uint32_t>(stream.Size());
-                            reader.LoadAsync(bytesToRead).get();
-
-                            outputBuffer.resize(bytesToRead);
-                            reader.ReadBytes(winrt::array_view<uint8_t>(outputBuffer));
-
-                            Log(L"Screenshot encoded to memory successfully. Size: " + std::to_wstring(outputBuffer.size()) + L" bytes");
-                            captureSuccess = true;
-                        }
-                        catch (...)
-                        {
-                            LogError(L"Error encoding screenshot to memory");
-                        }
+    ErrorCode CaptureSession::GrabRawFrame(RawFrame& frame, PixelFormat format, uint32_t timeoutMs)
+    {
+        if (!m_impl)
+        {
+            LogError(L"Capture session is not open");
+            return ErrorCode::CaptureSessionFailed;
+        }
 
-                        // Signal completion
-                        {
-                            std::lock_guard<std::mutex> lock(frameMutex);
-                            frameReceived = true;
-                        }
-                        frameCondition.notify_one();
-                    }
-                    catch (hresult_error const& ex)
-                    {
-                        LogError(L"Error processing frame: " + std::wstring(ex.message()));
-                        {
-                            std::lock_guard<std::mutex> lock(frameMutex);
-                            frameReceived = true;
-                        }
-                        frameCondition.notify_one();
-                    }
-                }
-                else
-                {
-                    LogError(L"No frame available");
-                }
-            });
+        // The staging ring only holds 8-bit frames
+        if (format == PixelFormat::Rgba16Float)
+        {
+            LogError(L"Sessions read back tone-mapped BGRA frames only");
+            return ErrorCode::InvalidParameter;
+        }
 
-            // 7. Start capture
-            Log(L"Starting capture session...");
-            session.StartCapture();
+        try
+        {
+            std::lock_guard<std::mutex> grabLock(m_impl->grabMutex);
 
-            // Wait for frame with timeout and message pumping
-            Log(L"Waiting for frame (timeout: 10 seconds)...");
+            // Wait for the first frame if none has arrived yet
+            if (!m_impl->WaitForFirstFrame(timeoutMs))
             {
-                std::unique_lock<std::mutex> lock(frameMutex);
-                auto start = std::chrono::steady_clock::now();
-                auto timeout = std::chrono::seconds(10);
+                LogError(L"Timeout: No frame received within " + std::to_wstring(timeoutMs) + L" ms");
+                return ErrorCode::TimeoutError;
+            }
 
-                while (!frameReceived && (std::chrono::steady_clock::now() - start) < timeout)
-                {
-                    lock.unlock();
+            // The copy of the newest frame was issued when it arrived, so this map
+            // normally does not stall on the GPU
+            if (!m_impl->stagingRing.ReadNewest(m_impl->context.get(), frame, format))
+            {
+                LogError(L"No frame available");
+                return ErrorCode::TextureProcessingFailed;
+            }
 
-                    // Pump messages to allow Windows events to be processed
-                    MSG msg;
-                    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-                    {
-                        TranslateMessage(&msg);
-                        DispatchMessage(&msg);
-                    }
+            return ErrorCode::Success;
+        }
+        catch (hresult_error const& ex)
+        {
+            LogError(L"Error grabbing frame: " + std::wstring(ex.message()));
+            return ErrorCode::TextureProcessingFailed;
+        }
+        catch (...)
+        {
+            LogError(L"Unknown error grabbing frame");
+            return ErrorCode::UnknownError;
+        }
+    }
+
+    ErrorCode CaptureSession::GrabRawFrameInto(uint8_t* buffer, size_t bufferSize, FrameLayout& layout, uint32_t timeoutMs)
+    {
+        return GrabRawFrameInto(buffer, bufferSize, layout, PixelFormat::Bgra, timeoutMs);
+    }
 
-                    // Small sleep to prevent busy waiting
-                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ErrorCode CaptureSession::GrabRawFrameInto(uint8_t* buffer, size_t bufferSize, FrameLayout& layout, PixelFormat format, uint32_t timeoutMs)
+    {
+        if (!m_impl)
+        {
+            LogError(L"Capture session is not open");
+            return ErrorCode::CaptureSessionFailed;
+        }
 
-                    lock.lock();
-                }
+        // The staging ring only holds 8-bit frames
+        if (format == PixelFormat::Rgba16Float)
+        {
+            LogError(L"Sessions read back tone-mapped BGRA frames only");
+            return ErrorCode::InvalidParameter;
+        }
 
-                if (frameReceived)
-                {
-                    Log(L"Frame received and processed to memory!");
-                }
-                else
+        try
+        {
+            std::lock_guard<std::mutex> grabLock(m_impl->grabMutex);
+
+            // Wait for the first frame if none has arrived yet
+            if (!m_impl->WaitForFirstFrame(timeoutMs))
+            {
+                LogError(L"Timeout: No frame received within " + std::to_wstring(timeoutMs) + L" ms");
+                return ErrorCode::TimeoutError;
+            }
+
+            // Convert straight from the mapped staging texture into the caller's rows
+            bool copied = false;
+            bool mapped = m_impl->stagingRing.MapNewest(m_impl->context.get(), [&](const D3D11_MAPPED_SUBRESOURCE& mappedResource, const StagedFrameInfo& info)
+            {
+                layout.width = info.width;
+                layout.height = info.height;
+                layout.stride = info.width * BytesPerPixel(format);
+                layout.format = format;
+
+                if (buffer && bufferSize >= layout.Size())
                 {
-                    LogError(L"Timeout: No frame received within 10 seconds");
-                    return ErrorCode::TimeoutError;
+                    StageTimer timer(CaptureStage::PixelCopy);
+                    ConvertPixels(static_cast<const uint8_t*>(mappedResource.pData), mappedResource.RowPitch, buffer, layout.stride, info.width, info.height, format);
+                    copied = true;
                 }
+            });
+
+            if (!mapped)
+            {
+                LogError(L"No frame available");
+                return ErrorCode::TextureProcessingFailed;
             }
 
-            // Cleanup
-            session.Close();
-            framePool.Close();
+            return copied ? ErrorCode::Success : ErrorCode::BufferTooSmall;
+        }
+        catch (hresult_error const& ex)
+        {
+            LogError(L"Error grabbing frame: " + std::wstring(ex.message()));
+            return ErrorCode::TextureProcessingFailed;
+        }
+        catch (...)
+        {
+            LogError(L"Unknown error grabbing frame");
+            return ErrorCode::UnknownError;
+        }
+    }
 
-            Log(L"Memory capture completed!");
+    ErrorCode CaptureSession::StartStream(FrameCallback callback, const StreamOptions& options)
+    {
+        if (!callback)
+        {
+            LogError(L"Stream callback is required");
+            return ErrorCode::InvalidParameter;
+        }
 
-            return captureSuccess ? ErrorCode::Success : ErrorCode::TextureProcessingFailed;
+        if (!std::isfinite(options.targetFps) || options.targetFps < 0.0f)
+        {
+            LogError(L"Invalid target frame rate");
+            return ErrorCode::InvalidParameter;
+        }
+
+        if (!m_impl)
+        {
+            auto result = Open(options.target, options.captureFormat, options.hideBorder, options.hideCursor, options.bufferCount);
+            if (result != ErrorCode::Success)
+            {
+                return result;
+            }
+        }
+
+        // Replace any stream that is already running
+        StopStream();
+
+        auto result = SetRegion(options.region);
+        if (result != ErrorCode::Success)
+        {
+            return result;
+        }
+
+        // Prefer the session's own dirty regions over hashing tiles on the GPU
+        if (options.changeDetection != ChangeDetection::Off && !options.deliverTexture)
+        {
+            RunOnWorker([this]
+            {
+                m_impl->osDirtyRegions = EnableDirtyRegions(m_impl->session);
+                return ErrorCode::Success;
+            });
+            Log(m_impl->osDirtyRegions ? L"Using session dirty regions" : L"Using GPU tile hashes for change detection");
+        }
+        m_impl->changesReset = true;
+        m_impl->minUpdateIntervalSupported = SupportsMinUpdateInterval();
+        m_impl->scheduler.Reset(options);
+
+        {
+            std::lock_guard<std::mutex> callbackLock(m_impl->callbackMutex);
+            std::lock_guard<std::mutex> lock(m_impl->streamMutex);
+            m_impl->streamOptions = options;
+            m_impl->streamCallback = std::move(callback);
+            m_impl->lastDeliveredSubmission = 0;
+        }
+
+        if (options.delivery == StreamDelivery::LatestOnly && !options.deliverTexture)
+        {
+            m_impl->deliveryThread = std::thread(&Impl::DeliveryLoop, m_impl.get());
+        }
+
+        Log(L"Stream started");
+        return ErrorCode::Success;
+    }
+
+    ErrorCode CaptureSession::StartRingStream(const FrameRingOptions& ringOptions, const StreamOptions& options)
+    {
+        if (ringOptions.name.empty() || ringOptions.slotCount < 2 || ringOptions.slotCount > MaxFrameRingSlots || options.deliverTexture)
+        {
+            LogError(L"Invalid frame ring options");
+            return ErrorCode::InvalidParameter;
+        }
+
+        if (!m_impl)
+        {
+            auto result = Open(options.target, options.captureFormat, options.hideBorder, options.hideCursor, options.bufferCount);
+            if (result != ErrorCode::Success)
+            {
+                return result;
+            }
+        }
+
+        // Size the slots for the whole target unless the caller knows better;
+        // regions only make frames smaller
+        uint64_t maxWidth = ringOptions.maxWidth;
+        uint64_t maxHeight = ringOptions.maxHeight;
+        if (maxWidth == 0 || maxHeight == 0)
+        {
+            auto size = m_impl->captureItem.Size();
+            maxWidth = maxWidth ? maxWidth : static_cast<uint64_t>(size.Width);
+            maxHeight = maxHeight ? maxHeight : static_cast<uint64_t>(size.Height);
+        }
+
+        std::shared_ptr<SharedFrameRing> ring;
+        try
+        {
+            // Release a previous ring first so a restarted stream can reuse its name
+            StopStream();
+            ring = std::make_shared<SharedFrameRing>(ringOptions.name, ringOptions.slotCount, maxWidth * 4 * maxHeight);
         }
         catch (hresult_error const& ex)
         {
-            LogError(L"Memory capture error: " + std::wstring(ex.message()));
+            LogError(L"Failed to create frame ring: " + std::wstring(ex.message()));
             return ErrorCode::CaptureSessionFailed;
         }
-        catch (std::exception const& ex)
+
+        if (LogEnabled())
         {
-            std::wstring errorMsg(ex.what(), ex.what() + strlen(ex.what()));
-            LogError(L"Standard error: " + errorMsg);
-            return ErrorCode::UnknownError;
+            Log(L"Publishing frames to ring " + ringOptions.name);
         }
-        catch (...)
+        return StartStream([ring](const StreamFrame& frame)
         {
-            LogError(L"Unknown error occurred");
-            return ErrorCode::UnknownError;
+            ring->Publish(frame);
+        }, options);
+    }
+
+    ErrorCode CaptureSession::StartFileStream(const FileStreamOptions& fileOptions, const StreamOptions& options, FileEncodeCompletion completion)
+    {
+        if (fileOptions.outputPattern.empty() || !IsValidEncodeOptions(fileOptions.encode) ||
+            fileOptions.workerCount == 0 || fileOptions.queueDepth == 0 || options.deliverTexture)
+        {
+            LogError(L"Invalid file stream options");
+            return ErrorCode::InvalidParameter;
+        }
+
+        EncodePipelineOptions pipelineOptions;
+        pipelineOptions.workerCount = fileOptions.workerCount;
+        pipelineOptions.queueDepth = fileOptions.queueDepth;
+        pipelineOptions.backpressure = fileOptions.backpressure;
+        pipelineOptions.encode = fileOptions.encode;
+
+        if (LogEnabled())
+        {
+            Log(L"Encoding stream frames to " + fileOptions.outputPattern);
+        }
+
+        // The callback owns the pipeline, so replacing or stopping the stream drains its queue
+        auto pipeline = std::make_shared<EncodePipeline>(pipelineOptions, m_logger);
+        uint32_t index = 0;
+        return StartStream([pipeline, pattern = fileOptions.outputPattern, completion = std::move(completion), index](const StreamFrame& frame) mutable
+        {
+            pipeline->SubmitStreamFrame(frame, FormatBurstPath(pattern, index++), completion);
+        }, options);
+    }
+
+    ErrorCode CaptureSession::SetRegion(const CaptureRegion& region)
+    {
+        if (!m_impl)
+        {
+            LogError(L"Capture session is not open");
+            return ErrorCode::CaptureSessionFailed;
+        }
+
+        if (!IsValidCaptureRegion(region))
+        {
+            LogError(L"Invalid capture region");
+            return ErrorCode::InvalidParameter;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_impl->regionMutex);
+            m_impl->region = region;
+        }
+        m_impl->changesReset = true;
+        return ErrorCode::Success;
+    }
+
+    ErrorCode CaptureSession::EnableTextureSharing(const SharedTextureOptions& options)
+    {
+        if (!m_impl)
+        {
+            LogError(L"Capture session is not open");
+            return ErrorCode::CaptureSessionFailed;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_impl->sharedMutex);
+            m_impl->sharedTexture = std::make_shared<SharedFrameTexture>(options);
+        }
+
+        Log(L"Texture sharing enabled");
+        return ErrorCode::Success;
+    }
+
+    void CaptureSession::DisableTextureSharing()
+    {
+        if (!m_impl)
+        {
+            return;
+        }
+
+        // The frame pool thread may still hold the texture for an in-flight frame
+        std::lock_guard<std::mutex> lock(m_impl->sharedMutex);
+        m_impl->sharedTexture.reset();
+    }
+
+    ErrorCode CaptureSession::GetSharedTexture(SharedTextureInfo& info, uint32_t timeoutMs)
+    {
+        if (!m_impl)
+        {
+            LogError(L"Capture session is not open");
+            return ErrorCode::CaptureSessionFailed;
+        }
+
+        std::shared_ptr<SharedFrameTexture> shared;
+        {
+            std::lock_guard<std::mutex> lock(m_impl->sharedMutex);
+            shared = m_impl->sharedTexture;
+        }
+
+        if (!shared)
+        {
+            LogError(L"Texture sharing is not enabled");
+            return ErrorCode::InvalidParameter;
+        }
+
+        if (!shared->Wait(info, timeoutMs))
+        {
+            LogError(L"Timeout: No frame shared within " + std::to_wstring(timeoutMs) + L" ms");
+            return ErrorCode::TimeoutError;
+        }
+
+        return ErrorCode::Success;
+    }
+
+    void CaptureSession::StopStream()
+    {
+        if (!m_impl)
+        {
+            return;
+        }
+
+        m_impl->StopDelivery();
+    }
+
+    ErrorCode CaptureSession::GetStreamStats(StreamStats& stats)
+    {
+        if (!m_impl)
+        {
+            LogError(L"Capture session is not open");
+            return ErrorCode::CaptureSessionFailed;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_impl->streamMutex);
+            if (!m_impl->streamCallback)
+            {
+                LogError(L"No stream is running");
+                return ErrorCode::InvalidParameter;
+            }
+        }
+
+        stats = m_impl->scheduler.GetStats();
+        return ErrorCode::Success;
+    }
+
+    void CaptureSession::SetAdapterOptions(const AdapterOptions& options)
+    {
+        m_adapterOptions = options;
+    }
+
+    void CaptureSession::Close()
+    {
+        if (!m_impl)
+        {
+            return;
         }
+
+        // Wait for an in-flight callback here rather than on the worker, which the
+        // callback may be calling into
+        StopStream();
+
+        RunOnWorker([this]
+        {
+            try
+            {
+                m_impl->frameArrivedRevoker.revoke();
+                m_impl->session.Close();
+                m_impl->framePool.Close();
+            }
+            catch (...)
+            {
+                // Session may already be closed by the system
+            }
+            return ErrorCode::Success;
+        });
+
+        m_impl->stagingRing.Reset();
+        m_impl.reset();
+        Log(L"Capture session closed");
     }
 }
@@ -2,6 +2,9 @@
 
 #include <windows.h>
 #include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
 #include <functional>
 
 namespace ScreenCaptureCore
@@ -16,9 +19,338 @@ namespace ScreenCaptureCore
         TextureProcessingFailed = 4,
         FileSaveFailed = 5,
         TimeoutError = 6,
+        BufferTooSmall = 7,
+        FrameDropped = 8,
+        EncoderFailed = 9,
+        Cancelled = 10,
+        InvalidParameter = 97,
         UnknownError = 99
     };
 
+    // Default time to wait for the first frame
+    constexpr uint32_t DefaultFrameTimeoutMs = 10000;
+
+    // Frame pool buffer counts for sessions and streams
+    constexpr int32_t DefaultFrameBufferCount = 2;
+    constexpr int32_t MaxFrameBufferCount = 8;
+
+    // Upper bound of frames held in memory by one burst capture
+    constexpr uint32_t MaxBurstFrameCount = 1000;
+
+    // What to capture
+    enum class CaptureTargetType
+    {
+        PrimaryMonitor,
+        MonitorIndex,   // Index into EnumerateMonitors()
+        Monitor,        // Specific HMONITOR
+        Window,         // Specific HWND
+        AllMonitors     // Whole virtual desktop in one frame (one-shot captures only)
+    };
+
+    // Capture target selection
+    struct CaptureTarget
+    {
+        CaptureTargetType type = CaptureTargetType::PrimaryMonitor;
+        uint32_t monitorIndex = 0;
+        HMONITOR monitor = nullptr;
+        HWND window = nullptr;
+
+        static CaptureTarget Primary();
+        static CaptureTarget FromMonitorIndex(uint32_t index);
+        static CaptureTarget FromMonitor(HMONITOR monitor);
+        static CaptureTarget FromWindow(HWND window);
+        static CaptureTarget AllMonitors();
+    };
+
+    // Monitor attached to the desktop
+    struct MonitorInfo
+    {
+        HMONITOR handle = nullptr;
+        RECT bounds = {};           // Virtual-screen coordinates
+        bool primary = false;
+        std::wstring deviceName;
+    };
+
+    // List attached monitors; the primary monitor is always index 0
+    std::vector<MonitorInfo> EnumerateMonitors();
+
+    // GPU that captures run on
+    enum class GpuPreference
+    {
+        Auto,               // The adapter driving the target's monitor, so frames need no cross-adapter copy
+        SystemDefault,      // The first adapter, as D3D11CreateDevice picks without one
+        MinimumPower,       // Integrated GPU of hybrid systems
+        HighPerformance     // Discrete GPU of hybrid systems
+    };
+
+    // Adapter selection for capture devices
+    struct AdapterOptions
+    {
+        GpuPreference preference = GpuPreference::Auto;
+        LUID adapterLuid = {};      // Non-zero: this adapter (see EnumerateAdapters), preference is ignored
+    };
+
+    // Display adapter of the system
+    struct AdapterInfo
+    {
+        LUID luid = {};
+        std::wstring description;
+        uint64_t dedicatedVideoMemory = 0;
+        bool software = false;              // WARP / Microsoft Basic Render Driver
+        std::vector<HMONITOR> monitors;     // Monitors the adapter drives
+    };
+
+    // List display adapters in DXGI order (the system default first)
+    std::vector<AdapterInfo> EnumerateAdapters();
+
+    // Pixel layouts raw captures can be converted to while they are read back
+    enum class PixelFormat
+    {
+        Bgra,       // 4 bytes per pixel, as captured
+        Rgba,       // 4 bytes per pixel
+        Rgb24,      // 3 bytes per pixel, R first
+        Gray8,      // 1 byte per pixel (BT.601 luma)
+        Rgba16Float // 8 bytes per pixel, scRGB half floats (CaptureFormat::Rgba16Float one-shot captures only)
+    };
+
+    // Pixel format of the frame pool surfaces
+    enum class CaptureFormat
+    {
+        Bgra8,          // 8-bit sRGB; on HDR monitors the OS tone-maps every frame
+        Rgba16Float     // scRGB half floats with the HDR range intact, tone-mapped on the GPU for 8-bit output
+    };
+
+    // API that one-shot captures of monitors go through
+    enum class CaptureBackend
+    {
+        Auto,               // Graphics Capture; Desktop Duplication where it cannot hide the cursor or border
+        GraphicsCapture,    // Windows.Graphics.Capture only
+        DesktopDuplication  // DXGI Desktop Duplication: monitors only, BGRA8, never draws the cursor or a border
+    };
+
+    // Raw frame, BGRA (8 bits per channel) unless converted to another format
+    // Rows are stride bytes apart; BGRA and Rgba16Float strides may be larger than
+    // width * BytesPerPixel, converted frames are tightly packed
+    struct RawFrame
+    {
+        std::vector<uint8_t> pixels;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t stride = 0;
+        int64_t timestamp = 0;  // SystemRelativeTime in 100 ns units (0 for one-shot captures)
+        PixelFormat format = PixelFormat::Bgra;
+    };
+
+    // Encoded output formats
+    enum class ImageFormat
+    {
+        Auto,       // From the file extension (PNG for memory output or unknown extensions)
+        Png,        // Lossless, smallest files, slowest encode
+        Bmp,        // Uncompressed 32-bit BMP
+        Raw,        // Tightly packed BGRA (or Rgba16Float) rows without a header
+        Qoi,        // Fast lossless (Quite OK Image format)
+        Jpeg,       // Lossy, see EncodeOptions::jpegQuality
+        Jxr         // JPEG XR, lossless; keeps half floats of Rgba16Float captures
+    };
+
+    // PNG row filter; None encodes fastest, Adaptive gives the smallest files
+    enum class PngFilter
+    {
+        Default,    // Let the encoder choose
+        None,
+        Sub,
+        Up,
+        Average,
+        Paeth,
+        Adaptive
+    };
+
+    // Encoder selection and tuning
+    struct EncodeOptions
+    {
+        ImageFormat format = ImageFormat::Auto;
+        float jpegQuality = 0.9f;               // 0.0 - 1.0
+        PngFilter pngFilter = PngFilter::Default;
+        bool pngInterlace = false;
+        bool parallelPng = false;               // Built-in PNG encoder that deflates row strips on all cores (ignored with pngInterlace)
+    };
+
+    // Part of the target to read back, cropped and downscaled on the GPU
+    // The default region is the whole frame at full size
+    struct CaptureRegion
+    {
+        int32_t x = 0;              // Left edge relative to the target
+        int32_t y = 0;              // Top edge relative to the target
+        uint32_t width = 0;         // 0 extends to the right edge
+        uint32_t height = 0;        // 0 extends to the bottom edge
+        float scale = 1.0f;         // Output size relative to the region, (0, 1]
+    };
+
+    // Layout of tightly packed pixels written into a caller-provided buffer
+    struct FrameLayout
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t stride = 0;
+        PixelFormat format = PixelFormat::Bgra;
+
+        size_t Size() const { return static_cast<size_t>(stride) * height; }
+    };
+
+    // One capture of a CaptureFrames batch
+    struct FrameRequest
+    {
+        CaptureTarget target;
+        CaptureRegion region;
+        CaptureFormat captureFormat = CaptureFormat::Bgra8;
+        PixelFormat pixelFormat = PixelFormat::Bgra;    // Layout of raw output
+        bool encode = false;                            // Encode with encodeOptions (Auto means PNG) instead of raw pixels
+        EncodeOptions encodeOptions;
+        bool hideBorder = true;
+        bool hideCursor = true;
+        uint32_t timeoutMs = DefaultFrameTimeoutMs;
+    };
+
+    // Caller-owned destination of one FrameRequest, written in place
+    struct FrameOutput
+    {
+        uint8_t* buffer = nullptr;
+        size_t bufferSize = 0;
+        size_t size = 0;                    // Bytes written, or needed when result is BufferTooSmall
+        FrameLayout layout;                 // Raw output: tightly packed rows; encoded output: width and height only
+        ErrorCode result = ErrorCode::Success;
+    };
+
+    // Which frames a stream hands to its callback
+    enum class StreamDelivery
+    {
+        EveryFrame,     // Every frame, on the frame pool thread (slow callbacks back-pressure capture)
+        LatestOnly      // Newest frame only, on a delivery thread (frames are dropped while the callback runs)
+    };
+
+    // How a stream finds out which parts of a frame changed
+    // Without session dirty regions the GPU tile hashes are read back a frame behind, so
+    // a change may be reported with the frame after the one that first shows it
+    enum class ChangeDetection
+    {
+        Off,            // Every frame is reported as changed as a whole
+        Report,         // Report dirty rectangles with each frame
+        SkipUnchanged   // Report dirty rectangles and drop unchanged frames before readback
+    };
+
+    // Changed area of a frame in output pixels
+    struct DirtyRect
+    {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    // Streaming options
+    struct StreamOptions
+    {
+        bool hideBorder = true;
+        bool hideCursor = true;
+        int32_t bufferCount = DefaultFrameBufferCount;     // Frame pool buffers (1 to MaxFrameBufferCount)
+        StreamDelivery delivery = StreamDelivery::LatestOnly;
+        bool deliverTexture = false;                        // Pass the GPU texture instead of mapped pixels
+        CaptureTarget target;                               // Monitor or window (AllMonitors is not supported)
+        CaptureRegion region;                               // Crop and scale (ignored for texture delivery)
+        ChangeDetection changeDetection = ChangeDetection::Off;     // OS dirty regions, else GPU tile hashes (ignored for texture delivery)
+        CaptureFormat captureFormat = CaptureFormat::Bgra8;         // Half-float textures are tone-mapped before readback
+        float targetFps = 0.0f;                             // Deliver at most this many frames per second (0 = as they arrive)
+        uint32_t minUpdateIntervalMs = 0;                   // Shortest time between delivered frames (0 = from targetFps only)
+        bool adaptiveRate = true;                           // Lower the rate while callbacks cannot keep up, restore it when they can
+    };
+
+    // Delivery counters of a running stream
+    // Frames skipped by the rate are never copied for readback; the effective interval is
+    // also passed to GraphicsCaptureSession::MinUpdateInterval where the system supports it
+    struct StreamStats
+    {
+        uint64_t framesDelivered = 0;
+        uint64_t framesSkipped = 0;         // Left out to keep to the rate
+        uint64_t framesDropped = 0;         // Copied, then replaced by a newer frame before the callback took it
+        uint64_t framesLate = 0;            // Callback started more than one interval (33 ms uncapped) after capture
+        double currentFps = 0.0;            // Rate cap in effect including backoff (0 = uncapped)
+        double callbackMs = 0.0;            // Moving average of the callback duration
+    };
+
+    // Frame passed to a stream callback
+    // Pointers are only valid for the duration of the callback
+    struct StreamFrame
+    {
+        const uint8_t* pixels = nullptr;    // Mapped BGRA rows (null for texture delivery)
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t stride = 0;                // Bytes between rows (0 for texture delivery)
+        int64_t timestamp = 0;              // SystemRelativeTime in 100 ns units
+        uint64_t frameNumber = 0;           // Frame pool sequence number; gaps mean dropped frames
+        void* texture = nullptr;            // ID3D11Texture2D* for texture delivery
+        void* device = nullptr;             // ID3D11Device* that owns texture
+        const DirtyRect* dirtyRects = nullptr;  // Areas changed since the previously delivered frame
+        uint32_t dirtyRectCount = 0;            // 0 means unchanged (always the whole frame without detection)
+    };
+
+    // Options for publishing frames in a GPU texture shared with other devices
+    struct SharedTextureOptions
+    {
+        bool keyedMutex = true;     // Guard the texture with a keyed mutex (key 0 on both sides)
+        bool skipReadback = true;   // Stop copying frames to staging unless a pixel stream runs (GrabFrame then times out)
+    };
+
+    // Shared texture of a session
+    // The handles belong to the session; duplicate them to pass them to another process
+    struct SharedTextureInfo
+    {
+        HANDLE textureHandle = nullptr;     // NT handle for OpenSharedResource1 / OpenSharedHandle
+        HANDLE fenceHandle = nullptr;       // NT handle of a fence signaled with frameNumber (null if unsupported)
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t frameNumber = 0;           // Frames published so far
+        uint64_t generation = 0;            // Changes when the texture is recreated for a new size
+        bool keyedMutex = false;            // Acquire key 0 with IDXGIKeyedMutex before reading
+    };
+
+    // Options for a stream that publishes frames into a named shared-memory ring
+    // (layout in SharedFrameRing.h)
+    struct FrameRingOptions
+    {
+        std::wstring name;          // File mapping name, e.g. L"Local\\ScreenCaptureRing"
+        uint32_t slotCount = 3;     // Frames kept in the ring (2 to 16)
+        uint32_t maxWidth = 0;      // Largest frame a slot holds; 0 uses the target size when the stream starts
+        uint32_t maxHeight = 0;
+    };
+
+    // What a full encode queue does with the next frame
+    enum class BackpressurePolicy
+    {
+        Block,          // Wait for a free queue slot (capture rate follows encode rate)
+        DropOldest      // Discard the oldest queued frame (capture rate is never limited)
+    };
+
+    // Options for a stream that encodes frames to files on encoder threads
+    struct FileStreamOptions
+    {
+        std::wstring outputPattern;     // One printf-style integer field for the frame index (out_%05d.png), as for bursts
+        EncodeOptions encode;           // Format of every file (Auto picks it by extension)
+        size_t workerCount = 2;         // Encoder threads
+        size_t queueDepth = 4;          // Frames waiting for an encoder
+        BackpressurePolicy backpressure = BackpressurePolicy::DropOldest;
+    };
+
+    // Stream callback; must not call back into the session or stream that invoked it
+    using FrameCallback = std::function<void(const StreamFrame& frame)>;
+
+    // Called on an encoder thread when a file job finishes (or FrameDropped if it was discarded)
+    using FileEncodeCompletion = std::function<void(ErrorCode result, const std::wstring& outputPath)>;
+
+    class CaptureSession;
+    class CaptureDeviceCache;
+    class CaptureWorker;
+    class DesktopDuplication;
+
     // Logger interface
     class ILogger
     {
@@ -26,6 +358,9 @@ namespace ScreenCaptureCore
         virtual ~ILogger() = default;
         virtual void LogInfo(const std::wstring& message) = 0;
         virtual void LogError(const std::wstring& message) = 0;
+
+        // Whether LogInfo output goes anywhere; callers skip building messages when it does not
+        virtual bool IsEnabled() const { return true; }
     };
 
     // Silent logger (no output)
@@ -34,6 +369,7 @@ namespace ScreenCaptureCore
     public:
         void LogInfo(const std::wstring& message) override {}
         void LogError(const std::wstring& message) override {}
+        bool IsEnabled() const override { return false; }
     };
 
     // Console logger
@@ -45,30 +381,259 @@ namespace ScreenCaptureCore
     };
 
     // Main screen capture class
+    // Every public method runs on the library-owned CaptureWorker thread (or the one
+    // given to the constructor), so a ScreenCapture may be used from any thread, by
+    // several threads at once, without the caller initializing an apartment (calls
+    // are serialized)
     class ScreenCapture
     {
     public:
         ScreenCapture(ILogger* logger = nullptr);
+
+        // Run on a dedicated worker instead of the process-wide one, so captures of
+        // this object proceed in parallel with those of other ScreenCaptures
+        ScreenCapture(ILogger* logger, std::shared_ptr<CaptureWorker> worker);
         ~ScreenCapture();
 
-        // Capture primary monitor and save to PNG file
+        // Capture primary monitor and save to an image file (format from the extension, PNG by default)
         ErrorCode CaptureToFile(const std::wstring& outputPath);
         
         // Capture with options
-        ErrorCode CaptureToFile(const std::wstring& outputPath, bool hideBorder, bool hideCursor = true);
+        ErrorCode CaptureToFile(const std::wstring& outputPath, bool hideBorder, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture with an explicit encoder (Auto picks the format from the file extension)
+        ErrorCode CaptureToFile(const std::wstring& outputPath, const EncodeOptions& encodeOptions, bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
 
         // Capture to memory buffer (PNG format)
-        ErrorCode CaptureToMemory(std::vector<uint8_t>& outputBuffer, bool hideBorder = true, bool hideCursor = true);
+        ErrorCode CaptureToMemory(std::vector<uint8_t>& outputBuffer, bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture to memory buffer with an explicit encoder (Auto means PNG)
+        ErrorCode CaptureToMemory(std::vector<uint8_t>& outputBuffer, const EncodeOptions& encodeOptions, bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture raw BGRA pixels without encoding
+        ErrorCode CaptureRaw(RawFrame& frame, bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture raw pixels converted to format while they are copied out of the staging texture
+        ErrorCode CaptureRaw(RawFrame& frame, PixelFormat format, bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture every monitor at the same moment: one session per monitor on a shared
+        // device, all first frames awaited together (frames ordered like EnumerateMonitors)
+        ErrorCode CaptureAllMonitors(std::vector<RawFrame>& frames, bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture every monitor at the same moment and encode each on its own worker thread
+        // Files are named <stem>_<index><extension> next to outputPath
+        ErrorCode CaptureAllMonitorsToFiles(const std::wstring& outputPath, const EncodeOptions& encodeOptions = EncodeOptions(), bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture count frames intervalMs apart in one session (AllMonitors is not supported)
+        // Frames keep their capture timestamps; equal timestamps mean the target did not update
+        ErrorCode CaptureBurst(uint32_t count, uint32_t intervalMs, std::vector<RawFrame>& frames, bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture a burst and encode it on worker threads once the last frame is taken
+        // outputPattern holds one printf-style integer field for the frame index (out_%03d.png);
+        // without one, files are named <stem>_<index><extension>
+        ErrorCode CaptureBurst(uint32_t count, uint32_t intervalMs, const std::wstring& outputPattern, const EncodeOptions& encodeOptions = EncodeOptions(), bool hideBorder = true, bool hideCursor = true, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Capture several targets or regions in one call, each straight into its caller buffer
+        // Unscaled requests for the same target, capture format and flags share one capture
+        // and are cropped while they are copied out; the target and region set on this
+        // object are not used or changed
+        // Returns Success if every request succeeded, else the first failed request's result
+        ErrorCode CaptureFrames(const FrameRequest* requests, FrameOutput* outputs, size_t count);
+
+        // Start streaming frames to a callback (replaces a running stream)
+        ErrorCode StartStream(const StreamOptions& options, FrameCallback callback);
+
+        // Start streaming frames into files through a bounded encode queue (replaces a running stream)
+        // The stream only copies pixels; stopping it waits until every queued frame is written
+        ErrorCode StartFileStream(const FileStreamOptions& fileOptions, const StreamOptions& options = StreamOptions(), FileEncodeCompletion completion = nullptr);
+
+        // Stop the running stream, waiting for an in-flight callback
+        void StopStream();
+
+        // Get the delivery counters of the running stream
+        ErrorCode GetStreamStats(StreamStats& stats);
+
+        // Select the monitor or window used by later captures (primary monitor by default)
+        void SetTarget(const CaptureTarget& target);
+        CaptureTarget GetTarget() const;
+
+        // Crop and downscale later captures on the GPU (not supported for AllMonitors)
+        void SetRegion(const CaptureRegion& region);
+        CaptureRegion GetRegion() const;
+
+        // Capture later frames as half floats (AllMonitors always captures BGRA)
+        // JXR output and raw Rgba16Float captures keep the floats; everything else is tone-mapped on the GPU
+        void SetCaptureFormat(CaptureFormat format);
+        CaptureFormat GetCaptureFormat() const;
+
+        // Reuse a shared D3D device and monitor capture items for one-shot captures
+        // (streams keep their own); nullptr creates fresh ones per capture
+        void SetDeviceCache(std::shared_ptr<CaptureDeviceCache> cache);
+
+        // Choose the capture API for monitor targets (Auto by default)
+        // Desktop Duplication is kept open between captures, so repeated captures of one
+        // monitor return at once and copy only what changed; with a device cache attached
+        // it runs on the cached device
+        void SetBackend(CaptureBackend backend);
+        CaptureBackend GetBackend() const;
+
+        // Choose the GPU of later captures and streams (by default the one driving the
+        // target's monitor); with a device cache attached, each adapter gets its own device
+        void SetAdapterOptions(const AdapterOptions& options);
+        AdapterOptions GetAdapterOptions() const;
 
     private:
         ILogger* m_logger;
         SilentLogger m_defaultLogger;
+        std::unique_ptr<CaptureSession> m_stream;
+        CaptureTarget m_target;
+        CaptureRegion m_region;
+        CaptureFormat m_captureFormat = CaptureFormat::Bgra8;
+        std::shared_ptr<CaptureDeviceCache> m_deviceCache;
+        CaptureBackend m_backend = CaptureBackend::Auto;
+        AdapterOptions m_adapterOptions;
+        std::unique_ptr<DesktopDuplication> m_duplication;
+        std::shared_ptr<CaptureWorker> m_worker;    // nullptr: CaptureWorker::Instance()
 
         void Log(const std::wstring& message);
+        void Log(const wchar_t* message);
         void LogError(const std::wstring& message);
+        bool LogEnabled() const;
+
+        // Whether a monitor capture with these flags goes through Desktop Duplication
+        bool UsesDesktopDuplication(bool hideBorder, bool hideCursor) const;
+
+        // Whether captures of the current target arrive as half floats
+        bool UsesFloatFrames() const;
+
+        // Run work on the CaptureWorker thread and return its result
+        ErrorCode RunOnWorker(const std::function<ErrorCode()>& work) const;
         
         // Internal capture with options
-        ErrorCode InternalCapture(const std::wstring& outputPath, bool hideBorder, bool hideCursor);
-        ErrorCode InternalCaptureToMemory(std::vector<uint8_t>& outputBuffer, bool hideBorder, bool hideCursor);
+        ErrorCode InternalCapture(const std::wstring& outputPath, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureToMemory(std::vector<uint8_t>& outputBuffer, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureRaw(RawFrame& frame, PixelFormat format, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureTarget(const CaptureTarget& target, RawFrame& frame, PixelFormat format, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureDuplication(HMONITOR monitor, RawFrame& frame, PixelFormat format, uint32_t timeoutMs);
+        ErrorCode InternalCaptureAllMonitors(RawFrame& frame, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureEachMonitor(std::vector<RawFrame>& frames, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureAllMonitorsToFiles(const std::wstring& outputPath, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureBurst(uint32_t count, uint32_t intervalMs, std::vector<RawFrame>& frames, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureBurstToFiles(uint32_t count, uint32_t intervalMs, const std::wstring& outputPattern, const EncodeOptions& encodeOptions, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureMonitors(const std::vector<MonitorInfo>& monitors, std::vector<RawFrame>& frames, bool hideBorder, bool hideCursor, uint32_t timeoutMs);
+        ErrorCode InternalCaptureFrames(const FrameRequest* requests, FrameOutput* outputs, size_t count);
+    };
+
+    // Long-lived capture session
+    // Keeps the D3D device, frame pool and capture session alive between grabs,
+    // so a warm capture only costs one readback and encode
+    // Setup and teardown run on the CaptureWorker like ScreenCapture's; grabs only touch
+    // the free-threaded frame pool's staging copies and stay on the calling thread
+    class CaptureSession
+    {
+    public:
+        CaptureSession(ILogger* logger = nullptr);
+
+        // Set up and tear down on a dedicated worker instead of the process-wide one
+        CaptureSession(ILogger* logger, std::shared_ptr<CaptureWorker> worker);
+        ~CaptureSession();
+
+        CaptureSession(const CaptureSession&) = delete;
+        CaptureSession& operator=(const CaptureSession&) = delete;
+
+        // Start capturing the primary monitor
+        ErrorCode Open(bool hideBorder = true, bool hideCursor = true, int32_t bufferCount = DefaultFrameBufferCount);
+
+        // Start capturing a monitor or window (AllMonitors is not supported)
+        ErrorCode Open(const CaptureTarget& target, bool hideBorder = true, bool hideCursor = true, int32_t bufferCount = DefaultFrameBufferCount);
+
+        // Start capturing a monitor or window into surfaces of captureFormat
+        // Half-float frames are tone-mapped on the GPU before they are copied for readback;
+        // texture streams and the shared texture get the half floats
+        ErrorCode Open(const CaptureTarget& target, CaptureFormat captureFormat, bool hideBorder = true, bool hideCursor = true, int32_t bufferCount = DefaultFrameBufferCount);
+
+        // Encode the newest frame to memory (PNG format)
+        // Reuse outputBuffer across calls to avoid reallocating it per frame
+        // Waits up to timeoutMs for the first frame if none has arrived yet
+        ErrorCode GrabFrame(std::vector<uint8_t>& outputBuffer, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Encode the newest frame to memory with an explicit encoder (Auto means PNG)
+        ErrorCode GrabFrame(std::vector<uint8_t>& outputBuffer, const EncodeOptions& encodeOptions, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Copy the newest frame out as raw BGRA pixels without encoding
+        ErrorCode GrabRawFrame(RawFrame& frame, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Copy the newest frame out converted to format (tightly packed unless BGRA)
+        ErrorCode GrabRawFrame(RawFrame& frame, PixelFormat format, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Copy the newest frame as tightly packed BGRA rows into a caller-provided buffer
+        // Fills layout and returns BufferTooSmall if buffer is null or smaller than
+        // layout.Size(), so callers can query the size once and reuse their buffer
+        ErrorCode GrabRawFrameInto(uint8_t* buffer, size_t bufferSize, FrameLayout& layout, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Copy the newest frame converted to format as tightly packed rows into a caller-provided buffer
+        ErrorCode GrabRawFrameInto(uint8_t* buffer, size_t bufferSize, FrameLayout& layout, PixelFormat format, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Hand frames to a callback as they arrive, opening the session with the
+        // stream options if it is not open yet (replaces a running stream)
+        // Texture streams skip the staging copy, so GrabFrame is not fed meanwhile
+        ErrorCode StartStream(FrameCallback callback, const StreamOptions& options = StreamOptions());
+
+        // Stream frames into a named shared-memory ring instead of a callback, for readers
+        // in other processes (replaces a running stream; texture delivery is not supported)
+        // Frames larger than the slots are skipped and counted in the ring header
+        ErrorCode StartRingStream(const FrameRingOptions& ringOptions, const StreamOptions& options = StreamOptions());
+
+        // Stream frames into files encoded on worker threads instead of a callback
+        // (replaces a running stream; texture delivery is not supported)
+        // The callback only copies the pixels into the encode queue, whose backpressure
+        // decides between waiting for an encoder and dropping the oldest queued frame;
+        // stopping the stream waits until every queued frame is written
+        ErrorCode StartFileStream(const FileStreamOptions& fileOptions, const StreamOptions& options = StreamOptions(), FileEncodeCompletion completion = nullptr);
+
+        // Crop and downscale frames copied from now on (the session must be open)
+        // Texture streams still get the full frame pool surface
+        ErrorCode SetRegion(const CaptureRegion& region);
+
+        // Copy every frame into a texture of the capture format shared through an NT handle (the session must be open)
+        // The shared texture always holds the full frame, whatever the region
+        ErrorCode EnableTextureSharing(const SharedTextureOptions& options = SharedTextureOptions());
+        void DisableTextureSharing();
+
+        // Describe the shared texture, waiting up to timeoutMs for the first shared frame
+        ErrorCode GetSharedTexture(SharedTextureInfo& info, uint32_t timeoutMs = DefaultFrameTimeoutMs);
+
+        // Stop the running stream, waiting for an in-flight callback
+        void StopStream();
+
+        // Get the delivery counters of the running stream
+        ErrorCode GetStreamStats(StreamStats& stats);
+
+        // Stop capturing and release the device, frame pool and session
+        void Close();
+
+        // Choose the GPU of the next Open (by default the one driving the target's monitor)
+        void SetAdapterOptions(const AdapterOptions& options);
+
+        bool IsOpen() const;
+
+    private:
+        struct Impl;
+
+        ILogger* m_logger;
+        SilentLogger m_defaultLogger;
+        std::shared_ptr<Impl> m_impl;
+        AdapterOptions m_adapterOptions;
+        std::shared_ptr<CaptureWorker> m_worker;    // nullptr: CaptureWorker::Instance()
+
+        void Log(const std::wstring& message);
+        void Log(const wchar_t* message);
+        void LogError(const std::wstring& message);
+        bool LogEnabled() const;
+
+        // Run work on the CaptureWorker thread and return its result
+        ErrorCode RunOnWorker(const std::function<ErrorCode()>& work) const;
+
+        ErrorCode InternalOpen(const CaptureTarget& target, CaptureFormat captureFormat, bool hideBorder, bool hideCursor, int32_t bufferCount);
     };
 }
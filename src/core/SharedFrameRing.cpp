@@ -0,0 +1,112 @@
+#include "SharedFrameRing.h"
+#include "FrameEncoder.h"
+#include "../../pch.h"
+#include <atomic>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    // Slots start on cache lines so a slot header never shares one with the previous slot's pixels
+    constexpr uint64_t FrameRingAlignment = 64;
+
+    SharedFrameRing::SharedFrameRing(const std::wstring& name, uint32_t slotCount, uint64_t slotCapacity)
+    {
+        if (name.empty() || slotCount < 2 || slotCount > MaxFrameRingSlots || slotCapacity == 0)
+        {
+            throw hresult_error(E_INVALIDARG, L"Invalid frame ring options");
+        }
+
+        const uint64_t capacity = (slotCapacity + FrameRingAlignment - 1) / FrameRingAlignment * FrameRingAlignment;
+        const uint64_t slotSize = sizeof(FrameRingSlotHeader) + capacity;
+        const uint64_t mappingSize = sizeof(FrameRingHeader) + slotSize * slotCount;
+
+        m_mapping.attach(CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+            static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize), name.c_str()));
+        if (!m_mapping)
+        {
+            throw_last_error();
+        }
+
+        // Another writer owns this name; attaching to it would corrupt its ring
+        if (GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            throw hresult_error(HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS), L"A frame ring with this name already exists");
+        }
+
+        m_view = static_cast<uint8_t*>(MapViewOfFile(m_mapping.get(), FILE_MAP_ALL_ACCESS, 0, 0, 0));
+        if (!m_view)
+        {
+            throw_last_error();
+        }
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+
+        // New mappings are zero-filled; readers wait for the magic, which is stored last
+        m_header = reinterpret_cast<FrameRingHeader*>(m_view);
+        m_header->version = FrameRingVersion;
+        m_header->headerSize = sizeof(FrameRingHeader);
+        m_header->slotCount = slotCount;
+        m_header->slotSize = slotSize;
+        m_header->slotCapacity = capacity;
+        m_header->qpcFrequency = frequency.QuadPart;
+        m_header->latestSlot = -1;
+        std::atomic_ref<uint32_t>(m_header->magic).store(FrameRingMagic, std::memory_order_release);
+    }
+
+    SharedFrameRing::~SharedFrameRing()
+    {
+        if (m_view)
+        {
+            UnmapViewOfFile(m_view);
+        }
+    }
+
+    FrameRingSlotHeader* SharedFrameRing::Slot(uint32_t index) const
+    {
+        return reinterpret_cast<FrameRingSlotHeader*>(m_view + m_header->headerSize + m_header->slotSize * index);
+    }
+
+    bool SharedFrameRing::Publish(const StreamFrame& frame)
+    {
+        if (!frame.pixels)
+        {
+            return false;
+        }
+
+        const uint32_t stride = frame.width * 4;
+        const uint64_t dataSize = static_cast<uint64_t>(stride) * frame.height;
+        if (dataSize > m_header->slotCapacity)
+        {
+            std::atomic_ref<uint64_t>(m_header->skippedCount).store(++m_skippedCount, std::memory_order_relaxed);
+            return false;
+        }
+
+        // The newest slot is never the one being written, so readers of it are not disturbed
+        FrameRingSlotHeader* slot = Slot(m_nextSlot);
+        std::atomic_ref<uint64_t> sequence(slot->sequence);
+        const uint64_t stable = sequence.load(std::memory_order_relaxed);
+
+        sequence.store(stable + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot->frameNumber = frame.frameNumber;
+        slot->systemRelativeTime = frame.timestamp;
+        // SystemRelativeTime is the QPC converted to 100 ns units; convert back without overflowing
+        slot->qpcTimestamp = frame.timestamp / 10000000 * m_header->qpcFrequency + frame.timestamp % 10000000 * m_header->qpcFrequency / 10000000;
+        slot->width = frame.width;
+        slot->height = frame.height;
+        slot->stride = stride;
+        slot->format = static_cast<uint32_t>(PixelFormat::Bgra);
+        slot->dataSize = static_cast<uint32_t>(dataSize);
+        CopyRows(reinterpret_cast<uint8_t*>(slot + 1), stride, frame.pixels, frame.stride, stride, frame.height);
+
+        sequence.store(stable + 2, std::memory_order_release);
+
+        std::atomic_ref<int64_t>(m_header->latestSlot).store(m_nextSlot, std::memory_order_release);
+        std::atomic_ref<uint64_t>(m_header->publishedCount).store(++m_publishedCount, std::memory_order_release);
+        m_nextSlot = (m_nextSlot + 1) % m_header->slotCount;
+        return true;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <winrt/base.h>
+
+namespace ScreenCaptureCore
+{
+    // Binary layout of a frame ring mapping, shared with readers in other processes
+    // The mapping is a FrameRingHeader followed by slotCount slots of slotSize bytes;
+    // each slot is a FrameRingSlotHeader followed by tightly packed BGRA rows.
+    // All fields are little-endian and naturally aligned
+    constexpr uint32_t FrameRingMagic = 0x42524353;     // "SCRB"
+    constexpr uint32_t FrameRingVersion = 1;
+    constexpr uint32_t MaxFrameRingSlots = 16;
+
+    struct FrameRingHeader
+    {
+        uint32_t magic;             // FrameRingMagic once the ring is initialized
+        uint32_t version;           // FrameRingVersion
+        uint32_t headerSize;        // Offset of the first slot
+        uint32_t slotCount;
+        uint64_t slotSize;          // Bytes from one slot to the next
+        uint64_t slotCapacity;      // Pixel bytes a slot holds
+        int64_t qpcFrequency;       // QueryPerformanceFrequency of the slot timestamps
+        int64_t latestSlot;         // Newest complete slot, -1 before the first frame
+        uint64_t publishedCount;    // Frames published so far
+        uint64_t skippedCount;      // Frames too large for a slot
+    };
+
+    struct FrameRingSlotHeader
+    {
+        uint64_t sequence;          // Seqlock: odd while the slot is being written
+        uint64_t frameNumber;       // Stream frame number
+        int64_t qpcTimestamp;       // Capture time in QueryPerformanceCounter ticks
+        int64_t systemRelativeTime; // Capture time in 100 ns units (StreamFrame::timestamp)
+        uint32_t width;
+        uint32_t height;
+        uint32_t stride;            // Always width * 4
+        uint32_t format;            // PixelFormat (always Bgra)
+        uint32_t dataSize;          // stride * height
+        uint32_t reserved[3];
+    };
+
+    static_assert(sizeof(FrameRingHeader) == 64, "Frame ring header layout changed");
+    static_assert(sizeof(FrameRingSlotHeader) == 64, "Frame ring slot layout changed");
+
+    // Publishes stream frames into a named shared-memory ring
+    // The writer fills the slot after the newest one and bumps its sequence to an odd
+    // value first and an even one last; readers take the header's latestSlot, read the
+    // slot in place and accept it if the sequence was even and unchanged across the read.
+    // Readers never block the writer and need no lock or copy
+    class SharedFrameRing
+    {
+    public:
+        // Create the mapping with slots of slotCapacity pixel bytes
+        // Throws winrt::hresult_error if it cannot be created or the name is in use
+        SharedFrameRing(const std::wstring& name, uint32_t slotCount, uint64_t slotCapacity);
+        ~SharedFrameRing();
+
+        SharedFrameRing(const SharedFrameRing&) = delete;
+        SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+        // Copy a mapped stream frame into the next slot (single writer)
+        // Returns false if the frame does not fit a slot
+        bool Publish(const StreamFrame& frame);
+
+    private:
+        winrt::handle m_mapping;
+        uint8_t* m_view = nullptr;
+        FrameRingHeader* m_header = nullptr;
+        uint32_t m_nextSlot = 0;
+        uint64_t m_publishedCount = 0;
+        uint64_t m_skippedCount = 0;
+
+        FrameRingSlotHeader* Slot(uint32_t index) const;
+    };
+}
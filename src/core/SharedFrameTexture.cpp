@@ -0,0 +1,142 @@
+#include "SharedFrameTexture.h"
+#include "../../pch.h"
+#include <chrono>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    SharedFrameTexture::SharedFrameTexture(const SharedTextureOptions& options)
+        : m_options(options)
+    {
+        m_info.keyedMutex = options.keyedMutex;
+    }
+
+    bool SharedFrameTexture::Publish(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* texture)
+    {
+        D3D11_TEXTURE2D_DESC desc;
+        texture->GetDesc(&desc);
+
+        if (!m_fenceChecked)
+        {
+            CreateFence(device, context);
+        }
+
+        if (!m_current.texture || desc.Width != m_info.width || desc.Height != m_info.height)
+        {
+            Recreate(device, desc);
+        }
+
+        // Never block the frame pool on a consumer; skip the frame instead
+        if (m_current.keyedMutex)
+        {
+            HRESULT hr = m_current.keyedMutex->AcquireSync(0, 0);
+            if (hr == static_cast<HRESULT>(WAIT_TIMEOUT))
+            {
+                return false;
+            }
+            check_hresult(hr);
+        }
+
+        context->CopyResource(m_current.texture.get(), texture);
+
+        if (m_current.keyedMutex)
+        {
+            check_hresult(m_current.keyedMutex->ReleaseSync(0));
+        }
+
+        uint64_t frameNumber = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            frameNumber = ++m_info.frameNumber;
+        }
+
+        if (m_fence)
+        {
+            check_hresult(m_fenceContext->Signal(m_fence.get(), frameNumber));
+        }
+
+        // Submit now so other devices see the copy without waiting for our next batch
+        context->Flush();
+        m_condition.notify_all();
+        return true;
+    }
+
+    bool SharedFrameTexture::Wait(SharedTextureInfo& info, uint32_t timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return m_info.frameNumber > 0; }))
+        {
+            return false;
+        }
+
+        info = m_info;
+        return true;
+    }
+
+    void SharedFrameTexture::CreateFence(ID3D11Device* device, ID3D11DeviceContext* context)
+    {
+        m_fenceChecked = true;
+
+        // Shared fences need ID3D11Device5 (Windows 10 Creators Update); keyed mutexes work without them
+        com_ptr<ID3D11Device5> device5;
+        com_ptr<ID3D11DeviceContext4> context4;
+        if (FAILED(device->QueryInterface(IID_PPV_ARGS(device5.put()))) ||
+            FAILED(context->QueryInterface(IID_PPV_ARGS(context4.put()))))
+        {
+            return;
+        }
+
+        com_ptr<ID3D11Fence> fence;
+        if (FAILED(device5->CreateFence(0, D3D11_FENCE_FLAG_SHARED, IID_PPV_ARGS(fence.put()))))
+        {
+            return;
+        }
+
+        winrt::handle fenceHandle;
+        if (FAILED(fence->CreateSharedHandle(nullptr, GENERIC_ALL, nullptr, fenceHandle.put())))
+        {
+            return;
+        }
+
+        m_fence = std::move(fence);
+        m_fenceContext = std::move(context4);
+        m_fenceHandle = std::move(fenceHandle);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_info.fenceHandle = m_fenceHandle.get();
+    }
+
+    void SharedFrameTexture::Recreate(ID3D11Device* device, const D3D11_TEXTURE2D_DESC& sourceDesc)
+    {
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = sourceDesc.Width;
+        desc.Height = sourceDesc.Height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = sourceDesc.Format;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED_NTHANDLE |
+            (m_options.keyedMutex ? D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX : D3D11_RESOURCE_MISC_SHARED);
+
+        Generation generation;
+        check_hresult(device->CreateTexture2D(&desc, nullptr, generation.texture.put()));
+        if (m_options.keyedMutex)
+        {
+            generation.keyedMutex = generation.texture.as<IDXGIKeyedMutex>();
+        }
+
+        auto resource = generation.texture.as<IDXGIResource1>();
+        check_hresult(resource->CreateSharedHandle(nullptr, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE, nullptr, generation.handle.put()));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_previous = std::move(m_current);
+        m_current = std::move(generation);
+        m_info.textureHandle = m_current.handle.get();
+        m_info.width = desc.Width;
+        m_info.height = desc.Height;
+        ++m_info.generation;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+#include <d3d11_4.h>
+#include <winrt/base.h>
+#include <mutex>
+#include <condition_variable>
+
+namespace ScreenCaptureCore
+{
+    // Publishes captured frames in a shared texture that other D3D11/D3D12 devices
+    // and processes open through an NT handle, with no CPU readback
+    // Publish runs on the frame pool thread; Wait may be called from any thread
+    class SharedFrameTexture
+    {
+    public:
+        explicit SharedFrameTexture(const SharedTextureOptions& options);
+
+        SharedFrameTexture(const SharedFrameTexture&) = delete;
+        SharedFrameTexture& operator=(const SharedFrameTexture&) = delete;
+
+        // Copy texture into the shared texture, recreating it when the size changes
+        // Returns false if a consumer held the keyed mutex and the frame was skipped
+        // Throws winrt::hresult_error on failure
+        bool Publish(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11Texture2D* texture);
+
+        // Wait up to timeoutMs for the first published frame and describe the texture
+        // Returns false on timeout
+        bool Wait(SharedTextureInfo& info, uint32_t timeoutMs);
+
+        const SharedTextureOptions& Options() const { return m_options; }
+
+    private:
+        // One shared texture; replaced when the frame size changes
+        struct Generation
+        {
+            winrt::com_ptr<ID3D11Texture2D> texture;
+            winrt::com_ptr<IDXGIKeyedMutex> keyedMutex;
+            winrt::handle handle;
+        };
+
+        SharedTextureOptions m_options;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        SharedTextureInfo m_info;
+
+        // The previous generation stays open so a handle that was just handed
+        // out remains valid until one more resize
+        Generation m_current;
+        Generation m_previous;
+
+        winrt::com_ptr<ID3D11Fence> m_fence;
+        winrt::com_ptr<ID3D11DeviceContext4> m_fenceContext;
+        winrt::handle m_fenceHandle;
+        bool m_fenceChecked = false;
+
+        void CreateFence(ID3D11Device* device, ID3D11DeviceContext* context);
+        void Recreate(ID3D11Device* device, const D3D11_TEXTURE2D_DESC& sourceDesc);
+    };
+}
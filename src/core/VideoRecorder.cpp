@@ -0,0 +1,386 @@
+#include "VideoRecorder.h"
+#include "CaptureStats.h"
+#include "../../pch.h"
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#include <mferror.h>
+#include <filesystem>
+#include <atomic>
+
+using namespace winrt;
+
+namespace ScreenCaptureCore
+{
+    // Encoder-owned textures in flight; when all are queued the frame is dropped
+    constexpr DWORD MaxEncoderSamples = 8;
+
+    struct VideoRecorder::Impl
+    {
+        ILogger* logger = nullptr;
+        std::wstring outputPath;
+        RecordOptions options;
+
+        // Media Foundation objects (created on the first frame, once the size is known)
+        com_ptr<IMFDXGIDeviceManager> deviceManager;
+        UINT resetToken = 0;
+        com_ptr<IMFSinkWriter> sinkWriter;
+        DWORD streamIndex = 0;
+        com_ptr<IMFVideoSampleAllocatorEx> sampleAllocator;
+        com_ptr<ID3D11DeviceContext> context;
+        bool writing = false;
+
+        // Encoded size (rounded down to even dimensions for the encoder)
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        // Frame pacing in 100 ns units relative to the first frame
+        int64_t firstTimestamp = -1;
+        int64_t nextFrameTime = 0;
+        int64_t frameDuration = 0;
+
+        std::atomic<uint64_t> framesWritten{ 0 };
+        std::atomic<uint64_t> framesDropped{ 0 };
+
+        // Set once when the writer is created (or fails) on the first frame
+        std::mutex startMutex;
+        std::condition_variable startCondition;
+        bool startDone = false;
+        ErrorCode startResult = ErrorCode::Success;
+
+        // First error after start; later frames are ignored
+        ErrorCode writeResult = ErrorCode::Success;
+
+        void OnFrame(const StreamFrame& frame)
+        {
+            if (!frame.texture || writeResult != ErrorCode::Success)
+            {
+                return;
+            }
+
+            if (!writing)
+            {
+                if (startDone)
+                {
+                    return;
+                }
+
+                CompleteStart(CreateWriter(static_cast<ID3D11Device*>(frame.device), frame.width, frame.height));
+                if (!writing)
+                {
+                    return;
+                }
+            }
+
+            // Keep the output at the requested frame rate
+            if (firstTimestamp < 0)
+            {
+                firstTimestamp = frame.timestamp;
+            }
+            const int64_t sampleTime = frame.timestamp - firstTimestamp;
+            if (sampleTime < nextFrameTime)
+            {
+                return;
+            }
+            nextFrameTime = (sampleTime / frameDuration + 1) * frameDuration;
+
+            // The encoder size is fixed; skip frames that no longer cover it
+            if (frame.width < width || frame.height < height)
+            {
+                ++framesDropped;
+                RecordDroppedFrames(1);
+                return;
+            }
+
+            try
+            {
+                WriteFrame(static_cast<ID3D11Texture2D*>(frame.texture), sampleTime);
+            }
+            catch (hresult_error const& ex)
+            {
+                logger->LogError(L"Failed to encode frame: " + std::wstring(ex.message()));
+                writeResult = ErrorCode::EncoderFailed;
+            }
+        }
+
+        void CompleteStart(ErrorCode result)
+        {
+            {
+                std::lock_guard<std::mutex> lock(startMutex);
+                startDone = true;
+                startResult = result;
+            }
+            startCondition.notify_all();
+        }
+
+        ErrorCode CreateWriter(ID3D11Device* device, uint32_t frameWidth, uint32_t frameHeight)
+        {
+            width = frameWidth & ~1u;
+            height = frameHeight & ~1u;
+            frameDuration = 10000000LL / options.frameRate;
+
+            if (width == 0 || height == 0)
+            {
+                logger->LogError(L"Frame is too small to encode");
+                return ErrorCode::EncoderFailed;
+            }
+
+            try
+            {
+                // Ensure the output directory exists
+                auto parentPath = std::filesystem::path(outputPath).parent_path();
+                if (!parentPath.empty() && !std::filesystem::exists(parentPath))
+                {
+                    std::filesystem::create_directories(parentPath);
+                }
+            }
+            catch (...)
+            {
+                logger->LogError(L"Failed to create output directory");
+                return ErrorCode::FileSaveFailed;
+            }
+
+            try
+            {
+                device->GetImmediateContext(context.put());
+
+                // Share the capture device with the encoder
+                check_hresult(MFCreateDXGIDeviceManager(&resetToken, deviceManager.put()));
+                check_hresult(deviceManager->ResetDevice(device, resetToken));
+
+                com_ptr<IMFAttributes> attributes;
+                check_hresult(MFCreateAttributes(attributes.put(), 4));
+                check_hresult(attributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE));
+                check_hresult(attributes->SetUnknown(MF_SINK_WRITER_D3D_MANAGER, deviceManager.get()));
+                check_hresult(attributes->SetUINT32(MF_SINK_WRITER_DISABLE_THROTTLING, TRUE));
+                check_hresult(attributes->SetGUID(MF_TRANSCODE_CONTAINERTYPE, MFTranscodeContainerType_MPEG4));
+
+                check_hresult(MFCreateSinkWriterFromURL(outputPath.c_str(), nullptr, attributes.get(), sinkWriter.put()));
+
+                // Encoded stream
+                com_ptr<IMFMediaType> outputType;
+                check_hresult(MFCreateMediaType(outputType.put()));
+                check_hresult(outputType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video));
+                check_hresult(outputType->SetGUID(MF_MT_SUBTYPE, options.codec == VideoCodec::Hevc ? MFVideoFormat_HEVC : MFVideoFormat_H264));
+                check_hresult(outputType->SetUINT32(MF_MT_AVG_BITRATE, options.bitrate));
+                check_hresult(outputType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive));
+                check_hresult(MFSetAttributeSize(outputType.get(), MF_MT_FRAME_SIZE, width, height));
+                check_hresult(MFSetAttributeRatio(outputType.get(), MF_MT_FRAME_RATE, options.frameRate, 1));
+                check_hresult(MFSetAttributeRatio(outputType.get(), MF_MT_PIXEL_ASPECT_RATIO, 1, 1));
+                check_hresult(sinkWriter->AddStream(outputType.get(), &streamIndex));
+
+                // BGRA textures in; the sink writer converts to the encoder format on the GPU
+                com_ptr<IMFMediaType> inputType;
+                check_hresult(MFCreateMediaType(inputType.put()));
+                check_hresult(inputType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video));
+                check_hresult(inputType->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_ARGB32));
+                check_hresult(inputType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive));
+                check_hresult(MFSetAttributeSize(inputType.get(), MF_MT_FRAME_SIZE, width, height));
+                check_hresult(MFSetAttributeRatio(inputType.get(), MF_MT_FRAME_RATE, options.frameRate, 1));
+                check_hresult(MFSetAttributeRatio(inputType.get(), MF_MT_PIXEL_ASPECT_RATIO, 1, 1));
+                check_hresult(sinkWriter->SetInputMediaType(streamIndex, inputType.get(), nullptr));
+
+                // Recycled encoder textures matching the input type
+                check_hresult(MFCreateVideoSampleAllocatorEx(__uuidof(IMFVideoSampleAllocatorEx), sampleAllocator.put_void()));
+                check_hresult(sampleAllocator->SetDirectXManager(deviceManager.get()));
+
+                com_ptr<IMFAttributes> allocatorAttributes;
+                check_hresult(MFCreateAttributes(allocatorAttributes.put(), 1));
+                check_hresult(allocatorAttributes->SetUINT32(MF_SA_D3D11_BINDFLAGS, D3D11_BIND_SHADER_RESOURCE));
+                check_hresult(sampleAllocator->InitializeSampleAllocatorEx(2, MaxEncoderSamples, allocatorAttributes.get(), inputType.get()));
+
+                check_hresult(sinkWriter->BeginWriting());
+                writing = true;
+                return ErrorCode::Success;
+            }
+            catch (hresult_error const& ex)
+            {
+                logger->LogError(L"Failed to create video encoder: " + std::wstring(ex.message()));
+                return ErrorCode::EncoderFailed;
+            }
+        }
+
+        void WriteFrame(ID3D11Texture2D* texture, int64_t sampleTime)
+        {
+            com_ptr<IMFSample> sample;
+            HRESULT hr = sampleAllocator->AllocateSample(sample.put());
+            if (hr == MF_E_SAMPLEALLOCATOR_EMPTY)
+            {
+                // Every encoder texture is still queued
+                ++framesDropped;
+                RecordDroppedFrames(1);
+                return;
+            }
+            check_hresult(hr);
+
+            com_ptr<IMFMediaBuffer> buffer;
+            check_hresult(sample->GetBufferByIndex(0, buffer.put()));
+
+            auto dxgiBuffer = buffer.as<IMFDXGIBuffer>();
+            com_ptr<ID3D11Texture2D> target;
+            check_hresult(dxgiBuffer->GetResource(__uuidof(ID3D11Texture2D), target.put_void()));
+            UINT subresource = 0;
+            check_hresult(dxgiBuffer->GetSubresourceIndex(&subresource));
+
+            // GPU copy out of the frame pool surface, which is recycled after the callback
+            D3D11_BOX box = { 0, 0, 0, width, height, 1 };
+            context->CopySubresourceRegion(target.get(), subresource, 0, 0, 0, texture, 0, &box);
+
+            DWORD length = 0;
+            check_hresult(buffer.as<IMF2DBuffer>()->GetContiguousLength(&length));
+            check_hresult(buffer->SetCurrentLength(length));
+
+            check_hresult(sample->SetSampleTime(sampleTime));
+            check_hresult(sample->SetSampleDuration(frameDuration));
+            check_hresult(sinkWriter->WriteSample(streamIndex, sample.get()));
+            ++framesWritten;
+        }
+
+        ErrorCode Finalize()
+        {
+            ErrorCode result = writeResult;
+            if (writing)
+            {
+                HRESULT hr = sinkWriter->Finalize();
+                if (FAILED(hr))
+                {
+                    logger->LogError(L"Failed to finalize video file");
+                    if (result == ErrorCode::Success)
+                    {
+                        result = ErrorCode::FileSaveFailed;
+                    }
+                }
+                writing = false;
+            }
+
+            sinkWriter = nullptr;
+            sampleAllocator = nullptr;
+            deviceManager = nullptr;
+            context = nullptr;
+            return result;
+        }
+    };
+
+    VideoRecorder::VideoRecorder(ILogger* logger)
+        : m_logger(logger ? logger : &m_defaultLogger)
+    {
+    }
+
+    VideoRecorder::~VideoRecorder()
+    {
+        Stop();
+    }
+
+    void VideoRecorder::Log(const std::wstring& message)
+    {
+        if (m_logger)
+        {
+            m_logger->LogInfo(message);
+        }
+    }
+
+    void VideoRecorder::LogError(const std::wstring& message)
+    {
+        if (m_logger)
+        {
+            m_logger->LogError(message);
+        }
+    }
+
+    ErrorCode VideoRecorder::Start(const std::wstring& outputPath, const RecordOptions& options)
+    {
+        if (m_impl)
+        {
+            LogError(L"Recording is already running");
+            return ErrorCode::InvalidParameter;
+        }
+
+        if (outputPath.empty() || options.frameRate == 0 || options.bitrate == 0)
+        {
+            LogError(L"Invalid recording options");
+            return ErrorCode::InvalidParameter;
+        }
+
+        HRESULT hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+        if (FAILED(hr))
+        {
+            LogError(L"Failed to start Media Foundation");
+            return ErrorCode::InitializationFailed;
+        }
+
+        m_impl = std::make_unique<Impl>();
+        m_impl->logger = m_logger;
+        m_impl->outputPath = outputPath;
+        m_impl->options = options;
+
+        StreamOptions streamOptions;
+        streamOptions.hideBorder = options.hideBorder;
+        streamOptions.hideCursor = options.hideCursor;
+        streamOptions.delivery = StreamDelivery::EveryFrame;
+        streamOptions.deliverTexture = true;
+        streamOptions.target = options.target;
+
+        // The stream stops before m_impl is released, so the raw pointer stays valid
+        Impl* impl = m_impl.get();
+        m_session = std::make_unique<CaptureSession>(m_logger);
+        m_session->SetAdapterOptions(options.adapter);
+        auto result = m_session->StartStream([impl](const StreamFrame& frame) { impl->OnFrame(frame); }, streamOptions);
+
+        if (result == ErrorCode::Success)
+        {
+            std::unique_lock<std::mutex> lock(m_impl->startMutex);
+            if (!m_impl->startCondition.wait_for(lock, std::chrono::milliseconds(options.firstFrameTimeoutMs), [impl] { return impl->startDone; }))
+            {
+                LogError(L"Timeout: No frame received for recording");
+                result = ErrorCode::TimeoutError;
+            }
+            else
+            {
+                result = m_impl->startResult;
+            }
+        }
+
+        if (result != ErrorCode::Success)
+        {
+            Stop();
+            return result;
+        }
+
+        Log(L"Recording started: " + outputPath);
+        return ErrorCode::Success;
+    }
+
+    ErrorCode VideoRecorder::Stop()
+    {
+        if (!m_impl)
+        {
+            return ErrorCode::Success;
+        }
+
+        // No callbacks run once the session is closed
+        m_session.reset();
+
+        auto result = m_impl->Finalize();
+        Log(L"Recording stopped. Frames written: " + std::to_wstring(m_impl->framesWritten.load()) +
+            L", dropped: " + std::to_wstring(m_impl->framesDropped.load()));
+
+        m_impl.reset();
+        MFShutdown();
+        return result;
+    }
+
+    bool VideoRecorder::IsRecording() const
+    {
+        return m_impl != nullptr;
+    }
+
+    uint64_t VideoRecorder::FramesWritten() const
+    {
+        return m_impl ? m_impl->framesWritten.load() : 0;
+    }
+
+    uint64_t VideoRecorder::FramesDropped() const
+    {
+        return m_impl ? m_impl->framesDropped.load() : 0;
+    }
+}
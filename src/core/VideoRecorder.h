@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ScreenCaptureCore.h"
+
+namespace ScreenCaptureCore
+{
+    // Video codecs for recording
+    enum class VideoCodec
+    {
+        H264,
+        Hevc
+    };
+
+    // Recording options
+    struct RecordOptions
+    {
+        bool hideBorder = true;
+        bool hideCursor = true;
+        VideoCodec codec = VideoCodec::H264;
+        uint32_t frameRate = 30;                            // Output frames per second; faster captures are skipped
+        uint32_t bitrate = 8000000;                         // Average bits per second
+        uint32_t firstFrameTimeoutMs = DefaultFrameTimeoutMs;
+        CaptureTarget target;                               // Monitor or window (AllMonitors is not supported)
+        AdapterOptions adapter;                             // GPU the capture and encode device is created on
+    };
+
+    // Records a monitor or window to an MP4 file with a Media Foundation encoder
+    // Frames never leave the GPU: each capture texture is copied into an encoder-owned
+    // texture that reaches the (hardware) encoder through a DXGI device manager
+    class VideoRecorder
+    {
+    public:
+        VideoRecorder(ILogger* logger = nullptr);
+
+        // Stops and finalizes a running recording
+        ~VideoRecorder();
+
+        VideoRecorder(const VideoRecorder&) = delete;
+        VideoRecorder& operator=(const VideoRecorder&) = delete;
+
+        // Start recording to outputPath
+        // Returns once the encoder has been set up for the first frame (or setup failed)
+        ErrorCode Start(const std::wstring& outputPath, const RecordOptions& options = RecordOptions());
+
+        // Stop recording and finalize the MP4 file
+        ErrorCode Stop();
+
+        bool IsRecording() const;
+
+        // Frames handed to the encoder
+        uint64_t FramesWritten() const;
+
+        // Frames skipped because the encoder was behind or the frame size changed
+        uint64_t FramesDropped() const;
+
+    private:
+        struct Impl;
+
+        ILogger* m_logger;
+        SilentLogger m_defaultLogger;
+        std::unique_ptr<CaptureSession> m_session;
+        std::unique_ptr<Impl> m_impl;
+
+        void Log(const std::wstring& message);
+        void LogError(const std::wstring& message);
+    };
+}
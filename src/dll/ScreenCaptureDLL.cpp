@@ -1,8 +1,16 @@
 #include "ScreenCaptureDLL.h"
 #include "../../pch.h"
 #include "../core/ScreenCaptureCore.h"
+#include "../core/VideoRecorder.h"
+#include "../core/CaptureQueue.h"
+#include "../core/CaptureDeviceCache.h"
+#include "../core/SharedFrameRing.h"
+#include "../core/CaptureStats.h"
 #include <string>
 #include <memory>
+#include <mutex>
+#include <algorithm>
+#include <atomic>
 
 using namespace ScreenCaptureCore;
 
@@ -25,41 +33,1139 @@ ScreenCaptureResult ConvertErrorCode(ErrorCode coreError)
         return SC_FILE_SAVE_FAILED;
     case ErrorCode::TimeoutError:
         return SC_TIMEOUT_ERROR;
+    case ErrorCode::BufferTooSmall:
+        return SC_BUFFER_TOO_SMALL;
+    case ErrorCode::FrameDropped:
+        return SC_FRAME_DROPPED;
+    case ErrorCode::EncoderFailed:
+        return SC_ENCODER_FAILED;
+    case ErrorCode::Cancelled:
+        return SC_CANCELLED;
+    case ErrorCode::InvalidParameter:
+        return SC_INVALID_PARAMETER;
     case ErrorCode::UnknownError:
     default:
         return SC_UNKNOWN_ERROR;
     }
 }
 
+// Copy a core buffer into a malloc'd buffer owned by the caller (released with FreeBuffer)
+ScreenCaptureResult CopyToCallerBuffer(const std::vector<uint8_t>& buffer, unsigned char** outputBuffer, unsigned int* bufferSize)
+{
+    *bufferSize = static_cast<unsigned int>(buffer.size());
+    *outputBuffer = static_cast<unsigned char*>(malloc(*bufferSize));
+
+    if (!*outputBuffer)
+    {
+        *bufferSize = 0;
+        return SC_UNKNOWN_ERROR; // Memory allocation failed
+    }
+
+    memcpy(*outputBuffer, buffer.data(), *bufferSize);
+    return SC_SUCCESS;
+}
+
+// Hand a raw frame to the caller in a malloc'd buffer (released with FreeBuffer)
+ScreenCaptureResult CopyRawFrameToCaller(const RawFrame& frame, void** pixels, int* width, int* height, int* stride)
+{
+    unsigned char* buffer = nullptr;
+    unsigned int bufferSize = 0;
+    auto result = CopyToCallerBuffer(frame.pixels, &buffer, &bufferSize);
+    if (result != SC_SUCCESS)
+    {
+        return result;
+    }
+
+    *pixels = buffer;
+    *width = static_cast<int>(frame.width);
+    *height = static_cast<int>(frame.height);
+    *stride = static_cast<int>(frame.stride);
+    return SC_SUCCESS;
+}
+
+// Reset raw frame output parameters before a capture
+void ClearRawFrameOutputs(void** pixels, int* width, int* height, int* stride)
+{
+    *pixels = nullptr;
+    *width = 0;
+    *height = 0;
+    *stride = 0;
+}
+
+// State behind a ScreenCaptureSessionHandle
+struct SessionContext
+{
+    // Silent logger for DLL (no console output); declared first so it outlives the session
+    SilentLogger logger;
+    CaptureSession session{ &logger };
+
+    // Encoded frame kept for GrabFrameToBuffer until the caller's buffer is large enough
+    std::mutex encodedMutex;
+    std::vector<uint8_t> encoded;
+    bool encodedPending = false;
+};
+
+// Translate DLL stream options (null means defaults) to core options
+StreamOptions ConvertStreamOptions(const ScreenCaptureStreamOptions* options)
+{
+    StreamOptions streamOptions;
+    if (options)
+    {
+        streamOptions.hideBorder = options->hideBorder != 0;
+        streamOptions.hideCursor = options->hideCursor != 0;
+        streamOptions.bufferCount = options->bufferCount > 0 ? options->bufferCount : DefaultFrameBufferCount;
+        streamOptions.delivery = options->latestFrameOnly != 0 ? StreamDelivery::LatestOnly : StreamDelivery::EveryFrame;
+        streamOptions.deliverTexture = options->deliverTexture != 0;
+        streamOptions.changeDetection = static_cast<ChangeDetection>(std::clamp(options->changeDetection, 0, static_cast<int>(ChangeDetection::SkipUnchanged)));
+        streamOptions.captureFormat = options->captureFormat == SC_CAPTURE_RGBA16F ? CaptureFormat::Rgba16Float : CaptureFormat::Bgra8;
+        streamOptions.targetFps = options->targetFps;
+        streamOptions.minUpdateIntervalMs = static_cast<uint32_t>((std::max)(options->minUpdateIntervalMs, 0));
+        streamOptions.adaptiveRate = options->adaptiveRate != 0;
+    }
+    return streamOptions;
+}
+
+// Translate a DLL capture format to a core capture format
+// Returns false for unknown formats
+bool ConvertCaptureFormat(int captureFormat, CaptureFormat& format)
+{
+    if (captureFormat < SC_CAPTURE_BGRA8 || captureFormat > SC_CAPTURE_RGBA16F)
+    {
+        return false;
+    }
+
+    // ScreenCaptureFormat values match the core CaptureFormat order
+    format = static_cast<CaptureFormat>(captureFormat);
+    return true;
+}
+
+// Translate a DLL pixel format to a core pixel format
+// Returns false for unknown formats
+bool ConvertPixelFormat(int pixelFormat, PixelFormat& format)
+{
+    if (pixelFormat < SC_PIXEL_BGRA || pixelFormat > SC_PIXEL_RGBA16F)
+    {
+        return false;
+    }
+
+    // ScreenCapturePixelFormat values match the core PixelFormat order
+    format = static_cast<PixelFormat>(pixelFormat);
+    return true;
+}
+
+// Dirty rectangles are handed to callers without copying
+static_assert(sizeof(ScreenCaptureDirtyRect) == sizeof(DirtyRect), "ScreenCaptureDirtyRect must match DirtyRect");
+static_assert(sizeof(ScreenCaptureRingHeader) == sizeof(FrameRingHeader), "ScreenCaptureRingHeader must match FrameRingHeader");
+static_assert(sizeof(ScreenCaptureRingSlot) == sizeof(FrameRingSlotHeader), "ScreenCaptureRingSlot must match FrameRingSlotHeader");
+
+// Translate DLL encode options (null means defaults) to core options
+// Returns false if a value is out of range
+bool ConvertEncodeOptions(const ScreenCaptureEncodeOptions* options, EncodeOptions& encodeOptions)
+{
+    encodeOptions = EncodeOptions();
+    if (!options)
+    {
+        return true;
+    }
+
+    if (options->format < SC_FORMAT_AUTO || options->format > SC_FORMAT_JXR ||
+        options->jpegQuality < 0 || options->jpegQuality > 100 ||
+        options->pngFilter < 0 || options->pngFilter > static_cast<int>(PngFilter::Adaptive))
+    {
+        return false;
+    }
+
+    // ScreenCaptureImageFormat values match the core ImageFormat order
+    encodeOptions.format = static_cast<ImageFormat>(options->format);
+    if (options->jpegQuality > 0)
+    {
+        encodeOptions.jpegQuality = options->jpegQuality / 100.0f;
+    }
+    encodeOptions.pngFilter = static_cast<PngFilter>(options->pngFilter);
+    encodeOptions.pngInterlace = options->pngInterlace != 0;
+    encodeOptions.parallelPng = options->pngParallel != 0;
+    return true;
+}
+
+// Translate a DLL capture target (null means primary monitor) to a core target
+// Returns false for unknown target types
+bool ConvertCaptureTarget(const ScreenCaptureTarget* target, CaptureTarget& captureTarget)
+{
+    captureTarget = CaptureTarget();
+    if (!target)
+    {
+        return true;
+    }
+
+    switch (target->type)
+    {
+    case SC_TARGET_PRIMARY_MONITOR:
+        return true;
+    case SC_TARGET_MONITOR_INDEX:
+        if (target->monitorIndex < 0)
+        {
+            return false;
+        }
+        captureTarget = CaptureTarget::FromMonitorIndex(static_cast<uint32_t>(target->monitorIndex));
+        return true;
+    case SC_TARGET_MONITOR:
+        captureTarget = CaptureTarget::FromMonitor(static_cast<HMONITOR>(target->monitor));
+        return true;
+    case SC_TARGET_WINDOW:
+        captureTarget = CaptureTarget::FromWindow(static_cast<HWND>(target->window));
+        return true;
+    case SC_TARGET_ALL_MONITORS:
+        captureTarget = CaptureTarget::AllMonitors();
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Translate a DLL capture region (null means the whole frame) to a core region
+// Returns false for negative sizes or a scale outside 0-100
+bool ConvertCaptureRegion(const ScreenCaptureRegion* region, CaptureRegion& captureRegion)
+{
+    captureRegion = CaptureRegion();
+    if (!region)
+    {
+        return true;
+    }
+
+    if (region->width < 0 || region->height < 0 || region->scalePercent < 0 || region->scalePercent > 100)
+    {
+        return false;
+    }
+
+    captureRegion.x = region->x;
+    captureRegion.y = region->y;
+    captureRegion.width = static_cast<uint32_t>(region->width);
+    captureRegion.height = static_cast<uint32_t>(region->height);
+    if (region->scalePercent > 0)
+    {
+        captureRegion.scale = region->scalePercent / 100.0f;
+    }
+    return true;
+}
+
+// State behind a recording handle
+struct RecordingContext
+{
+    // Declared first so it outlives the recorder
+    SilentLogger logger;
+    VideoRecorder recorder{ &logger };
+};
+
+// Translate DLL asynchronous capture options (null means defaults) to a core request
+// Returns false if a value is out of range
+bool ConvertAsyncOptions(const ScreenCaptureAsyncOptions* options, CaptureRequest& request)
+{
+    request = CaptureRequest();
+    if (!options)
+    {
+        return true;
+    }
+
+    if (options->timeoutMs < 0 ||
+        !ConvertCaptureTarget(options->target, request.target) ||
+        !ConvertCaptureRegion(options->region, request.region) ||
+        !ConvertEncodeOptions(options->encodeOptions, request.encodeOptions) ||
+        !ConvertCaptureFormat(options->captureFormat, request.captureFormat))
+    {
+        return false;
+    }
+
+    if (options->outputPath)
+    {
+        request.outputPath = options->outputPath;
+    }
+    request.hideBorder = options->hideBorder != 0;
+    request.hideCursor = options->hideCursor != 0;
+    request.timeoutMs = options->timeoutMs > 0 ? static_cast<uint32_t>(options->timeoutMs) : DefaultFrameTimeoutMs;
+    return true;
+}
+
+// Translate a DLL frame request to a core request
+// Returns false if a value is out of range
+bool ConvertFrameRequest(const ScreenCaptureFrameRequest& source, FrameRequest& request)
+{
+    request = FrameRequest();
+    if (source.timeoutMs < 0 ||
+        !ConvertCaptureTarget(&source.target, request.target) ||
+        !ConvertCaptureRegion(&source.region, request.region) ||
+        !ConvertCaptureFormat(source.captureFormat, request.captureFormat) ||
+        !ConvertPixelFormat(source.pixelFormat, request.pixelFormat))
+    {
+        return false;
+    }
+
+    request.encode = source.encode != 0;
+    if (request.encode && !ConvertEncodeOptions(&source.encodeOptions, request.encodeOptions))
+    {
+        return false;
+    }
+    request.hideBorder = source.hideBorder != 0;
+    request.hideCursor = source.hideCursor != 0;
+    request.timeoutMs = source.timeoutMs > 0 ? static_cast<uint32_t>(source.timeoutMs) : DefaultFrameTimeoutMs;
+    return true;
+}
+
+// Helper function to report a core frame output through a DLL frame buffer
+void ConvertFrameOutput(const FrameOutput& output, ScreenCaptureFrameBuffer& frame)
+{
+    frame.size = output.size;
+    frame.width = static_cast<int>(output.layout.width);
+    frame.height = static_cast<int>(output.layout.height);
+    frame.stride = static_cast<int>(output.layout.stride);
+    frame.pixelFormat = static_cast<int>(output.layout.format);
+    frame.result = ConvertErrorCode(output.result);
+}
+
+// Process-wide device and monitor item cache shared by every one-shot export,
+// so repeated P/Invoke calls skip device and item creation
+// Never destroyed either: releasing D3D and WinRT objects during unload is unsafe
+std::shared_ptr<CaptureDeviceCache> GetDeviceCache()
+{
+    static auto* cache = new std::shared_ptr<CaptureDeviceCache>(std::make_shared<CaptureDeviceCache>());
+    return *cache;
+}
+
+// Capture API of one-shot exports, set by SetCaptureBackend
+std::atomic<int> g_captureBackend{ SC_BACKEND_AUTO };
+
+CaptureBackend GetCaptureBackend()
+{
+    return static_cast<CaptureBackend>(g_captureBackend.load());
+}
+
+// Adapter choice of every capture, set by SetCaptureAdapter
+std::mutex g_adapterMutex;
+AdapterOptions g_adapterOptions;
+
+AdapterOptions GetCaptureAdapter()
+{
+    std::lock_guard<std::mutex> lock(g_adapterMutex);
+    return g_adapterOptions;
+}
+
+// Process-wide queue behind BeginCapture, started on first use
+// Deliberately never destroyed: joining its thread while the DLL unloads would
+// run under the loader lock
+CaptureQueue& GetCaptureQueue()
+{
+    static CaptureQueue* queue = new CaptureQueue(nullptr, GetDeviceCache());
+    return *queue;
+}
+
+// Translate DLL recording options (null means defaults) to core options
+RecordOptions ConvertRecordOptions(const ScreenCaptureRecordOptions* options)
+{
+    RecordOptions recordOptions;
+    recordOptions.adapter = GetCaptureAdapter();
+    if (options)
+    {
+        recordOptions.hideBorder = options->hideBorder != 0;
+        recordOptions.hideCursor = options->hideCursor != 0;
+        recordOptions.codec = options->codec == 1 ? VideoCodec::Hevc : VideoCodec::H264;
+        if (options->frameRate > 0)
+        {
+            recordOptions.frameRate = static_cast<uint32_t>(options->frameRate);
+        }
+        if (options->bitrate > 0)
+        {
+            recordOptions.bitrate = static_cast<uint32_t>(options->bitrate);
+        }
+    }
+    return recordOptions;
+}
+
 extern "C" {
 
-    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreen(const wchar_t* outputPath)
-    {
-        // Default: hide border and cursor
-        return CaptureScreenWithOptions(outputPath, 1, 1);
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreen(const wchar_t* outputPath)
+    {
+        // Default: hide border and cursor
+        return CaptureScreenWithOptions(outputPath, 1, 1);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithOptions(const wchar_t* outputPath, int hideBorder, int hideCursor)
+    {
+        return CaptureScreenWithTimeout(outputPath, hideBorder, hideCursor, static_cast<int>(DefaultFrameTimeoutMs));
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithTimeout(const wchar_t* outputPath, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        return CaptureScreenWithFormat(outputPath, nullptr, hideBorder, hideCursor, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithFormat(const wchar_t* outputPath, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        return CaptureScreenForTarget(outputPath, nullptr, encodeOptions, hideBorder, hideCursor, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenForTarget(const wchar_t* outputPath, const ScreenCaptureTarget* target, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        return CaptureScreenRegion(outputPath, target, nullptr, encodeOptions, hideBorder, hideCursor, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenRegion(const wchar_t* outputPath, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        return CaptureScreenWithCaptureFormat(outputPath, target, region, SC_CAPTURE_BGRA8, encodeOptions, hideBorder, hideCursor, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithCaptureFormat(const wchar_t* outputPath, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, int captureFormat, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        // Validate input parameters
+        if (!outputPath || wcslen(outputPath) == 0 || timeoutMs <= 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        EncodeOptions coreOptions;
+        CaptureTarget captureTarget;
+        CaptureRegion captureRegion;
+        CaptureFormat surfaceFormat = CaptureFormat::Bgra8;
+        if (!ConvertEncodeOptions(encodeOptions, coreOptions) || !ConvertCaptureTarget(target, captureTarget) ||
+            !ConvertCaptureRegion(region, captureRegion) || !ConvertCaptureFormat(captureFormat, surfaceFormat))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            // Create silent logger for DLL (no console output)
+            SilentLogger logger;
+            
+            // Create screen capture instance
+            ScreenCapture capture(&logger);
+            capture.SetDeviceCache(GetDeviceCache());
+            capture.SetBackend(GetCaptureBackend());
+            capture.SetAdapterOptions(GetCaptureAdapter());
+
+            // Perform capture with options
+            capture.SetTarget(captureTarget);
+            capture.SetRegion(captureRegion);
+            capture.SetCaptureFormat(surfaceFormat);
+            auto result = capture.CaptureToFile(std::wstring(outputPath), coreOptions, hideBorder != 0, hideCursor != 0, static_cast<uint32_t>(timeoutMs));
+
+            // Convert and return result
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureAllMonitorsToFiles(const wchar_t* outputPath, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        // Validate input parameters
+        if (!outputPath || wcslen(outputPath) == 0 || timeoutMs <= 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        EncodeOptions coreOptions;
+        if (!ConvertEncodeOptions(encodeOptions, coreOptions))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            // Create silent logger for DLL (no console output)
+            SilentLogger logger;
+            ScreenCapture capture(&logger);
+            capture.SetDeviceCache(GetDeviceCache());
+            capture.SetBackend(GetCaptureBackend());
+            capture.SetAdapterOptions(GetCaptureAdapter());
+
+            auto result = capture.CaptureAllMonitorsToFiles(std::wstring(outputPath), coreOptions, hideBorder != 0, hideCursor != 0, static_cast<uint32_t>(timeoutMs));
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureBurst(const wchar_t* outputPattern, int count, int intervalMs, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, int captureFormat, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        // Validate input parameters
+        if (!outputPattern || wcslen(outputPattern) == 0 || count <= 0 || intervalMs < 0 || timeoutMs <= 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        EncodeOptions coreOptions;
+        CaptureTarget captureTarget;
+        CaptureRegion captureRegion;
+        CaptureFormat surfaceFormat = CaptureFormat::Bgra8;
+        if (!ConvertEncodeOptions(encodeOptions, coreOptions) || !ConvertCaptureTarget(target, captureTarget) ||
+            !ConvertCaptureRegion(region, captureRegion) || !ConvertCaptureFormat(captureFormat, surfaceFormat))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            // Create silent logger for DLL (no console output)
+            SilentLogger logger;
+            ScreenCapture capture(&logger);
+            capture.SetDeviceCache(GetDeviceCache());
+            capture.SetBackend(GetCaptureBackend());
+            capture.SetAdapterOptions(GetCaptureAdapter());
+
+            capture.SetTarget(captureTarget);
+            capture.SetRegion(captureRegion);
+            capture.SetCaptureFormat(surfaceFormat);
+            auto result = capture.CaptureBurst(static_cast<uint32_t>(count), static_cast<uint32_t>(intervalMs), std::wstring(outputPattern), coreOptions, hideBorder != 0, hideCursor != 0, static_cast<uint32_t>(timeoutMs));
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureFrameInto(const ScreenCaptureFrameRequest* request, ScreenCaptureFrameBuffer* frame)
+    {
+        return CaptureFramesInto(request, frame, 1);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureFramesInto(const ScreenCaptureFrameRequest* requests, ScreenCaptureFrameBuffer* frames, int count)
+    {
+        // Validate input parameters
+        if (!requests || !frames || count <= 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        std::vector<FrameRequest> coreRequests(static_cast<size_t>(count));
+        std::vector<FrameOutput> outputs(static_cast<size_t>(count));
+        bool valid = true;
+        for (int i = 0; i < count; ++i)
+        {
+            frames[i].size = 0;
+            frames[i].result = SC_INVALID_PARAMETER;
+            if (!ConvertFrameRequest(requests[i], coreRequests[i]))
+            {
+                valid = false;
+            }
+            outputs[i].buffer = static_cast<uint8_t*>(frames[i].buffer);
+            outputs[i].bufferSize = static_cast<size_t>(frames[i].bufferSize);
+        }
+
+        if (!valid)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            // Create silent logger for DLL (no console output)
+            SilentLogger logger;
+            ScreenCapture capture(&logger);
+            capture.SetDeviceCache(GetDeviceCache());
+            capture.SetBackend(GetCaptureBackend());
+            capture.SetAdapterOptions(GetCaptureAdapter());
+
+            auto result = capture.CaptureFrames(coreRequests.data(), outputs.data(), outputs.size());
+            for (int i = 0; i < count; ++i)
+            {
+                ConvertFrameOutput(outputs[i], frames[i]);
+            }
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemory(unsigned char** outputBuffer, unsigned int* bufferSize, int hideBorder, int hideCursor)
+    {
+        return CaptureScreenToMemoryWithTimeout(outputBuffer, bufferSize, hideBorder, hideCursor, static_cast<int>(DefaultFrameTimeoutMs));
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryWithTimeout(unsigned char** outputBuffer, unsigned int* bufferSize, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        return CaptureScreenToMemoryWithFormat(outputBuffer, bufferSize, nullptr, hideBorder, hideCursor, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryWithFormat(unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        return CaptureScreenToMemoryForTarget(outputBuffer, bufferSize, nullptr, encodeOptions, hideBorder, hideCursor, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryForTarget(unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureTarget* target, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        return CaptureScreenToMemoryRegion(outputBuffer, bufferSize, target, nullptr, encodeOptions, hideBorder, hideCursor, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryRegion(unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        return CaptureScreenToMemoryWithCaptureFormat(outputBuffer, bufferSize, target, region, SC_CAPTURE_BGRA8, encodeOptions, hideBorder, hideCursor, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryWithCaptureFormat(unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, int captureFormat, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        // Validate input parameters
+        if (!outputBuffer || !bufferSize || timeoutMs <= 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        EncodeOptions coreOptions;
+        CaptureTarget captureTarget;
+        CaptureRegion captureRegion;
+        CaptureFormat surfaceFormat = CaptureFormat::Bgra8;
+        if (!ConvertEncodeOptions(encodeOptions, coreOptions) || !ConvertCaptureTarget(target, captureTarget) ||
+            !ConvertCaptureRegion(region, captureRegion) || !ConvertCaptureFormat(captureFormat, surfaceFormat))
+        {
+            *outputBuffer = nullptr;
+            *bufferSize = 0;
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            // Create silent logger for DLL (no console output)
+            SilentLogger logger;
+            
+            // Create screen capture instance
+            ScreenCapture capture(&logger);
+            capture.SetDeviceCache(GetDeviceCache());
+            capture.SetBackend(GetCaptureBackend());
+            capture.SetAdapterOptions(GetCaptureAdapter());
+
+            // Capture to memory buffer
+            std::vector<uint8_t> buffer;
+            capture.SetTarget(captureTarget);
+            capture.SetRegion(captureRegion);
+            capture.SetCaptureFormat(surfaceFormat);
+            auto result = capture.CaptureToMemory(buffer, coreOptions, hideBorder != 0, hideCursor != 0, static_cast<uint32_t>(timeoutMs));
+
+            if (result == ErrorCode::Success && !buffer.empty())
+            {
+                // Allocate buffer for caller
+                return CopyToCallerBuffer(buffer, outputBuffer, bufferSize);
+            }
+            else
+            {
+                *outputBuffer = nullptr;
+                *bufferSize = 0;
+                return ConvertErrorCode(result);
+            }
+        }
+        catch (...)
+        {
+            *outputBuffer = nullptr;
+            *bufferSize = 0;
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenRaw(void** pixels, int* width, int* height, int* stride, int hideBorder, int hideCursor)
+    {
+        return CaptureScreenRawWithPixelFormat(SC_PIXEL_BGRA, pixels, width, height, stride, hideBorder, hideCursor);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenRawWithPixelFormat(int pixelFormat, void** pixels, int* width, int* height, int* stride, int hideBorder, int hideCursor)
+    {
+        return CaptureScreenRawForTarget(nullptr, nullptr, SC_CAPTURE_BGRA8, pixelFormat, pixels, width, height, stride, hideBorder, hideCursor, static_cast<int>(DefaultFrameTimeoutMs));
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenRawForTarget(const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, int captureFormat, int pixelFormat, void** pixels, int* width, int* height, int* stride, int hideBorder, int hideCursor, int timeoutMs)
+    {
+        // Validate input parameters
+        PixelFormat format = PixelFormat::Bgra;
+        CaptureTarget captureTarget;
+        CaptureRegion captureRegion;
+        CaptureFormat surfaceFormat = CaptureFormat::Bgra8;
+        if (!pixels || !width || !height || !stride || timeoutMs <= 0 || !ConvertPixelFormat(pixelFormat, format) ||
+            !ConvertCaptureTarget(target, captureTarget) || !ConvertCaptureRegion(region, captureRegion) ||
+            !ConvertCaptureFormat(captureFormat, surfaceFormat))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        ClearRawFrameOutputs(pixels, width, height, stride);
+
+        try
+        {
+            // Create silent logger for DLL (no console output)
+            SilentLogger logger;
+
+            // Create screen capture instance
+            ScreenCapture capture(&logger);
+            capture.SetDeviceCache(GetDeviceCache());
+            capture.SetBackend(GetCaptureBackend());
+            capture.SetAdapterOptions(GetCaptureAdapter());
+
+            // Capture raw pixels (no PNG encode)
+            RawFrame frame;
+            capture.SetTarget(captureTarget);
+            capture.SetRegion(captureRegion);
+            capture.SetCaptureFormat(surfaceFormat);
+            auto result = capture.CaptureRaw(frame, format, hideBorder != 0, hideCursor != 0, static_cast<uint32_t>(timeoutMs));
+
+            if (result == ErrorCode::Success && !frame.pixels.empty())
+            {
+                return CopyRawFrameToCaller(frame, pixels, width, height, stride);
+            }
+
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult OpenCaptureSession(int hideBorder, int hideCursor, ScreenCaptureSessionHandle* session)
+    {
+        return OpenCaptureSessionForTarget(nullptr, hideBorder, hideCursor, session);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult OpenCaptureSessionForTarget(const ScreenCaptureTarget* target, int hideBorder, int hideCursor, ScreenCaptureSessionHandle* session)
+    {
+        return OpenCaptureSessionWithCaptureFormat(target, SC_CAPTURE_BGRA8, hideBorder, hideCursor, session);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult OpenCaptureSessionWithCaptureFormat(const ScreenCaptureTarget* target, int captureFormat, int hideBorder, int hideCursor, ScreenCaptureSessionHandle* session)
+    {
+        // Validate input parameters
+        if (!session)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *session = nullptr;
+
+        CaptureTarget captureTarget;
+        CaptureFormat surfaceFormat = CaptureFormat::Bgra8;
+        if (!ConvertCaptureTarget(target, captureTarget) || !ConvertCaptureFormat(captureFormat, surfaceFormat))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            auto context = std::make_unique<SessionContext>();
+            context->session.SetAdapterOptions(GetCaptureAdapter());
+
+            auto result = context->session.Open(captureTarget, surfaceFormat, hideBorder != 0, hideCursor != 0);
+            if (result != ErrorCode::Success)
+            {
+                return ConvertErrorCode(result);
+            }
+
+            *session = context.release();
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabFrame(ScreenCaptureSessionHandle session, unsigned char** outputBuffer, unsigned int* bufferSize, int timeoutMs)
+    {
+        return GrabFrameWithFormat(session, outputBuffer, bufferSize, nullptr, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabFrameWithFormat(ScreenCaptureSessionHandle session, unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureEncodeOptions* encodeOptions, int timeoutMs)
+    {
+        // Validate input parameters
+        if (!session || !outputBuffer || !bufferSize || timeoutMs <= 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *outputBuffer = nullptr;
+        *bufferSize = 0;
+
+        EncodeOptions coreOptions;
+        if (!ConvertEncodeOptions(encodeOptions, coreOptions))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            auto context = static_cast<SessionContext*>(session);
+
+            std::vector<uint8_t> buffer;
+            auto result = context->session.GrabFrame(buffer, coreOptions, static_cast<uint32_t>(timeoutMs));
+
+            if (result == ErrorCode::Success && !buffer.empty())
+            {
+                return CopyToCallerBuffer(buffer, outputBuffer, bufferSize);
+            }
+
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabRawFrame(ScreenCaptureSessionHandle session, void** pixels, int* width, int* height, int* stride, int timeoutMs)
+    {
+        return GrabRawFrameWithPixelFormat(session, SC_PIXEL_BGRA, pixels, width, height, stride, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabRawFrameWithPixelFormat(ScreenCaptureSessionHandle session, int pixelFormat, void** pixels, int* width, int* height, int* stride, int timeoutMs)
+    {
+        // Validate input parameters
+        PixelFormat format = PixelFormat::Bgra;
+        if (!session || !pixels || !width || !height || !stride || timeoutMs <= 0 || !ConvertPixelFormat(pixelFormat, format))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        ClearRawFrameOutputs(pixels, width, height, stride);
+
+        try
+        {
+            auto context = static_cast<SessionContext*>(session);
+
+            RawFrame frame;
+            auto result = context->session.GrabRawFrame(frame, format, static_cast<uint32_t>(timeoutMs));
+
+            if (result == ErrorCode::Success && !frame.pixels.empty())
+            {
+                return CopyRawFrameToCaller(frame, pixels, width, height, stride);
+            }
+
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabRawFrameToBuffer(ScreenCaptureSessionHandle session, void* buffer, unsigned int bufferSize, int* width, int* height, int* stride, int timeoutMs)
+    {
+        return GrabRawFrameToBufferWithPixelFormat(session, SC_PIXEL_BGRA, buffer, bufferSize, width, height, stride, timeoutMs);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabRawFrameToBufferWithPixelFormat(ScreenCaptureSessionHandle session, int pixelFormat, void* buffer, unsigned int bufferSize, int* width, int* height, int* stride, int timeoutMs)
+    {
+        // Validate input parameters
+        PixelFormat format = PixelFormat::Bgra;
+        if (!session || !width || !height || !stride || timeoutMs <= 0 || !ConvertPixelFormat(pixelFormat, format))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *width = 0;
+        *height = 0;
+        *stride = 0;
+
+        try
+        {
+            auto context = static_cast<SessionContext*>(session);
+
+            FrameLayout layout;
+            auto result = context->session.GrabRawFrameInto(static_cast<uint8_t*>(buffer), bufferSize, layout, format, static_cast<uint32_t>(timeoutMs));
+
+            *width = static_cast<int>(layout.width);
+            *height = static_cast<int>(layout.height);
+            *stride = static_cast<int>(layout.stride);
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabFrameToBuffer(ScreenCaptureSessionHandle session, unsigned char* buffer, unsigned int bufferSize, unsigned int* bytesWritten, int timeoutMs)
+    {
+        // Validate input parameters
+        if (!session || !bytesWritten || timeoutMs <= 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *bytesWritten = 0;
+
+        try
+        {
+            auto context = static_cast<SessionContext*>(session);
+            std::lock_guard<std::mutex> lock(context->encodedMutex);
+
+            // Encode a new frame unless one is still waiting for a larger buffer
+            if (!context->encodedPending)
+            {
+                auto result = context->session.GrabFrame(context->encoded, static_cast<uint32_t>(timeoutMs));
+                if (result != ErrorCode::Success)
+                {
+                    return ConvertErrorCode(result);
+                }
+                context->encodedPending = true;
+            }
+
+            *bytesWritten = static_cast<unsigned int>(context->encoded.size());
+            if (!buffer || bufferSize < context->encoded.size())
+            {
+                return SC_BUFFER_TOO_SMALL;
+            }
+
+            memcpy(buffer, context->encoded.data(), context->encoded.size());
+            context->encodedPending = false;
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult SetCaptureSessionRegion(ScreenCaptureSessionHandle session, const ScreenCaptureRegion* region)
+    {
+        // Validate input parameters
+        CaptureRegion captureRegion;
+        if (!session || !ConvertCaptureRegion(region, captureRegion))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            auto context = static_cast<SessionContext*>(session);
+            return ConvertErrorCode(context->session.SetRegion(captureRegion));
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult EnableSharedTexture(ScreenCaptureSessionHandle session, const ScreenCaptureSharedTextureOptions* options)
+    {
+        // Validate input parameters
+        if (!session)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        SharedTextureOptions sharedOptions;
+        if (options)
+        {
+            sharedOptions.keyedMutex = options->keyedMutex != 0;
+            sharedOptions.skipReadback = options->skipReadback != 0;
+        }
+
+        try
+        {
+            auto context = static_cast<SessionContext*>(session);
+            return ConvertErrorCode(context->session.EnableTextureSharing(sharedOptions));
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetSharedTexture(ScreenCaptureSessionHandle session, ScreenCaptureSharedTexture* info, int timeoutMs)
+    {
+        // Validate input parameters
+        if (!session || !info || timeoutMs <= 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *info = {};
+
+        try
+        {
+            auto context = static_cast<SessionContext*>(session);
+
+            SharedTextureInfo shared;
+            auto result = context->session.GetSharedTexture(shared, static_cast<uint32_t>(timeoutMs));
+            if (result == ErrorCode::Success)
+            {
+                info->textureHandle = shared.textureHandle;
+                info->fenceHandle = shared.fenceHandle;
+                info->width = static_cast<int>(shared.width);
+                info->height = static_cast<int>(shared.height);
+                info->frameNumber = shared.frameNumber;
+                info->generation = shared.generation;
+                info->keyedMutex = shared.keyedMutex ? 1 : 0;
+            }
+            return ConvertErrorCode(result);
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API void CloseCaptureSession(ScreenCaptureSessionHandle session)
+    {
+        if (session)
+        {
+            delete static_cast<SessionContext*>(session);
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartStream(ScreenCaptureFrameCallback callback, void* userData, const ScreenCaptureStreamOptions* options, ScreenCaptureSessionHandle* stream)
+    {
+        return StartStreamForTarget(nullptr, callback, userData, options, stream);
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartStreamForTarget(const ScreenCaptureTarget* target, ScreenCaptureFrameCallback callback, void* userData, const ScreenCaptureStreamOptions* options, ScreenCaptureSessionHandle* stream)
+    {
+        // Validate input parameters
+        if (!callback || !stream)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *stream = nullptr;
+
+        StreamOptions streamOptions = ConvertStreamOptions(options);
+        if (!ConvertCaptureTarget(target, streamOptions.target))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            auto context = std::make_unique<SessionContext>();
+            context->session.SetAdapterOptions(GetCaptureAdapter());
+
+            auto result = context->session.StartStream([callback, userData](const StreamFrame& frame)
+            {
+                ScreenCaptureFrame nativeFrame = {};
+                nativeFrame.pixels = frame.pixels;
+                nativeFrame.width = static_cast<int>(frame.width);
+                nativeFrame.height = static_cast<int>(frame.height);
+                nativeFrame.stride = static_cast<int>(frame.stride);
+                nativeFrame.timestamp = frame.timestamp;
+                nativeFrame.frameNumber = frame.frameNumber;
+                nativeFrame.texture = frame.texture;
+                nativeFrame.device = frame.device;
+                nativeFrame.dirtyRects = reinterpret_cast<const ScreenCaptureDirtyRect*>(frame.dirtyRects);
+                nativeFrame.dirtyRectCount = static_cast<int>(frame.dirtyRectCount);
+                callback(&nativeFrame, userData);
+            }, streamOptions);
+
+            if (result != ErrorCode::Success)
+            {
+                return ConvertErrorCode(result);
+            }
+
+            *stream = context.release();
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartRingStream(const ScreenCaptureTarget* target, const ScreenCaptureRingOptions* ringOptions, const ScreenCaptureStreamOptions* options, ScreenCaptureSessionHandle* stream)
+    {
+        // Validate input parameters
+        if (!ringOptions || !ringOptions->name || wcslen(ringOptions->name) == 0 || ringOptions->slotCount < 0 ||
+            ringOptions->maxWidth < 0 || ringOptions->maxHeight < 0 || !stream)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *stream = nullptr;
+
+        StreamOptions streamOptions = ConvertStreamOptions(options);
+        if (!ConvertCaptureTarget(target, streamOptions.target))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        FrameRingOptions coreRingOptions;
+        coreRingOptions.name = ringOptions->name;
+        if (ringOptions->slotCount > 0)
+        {
+            coreRingOptions.slotCount = static_cast<uint32_t>(ringOptions->slotCount);
+        }
+        coreRingOptions.maxWidth = static_cast<uint32_t>(ringOptions->maxWidth);
+        coreRingOptions.maxHeight = static_cast<uint32_t>(ringOptions->maxHeight);
+
+        try
+        {
+            auto context = std::make_unique<SessionContext>();
+            context->session.SetAdapterOptions(GetCaptureAdapter());
+
+            auto result = context->session.StartRingStream(coreRingOptions, streamOptions);
+            if (result != ErrorCode::Success)
+            {
+                return ConvertErrorCode(result);
+            }
+
+            *stream = context.release();
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
     }
 
-    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithOptions(const wchar_t* outputPath, int hideBorder, int hideCursor)
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartFileStream(const ScreenCaptureTarget* target, const ScreenCaptureFileStreamOptions* fileOptions, const ScreenCaptureStreamOptions* options, ScreenCaptureFileCallback callback, void* userData, ScreenCaptureSessionHandle* stream)
     {
         // Validate input parameters
-        if (!outputPath || wcslen(outputPath) == 0)
+        if (!fileOptions || !fileOptions->outputPattern || wcslen(fileOptions->outputPattern) == 0 ||
+            fileOptions->workerCount < 0 || fileOptions->queueDepth < 0 || !stream)
         {
             return SC_INVALID_PARAMETER;
         }
 
+        *stream = nullptr;
+
+        StreamOptions streamOptions = ConvertStreamOptions(options);
+        FileStreamOptions coreFileOptions;
+        if (!ConvertCaptureTarget(target, streamOptions.target) || !ConvertEncodeOptions(&fileOptions->encodeOptions, coreFileOptions.encode))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        coreFileOptions.outputPattern = fileOptions->outputPattern;
+        if (fileOptions->workerCount > 0)
+        {
+            coreFileOptions.workerCount = static_cast<size_t>(fileOptions->workerCount);
+        }
+        if (fileOptions->queueDepth > 0)
+        {
+            coreFileOptions.queueDepth = static_cast<size_t>(fileOptions->queueDepth);
+        }
+        coreFileOptions.backpressure = fileOptions->blockWhenFull != 0 ? BackpressurePolicy::Block : BackpressurePolicy::DropOldest;
+
+        FileEncodeCompletion completion;
+        if (callback)
+        {
+            completion = [callback, userData](ErrorCode result, const std::wstring& path)
+            {
+                callback(ConvertErrorCode(result), path.c_str(), userData);
+            };
+        }
+
         try
         {
-            // Create silent logger for DLL (no console output)
-            SilentLogger logger;
-            
-            // Create screen capture instance
-            ScreenCapture capture(&logger);
+            auto context = std::make_unique<SessionContext>();
+            context->session.SetAdapterOptions(GetCaptureAdapter());
 
-            // Perform capture with options
-            auto result = capture.CaptureToFile(std::wstring(outputPath), hideBorder != 0, hideCursor != 0);
+            auto result = context->session.StartFileStream(coreFileOptions, streamOptions, std::move(completion));
+            if (result != ErrorCode::Success)
+            {
+                return ConvertErrorCode(result);
+            }
 
-            // Convert and return result
-            return ConvertErrorCode(result);
+            *stream = context.release();
+            return SC_SUCCESS;
         }
         catch (...)
         {
@@ -67,53 +1173,176 @@ extern "C" {
         }
     }
 
-    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemory(unsigned char** outputBuffer, unsigned int* bufferSize, int hideBorder, int hideCursor)
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetStreamStats(ScreenCaptureSessionHandle stream, ScreenCaptureStreamStats* stats)
+    {
+        if (!stream || !stats)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            StreamStats coreStats;
+            auto result = static_cast<SessionContext*>(stream)->session.GetStreamStats(coreStats);
+            if (result != ErrorCode::Success)
+            {
+                return ConvertErrorCode(result);
+            }
+
+            stats->framesDelivered = coreStats.framesDelivered;
+            stats->framesSkipped = coreStats.framesSkipped;
+            stats->framesDropped = coreStats.framesDropped;
+            stats->framesLate = coreStats.framesLate;
+            stats->currentFps = coreStats.currentFps;
+            stats->callbackMs = coreStats.callbackMs;
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API void StopStream(ScreenCaptureSessionHandle stream)
+    {
+        if (stream)
+        {
+            delete static_cast<SessionContext*>(stream);
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartRecording(const wchar_t* outputPath, const ScreenCaptureRecordOptions* options, ScreenCaptureSessionHandle* recording)
     {
         // Validate input parameters
-        if (!outputBuffer || !bufferSize)
+        if (!outputPath || wcslen(outputPath) == 0 || !recording)
         {
             return SC_INVALID_PARAMETER;
         }
 
+        *recording = nullptr;
+
         try
         {
-            // Create silent logger for DLL (no console output)
-            SilentLogger logger;
-            
-            // Create screen capture instance
-            ScreenCapture capture(&logger);
+            auto context = std::make_unique<RecordingContext>();
 
-            // Capture to memory buffer
-            std::vector<uint8_t> buffer;
-            auto result = capture.CaptureToMemory(buffer, hideBorder != 0, hideCursor != 0);
+            auto result = context->recorder.Start(std::wstring(outputPath), ConvertRecordOptions(options));
+            if (result != ErrorCode::Success)
+            {
+                return ConvertErrorCode(result);
+            }
 
-            if (result == ErrorCode::Success && !buffer.empty())
+            *recording = context.release();
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult StopRecording(ScreenCaptureSessionHandle recording)
+    {
+        if (!recording)
+        {
+            return SC_SUCCESS;
+        }
+
+        std::unique_ptr<RecordingContext> context(static_cast<RecordingContext*>(recording));
+        try
+        {
+            return ConvertErrorCode(context->recorder.Stop());
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API int GetMonitorCount()
+    {
+        try
+        {
+            return static_cast<int>(EnumerateMonitors().size());
+        }
+        catch (...)
+        {
+            return 0;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetCaptureMonitorInfo(int index, ScreenCaptureMonitorInfo* info)
+    {
+        // Validate input parameters
+        if (!info || index < 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            auto monitors = EnumerateMonitors();
+            if (static_cast<size_t>(index) >= monitors.size())
             {
-                // Allocate buffer for caller
-                *bufferSize = static_cast<unsigned int>(buffer.size());
-                *outputBuffer = static_cast<unsigned char*>(malloc(*bufferSize));
-                
-                if (*outputBuffer)
-                {
-                    memcpy(*outputBuffer, buffer.data(), *bufferSize);
-                    return SC_SUCCESS;
-                }
-                else
-                {
-                    return SC_UNKNOWN_ERROR; // Memory allocation failed
-                }
+                return SC_INVALID_PARAMETER;
             }
-            else
+
+            const auto& monitor = monitors[index];
+            *info = {};
+            info->monitor = monitor.handle;
+            info->left = monitor.bounds.left;
+            info->top = monitor.bounds.top;
+            info->right = monitor.bounds.right;
+            info->bottom = monitor.bounds.bottom;
+            info->primary = monitor.primary ? 1 : 0;
+            wcsncpy_s(info->deviceName, monitor.deviceName.c_str(), _TRUNCATE);
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API int GetCaptureAdapterCount()
+    {
+        try
+        {
+            return static_cast<int>(EnumerateAdapters().size());
+        }
+        catch (...)
+        {
+            return 0;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetCaptureAdapterInfo(int index, ScreenCaptureAdapterInfo* info)
+    {
+        // Validate input parameters
+        if (!info || index < 0)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            auto adapters = EnumerateAdapters();
+            if (static_cast<size_t>(index) >= adapters.size())
             {
-                *outputBuffer = nullptr;
-                *bufferSize = 0;
-                return ConvertErrorCode(result);
+                return SC_INVALID_PARAMETER;
             }
+
+            const auto& adapter = adapters[index];
+            *info = {};
+            info->luidLowPart = adapter.luid.LowPart;
+            info->luidHighPart = adapter.luid.HighPart;
+            info->dedicatedVideoMemory = adapter.dedicatedVideoMemory;
+            info->software = adapter.software ? 1 : 0;
+            info->monitorCount = static_cast<int>(adapter.monitors.size());
+            wcsncpy_s(info->description, adapter.description.c_str(), _TRUNCATE);
+            return SC_SUCCESS;
         }
         catch (...)
         {
-            *outputBuffer = nullptr;
-            *bufferSize = 0;
             return SC_UNKNOWN_ERROR;
         }
     }
@@ -126,6 +1355,160 @@ extern "C" {
         }
     }
 
+    SCREENCAPTUREDLL_API ScreenCaptureResult BeginCapture(const ScreenCaptureAsyncOptions* options, ScreenCaptureCompletionCallback callback, void* userData, ScreenCaptureRequestId* request)
+    {
+        // Validate input parameters
+        if (!request)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *request = 0;
+
+        CaptureRequest captureRequest;
+        if (!ConvertAsyncOptions(options, captureRequest))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+        captureRequest.backend = GetCaptureBackend();
+        captureRequest.adapter = GetCaptureAdapter();
+
+        try
+        {
+            CaptureCompletion completion;
+            if (callback)
+            {
+                completion = [callback, userData](uint64_t requestId, ErrorCode result, const std::vector<uint8_t>& encoded)
+                {
+                    callback(requestId, ConvertErrorCode(result), encoded.empty() ? nullptr : encoded.data(), static_cast<unsigned int>(encoded.size()), userData);
+                };
+            }
+
+            *request = GetCaptureQueue().Submit(captureRequest, std::move(completion));
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult WaitCapture(ScreenCaptureRequestId request, int timeoutMs, ScreenCaptureResult* captureResult, unsigned char** outputBuffer, unsigned int* bufferSize)
+    {
+        // Validate input parameters
+        if (!request || timeoutMs < 0 || !captureResult || (outputBuffer == nullptr) != (bufferSize == nullptr))
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        *captureResult = SC_UNKNOWN_ERROR;
+        if (outputBuffer)
+        {
+            *outputBuffer = nullptr;
+            *bufferSize = 0;
+        }
+
+        try
+        {
+            ErrorCode result = ErrorCode::Success;
+            std::vector<uint8_t> encoded;
+            auto waitResult = GetCaptureQueue().Wait(request, static_cast<uint32_t>(timeoutMs), result, &encoded);
+            if (waitResult != ErrorCode::Success)
+            {
+                return ConvertErrorCode(waitResult);
+            }
+
+            *captureResult = ConvertErrorCode(result);
+            if (outputBuffer && !encoded.empty())
+            {
+                return CopyToCallerBuffer(encoded, outputBuffer, bufferSize);
+            }
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult CancelCapture(ScreenCaptureRequestId request)
+    {
+        if (!request)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            return ConvertErrorCode(GetCaptureQueue().Cancel(request));
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetCaptureStats(ScreenCaptureStats* stats)
+    {
+        if (!stats)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        try
+        {
+            static_assert(SC_STAGE_COUNT == CaptureStageCount, "ScreenCaptureStage must match CaptureStage");
+
+            auto coreStats = ScreenCaptureCore::GetCaptureStats();
+            *stats = {};
+            for (uint32_t i = 0; i < CaptureStageCount; ++i)
+            {
+                const auto& stage = coreStats.stages[i];
+                stats->stages[i].count = stage.count;
+                stats->stages[i].lastMs = stage.lastMs;
+                stats->stages[i].meanMs = stage.meanMs;
+                stats->stages[i].p50Ms = stage.p50Ms;
+                stats->stages[i].p99Ms = stage.p99Ms;
+            }
+            stats->framesDropped = coreStats.framesDropped;
+            return SC_SUCCESS;
+        }
+        catch (...)
+        {
+            return SC_UNKNOWN_ERROR;
+        }
+    }
+
+    SCREENCAPTUREDLL_API void ResetCaptureStats()
+    {
+        ScreenCaptureCore::ResetCaptureStats();
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult SetCaptureBackend(int backend)
+    {
+        if (backend < SC_BACKEND_AUTO || backend > SC_BACKEND_DESKTOP_DUPLICATION)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        g_captureBackend = backend;
+        return SC_SUCCESS;
+    }
+
+    SCREENCAPTUREDLL_API ScreenCaptureResult SetCaptureAdapter(int preference, unsigned int luidLowPart, int luidHighPart)
+    {
+        if (preference < SC_GPU_AUTO || preference > SC_GPU_HIGH_PERFORMANCE)
+        {
+            return SC_INVALID_PARAMETER;
+        }
+
+        std::lock_guard<std::mutex> lock(g_adapterMutex);
+        g_adapterOptions.preference = static_cast<GpuPreference>(preference);
+        g_adapterOptions.adapterLuid.LowPart = luidLowPart;
+        g_adapterOptions.adapterLuid.HighPart = luidHighPart;
+        return SC_SUCCESS;
+    }
+
     SCREENCAPTUREDLL_API const wchar_t* GetErrorDescription(ScreenCaptureResult errorCode)
     {
         switch (errorCode)
@@ -144,6 +1527,14 @@ extern "C" {
             return L"Failed to save screenshot to file";
         case SC_TIMEOUT_ERROR:
             return L"Timeout waiting for frame capture";
+        case SC_BUFFER_TOO_SMALL:
+            return L"Output buffer is too small for the frame";
+        case SC_FRAME_DROPPED:
+            return L"Frame was dropped because the encode queue was full";
+        case SC_ENCODER_FAILED:
+            return L"Video encoder failed";
+        case SC_CANCELLED:
+            return L"Capture was cancelled";
         case SC_INVALID_PARAMETER:
             return L"Invalid parameter provided";
         case SC_NOT_IMPLEMENTED:
@@ -167,15 +1558,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
     switch (ul_reason_for_call)
     {
     case DLL_PROCESS_ATTACH:
-        // Initialize COM/WinRT when DLL is loaded
-        try
-        {
-            winrt::init_apartment(winrt::apartment_type::single_threaded);
-        }
-        catch (...)
-        {
-            // May already be initialized
-        }
+        // No apartment is set up here: captures run on the library's own worker thread
         break;
     case DLL_THREAD_ATTACH:
     case DLL_THREAD_DETACH:
@@ -17,11 +17,318 @@ extern "C" {
         SC_TEXTURE_PROCESSING_FAILED = 4,
         SC_FILE_SAVE_FAILED = 5,
         SC_TIMEOUT_ERROR = 6,
+        SC_BUFFER_TOO_SMALL = 7,
+        SC_FRAME_DROPPED = 8,
+        SC_ENCODER_FAILED = 9,
+        SC_CANCELLED = 10,
         SC_INVALID_PARAMETER = 97,
         SC_NOT_IMPLEMENTED = 98,
         SC_UNKNOWN_ERROR = 99
     } ScreenCaptureResult;
 
+    // Opaque handle to a persistent capture session or stream
+    typedef void* ScreenCaptureSessionHandle;
+
+    // Id of an asynchronous capture started by BeginCapture (never 0)
+    typedef unsigned long long ScreenCaptureRequestId;
+
+    // Changed area of a streamed frame in pixels
+    typedef struct {
+        int x;
+        int y;
+        int width;
+        int height;
+    } ScreenCaptureDirtyRect;
+
+    // Frame handed to a stream callback; pointers are only valid during the callback
+    typedef struct {
+        const unsigned char* pixels;    // Mapped BGRA rows (NULL for texture delivery)
+        int width;
+        int height;
+        int stride;                     // Bytes between rows (0 for texture delivery)
+        long long timestamp;            // SystemRelativeTime in 100 ns units
+        unsigned long long frameNumber; // Frame pool sequence number; gaps mean dropped frames
+        void* texture;                  // ID3D11Texture2D* for texture delivery
+        void* device;                   // ID3D11Device* that owns texture
+        const ScreenCaptureDirtyRect* dirtyRects;   // Areas changed since the previous frame delivered
+        int dirtyRectCount;             // 0 means unchanged (the whole frame without change detection)
+    } ScreenCaptureFrame;
+
+    // Stream callback; must not call StopStream for its own stream
+    typedef void (__cdecl *ScreenCaptureFrameCallback)(const ScreenCaptureFrame* frame, void* userData);
+
+    // Streaming options (pass NULL to StartStream for the defaults shown)
+    typedef struct {
+        int hideBorder;         // Try to hide capture border (default 1)
+        int hideCursor;         // Hide mouse cursor in capture (default 1)
+        int bufferCount;        // Frame pool buffers, 1-8 (default 2; 0 means default)
+        int latestFrameOnly;    // 1: newest frame only on a delivery thread, 0: every frame (default 1)
+        int deliverTexture;     // 1: pass the GPU texture instead of mapped pixels (default 0)
+        int changeDetection;    // 0: off, 1: report dirty rectangles, 2: also skip unchanged frames (default 0)
+        int captureFormat;      // ScreenCaptureFormat; half floats are tone-mapped before readback (default SC_CAPTURE_BGRA8)
+        float targetFps;        // Deliver at most this many frames per second, 0: as they arrive (default 0)
+        int minUpdateIntervalMs;    // Shortest time between delivered frames, 0: from targetFps only (default 0)
+        int adaptiveRate;       // 1: lower the rate while callbacks cannot keep up (default 1)
+    } ScreenCaptureStreamOptions;
+
+    // Delivery counters of a stream returned by GetStreamStats
+    typedef struct {
+        unsigned long long framesDelivered;
+        unsigned long long framesSkipped;   // Left out to keep to the rate (never read back)
+        unsigned long long framesDropped;   // Read back, then replaced by a newer frame before the callback took it
+        unsigned long long framesLate;      // Callback started more than one interval (33 ms uncapped) after capture
+        double currentFps;                  // Rate cap in effect including backoff (0 = uncapped)
+        double callbackMs;                  // Moving average of the callback duration
+    } ScreenCaptureStreamStats;
+
+    // Output image formats
+    typedef enum {
+        SC_FORMAT_AUTO = 0,     // From the file extension (PNG for memory output or unknown extensions)
+        SC_FORMAT_PNG = 1,      // Lossless, smallest files, slowest encode
+        SC_FORMAT_BMP = 2,      // Uncompressed 32-bit BMP
+        SC_FORMAT_RAW = 3,      // Tightly packed BGRA rows without a header
+        SC_FORMAT_QOI = 4,      // Fast lossless (Quite OK Image format)
+        SC_FORMAT_JPEG = 5,     // Lossy, see jpegQuality
+        SC_FORMAT_JXR = 6       // JPEG XR, lossless; keeps half floats of SC_CAPTURE_RGBA16F captures
+    } ScreenCaptureImageFormat;
+
+    // Raw pixel layouts (converted while the frame is read back)
+    typedef enum {
+        SC_PIXEL_BGRA = 0,      // 4 bytes per pixel, as captured
+        SC_PIXEL_RGBA = 1,      // 4 bytes per pixel
+        SC_PIXEL_RGB24 = 2,     // 3 bytes per pixel, R first
+        SC_PIXEL_GRAY8 = 3,     // 1 byte per pixel (BT.601 luma)
+        SC_PIXEL_RGBA16F = 4    // 8 bytes per pixel, scRGB half floats (SC_CAPTURE_RGBA16F one-shot captures only)
+    } ScreenCapturePixelFormat;
+
+    // Pixel format of the frame pool surfaces
+    typedef enum {
+        SC_CAPTURE_BGRA8 = 0,   // 8-bit sRGB; on HDR monitors the OS tone-maps every frame
+        SC_CAPTURE_RGBA16F = 1  // scRGB half floats, tone-mapped on the GPU for 8-bit output
+    } ScreenCaptureFormat;
+
+    // API that one-shot captures of monitors go through (see SetCaptureBackend)
+    typedef enum {
+        SC_BACKEND_AUTO = 0,                // Graphics Capture; Desktop Duplication where it cannot hide the cursor or border
+        SC_BACKEND_GRAPHICS_CAPTURE = 1,    // Windows.Graphics.Capture only
+        SC_BACKEND_DESKTOP_DUPLICATION = 2  // DXGI Desktop Duplication: monitors only, BGRA8, no cursor or border
+    } ScreenCaptureBackend;
+
+    // GPU that captures create their devices on (see SetCaptureAdapter)
+    typedef enum {
+        SC_GPU_AUTO = 0,                // The adapter that drives the target monitor
+        SC_GPU_DEFAULT = 1,             // The system default adapter
+        SC_GPU_MINIMUM_POWER = 2,       // Usually the integrated GPU
+        SC_GPU_HIGH_PERFORMANCE = 3     // Usually the discrete GPU
+    } ScreenCaptureGpuPreference;
+
+    // Encoder options (pass NULL for SC_FORMAT_AUTO with default tuning)
+    typedef struct {
+        int format;             // ScreenCaptureImageFormat
+        int jpegQuality;        // 1-100 (0 means default 90)
+        int pngFilter;          // 0 default, 1 none (fastest), 2 sub, 3 up, 4 average, 5 paeth, 6 adaptive
+        int pngInterlace;       // 1: interlaced PNG (default 0)
+        int pngParallel;        // 1: deflate PNG row strips on all cores instead of using WIC (ignored when interlaced)
+    } ScreenCaptureEncodeOptions;
+
+    // Recording options (pass NULL to StartRecording for the defaults shown)
+    typedef struct {
+        int hideBorder;         // Try to hide capture border (default 1)
+        int hideCursor;         // Hide mouse cursor in capture (default 1)
+        int codec;              // 0: H.264, 1: HEVC (default 0)
+        int frameRate;          // Output frames per second (default 30; 0 means default)
+        int bitrate;            // Average bits per second (default 8000000; 0 means default)
+    } ScreenCaptureRecordOptions;
+
+    // Capture target types
+    typedef enum {
+        SC_TARGET_PRIMARY_MONITOR = 0,
+        SC_TARGET_MONITOR_INDEX = 1,    // monitorIndex (see GetMonitorCount)
+        SC_TARGET_MONITOR = 2,          // monitor (HMONITOR)
+        SC_TARGET_WINDOW = 3,           // window (HWND)
+        SC_TARGET_ALL_MONITORS = 4      // Whole virtual desktop (one-shot captures only)
+    } ScreenCaptureTargetType;
+
+    // Capture target (pass NULL to the *ForTarget functions for the primary monitor)
+    typedef struct {
+        int type;               // ScreenCaptureTargetType
+        int monitorIndex;
+        void* monitor;
+        void* window;
+    } ScreenCaptureTarget;
+
+    // Part of the target to capture, cropped and downscaled on the GPU before readback
+    // (pass NULL to the *Region functions for the whole frame)
+    typedef struct {
+        int x;                  // Left edge relative to the target
+        int y;                  // Top edge relative to the target
+        int width;              // 0 extends to the right edge
+        int height;             // 0 extends to the bottom edge
+        int scalePercent;       // Output size relative to the region, 1-100 (0 means 100)
+    } ScreenCaptureRegion;
+
+    // Shared texture options (pass NULL to EnableSharedTexture for the defaults shown)
+    typedef struct {
+        int keyedMutex;         // 1: guard the texture with a keyed mutex, key 0 (default 1)
+        int skipReadback;       // 1: no staging copies unless a pixel stream runs (default 1)
+    } ScreenCaptureSharedTextureOptions;
+
+    // Shared texture description returned by GetSharedTexture
+    // The handles belong to the session; DuplicateHandle them for another process
+    typedef struct {
+        void* textureHandle;    // NT handle: ID3D11Device1::OpenSharedResource1 or ID3D12Device::OpenSharedHandle
+        void* fenceHandle;      // NT handle of a fence signaled with frameNumber (NULL if unsupported)
+        int width;
+        int height;
+        unsigned long long frameNumber;     // Frames published so far
+        unsigned long long generation;      // Changes when the texture is recreated for a new size
+        int keyedMutex;         // 1: AcquireSync(0) / ReleaseSync(0) around every read
+    } ScreenCaptureSharedTexture;
+
+    // Options for StartRingStream
+    typedef struct {
+        const wchar_t* name;    // File mapping name, e.g. L"Local\\ScreenCaptureRing"
+        int slotCount;          // Frames kept in the ring, 2-16 (0 means 3)
+        int maxWidth;           // Largest frame a slot holds (0 uses the target size at start)
+        int maxHeight;
+    } ScreenCaptureRingOptions;
+
+    // Options for StartFileStream
+    typedef struct {
+        const wchar_t* outputPattern;   // One printf-style integer field for the frame index, e.g. L"out_%05d.png" (required)
+        ScreenCaptureEncodeOptions encodeOptions;   // Format of every file (all zero for the defaults)
+        int workerCount;        // Encoder threads (0 means 2)
+        int queueDepth;         // Frames waiting for an encoder (0 means 4)
+        int blockWhenFull;      // 1: wait for a free queue slot, 0: drop the oldest queued frame (default 0)
+    } ScreenCaptureFileStreamOptions;
+
+    // Called on an encoder thread for every file stream frame: SC_SUCCESS once it is written,
+    // SC_FRAME_DROPPED if the full queue discarded it, else SC_FILE_SAVE_FAILED
+    typedef void (__cdecl *ScreenCaptureFileCallback)(ScreenCaptureResult result, const wchar_t* path, void* userData);
+
+    // Layout of a frame ring mapping: one ScreenCaptureRingHeader, then slotCount slots
+    // of slotSize bytes, each a ScreenCaptureRingSlot followed by tightly packed BGRA rows
+    // To read the newest frame without locking:
+    //   1. wait for magic == 0x42524353, then read latestSlot (-1: no frame yet)
+    //   2. read the slot's sequence; retry if it is odd (the slot is being written)
+    //   3. use the header fields and pixels in place
+    //   4. read sequence again; the frame is valid if it did not change
+    typedef struct {
+        unsigned int magic;
+        unsigned int version;               // 1
+        unsigned int headerSize;            // Offset of the first slot
+        unsigned int slotCount;
+        unsigned long long slotSize;        // Bytes from one slot to the next
+        unsigned long long slotCapacity;    // Pixel bytes a slot holds
+        long long qpcFrequency;             // QueryPerformanceFrequency of qpcTimestamp
+        long long latestSlot;               // Newest complete slot, -1 before the first frame
+        unsigned long long publishedCount;  // Frames published so far
+        unsigned long long skippedCount;    // Frames too large for a slot
+    } ScreenCaptureRingHeader;
+
+    typedef struct {
+        unsigned long long sequence;        // Odd while the slot is being written
+        unsigned long long frameNumber;
+        long long qpcTimestamp;             // Capture time in QueryPerformanceCounter ticks
+        long long timestamp;                // Capture time in 100 ns units (SystemRelativeTime)
+        unsigned int width;
+        unsigned int height;
+        unsigned int stride;                // width * 4
+        unsigned int pixelFormat;           // SC_PIXEL_BGRA
+        unsigned int dataSize;              // stride * height
+        unsigned int reserved[3];
+    } ScreenCaptureRingSlot;
+
+    // Monitor description returned by GetCaptureMonitorInfo
+    typedef struct {
+        void* monitor;          // HMONITOR
+        int left;               // Bounds in virtual-screen coordinates
+        int top;
+        int right;
+        int bottom;
+        int primary;
+        wchar_t deviceName[32];
+    } ScreenCaptureMonitorInfo;
+
+    // Graphics adapter description returned by GetCaptureAdapterInfo
+    typedef struct {
+        unsigned int luidLowPart;           // Adapter LUID, for SetCaptureAdapter
+        int luidHighPart;
+        unsigned long long dedicatedVideoMemory;
+        int software;                       // Nonzero for WARP and other software adapters
+        int monitorCount;                   // Monitors the adapter drives
+        wchar_t description[128];
+    } ScreenCaptureAdapterInfo;
+
+    // Asynchronous capture options (pass NULL to BeginCapture for a PNG of the primary monitor in memory)
+    // Pointed-to values are copied by BeginCapture
+    typedef struct {
+        const wchar_t* outputPath;                          // File to write, or NULL to encode to memory
+        const ScreenCaptureTarget* target;                  // Capture target, or NULL for the primary monitor
+        const ScreenCaptureRegion* region;                  // Region to capture, or NULL for the whole frame
+        const ScreenCaptureEncodeOptions* encodeOptions;    // Encoder options, or NULL for defaults
+        int captureFormat;                                  // ScreenCaptureFormat (default SC_CAPTURE_BGRA8)
+        int hideBorder;                                     // Try to hide capture border
+        int hideCursor;                                     // Hide mouse cursor in capture
+        int timeoutMs;                                      // Maximum time to wait for a frame (0 means 10000)
+    } ScreenCaptureAsyncOptions;
+
+    // One capture of CaptureFrameInto / CaptureFramesInto; blittable, every field by value
+    typedef struct {
+        ScreenCaptureTarget target;                 // type SC_TARGET_PRIMARY_MONITOR (0) for the primary monitor
+        ScreenCaptureRegion region;                 // All zeros for the whole frame
+        ScreenCaptureEncodeOptions encodeOptions;   // Used when encode is 1; all zeros for a PNG
+        int encode;                                 // 1: write an encoded image, 0: raw pixels in pixelFormat
+        int pixelFormat;                            // ScreenCapturePixelFormat of raw output
+        int captureFormat;                          // ScreenCaptureFormat (default SC_CAPTURE_BGRA8)
+        int hideBorder;                             // Try to hide capture border
+        int hideCursor;                             // Hide mouse cursor in capture
+        int timeoutMs;                              // Maximum time to wait for a frame (0 means 10000)
+    } ScreenCaptureFrameRequest;
+
+    // Caller-owned output of one ScreenCaptureFrameRequest (e.g. a pinned managed array)
+    typedef struct {
+        void* buffer;                   // Written by the call; may be NULL to query the size
+        unsigned long long bufferSize;  // Bytes available at buffer
+        unsigned long long size;        // Bytes written, or needed when result is SC_BUFFER_TOO_SMALL
+        int width;
+        int height;
+        int stride;                     // Row pitch of raw output (width * bytes per pixel), 0 when encoded
+        int pixelFormat;                // ScreenCapturePixelFormat of the pixels that were captured
+        int result;                     // ScreenCaptureResult of this request
+    } ScreenCaptureFrameBuffer;
+
+    // Called on the library's capture thread when an asynchronous capture finishes
+    // data/size hold the encoded image of memory captures (NULL/0 otherwise) and are only
+    // valid during the call; the request is released once the callback returns
+    typedef void (__cdecl *ScreenCaptureCompletionCallback)(ScreenCaptureRequestId request, ScreenCaptureResult result, const unsigned char* data, unsigned int size, void* userData);
+
+    // Timed stages of the capture paths (indexes into ScreenCaptureStats::stages)
+    typedef enum {
+        SC_STAGE_DEVICE_CREATION = 0,   // D3D11 device creation
+        SC_STAGE_FIRST_FRAME_WAIT = 1,  // StartCapture until the first frame arrived
+        SC_STAGE_READBACK = 2,          // Staging copy and Map, including any wait for the GPU
+        SC_STAGE_PIXEL_COPY = 3,        // memcpy or pixel conversion out of the mapped texture
+        SC_STAGE_ENCODE = 4,            // Image encoding
+        SC_STAGE_FILE_WRITE = 5,        // Writing an encoded image to disk
+        SC_STAGE_COUNT = 6
+    } ScreenCaptureStage;
+
+    // Latency of one stage in milliseconds
+    typedef struct {
+        unsigned long long count;   // Samples since the last reset
+        double lastMs;
+        double meanMs;              // Over all samples since the last reset
+        double p50Ms;               // Over the last 1024 samples
+        double p99Ms;
+    } ScreenCaptureStageStats;
+
+    // Process-wide capture statistics returned by GetCaptureStats
+    typedef struct {
+        ScreenCaptureStageStats stages[SC_STAGE_COUNT];
+        unsigned long long framesDropped;   // Stream, encode queue and recorder frames never delivered
+    } ScreenCaptureStats;
+
     // Main capture function
     // outputPath: Full path to output PNG file (must be null-terminated wide string)
     // Returns: ScreenCaptureResult error code
@@ -34,6 +341,75 @@ extern "C" {
     // Returns: ScreenCaptureResult error code
     SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithOptions(const wchar_t* outputPath, int hideBorder, int hideCursor);
 
+    // Capture with options and a custom frame timeout
+    // outputPath: Full path to output PNG file
+    // hideBorder: Try to hide capture border (true recommended)
+    // hideCursor: Hide mouse cursor in capture (true recommended)
+    // timeoutMs: Maximum time to wait for a frame in milliseconds (default is 10000)
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithTimeout(const wchar_t* outputPath, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture with an explicit encoder and a custom frame timeout
+    // outputPath: Full path to output image file
+    // encodeOptions: Encoder options, or NULL to pick the format from the file extension
+    // Other parameters as in CaptureScreenWithTimeout
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithFormat(const wchar_t* outputPath, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture a monitor, window or the whole desktop
+    // target: Capture target, or NULL for the primary monitor
+    // Other parameters as in CaptureScreenWithFormat
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenForTarget(const wchar_t* outputPath, const ScreenCaptureTarget* target, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture part of a monitor or window, optionally downscaled
+    // region: Region to capture, or NULL for the whole frame (SC_TARGET_ALL_MONITORS needs NULL)
+    // Other parameters as in CaptureScreenForTarget
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenRegion(const wchar_t* outputPath, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture a monitor or window with a chosen surface format
+    // captureFormat: ScreenCaptureFormat; with SC_CAPTURE_RGBA16F, JPEG XR output keeps the
+    // half floats and other formats are tone-mapped to 8 bits on the GPU
+    // Other parameters as in CaptureScreenRegion
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenWithCaptureFormat(const wchar_t* outputPath, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, int captureFormat, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture every monitor at the same moment and save one file per monitor
+    // Sessions for all monitors share one device and run concurrently; each file is
+    // encoded on its own worker thread and named <stem>_<index><extension> after outputPath
+    // outputPath: Base path of the output files (index order as in GetCaptureMonitorInfo)
+    // encodeOptions: Encoder options, or NULL to pick the format from the file extension
+    // Other parameters as in CaptureScreenWithTimeout
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureAllMonitorsToFiles(const wchar_t* outputPath, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture count frames intervalMs apart in one session and write one file per frame
+    // Files are encoded on worker threads after the last frame, so encoding cannot
+    // disturb the spacing
+    // outputPattern: Path with one printf-style integer field for the frame index
+    //                (e.g. out_%03d.png); without one, files are named <stem>_<index><extension>
+    // count: Number of frames (1 to 1000)
+    // target, region, captureFormat: As in CaptureScreenWithCaptureFormat (AllMonitors is not supported)
+    // timeoutMs: Maximum time to wait for each frame
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureBurst(const wchar_t* outputPattern, int count, int intervalMs, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, int captureFormat, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture one frame into a caller-owned buffer without a library allocation
+    // request: What to capture and how to write it
+    // frame: Caller buffer; receives the size, layout and result
+    // Returns: ScreenCaptureResult error code (SC_BUFFER_TOO_SMALL with frame->size
+    //          set to the bytes needed)
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureFrameInto(const ScreenCaptureFrameRequest* request, ScreenCaptureFrameBuffer* frame);
+
+    // Capture several targets or regions in one call, each into its own caller buffer
+    // Unscaled requests for the same target, capture format and flags share one capture
+    // and are cropped from it, so regions of one frame come from the same moment
+    // requests, frames: Arrays of count entries
+    // Returns: ScreenCaptureResult of the first request that failed; every frame's
+    //          result is set
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureFramesInto(const ScreenCaptureFrameRequest* requests, ScreenCaptureFrameBuffer* frames, int count);
+
     // Capture to memory buffer (PNG format)
     // outputBuffer: Pointer to receive the buffer pointer (caller must free with FreeBuffer)
     // bufferSize: Pointer to receive the buffer size
@@ -42,10 +418,302 @@ extern "C" {
     // Returns: ScreenCaptureResult error code
     SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemory(unsigned char** outputBuffer, unsigned int* bufferSize, int hideBorder, int hideCursor);
 
-    // Free buffer allocated by CaptureScreenToMemory
-    // buffer: Buffer pointer returned by CaptureScreenToMemory
+    // Capture to memory buffer (PNG format) with a custom frame timeout
+    // timeoutMs: Maximum time to wait for a frame in milliseconds (default is 10000)
+    // Other parameters and ownership as in CaptureScreenToMemory
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryWithTimeout(unsigned char** outputBuffer, unsigned int* bufferSize, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture to memory buffer with an explicit encoder and a custom frame timeout
+    // encodeOptions: Encoder options, or NULL for PNG
+    // Other parameters and ownership as in CaptureScreenToMemoryWithTimeout
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryWithFormat(unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture a monitor, window or the whole desktop to memory
+    // target: Capture target, or NULL for the primary monitor
+    // Other parameters and ownership as in CaptureScreenToMemoryWithFormat
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryForTarget(unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureTarget* target, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture part of a monitor or window to memory, optionally downscaled
+    // region: Region to capture, or NULL for the whole frame (SC_TARGET_ALL_MONITORS needs NULL)
+    // Other parameters and ownership as in CaptureScreenToMemoryForTarget
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryRegion(unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture a monitor or window to memory with a chosen surface format
+    // captureFormat: ScreenCaptureFormat, as in CaptureScreenWithCaptureFormat
+    // Other parameters and ownership as in CaptureScreenToMemoryRegion
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenToMemoryWithCaptureFormat(unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, int captureFormat, const ScreenCaptureEncodeOptions* encodeOptions, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Capture raw BGRA pixels (no PNG encode)
+    // pixels: Pointer to receive the pixel buffer (caller must free with FreeBuffer)
+    // width, height: Pointers to receive the frame size in pixels
+    // stride: Pointer to receive the distance between rows in bytes (may exceed width * 4)
+    // hideBorder: Try to hide capture border (true recommended)
+    // hideCursor: Hide mouse cursor in capture (true recommended)
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenRaw(void** pixels, int* width, int* height, int* stride, int hideBorder, int hideCursor);
+
+    // Capture raw pixels converted to a pixel format (tightly packed unless SC_PIXEL_BGRA)
+    // pixelFormat: ScreenCapturePixelFormat
+    // Other parameters and ownership as in CaptureScreenRaw
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenRawWithPixelFormat(int pixelFormat, void** pixels, int* width, int* height, int* stride, int hideBorder, int hideCursor);
+
+    // Capture raw pixels of a monitor or window with a chosen surface and pixel format
+    // target: Capture target, or NULL for the primary monitor
+    // region: Region to capture, or NULL for the whole frame
+    // captureFormat: ScreenCaptureFormat; SC_PIXEL_RGBA16F needs SC_CAPTURE_RGBA16F and an unscaled region
+    // timeoutMs: Maximum time to wait for a frame in milliseconds
+    // Other parameters and ownership as in CaptureScreenRawWithPixelFormat
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult CaptureScreenRawForTarget(const ScreenCaptureTarget* target, const ScreenCaptureRegion* region, int captureFormat, int pixelFormat, void** pixels, int* width, int* height, int* stride, int hideBorder, int hideCursor, int timeoutMs);
+
+    // Free buffer allocated by the CaptureScreenToMemory*, CaptureScreenRaw, GrabFrame* or GrabRawFrame functions
+    // buffer: Buffer pointer returned by one of those functions
     SCREENCAPTUREDLL_API void FreeBuffer(unsigned char* buffer);
 
+    // Open a persistent capture session on the primary monitor
+    // The D3D device, frame pool and session stay alive until CloseCaptureSession,
+    // so repeated GrabFrame calls skip the setup cost of CaptureScreenToMemory
+    // hideBorder: Try to hide capture border (true recommended)
+    // hideCursor: Hide mouse cursor in capture (true recommended)
+    // session: Pointer to receive the session handle
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult OpenCaptureSession(int hideBorder, int hideCursor, ScreenCaptureSessionHandle* session);
+
+    // Open a persistent capture session on a monitor or window
+    // target: Capture target, or NULL for the primary monitor (SC_TARGET_ALL_MONITORS is not supported)
+    // Other parameters as in OpenCaptureSession
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult OpenCaptureSessionForTarget(const ScreenCaptureTarget* target, int hideBorder, int hideCursor, ScreenCaptureSessionHandle* session);
+
+    // Open a persistent capture session with a chosen surface format
+    // captureFormat: ScreenCaptureFormat; half-float frames are tone-mapped before GrabFrame
+    // reads them, while the shared texture keeps the half floats
+    // Other parameters as in OpenCaptureSessionForTarget
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult OpenCaptureSessionWithCaptureFormat(const ScreenCaptureTarget* target, int captureFormat, int hideBorder, int hideCursor, ScreenCaptureSessionHandle* session);
+
+    // Encode the newest frame of an open session to memory (PNG format)
+    // session: Handle returned by OpenCaptureSession
+    // outputBuffer: Pointer to receive the buffer pointer (caller must free with FreeBuffer)
+    // bufferSize: Pointer to receive the buffer size
+    // timeoutMs: Maximum time to wait for the first frame in milliseconds
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabFrame(ScreenCaptureSessionHandle session, unsigned char** outputBuffer, unsigned int* bufferSize, int timeoutMs);
+
+    // Encode the newest frame of an open session to memory with an explicit encoder
+    // encodeOptions: Encoder options, or NULL for PNG
+    // Other parameters and ownership as in GrabFrame
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabFrameWithFormat(ScreenCaptureSessionHandle session, unsigned char** outputBuffer, unsigned int* bufferSize, const ScreenCaptureEncodeOptions* encodeOptions, int timeoutMs);
+
+    // Copy the newest frame of an open session as raw BGRA pixels (no PNG encode)
+    // session: Handle returned by OpenCaptureSession
+    // pixels, width, height, stride: As in CaptureScreenRaw (free pixels with FreeBuffer)
+    // timeoutMs: Maximum time to wait for the first frame in milliseconds
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabRawFrame(ScreenCaptureSessionHandle session, void** pixels, int* width, int* height, int* stride, int timeoutMs);
+
+    // Copy the newest frame of an open session converted to a pixel format
+    // pixelFormat: ScreenCapturePixelFormat (converted rows are tightly packed)
+    // Other parameters and ownership as in GrabRawFrame
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabRawFrameWithPixelFormat(ScreenCaptureSessionHandle session, int pixelFormat, void** pixels, int* width, int* height, int* stride, int timeoutMs);
+
+    // Copy the newest frame of an open session into a caller-provided buffer as
+    // tightly packed BGRA rows (stride = width * 4), without any allocation
+    // Pass buffer = NULL first to query the size: returns SC_BUFFER_TOO_SMALL with
+    // width, height and stride filled, then allocate stride * height bytes once
+    // session: Handle returned by OpenCaptureSession
+    // buffer: Caller-owned (e.g. pinned) buffer, or NULL to query the size
+    // bufferSize: Size of buffer in bytes
+    // width, height, stride: Pointers to receive the frame layout
+    // timeoutMs: Maximum time to wait for the first frame in milliseconds
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabRawFrameToBuffer(ScreenCaptureSessionHandle session, void* buffer, unsigned int bufferSize, int* width, int* height, int* stride, int timeoutMs);
+
+    // Copy the newest frame of an open session into a caller-provided buffer, converted
+    // to a pixel format in the same pass (stride = width * bytes per pixel)
+    // pixelFormat: ScreenCapturePixelFormat
+    // Other parameters as in GrabRawFrameToBuffer
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabRawFrameToBufferWithPixelFormat(ScreenCaptureSessionHandle session, int pixelFormat, void* buffer, unsigned int bufferSize, int* width, int* height, int* stride, int timeoutMs);
+
+    // Encode the newest frame of an open session (PNG format) into a caller-provided buffer
+    // If the buffer is NULL or too small, returns SC_BUFFER_TOO_SMALL with the required
+    // size in bytesWritten and keeps the encoded frame, so the next call with a large
+    // enough buffer returns that same frame without capturing or encoding again
+    // session: Handle returned by OpenCaptureSession
+    // buffer: Caller-owned buffer, or NULL to query the size
+    // bufferSize: Size of buffer in bytes
+    // bytesWritten: Pointer to receive the PNG size in bytes
+    // timeoutMs: Maximum time to wait for the first frame in milliseconds
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GrabFrameToBuffer(ScreenCaptureSessionHandle session, unsigned char* buffer, unsigned int bufferSize, unsigned int* bytesWritten, int timeoutMs);
+
+    // Crop and downscale the frames of an open session or stream from now on
+    // Texture streams still receive the full frame
+    // session: Handle returned by OpenCaptureSession or StartStream
+    // region: Region to capture, or NULL for the whole frame
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult SetCaptureSessionRegion(ScreenCaptureSessionHandle session, const ScreenCaptureRegion* region);
+
+    // Copy every frame of an open session or stream into a texture of its capture format shared through
+    // an NT handle, so other D3D11/D3D12 devices can use frames without CPU readback
+    // session: Handle returned by OpenCaptureSession or StartStream
+    // options: Sharing options, or NULL for defaults
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult EnableSharedTexture(ScreenCaptureSessionHandle session, const ScreenCaptureSharedTextureOptions* options);
+
+    // Describe the shared texture of a session, waiting for the first shared frame
+    // session: Handle passed to EnableSharedTexture
+    // info: Pointer to receive the texture description
+    // timeoutMs: Maximum time to wait for the first frame in milliseconds
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetSharedTexture(ScreenCaptureSessionHandle session, ScreenCaptureSharedTexture* info, int timeoutMs);
+
+    // Close a session opened by OpenCaptureSession and release its resources
+    // session: Handle returned by OpenCaptureSession (may be null)
+    SCREENCAPTUREDLL_API void CloseCaptureSession(ScreenCaptureSessionHandle session);
+
+    // Start streaming frames to a callback
+    // The frame pool keeps running until StopStream; each frame (or only the newest,
+    // see ScreenCaptureStreamOptions) is handed to callback with its capture timestamp
+    // callback: Function receiving frames
+    // userData: Passed through to callback unchanged
+    // options: Streaming options, or NULL for defaults
+    // stream: Pointer to receive the stream handle
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartStream(ScreenCaptureFrameCallback callback, void* userData, const ScreenCaptureStreamOptions* options, ScreenCaptureSessionHandle* stream);
+
+    // Start streaming frames of a monitor or window to a callback
+    // target: Capture target, or NULL for the primary monitor (SC_TARGET_ALL_MONITORS is not supported)
+    // Other parameters as in StartStream
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartStreamForTarget(const ScreenCaptureTarget* target, ScreenCaptureFrameCallback callback, void* userData, const ScreenCaptureStreamOptions* options, ScreenCaptureSessionHandle* stream);
+
+    // Start streaming frames into a named shared-memory ring for readers in other processes
+    // (layout and read protocol at ScreenCaptureRingHeader); stop it with StopStream
+    // target: Capture target, or NULL for the primary monitor (SC_TARGET_ALL_MONITORS is not supported)
+    // ringOptions: Ring name and size (name is required)
+    // options: Streaming options, or NULL for defaults (texture delivery is not supported)
+    // stream: Pointer to receive the stream handle
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartRingStream(const ScreenCaptureTarget* target, const ScreenCaptureRingOptions* ringOptions, const ScreenCaptureStreamOptions* options, ScreenCaptureSessionHandle* stream);
+
+    // Start streaming frames into files encoded on worker threads; stop it with StopStream,
+    // which waits until every queued frame is written
+    // The stream only copies pixels into a bounded queue, so capture is not limited by encode speed
+    // target: Capture target, or NULL for the primary monitor (SC_TARGET_ALL_MONITORS is not supported)
+    // fileOptions: Output pattern, encoding and queue (outputPattern is required)
+    // options: Streaming options, or NULL for defaults (texture delivery is not supported)
+    // callback: Function told about every written or dropped frame (may be NULL)
+    // userData: Passed through to callback unchanged
+    // stream: Pointer to receive the stream handle
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartFileStream(const ScreenCaptureTarget* target, const ScreenCaptureFileStreamOptions* fileOptions, const ScreenCaptureStreamOptions* options, ScreenCaptureFileCallback callback, void* userData, ScreenCaptureSessionHandle* stream);
+
+    // Get the delivery counters of a stream
+    // stream: Handle returned by StartStream, StartStreamForTarget, StartRingStream or StartFileStream
+    // stats: Pointer to receive the counters
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetStreamStats(ScreenCaptureSessionHandle stream, ScreenCaptureStreamStats* stats);
+
+    // Stop a stream started by StartStream, waiting for an in-flight callback
+    // stream: Handle returned by StartStream (may be null)
+    SCREENCAPTUREDLL_API void StopStream(ScreenCaptureSessionHandle stream);
+
+    // Start recording the primary monitor to an MP4 file with a hardware video encoder
+    // Frames stay on the GPU from capture to encoder
+    // outputPath: Full path to output MP4 file
+    // options: Recording options, or NULL for defaults
+    // recording: Pointer to receive the recording handle
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult StartRecording(const wchar_t* outputPath, const ScreenCaptureRecordOptions* options, ScreenCaptureSessionHandle* recording);
+
+    // Stop a recording started by StartRecording and finalize the file
+    // recording: Handle returned by StartRecording (may be null)
+    // Returns: ScreenCaptureResult error code from encoding or finalizing
+    SCREENCAPTUREDLL_API ScreenCaptureResult StopRecording(ScreenCaptureSessionHandle recording);
+
+    // Get the number of attached monitors (the primary monitor is index 0)
+    SCREENCAPTUREDLL_API int GetMonitorCount();
+
+    // Describe an attached monitor
+    // index: 0 to GetMonitorCount() - 1
+    // info: Pointer to receive the monitor description
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetCaptureMonitorInfo(int index, ScreenCaptureMonitorInfo* info);
+
+    // Get the number of graphics adapters (index 0 is the system default)
+    SCREENCAPTUREDLL_API int GetCaptureAdapterCount();
+
+    // Describe a graphics adapter
+    // index: 0 to GetCaptureAdapterCount() - 1
+    // info: Pointer to receive the adapter description
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetCaptureAdapterInfo(int index, ScreenCaptureAdapterInfo* info);
+
+    // Start a capture without blocking the calling thread
+    // Captures run one after another on a library-owned thread that owns the COM apartment,
+    // so any number can be in flight without a thread per capture
+    // options: Capture options, or NULL for a PNG of the primary monitor in memory
+    // callback: Called when the capture finishes, or NULL to collect the result with WaitCapture
+    // userData: Passed through to callback unchanged
+    // request: Pointer to receive the request id
+    // Returns: ScreenCaptureResult error code (SC_SUCCESS once the capture is queued)
+    SCREENCAPTUREDLL_API ScreenCaptureResult BeginCapture(const ScreenCaptureAsyncOptions* options, ScreenCaptureCompletionCallback callback, void* userData, ScreenCaptureRequestId* request);
+
+    // Wait for a capture started by BeginCapture without a callback, and release it
+    // request: Id returned by BeginCapture
+    // timeoutMs: Maximum time to wait in milliseconds (0 polls)
+    // captureResult: Pointer to receive the result of the capture itself
+    // outputBuffer, bufferSize: Optional pointers to receive the encoded image of a memory
+    // capture (caller must free with FreeBuffer); NULL/0 for file captures
+    // Returns: SC_SUCCESS when the capture finished, SC_TIMEOUT_ERROR while it is still queued
+    // or running (call again later), SC_INVALID_PARAMETER for unknown or released ids
+    SCREENCAPTUREDLL_API ScreenCaptureResult WaitCapture(ScreenCaptureRequestId request, int timeoutMs, ScreenCaptureResult* captureResult, unsigned char** outputBuffer, unsigned int* bufferSize);
+
+    // Cancel a capture started by BeginCapture
+    // A queued capture finishes with SC_CANCELLED at once (its callback runs on the calling
+    // thread); a running capture completes but reports SC_CANCELLED and drops its image
+    // request: Id returned by BeginCapture
+    // Returns: ScreenCaptureResult error code (SC_INVALID_PARAMETER if already finished)
+    SCREENCAPTUREDLL_API ScreenCaptureResult CancelCapture(ScreenCaptureRequestId request);
+
+    // Get per-stage latency statistics of every capture in the process
+    // Timing is always on and costs two QueryPerformanceCounter calls per stage; the same
+    // samples are written as TraceLogging events of the "ScreenCapture" ETW provider
+    // ({1f3ddd28-d8ab-4052-aa36-f143e23e43b4}) while a trace session enables it
+    // stats: Pointer to receive the statistics
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult GetCaptureStats(ScreenCaptureStats* stats);
+
+    // Clear the statistics returned by GetCaptureStats
+    SCREENCAPTUREDLL_API void ResetCaptureStats();
+
+    // Choose the capture API of every later one-shot and BeginCapture capture in the process
+    // (SC_BACKEND_AUTO by default; sessions, streams and recordings always use Graphics Capture)
+    // BeginCapture keeps its Desktop Duplication open, so polling a monitor through it
+    // returns at once while the desktop is unchanged
+    // backend: ScreenCaptureBackend
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult SetCaptureBackend(int backend);
+
+    // Choose the GPU of every later capture, session, stream and recording in the process
+    // SC_GPU_AUTO (the default) creates devices on the adapter that drives the target,
+    // which avoids a cross-adapter copy of each frame on hybrid-GPU laptops
+    // preference: ScreenCaptureGpuPreference, used when the LUID is zero
+    // luidLowPart, luidHighPart: Adapter from GetCaptureAdapterInfo (both 0 for none);
+    //                            captures fail with SC_CAPTURE_SESSION_FAILED once it is removed
+    // Returns: ScreenCaptureResult error code
+    SCREENCAPTUREDLL_API ScreenCaptureResult SetCaptureAdapter(int preference, unsigned int luidLowPart, int luidHighPart);
+
     // Get error description for a given error code
     // errorCode: The error code returned by CaptureScreen
     // Returns: Pointer to null-terminated wide string describing the error